@@ -27,11 +27,15 @@
 #include <QMenuBar>
 
 #ifndef NO_XML_MODULE
+#include <QVector>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #endif
 
 #ifndef NO_SQL_MODULE
+#include <QDir>
+#include <QFileInfo>
+#include <QTimer>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
@@ -90,7 +94,9 @@ SettingManager::SettingManager(QObject *parent) :
  */
 SettingManager::~SettingManager()
 {
-    d->m_Settings->sync();
+    if(d->m_Settings) {
+        d->m_Settings->sync();
+    }
 }
 
 bool SettingManager::initialize()
@@ -125,11 +131,14 @@ bool SettingManager::initialize()
 
 void SettingManager::shutdown()
 {
-    if(!d->m_Initialized) {
-        return;
+#ifndef NO_SQL_MODULE
+    /* Flush and close the connection while the SQL driver is still around;
+       the singleton itself outlives the QApplication.  The store may be in
+       use without initialize(), which only sets up the user interface. */
+    if(d->m_Sqlite) {
+        d->m_Sqlite->close();
     }
-
-    // ...
+#endif
 }
 
 
@@ -141,6 +150,20 @@ void SettingManager::setFormatType(const FormatTypes &type)
 {
     d->m_FormatType = type;
 
+    /* The store in use is written out before it's replaced */
+    QSettings *previous = d->m_Settings;
+    d->m_Settings = NULL;
+    if(previous) {
+        previous->sync();
+    }
+
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        delete d->m_Sqlite;
+        d->m_Sqlite = NULL;
+    }
+#endif
+
     switch(d->m_FormatType) {
     case FormatType_Native:
         d->m_Settings = new QSettings(QSettings::NativeFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName(), this);
@@ -155,13 +178,26 @@ void SettingManager::setFormatType(const FormatTypes &type)
 #endif
 
 #ifndef NO_SQL_MODULE
-    case FormatType_Sqlite:
-        d->m_Settings = new QSettings(d->m_SqliteFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName(), this);
+    case FormatType_Sqlite: {
+        /* The SQLite backend bypasses QSettings, which would rewrite the whole
+           file on every sync; it lives next to where the INI file would be */
+        QSettings locator(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+        QFileInfo fileInfo(locator.fileName());
+        QString fileName = QString("%1/%2.sqlite").arg(fileInfo.absolutePath()).arg(fileInfo.completeBaseName());
+        bool created = !QFileInfo(fileName).exists();
+        d->m_Sqlite = new SqliteSettings(fileName, this);
+
+        /* A new store starts out with what the INI or native store in use held */
+        if(created && previous && d->m_Sqlite->isOpen()) {
+            d->m_Sqlite->migrate(*previous);
+        }
         break;
+    }
 #endif
 
     }
 
+    delete previous;
 }
 
 
@@ -173,6 +209,13 @@ void SettingManager::setFormatType(const FormatTypes &type)
  */
 void SettingManager::setValue(const QString &key, const QVariant &value)
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        d->m_Sqlite->setValue(key, value);
+        return;
+    }
+#endif
+
     d->m_Settings->setValue(key, value);
 }
 
@@ -184,6 +227,12 @@ void SettingManager::setValue(const QString &key, const QVariant &value)
  */
 QVariant SettingManager::value(const QString &key, const QVariant &defaultValue) const
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        return d->m_Sqlite->value(key, defaultValue);
+    }
+#endif
+
     return d->m_Settings->value(key, defaultValue);
 }
 
@@ -193,6 +242,13 @@ QVariant SettingManager::value(const QString &key, const QVariant &defaultValue)
  */
 void SettingManager::remove(const QString &key)
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        d->m_Sqlite->remove(key);
+        return;
+    }
+#endif
+
     d->m_Settings->remove(key);
 }
 
@@ -202,6 +258,12 @@ void SettingManager::remove(const QString &key)
  */
 bool SettingManager::contains(const QString &key) const
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        return d->m_Sqlite->contains(key);
+    }
+#endif
+
     return d->m_Settings->contains(key);
 }
 
@@ -214,6 +276,13 @@ bool SettingManager::contains(const QString &key) const
  */
 void SettingManager::beginGroup(const QString &prefix)
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        d->m_Sqlite->beginGroup(prefix);
+        return;
+    }
+#endif
+
     d->m_Settings->beginGroup(prefix);
 }
 
@@ -225,6 +294,13 @@ void SettingManager::beginGroup(const QString &prefix)
  */
 void SettingManager::endGroup()
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        d->m_Sqlite->endGroup();
+        return;
+    }
+#endif
+
     d->m_Settings->endGroup();
 }
 
@@ -253,6 +329,12 @@ void SettingManager::setGroup(const QString &group)
  */
 QString SettingManager::group() const
 {
+#ifndef NO_SQL_MODULE
+    if(d->m_Sqlite) {
+        return d->m_Sqlite->group();
+    }
+#endif
+
     return d->m_Settings->group();
 }
 
@@ -274,15 +356,16 @@ SettingManagerPrivate::SettingManagerPrivate() :
     QObject(NULL),
     q(NULL),
     m_Initialized(false),
-    m_Settings(new QSettings())
+    m_Settings(new QSettings()),
+    m_FormatType(SettingManager::FormatType_Native)
 {
 
-#ifndef NO_XML_MODULE
-    m_XmlFormat = QSettings::registerFormat(QString("xml"), readXmlFile, writeXmlFile, Qt::CaseSensitive);
+#ifndef NO_SQL_MODULE
+    m_Sqlite = NULL;
 #endif
 
-#ifndef NO_SQL_MODULE
-    m_SqliteFormat = QSettings::registerFormat("sqlite", readSqliteFile, writeSqliteFile, Qt::CaseSensitive);
+#ifndef NO_XML_MODULE
+    m_XmlFormat = QSettings::registerFormat(QString("xml"), readXmlFile, writeXmlFile, Qt::CaseSensitive);
 #endif
 
 }
@@ -500,18 +583,51 @@ static inline QVariant stringToVariant(const QString &s)
 bool SettingManagerPrivate::readXmlFile(QIODevice &device, QSettings::SettingsMap &map)
 {
     QXmlStreamReader reader(&device);
-    QStringList elementStack;
+
+    // The key of the current element is kept in one buffer; each start
+    // element appends its name, and the matching end element truncates it
+    QString path;
+    QVector<int> pathLengths;
+    bool inRoot = false;
+
+    // An element with no child elements is a key, whatever its text; text
+    // may come in several pieces, such as around entity references
+    QString text;
+    bool leaf = false;
 
     while(!reader.atEnd() && !reader.hasError()) {
         reader.readNext();
-        if(reader.isStartElement() && reader.name() != "Settings") {
-            elementStack << reader.name().toString();        // Push
+        if(reader.isStartElement()) {
+            if(!inRoot) {
+                inRoot = true;                               // <Settings>
+                continue;
+            }
+
+            text.clear();
+            leaf = true;
+
+            pathLengths.append(path.size());                 // Push
+            if(!path.isEmpty()) {
+                path.append(QLatin1Char('/'));
+            }
+            path.append(reader.name());
+
         } else if(reader.isEndElement()) {
-            if(!elementStack.isEmpty()) {
-                elementStack.removeLast();                   // Pop
+            if(pathLengths.isEmpty()) {
+                continue;                                    // </Settings>
+            }
+
+            if(leaf) {
+                map[path] = stringToVariant(text);
             }
-        } else if(reader.isCharacters() && !reader.isWhitespace()) {
-            map[elementStack.join("/")] = stringToVariant(reader.text().toString());
+            text.clear();
+            leaf = false;                                    // The parent has a child
+
+            path.truncate(pathLengths.last());               // Pop
+            pathLengths.resize(pathLengths.size() - 1);
+
+        } else if(reader.isCharacters() && leaf) {
+            text.append(reader.text());
         }
     }
 
@@ -523,77 +639,61 @@ bool SettingManagerPrivate::readXmlFile(QIODevice &device, QSettings::SettingsMa
     return true;
 }
 
-struct KeyPath {
-    KeyPath() {}
-    KeyPath(QString name) : name(name) {}
-    KeyPath(QString name, QVariant value) : name(name), value(value) {}
-
-    QString name;
-    QVariant value;
-    QList<KeyPath *> children;
-};
-
-static inline void writeElement(KeyPath *root, QXmlStreamWriter *writer)
-{
-    if(root->children.isEmpty()) {
-        writer->writeStartElement(root->name);
-        writer->writeCharacters(variantToString(root->value));
-        writer->writeEndElement();
-        return;
-    }
-
-    writer->writeStartElement(root->name);
-    foreach(KeyPath *child, root->children) {
-        writeElement(child, writer);
-    }
-    writer->writeEndElement();
-}
-
 bool SettingManagerPrivate::writeXmlFile(QIODevice &device, const QSettings::SettingsMap &map)
 {
+    QXmlStreamWriter writer(&device);
+    writer.setAutoFormatting(true);
 
-    KeyPath *root = new KeyPath();
-    foreach(QString key, map.keys()) {
-        KeyPath *current = root;
-        QVariant value = map.value(key);
-
-        QStringList keyPath = key.split('/');
-        for(int i = 0; i < keyPath.count(); ++i) {
-            QString name = keyPath.at(i);
-
-            if(name == keyPath.last()) {
-                current->children << new KeyPath(name, value);
-
-            } else {
-                bool found = false;
+    writer.writeStartDocument();
+    writer.writeStartElement("Settings");
 
-                foreach(KeyPath *child, current->children) {
-                    if(child->name == name) {
-                        current = child;
-                        found = true;
-                        break;
-                    }
-                }
+    // The map is sorted by key, so the keys under a group are adjacent; only
+    // the groups that differ from those of the previous key are closed and
+    // opened.  The open groups are the leading segments of the previous key,
+    // and groupEnds holds where each one ends in it.
+    QString previous;
+    QVector<int> groupEnds;
+
+    QSettings::SettingsMap::const_iterator iter;
+    for(iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+        const QString &key = iter.key();
+        if(key.isEmpty()) {
+            continue;
+        }
 
-                if(!found) {
-                    KeyPath *child = new KeyPath(name);
-                    current->children.append(child);
-                    current = child;
-                }
+        int nameStart = key.lastIndexOf(QLatin1Char('/')) + 1;
 
+        // Keep open the groups this key is also under
+        int common = 0;
+        int start = 0;
+        while(common < groupEnds.count()) {
+            int end = groupEnds.at(common);
+            if(end >= nameStart || key.at(end) != QLatin1Char('/') ||
+                    key.midRef(start, end - start) != previous.midRef(start, end - start)) {
+                break;
             }
+            start = end + 1;
+            ++common;
         }
-    }
 
+        for(int i = groupEnds.count(); i > common; --i) {
+            writer.writeEndElement();
+        }
+        groupEnds.resize(common);
 
-    QXmlStreamWriter writer(&device);
-    writer.setAutoFormatting(true);
+        while(start < nameStart) {
+            int end = key.indexOf(QLatin1Char('/'), start);
+            writer.writeStartElement(key.mid(start, end - start));
+            groupEnds.append(end);
+            start = end + 1;
+        }
 
-    writer.writeStartDocument();
-    writer.writeStartElement("Settings");
+        writer.writeTextElement(key.mid(nameStart), variantToString(iter.value()));
+        previous = key;
+    }
 
-    foreach(KeyPath *child, root->children) {
-        writeElement(child, &writer);
+    for(int i = groupEnds.count(); i > 0; --i) {
+        writer.writeEndElement();
     }
 
     writer.writeEndElement();
@@ -605,102 +705,390 @@ bool SettingManagerPrivate::writeXmlFile(QIODevice &device, const QSettings::Set
 
 
 #ifndef NO_SQL_MODULE
-bool SettingManagerPrivate::readSqliteFile(QIODevice &device, QSettings::SettingsMap &map)
+/*!
+   \class SqliteSettings
+   \brief SQLite settings backend that keeps its connection open and writes only what changed.
+   \internal
+
+   The whole table is read once when the file is opened; after that, values
+   are served from memory. Modified and removed keys are tracked, and a sync
+   writes just those keys in a single transaction. Syncs are coalesced to the
+   next pass through the event loop, so a burst of setValue() calls costs one
+   transaction.
+ */
+
+static inline QString normalizedKey(const QString &key)
+{
+    QString result;
+    result.reserve(key.size());
+
+    for(int i = 0; i < key.size(); ++i) {
+        QChar c = key.at(i);
+        if(c == QLatin1Char('/') && (result.isEmpty() || result.endsWith(QLatin1Char('/')))) {
+            continue;
+        }
+        result.append(c);
+    }
+
+    if(result.endsWith(QLatin1Char('/'))) {
+        result.chop(1);
+    }
+
+    return result;
+}
+
+SqliteSettings::SqliteSettings(const QString &fileName, QObject *parent) :
+    QObject(parent),
+    m_FileName(fileName),
+    m_ConnectionName(QString("SettingManager:%1").arg(fileName)),
+    m_Open(false),
+    m_SyncPending(false)
+{
+    open();
+}
+
+SqliteSettings::~SqliteSettings()
+{
+    close();
+}
+
+QString SqliteSettings::fileName() const
+{
+    return m_FileName;
+}
+
+bool SqliteSettings::isOpen() const
+{
+    return m_Open;
+}
+
+bool SqliteSettings::open()
 {
     if(!QSqlDatabase::isDriverAvailable("QSQLITE")) {
         qCritical() << Q_FUNC_INFO << "SQLite driver is not available, please try another method of settings persistence";
         return false;
     }
 
-    // Open the database
-    device.close();    // Can't get there from here
-    QString fileName = SettingManager::instance().d->m_Settings->fileName();
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", fileName);
+    QDir().mkpath(QFileInfo(m_FileName).absolutePath());
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_ConnectionName);
+    db.setDatabaseName(m_FileName);
     if(!db.open()) {
         qCritical() << tr("Couldn't open SQLite database file: %1").arg(db.lastError().text());
         return false;
     }
 
+    QSqlQuery query(db);
+
+    // Write-ahead logging keeps commits to an append, instead of rewriting pages in place
+    if(!query.exec("PRAGMA journal_mode=WAL")) {
+        qWarning() << tr("Couldn't enable write-ahead logging for settings: %1").arg(query.lastError().text());
+    }
+    query.exec("PRAGMA synchronous=NORMAL");
+
     // Ensure that the Settings table exists
-    if(!db.tables().contains("Settings")) {
-        qCritical() << tr("Settings table doesn't exist");
+    if(!query.exec("CREATE TABLE IF NOT EXISTS Settings ( key TEXT PRIMARY KEY NOT NULL, value TEXT )")) {
+        qCritical() << tr("Couldn't create Settings table: %1").arg(query.lastError().text());
         return false;
     }
+    query.finish();
 
-    // Read all settings from table into memory
-    QSqlQuery q("SELECT * FROM 'Settings'", db);
-    if(!q.exec()) {
-        qCritical() << tr("Couldn't get values from Settings table: %1").arg(db.lastError().text());
-        return false;
+    m_Open = migrate() && load();
+    return m_Open;
+}
+
+/*!
+   \fn SqliteSettings::migrate()
+   \brief Copies the keys of \a settings that the database doesn't have yet,
+          such as those of the INI or native store used before it, and writes
+          them out.
+ */
+bool SqliteSettings::migrate(const QSettings &settings)
+{
+    foreach(const QString &key, settings.allKeys()) {
+        if(m_Values.contains(key)) {
+            continue;
+        }
+
+        QVariant value = settings.value(key);
+        if(value.isValid()) {
+            m_Values.insert(key, value);
+            m_Removed.remove(key);
+            m_Dirty.insert(key);
+        }
     }
 
-    // Transfer data into the settings map
-    while(q.next()) {
-        QString key = q.value(0).toString();
-        QVariant value = stringToVariant(q.value(1).toString());
+    return sync();
+}
 
-        if(!key.isEmpty() && value.isValid()) {
-            map[key] = value;
+bool SqliteSettings::migrate()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_ConnectionName, false);
+    QSqlQuery query(db);
+
+    if(!query.exec("PRAGMA table_info(Settings)")) {
+        qCritical() << tr("Couldn't inspect Settings table: %1").arg(query.lastError().text());
+        return false;
+    }
+
+    bool keyed = false;
+    while(query.next()) {
+        if(query.value(1).toString() == "key" && query.value(5).toInt() > 0) {
+            keyed = true;
         }
     }
+    query.finish();
 
-    q.finish();
+    if(keyed) {
+        return true;
+    }
+
+    // Earlier versions created the table without a key index, which let rows
+    // pile up for the same key; the most recently written row wins
+    bool okay = db.transaction() &&
+            query.exec("CREATE TABLE SettingsMigration ( key TEXT PRIMARY KEY NOT NULL, value TEXT )") &&
+            query.exec("INSERT OR REPLACE INTO SettingsMigration (key, value) SELECT key, value FROM Settings WHERE key IS NOT NULL ORDER BY rowid") &&
+            query.exec("DROP TABLE Settings") &&
+            query.exec("ALTER TABLE SettingsMigration RENAME TO Settings");
+    query.finish();
+
+    if(!okay || !db.commit()) {
+        qCritical() << tr("Couldn't add a key index to the Settings table: %1").arg(query.lastError().text());
+        db.rollback();
+        return false;
+    }
 
-    // Close the datasbase, and return
-    db.close();
     return true;
 }
 
-bool SettingManagerPrivate::writeSqliteFile(QIODevice &device, const QSettings::SettingsMap &map)
+bool SqliteSettings::load()
 {
+    QSqlDatabase db = QSqlDatabase::database(m_ConnectionName, false);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
 
-    if(!QSqlDatabase::isDriverAvailable("QSQLITE")) {
-        qCritical() << Q_FUNC_INFO << "SQLite driver is not available, please try another method of settings persistence";
+    // Read all settings from table into memory
+    if(!query.exec("SELECT key, value FROM Settings")) {
+        qCritical() << tr("Couldn't get values from Settings table: %1").arg(query.lastError().text());
         return false;
     }
 
-    // Prepare the data to be saved
-    QStringList replaceKeys, replaceValues;
-    foreach(QString key, map.keys()) {
-        replaceKeys << key;
-        replaceValues << variantToString(map.value(key));
+    while(query.next()) {
+        QString key = query.value(0).toString();
+        QVariant value = stringToVariant(query.value(1).toString());
+
+        if(!key.isEmpty() && value.isValid()) {
+            m_Values.insert(key, value);
+        }
     }
 
+    return true;
+}
 
-    // Open the database
-    device.close();    // Can't get there from here
-    QString fileName = SettingManager::instance().d->m_Settings->fileName();
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", fileName);
-    if(!db.open()) {
-        qCritical() << tr("Couldn't open SQLite database file: %1").arg(db.lastError().text());
+/*!
+   \fn SqliteSettings::sync()
+   \brief Writes the modified and removed keys in a single transaction.
+   \returns false if the database is closed or the transaction failed; the
+            pending keys are kept for the next attempt.
+ */
+bool SqliteSettings::sync()
+{
+    m_SyncPending = false;
+
+    if(m_Dirty.isEmpty() && m_Removed.isEmpty()) {
+        return true;
+    }
+
+    if(!m_Open) {
         return false;
     }
 
-    // Ensure that the Settings table exists
-    QSqlQuery createQuery("CREATE TABLE IF NOT EXISTS Settings ( key TEXT, value TEXT )", db);
-    if(!createQuery.exec()) {
-        qCritical() << tr("Couldn't create Settings table: %1").arg(db.lastError().text());
-        db.close();
+    QSqlDatabase db = QSqlDatabase::database(m_ConnectionName, false);
+    if(!db.transaction()) {
+        qCritical() << tr("Couldn't begin a settings transaction: %1").arg(db.lastError().text());
         return false;
     }
-    createQuery.finish();
 
-    // Do the batch query for data previously prepared
-    QSqlQuery replaceQuery(db);
-    replaceQuery.prepare("INSERT OR REPLACE Settings VALUES (?, ?)");
-    replaceQuery.addBindValue(replaceKeys);
-    replaceQuery.addBindValue(replaceValues);
-    if(!replaceQuery.execBatch()) {
-        qCritical() << tr("Couldn't update Settings table: %1").arg(db.lastError().text());
-        db.close();
+    bool okay = true;
+
+    if(!m_Dirty.isEmpty()) {
+        QVariantList keys, values;
+        foreach(const QString &key, m_Dirty) {
+            keys << key;
+            values << variantToString(m_Values.value(key));
+        }
+
+        QSqlQuery replaceQuery(db);
+        replaceQuery.prepare("INSERT OR REPLACE INTO Settings (key, value) VALUES (?, ?)");
+        replaceQuery.addBindValue(keys);
+        replaceQuery.addBindValue(values);
+        if(!replaceQuery.execBatch()) {
+            qCritical() << tr("Couldn't update Settings table: %1").arg(replaceQuery.lastError().text());
+            okay = false;
+        }
+    }
+
+    if(okay && !m_Removed.isEmpty()) {
+        QVariantList keys;
+        foreach(const QString &key, m_Removed) {
+            keys << key;
+        }
+
+        QSqlQuery removeQuery(db);
+        removeQuery.prepare("DELETE FROM Settings WHERE key = ?");
+        removeQuery.addBindValue(keys);
+        if(!removeQuery.execBatch()) {
+            qCritical() << tr("Couldn't remove from Settings table: %1").arg(removeQuery.lastError().text());
+            okay = false;
+        }
+    }
+
+    if(okay && !db.commit()) {
+        qCritical() << tr("Couldn't commit the settings transaction: %1").arg(db.lastError().text());
+        okay = false;
+    }
+
+    if(!okay) {
+        db.rollback();
         return false;
     }
-    replaceQuery.finish();
 
-    // Close the database, and return
-    db.close();
+    m_Dirty.clear();
+    m_Removed.clear();
     return true;
 }
+
+/*!
+   \fn SqliteSettings::close()
+   \brief Writes any pending changes and releases the connection.
+   Changes made afterwards are only kept in memory.
+ */
+void SqliteSettings::close()
+{
+    if(m_Open) {
+        sync();
+    }
+
+    m_Open = false;
+
+    if(QSqlDatabase::contains(m_ConnectionName)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_ConnectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_ConnectionName);
+    }
+}
+
+void SqliteSettings::scheduleSync()
+{
+    if(m_Open && !m_SyncPending) {
+        m_SyncPending = true;
+        QTimer::singleShot(0, this, SLOT(sync()));
+    }
+}
+
+QString SqliteSettings::absoluteKey(const QString &key) const
+{
+    QString result = normalizedKey(key);
+
+    if(m_Group.isEmpty()) {
+        return result;
+    }
+
+    if(result.isEmpty()) {
+        return m_Group;
+    }
+
+    return m_Group + QLatin1Char('/') + result;
+}
+
+void SqliteSettings::markRemoved(const QString &key)
+{
+    m_Dirty.remove(key);
+    m_Removed.insert(key);
+}
+
+void SqliteSettings::setValue(const QString &key, const QVariant &value)
+{
+    QString absolute = absoluteKey(key);
+    if(absolute.isEmpty()) {
+        return;
+    }
+
+    QSettings::SettingsMap::iterator iter = m_Values.find(absolute);
+    if(iter != m_Values.end()) {
+        if(iter.value().userType() == value.userType() && iter.value() == value) {
+            return;
+        }
+        iter.value() = value;
+    } else {
+        m_Values.insert(absolute, value);
+    }
+
+    m_Removed.remove(absolute);
+    m_Dirty.insert(absolute);
+    scheduleSync();
+}
+
+QVariant SqliteSettings::value(const QString &key, const QVariant &defaultValue) const
+{
+    return m_Values.value(absoluteKey(key), defaultValue);
+}
+
+void SqliteSettings::remove(const QString &key)
+{
+    QString absolute = absoluteKey(key);
+
+    if(absolute.isEmpty()) {
+        foreach(const QString &removed, m_Values.keys()) {
+            markRemoved(removed);
+        }
+        m_Values.clear();
+        scheduleSync();
+        return;
+    }
+
+    if(m_Values.remove(absolute)) {
+        markRemoved(absolute);
+    }
+
+    // Sub-settings are contiguous in the sorted map
+    QString prefix = absolute + QLatin1Char('/');
+    QSettings::SettingsMap::iterator iter = m_Values.lowerBound(prefix);
+    while(iter != m_Values.end() && iter.key().startsWith(prefix)) {
+        markRemoved(iter.key());
+        iter = m_Values.erase(iter);
+    }
+
+    scheduleSync();
+}
+
+bool SqliteSettings::contains(const QString &key) const
+{
+    return m_Values.contains(absoluteKey(key));
+}
+
+void SqliteSettings::beginGroup(const QString &prefix)
+{
+    m_Groups.append(m_Group);
+    m_Group = absoluteKey(prefix);
+}
+
+void SqliteSettings::endGroup()
+{
+    if(m_Groups.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "No matching beginGroup()";
+        return;
+    }
+
+    m_Group = m_Groups.takeLast();
+}
+
+QString SqliteSettings::group() const
+{
+    return m_Group;
+}
 #endif
 
 
@@ -36,6 +36,8 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QSet>
+#include <QStringList>
 
 #include "SettingManager.h"
 
@@ -44,6 +46,57 @@ namespace SettingManager {
 
 class ISettingPageFactory;
 
+#ifndef NO_SQL_MODULE
+class SqliteSettings : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SqliteSettings(const QString &fileName, QObject *parent = NULL);
+    ~SqliteSettings();
+
+    QString fileName() const;
+    bool isOpen() const;
+
+    bool migrate(const QSettings &settings);
+
+    void setValue(const QString &key, const QVariant &value);
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+
+    void remove(const QString &key);
+    bool contains(const QString &key) const;
+
+    void beginGroup(const QString &prefix);
+    void endGroup();
+    QString group() const;
+
+public slots:
+    bool sync();
+    void close();
+
+protected:
+    bool open();
+    bool migrate();
+    bool load();
+    void markRemoved(const QString &key);
+    QString absoluteKey(const QString &key) const;
+    void scheduleSync();
+
+private:
+    QString m_FileName;
+    QString m_ConnectionName;
+    bool m_Open;
+    bool m_SyncPending;
+
+    QStringList m_Groups;
+    QString m_Group;
+
+    QSettings::SettingsMap m_Values;
+    QSet<QString> m_Dirty;
+    QSet<QString> m_Removed;
+};
+#endif
+
 class SettingManagerPrivate : public QObject
 {
     Q_OBJECT
@@ -62,12 +115,6 @@ protected:
 #endif
 
 
-#ifndef NO_SQL_MODULE
-    static bool readSqliteFile(QIODevice &device, QSettings::SettingsMap &map);
-    static bool writeSqliteFile(QIODevice &device, const QSettings::SettingsMap &map);
-#endif
-
-
 protected slots:
     void pluginObjectRegistered(QObject *object);
     void pluginObjectDeregistered(QObject *object);
@@ -83,7 +130,7 @@ private:
 #endif
 
 #ifndef NO_SQL_MODULE
-    QSettings::Format m_SqliteFormat;
+    SqliteSettings *m_Sqlite;
 #endif
 
 };
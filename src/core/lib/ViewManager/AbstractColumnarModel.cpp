@@ -0,0 +1,278 @@
+/*!
+   \file AbstractColumnarModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AbstractColumnarModel.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <string.h>
+
+#include "MappedColumnarModelPrivate.h"
+
+namespace Core {
+namespace ViewManager {
+
+/*! \class Core::ViewManager::AbstractColumnarModel
+    \brief Interface to table models that store each column as one contiguous, typed array: 64-bit integers,
+           doubles, or ids into a table of interned strings.
+
+    Besides serving every view through data(), a columnar model hands out its typed columns directly (see
+    doubleColumn() and friends), which TableView's delegate, sorting and filtering use in place of data().  Any
+    columnar model can be saved to a file, which MappedColumnarModel serves straight from disk.
+    \sa ColumnarModel MappedColumnarModel
+ */
+
+AbstractColumnarModel::AbstractColumnarModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+}
+
+AbstractColumnarModel::~AbstractColumnarModel()
+{
+}
+
+/*! \fn AbstractColumnarModel::int64Column()
+    \brief The values of an integer \a column, one per row; NULL for any other type of column.
+ */
+
+/*! \fn AbstractColumnarModel::doubleColumn()
+    \brief The values of a double \a column, one per row; NULL for any other type of column.
+ */
+
+/*! \fn AbstractColumnarModel::stringColumn()
+    \brief The interned string ids of a string \a column, one per row; NULL for any other type of column.
+    \sa internedString()
+ */
+
+/*! \fn AbstractColumnarModel::internedString()
+    \brief The string with \a id; an empty string for an id out of range.
+ */
+
+/*! \fn AbstractColumnarModel::number()
+    \brief The value at \a row in a numeric \a column, as a double; NaN for an empty cell, and 0 for string columns.
+ */
+double AbstractColumnarModel::number(int row, int column) const
+{
+    if(const double *values = doubleColumn(column)) {
+        return values[row];
+    }
+    if(const qint64 *values = int64Column(column)) {
+        return (double)values[row];
+    }
+    return 0.0;
+}
+
+/*! \fn AbstractColumnarModel::string()
+    \brief The value at \a row in a string \a column; numeric columns are converted, and their empty cells are empty.
+ */
+QString AbstractColumnarModel::string(int row, int column) const
+{
+    if(const quint32 *ids = stringColumn(column)) {
+        return internedString(ids[row]);
+    }
+    if(const qint64 *values = int64Column(column)) {
+        return QString::number(values[row]);
+    }
+    double value = number(row, column);
+    return (value == value) ? QString::number(value) : QString();
+}
+
+/* Orders string ids by the strings they stand for */
+struct InternedStringLess
+{
+    InternedStringLess(const QVector<QString> &strings, Qt::CaseSensitivity cs) : m_Strings(strings), m_Cs(cs) {}
+    bool operator()(quint32 left, quint32 right) const
+    {
+        return QString::compare(m_Strings.at(left), m_Strings.at(right), m_Cs) < 0;
+    }
+    const QVector<QString> &m_Strings;
+    Qt::CaseSensitivity m_Cs;
+};
+
+/*! \fn AbstractColumnarModel::internedStringRanks()
+    \brief For each interned string id, the position of its string in sorted order; strings that compare equal share
+           a rank.  Sorting a string column by these ranks sorts it by its strings, at the cost of comparing numbers.
+ */
+QVector<quint32> AbstractColumnarModel::internedStringRanks(Qt::CaseSensitivity cs) const
+{
+    int count = internedStringCount();
+
+    QVector<QString> strings(count);
+    QVector<quint32> order(count);
+    for(int id = 0; id < count; ++id) {
+        strings[id] = internedString(id);
+        order[id] = id;
+    }
+
+    InternedStringLess less(strings, cs);
+    std::sort(order.begin(), order.end(), less);
+
+    QVector<quint32> ranks(count);
+    quint32 rank = 0;
+    for(int i = 0; i < count; ++i) {
+        if(i > 0 && less(order.at(i - 1), order.at(i))) {
+            ++rank;
+        }
+        ranks[order.at(i)] = rank;
+    }
+
+    return ranks;
+}
+
+/*! \fn AbstractColumnarModel::save()
+    \brief Writes the model to \a fileName in the columnar table format, for MappedColumnarModel to open.  On failure,
+           returns false and sets \a errorMessage.
+    Tool backends can fill a ColumnarModel with their results and save it, rather than writing text to be parsed.
+    \sa MappedColumnarModel::open()
+ */
+bool AbstractColumnarModel::save(const QString &fileName, QString *errorMessage) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if(errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    int rows = rowCount();
+    int columns = columnCount();
+    int strings = internedStringCount();
+
+    // Lay the file out: header, column table, column names, column blocks, string index, string data
+    quint64 offset = sizeof(ColumnarFile::Header);
+    quint64 columnTableOffset = offset;
+    offset += columns * sizeof(ColumnarFile::Column);
+
+    QVector<ColumnarFile::Column> columnTable(columns);
+    QStringList names;
+    for(int column = 0; column < columns; ++column) {
+        names.append(columnName(column));
+        memset(&columnTable[column], 0, sizeof(ColumnarFile::Column));
+        columnTable[column].type = columnType(column);
+        columnTable[column].nameLength = names.last().length();
+        columnTable[column].nameOffset = offset;
+        offset += names.last().length() * sizeof(ushort);
+    }
+
+    for(int column = 0; column < columns; ++column) {
+        offset = ColumnarFile::align(offset);
+        columnTable[column].dataOffset = offset;
+        offset += (quint64)rows * ColumnarFile::valueSize(columnTable.at(column).type);
+    }
+
+    offset = ColumnarFile::align(offset);
+    quint64 dictionaryOffset = offset;
+    offset += strings * sizeof(ColumnarFile::String);
+
+    QVector<ColumnarFile::String> dictionary(strings);
+    for(int id = 0; id < strings; ++id) {
+        memset(&dictionary[id], 0, sizeof(ColumnarFile::String));
+        dictionary[id].offset = offset;
+        dictionary[id].length = internedString(id).length();
+        offset += dictionary[id].length * sizeof(ushort);
+    }
+
+    ColumnarFile::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ColumnarFile::Magic, sizeof(header.magic));
+    header.byteOrder = ColumnarFile::ByteOrder;
+    header.version = ColumnarFile::Version;
+    header.rowCount = rows;
+    header.columnCount = columns;
+    header.columnTableOffset = columnTableOffset;
+    header.dictionaryOffset = dictionaryOffset;
+    header.dictionaryCount = strings;
+
+    // Then write it out in the same order
+    static const char padding[8] = { 0 };
+    bool ok = (file.write((const char *)&header, sizeof(header)) == sizeof(header));
+    ok = ok && file.write((const char *)columnTable.constData(), columns * sizeof(ColumnarFile::Column)) >= 0;
+    foreach(const QString &name, names) {
+        ok = ok && file.write((const char *)name.utf16(), name.length() * sizeof(ushort)) >= 0;
+    }
+
+    for(int column = 0; ok && column < columns; ++column) {
+        ok = ok && file.write(padding, columnTable.at(column).dataOffset - file.pos()) >= 0;
+
+        const char *values = NULL;
+        switch(columnTable.at(column).type) {
+        case ColumnType_Int64:  values = (const char *)int64Column(column);  break;
+        case ColumnType_Double: values = (const char *)doubleColumn(column); break;
+        default:                values = (const char *)stringColumn(column); break;
+        }
+
+        qint64 bytes = (qint64)rows * ColumnarFile::valueSize(columnTable.at(column).type);
+        ok = ok && (bytes == 0 || file.write(values, bytes) == bytes);
+    }
+
+    ok = ok && file.write(padding, dictionaryOffset - file.pos()) >= 0;
+    ok = ok && file.write((const char *)dictionary.constData(), strings * sizeof(ColumnarFile::String)) >= 0;
+    for(int id = 0; ok && id < strings; ++id) {
+        QString string = internedString(id);
+        ok = ok && file.write((const char *)string.utf16(), string.length() * sizeof(ushort)) >= 0;
+    }
+
+    if(!ok || !file.flush()) {
+        if(errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        file.close();
+        file.remove();
+        return false;
+    }
+
+    return true;
+}
+
+QVariant AbstractColumnarModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+
+    if(const double *values = doubleColumn(index.column())) {
+        double value = values[index.row()];
+        return (value == value) ? QVariant(value) : QVariant();
+    }
+    if(const qint64 *values = int64Column(index.column())) {
+        return QVariant((qlonglong)values[index.row()]);
+    }
+    if(const quint32 *ids = stringColumn(index.column())) {
+        return QVariant(internedString(ids[index.row()]));
+    }
+    return QVariant();
+}
+
+QVariant AbstractColumnarModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < columnCount()) {
+        return columnName(section);
+    }
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+} // namespace ViewManager
+} // namespace Core
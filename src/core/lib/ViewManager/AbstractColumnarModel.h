@@ -0,0 +1,73 @@
+/*!
+   \file AbstractColumnarModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_ABSTRACTCOLUMNARMODEL_H
+#define CORE_VIEWMANAGER_ABSTRACTCOLUMNARMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "ViewManagerLibrary.h"
+
+namespace Core {
+namespace ViewManager {
+
+class VIEWMANAGER_EXPORT AbstractColumnarModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum ColumnType {
+        ColumnType_Int64 = 0,
+        ColumnType_Double,
+        ColumnType_String
+    };
+
+    explicit AbstractColumnarModel(QObject *parent = 0);
+    virtual ~AbstractColumnarModel();
+
+    virtual ColumnType columnType(int column) const = 0;
+    virtual QString columnName(int column) const = 0;
+
+    virtual const qint64 *int64Column(int column) const = 0;
+    virtual const double *doubleColumn(int column) const = 0;
+    virtual const quint32 *stringColumn(int column) const = 0;
+
+    virtual QString internedString(quint32 id) const = 0;
+    virtual int internedStringCount() const = 0;
+    virtual QVector<quint32> internedStringRanks(Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+    double number(int row, int column) const;
+    QString string(int row, int column) const;
+
+    bool save(const QString &fileName, QString *errorMessage = NULL) const;
+
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_ABSTRACTCOLUMNARMODEL_H
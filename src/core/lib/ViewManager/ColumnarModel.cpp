@@ -0,0 +1,322 @@
+/*!
+   \file ColumnarModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ColumnarModelPrivate.h"
+
+namespace Core {
+namespace ViewManager {
+
+/*! \class Core::ViewManager::ColumnarModel
+    \brief Table model that stores each column as one contiguous, typed vector: 64-bit integers, doubles, or ids
+           into a table of interned strings.
+
+    A million rows of a double column take eight megabytes, rather than a QStandardItem and a boxed QVariant per cell.
+    The model implements QAbstractItemModel for any view, and also gives direct access to the typed column data through
+    AbstractColumnarModel, which TableView's delegate, sorting and filtering use in place of data().
+
+    Rows are added in batches: beginAppendRows() makes room for them, the setters fill them in without notifying
+    anyone, and endAppendRows() makes them visible with a single rowsInserted().
+    \code
+    int first = model.beginAppendRows(count);
+    for(int row = first; row < first + count; ++row) {
+        model.setString(row, 0, functionName);
+        model.setDouble(row, 1, time);
+    }
+    model.endAppendRows();
+    \endcode
+    \sa AbstractColumnarModel MappedColumnarModel
+ */
+
+ColumnarModel::ColumnarModel(QObject *parent) :
+    AbstractColumnarModel(parent),
+    d(new ColumnarModelPrivate)
+{
+    d->q = this;
+}
+
+ColumnarModel::~ColumnarModel()
+{
+}
+
+/*! \fn ColumnarModel::addColumn()
+    \brief Appends a column of \a type, filled with zeros or empty strings, and returns its index.
+ */
+int ColumnarModel::addColumn(const QString &name, ColumnType type)
+{
+    int column = d->m_Columns.count();
+
+    ColumnarModelPrivate::Column data;
+    data.name = name;
+    data.type = type;
+    d->resizeColumn(data, d->m_StoredRows);
+
+    beginInsertColumns(QModelIndex(), column, column);
+    d->m_Columns.append(data);
+    endInsertColumns();
+
+    return column;
+}
+
+ColumnarModel::ColumnType ColumnarModel::columnType(int column) const
+{
+    return d->m_Columns.at(column).type;
+}
+
+QString ColumnarModel::columnName(int column) const
+{
+    return d->m_Columns.at(column).name;
+}
+
+/*! \fn ColumnarModel::clear()
+    \brief Removes every row and column, and the interned strings.
+ */
+void ColumnarModel::clear()
+{
+    beginResetModel();
+    d->m_Columns.clear();
+    d->m_RowCount = 0;
+    d->m_StoredRows = 0;
+    d->m_Capacity = 0;
+    d->m_Strings.resize(1);
+    d->m_StringIds.clear();
+    d->m_StringIds.insert(QString(), 0);
+    endResetModel();
+}
+
+/*! \fn ColumnarModel::reserve()
+    \brief Allocates room for \a rows rows up front, so appending them doesn't reallocate the columns.
+ */
+void ColumnarModel::reserve(int rows)
+{
+    d->m_Capacity = rows;
+    for(int i = 0; i < d->m_Columns.count(); ++i) {
+        ColumnarModelPrivate::Column &column = d->m_Columns[i];
+        switch(column.type) {
+        case ColumnType_Int64:  column.int64s.reserve(rows);  break;
+        case ColumnType_Double: column.doubles.reserve(rows); break;
+        case ColumnType_String: column.strings.reserve(rows); break;
+        }
+    }
+}
+
+/*! \fn ColumnarModel::beginAppendRows()
+    \brief Adds \a count rows after any already waiting, and returns the first of them.  They can be filled in with
+           the setters, but aren't part of the model until endAppendRows().
+ */
+int ColumnarModel::beginAppendRows(int count)
+{
+    int first = d->m_StoredRows;
+    d->m_StoredRows += count;
+    for(int i = 0; i < d->m_Columns.count(); ++i) {
+        d->resizeColumn(d->m_Columns[i], d->m_StoredRows);
+    }
+    return first;
+}
+
+/*! \fn ColumnarModel::endAppendRows()
+    \brief Makes every row added since the last call visible, with a single rowsInserted().
+ */
+void ColumnarModel::endAppendRows()
+{
+    if(d->m_StoredRows == d->m_RowCount) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), d->m_RowCount, d->m_StoredRows - 1);
+    d->m_RowCount = d->m_StoredRows;
+    endInsertRows();
+}
+
+void ColumnarModel::setInt64(int row, int column, qint64 value)
+{
+    ColumnarModelPrivate::Column &data = d->m_Columns[column];
+    if(data.type == ColumnType_Int64) {
+        data.int64s[row] = value;
+    } else if(data.type == ColumnType_Double) {
+        data.doubles[row] = (double)value;
+    } else {
+        data.strings[row] = d->intern(QString::number(value));
+    }
+    d->emitDataChanged(row, column);
+}
+
+void ColumnarModel::setDouble(int row, int column, double value)
+{
+    ColumnarModelPrivate::Column &data = d->m_Columns[column];
+    if(data.type == ColumnType_Double) {
+        data.doubles[row] = value;
+    } else if(data.type == ColumnType_Int64) {
+        data.int64s[row] = (qint64)value;
+    } else {
+        data.strings[row] = d->intern(QString::number(value));
+    }
+    d->emitDataChanged(row, column);
+}
+
+void ColumnarModel::setString(int row, int column, const QString &value)
+{
+    ColumnarModelPrivate::Column &data = d->m_Columns[column];
+    if(data.type == ColumnType_String) {
+        data.strings[row] = d->intern(value);
+    } else if(data.type == ColumnType_Double) {
+        data.doubles[row] = value.toDouble();
+    } else {
+        data.int64s[row] = value.toLongLong();
+    }
+    d->emitDataChanged(row, column);
+}
+
+/*! \fn ColumnarModel::int64Column()
+    \brief The values of an integer \a column, one per row; NULL for any other type of column.
+    The pointer is only valid until rows or columns are next added.
+ */
+const qint64 *ColumnarModel::int64Column(int column) const
+{
+    const ColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_Int64) ? data.int64s.constData() : NULL;
+}
+
+/*! \fn ColumnarModel::doubleColumn()
+    \brief The values of a double \a column, one per row; NULL for any other type of column.
+    The pointer is only valid until rows or columns are next added.
+ */
+const double *ColumnarModel::doubleColumn(int column) const
+{
+    const ColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_Double) ? data.doubles.constData() : NULL;
+}
+
+/*! \fn ColumnarModel::stringColumn()
+    \brief The interned string ids of a string \a column, one per row; NULL for any other type of column.
+    The pointer is only valid until rows or columns are next added.
+    \sa internedString()
+ */
+const quint32 *ColumnarModel::stringColumn(int column) const
+{
+    const ColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_String) ? data.strings.constData() : NULL;
+}
+
+QString ColumnarModel::internedString(quint32 id) const
+{
+    return d->m_Strings.at(id);
+}
+
+int ColumnarModel::internedStringCount() const
+{
+    return d->m_Strings.count();
+}
+
+/*! \fn ColumnarModel::memoryUsage()
+    \brief Approximate number of bytes held by the columns and the string table.
+ */
+qint64 ColumnarModel::memoryUsage() const
+{
+    qint64 bytes = 0;
+
+    foreach(const ColumnarModelPrivate::Column &column, d->m_Columns) {
+        bytes += (qint64)column.int64s.capacity() * sizeof(qint64);
+        bytes += (qint64)column.doubles.capacity() * sizeof(double);
+        bytes += (qint64)column.strings.capacity() * sizeof(quint32);
+    }
+
+    foreach(const QString &string, d->m_Strings) {
+        bytes += sizeof(QString) + string.capacity() * sizeof(QChar);
+    }
+    bytes += (qint64)d->m_StringIds.capacity() * (sizeof(QString) + sizeof(quint32) + 2 * sizeof(void *));
+
+    return bytes;
+}
+
+int ColumnarModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_RowCount;
+}
+
+int ColumnarModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_Columns.count();
+}
+
+
+
+
+ColumnarModelPrivate::ColumnarModelPrivate() :
+    m_RowCount(0),
+    m_StoredRows(0),
+    m_Capacity(0)
+{
+    m_Strings.append(QString());
+    m_StringIds.insert(QString(), 0);
+}
+
+void ColumnarModelPrivate::resizeColumn(Column &column, int rows)
+{
+    // Only a reserve() still to be honoured is applied up front; growing past it is left to resize(), which
+    // over-allocates so that appending row after row stays linear
+    switch(column.type) {
+    case ColumnarModel::ColumnType_Int64:
+        if(m_Capacity > column.int64s.capacity()) {
+            column.int64s.reserve(m_Capacity);
+        }
+        column.int64s.resize(rows);
+        break;
+    case ColumnarModel::ColumnType_Double:
+        if(m_Capacity > column.doubles.capacity()) {
+            column.doubles.reserve(m_Capacity);
+        }
+        column.doubles.resize(rows);
+        break;
+    case ColumnarModel::ColumnType_String:
+        if(m_Capacity > column.strings.capacity()) {
+            column.strings.reserve(m_Capacity);
+        }
+        column.strings.resize(rows);
+        break;
+    }
+}
+
+quint32 ColumnarModelPrivate::intern(const QString &string)
+{
+    QHash<QString, quint32>::const_iterator iter = m_StringIds.constFind(string);
+    if(iter != m_StringIds.constEnd()) {
+        return iter.value();
+    }
+
+    quint32 id = m_Strings.count();
+    m_Strings.append(string);
+    m_StringIds.insert(string, id);
+    return id;
+}
+
+/* Rows still waiting for endAppendRows() aren't part of the model yet, so nobody is told about them */
+void ColumnarModelPrivate::emitDataChanged(int row, int column)
+{
+    if(row < m_RowCount) {
+        QModelIndex index = q->index(row, column);
+        emit q->dataChanged(index, index);
+    }
+}
+
+} // namespace ViewManager
+} // namespace Core
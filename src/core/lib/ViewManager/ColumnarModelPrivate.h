@@ -0,0 +1,84 @@
+/*!
+   \file ColumnarModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_COLUMNARMODELPRIVATE_H
+#define CORE_VIEWMANAGER_COLUMNARMODELPRIVATE_H
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public PTGF API.  This header file may change
+// from version to version without notice, or even be removed.
+//
+
+
+#include "ColumnarModel.h"
+
+#include <QHash>
+#include <QStringList>
+
+
+namespace Core {
+namespace ViewManager {
+
+class ColumnarModelPrivate
+{
+    Q_DISABLE_COPY(ColumnarModelPrivate)
+    DECLARE_PUBLIC(ColumnarModel)
+
+public:
+    /* Only the vector matching the type is used */
+    struct Column {
+        Column() : type(ColumnarModel::ColumnType_Double) {}
+        QString name;
+        ColumnarModel::ColumnType type;
+        QVector<qint64> int64s;
+        QVector<double> doubles;
+        QVector<quint32> strings;
+    };
+
+    ColumnarModelPrivate();
+
+    void resizeColumn(Column &column, int rows);
+    quint32 intern(const QString &string);
+    void emitDataChanged(int row, int column);
+
+private:
+    QVector<Column> m_Columns;
+
+    /* Rows up to m_RowCount are visible; rows appended up to m_StoredRows are waiting for endAppendRows() */
+    int m_RowCount;
+    int m_StoredRows;
+    int m_Capacity;
+
+    /* Every distinct string in the model is stored once; id 0 is the empty string */
+    QVector<QString> m_Strings;
+    QHash<QString, quint32> m_StringIds;
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_COLUMNARMODELPRIVATE_H
@@ -0,0 +1,670 @@
+/*!
+   \file FilterExpression.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "FilterExpressionPrivate.h"
+
+#include <QAbstractItemModel>
+#include <QObject>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <functional>
+#include <cstring>
+
+namespace Core {
+namespace ViewManager {
+
+/*! \class Core::ViewManager::FilterExpression
+    \brief A filter over the columns of a table, such as \c{excl_time > 0.5 && function ~ "MPI_"}, compiled once and
+           then evaluated over the raw, typed values of each column.
+
+    An expression is made of comparisons joined by \c{&&} (\c{and}), \c{||} (\c{or}) and \c{!} (\c{not}), grouped
+    with parentheses.  Each comparison names a column on its left, and a number, a quoted string or a bare word on its
+    right.  The operators are \c{==} (or \c{=}), \c{!=}, \c{<}, \c{<=}, \c{>}, \c{>=}, and \c{~} and \c{!~} for
+    regular expression matches.  String comparisons and matches ignore case.
+
+    Columns are named by their header text, quoted if it contains spaces, or by an identifier where anything but
+    letters and digits is written as an underscore.  Each word of an identifier may be abbreviated, as long as only
+    one column matches: \c{excl_time} names "Exclusive Time (ms)".  \c{$1} names the first column.
+
+    The expression is compiled into a postfix program of comparisons; evaluation runs each comparison over a block of
+    rows at a time, in a tight loop over the column's numbers or strings, and combines the resulting masks.  Evaluation
+    is const and thread-safe, and evaluate() splits the rows across the available cores.
+    \sa IViewFilterable::setViewFilterExpression()
+ */
+
+/*! \fn FilterExpression::FilterExpression()
+    \brief Compiles \a pattern, resolving the column names in it against \a columnNames.
+    \sa isValid() errorString()
+ */
+FilterExpression::FilterExpression(const QString &pattern, const QStringList &columnNames) :
+    d(new FilterExpressionPrivate)
+{
+    d->q = this;
+    d->m_Pattern = pattern;
+    d->m_ColumnNames = columnNames;
+
+    if(pattern.trimmed().isEmpty()) {
+        return;
+    }
+
+    d->m_Valid = d->tokenize() && d->parseOr();
+    if(d->m_Valid && d->m_Tokens.at(d->m_Current).type != FilterExpressionPrivate::Token_End) {
+        d->m_Valid = d->setError(QObject::tr("Unexpected '%1'").arg(d->m_Tokens.at(d->m_Current).text),
+                                 d->m_Tokens.at(d->m_Current).position);
+    }
+
+    if(!d->m_Valid) {
+        d->m_Program.clear();
+        d->m_Columns.clear();
+        return;
+    }
+
+    // Comparisons push a mask, binary operators pop one
+    int depth = 0;
+    foreach(const FilterExpressionPrivate::Node &node, d->m_Program) {
+        if(node.type == FilterExpressionPrivate::Node_Compare) {
+            d->m_Depth = qMax(d->m_Depth, ++depth);
+        } else if(node.type != FilterExpressionPrivate::Node_Not) {
+            --depth;
+        }
+    }
+}
+
+FilterExpression::~FilterExpression()
+{
+}
+
+QString FilterExpression::pattern() const
+{
+    return d->m_Pattern;
+}
+
+/*! \fn FilterExpression::isEmpty()
+    \brief Whether the expression is blank, and so accepts every row.
+ */
+bool FilterExpression::isEmpty() const
+{
+    return d->m_Program.isEmpty() && d->m_Valid;
+}
+
+bool FilterExpression::isValid() const
+{
+    return d->m_Valid;
+}
+
+/*! \fn FilterExpression::errorString()
+    \brief Describes why the expression didn't compile, including where in the pattern.
+ */
+QString FilterExpression::errorString() const
+{
+    return d->m_ErrorString;
+}
+
+/*! \fn FilterExpression::columns()
+    \brief The model columns the expression refers to.  The Column arrays passed to evaluate() are in this order.
+ */
+QList<int> FilterExpression::columns() const
+{
+    return d->m_Columns;
+}
+
+/*! \fn FilterExpression::evaluateRange()
+    \brief Evaluates rows \a begin up to \a end, setting \c{accepted[row - begin]} to 1 for each row that matches, and
+           0 for each that doesn't.  Safe to call from several threads at once.
+ */
+void FilterExpression::evaluateRange(const QVector<Column> &columns, int begin, int end, char *accepted) const
+{
+    static const int BlockSize = 4096;
+
+    if(end <= begin) {
+        return;
+    }
+
+    if(d->m_Program.isEmpty()) {
+        memset(accepted, d->m_Valid ? 1 : 0, end - begin);
+        return;
+    }
+
+    // QRegExp caches its last match, so each caller matches with its own copies
+    QVector<QRegExp> regExps(d->m_Program.count());
+    for(int i = 0; i < d->m_Program.count(); ++i) {
+        regExps[i] = d->m_Program.at(i).regExp;
+    }
+
+    QVector<QVector<char> > stack(d->m_Depth);
+    for(int i = 0; i < stack.count(); ++i) {
+        stack[i].resize(BlockSize);
+    }
+
+    for(int blockBegin = begin; blockBegin < end; blockBegin += BlockSize) {
+        int count = qMin(BlockSize, end - blockBegin);
+        int top = 0;
+
+        for(int i = 0; i < d->m_Program.count(); ++i) {
+            const FilterExpressionPrivate::Node &node = d->m_Program.at(i);
+            switch(node.type) {
+            case FilterExpressionPrivate::Node_Compare:
+                d->compareBlock(node, columns.at(node.slot), blockBegin, count, stack[top++].data(), regExps[i]);
+                break;
+            case FilterExpressionPrivate::Node_And: {
+                --top;
+                char *left = stack[top - 1].data();
+                const char *right = stack.at(top).constData();
+                for(int row = 0; row < count; ++row) {
+                    left[row] &= right[row];
+                }
+                break;
+            }
+            case FilterExpressionPrivate::Node_Or: {
+                --top;
+                char *left = stack[top - 1].data();
+                const char *right = stack.at(top).constData();
+                for(int row = 0; row < count; ++row) {
+                    left[row] |= right[row];
+                }
+                break;
+            }
+            case FilterExpressionPrivate::Node_Not: {
+                char *operand = stack[top - 1].data();
+                for(int row = 0; row < count; ++row) {
+                    operand[row] = !operand[row];
+                }
+                break;
+            }
+            }
+        }
+
+        memcpy(accepted + (blockBegin - begin), stack.at(0).constData(), count);
+    }
+}
+
+/*! \fn FilterExpression::evaluate()
+    \brief Evaluates the first \a rowCount rows, split across the available cores, and returns one flag per row.
+    \sa evaluateRange()
+ */
+QVector<char> FilterExpression::evaluate(const QVector<Column> &columns, int rowCount) const
+{
+    static const int MinimumChunk = 65536;
+
+    QVector<char> accepted(rowCount);
+    int chunks = qMax(1, qMin(QThread::idealThreadCount(), rowCount / MinimumChunk));
+
+    QList<QFuture<void> > futures;
+    for(int i = 0; i < chunks; ++i) {
+        int begin = (int)(((qint64)rowCount * i) / chunks);
+        int end = (int)(((qint64)rowCount * (i + 1)) / chunks);
+        futures.append(QtConcurrent::run(this, &FilterExpression::evaluateRange, columns, begin, end,
+                                         accepted.data() + begin));
+    }
+    foreach(QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+
+    return accepted;
+}
+
+/*! \fn FilterExpression::columnNames()
+    \brief The horizontal header texts of \a model, for resolving column names against.
+ */
+QStringList FilterExpression::columnNames(const QAbstractItemModel *model)
+{
+    QStringList names;
+    if(model) {
+        for(int column = 0; column < model->columnCount(); ++column) {
+            names.append(model->headerData(column, Qt::Horizontal, Qt::DisplayRole).toString());
+        }
+    }
+    return names;
+}
+
+
+
+
+/* Lowercase, with every run of anything but letters and digits turned into a single underscore */
+static QString normalizedName(const QString &name)
+{
+    QString normalized;
+    normalized.reserve(name.count());
+    foreach(QChar c, name.toLower()) {
+        if(c.isLetterOrNumber()) {
+            normalized.append(c);
+        } else if(!normalized.isEmpty() && !normalized.endsWith(QLatin1Char('_'))) {
+            normalized.append(QLatin1Char('_'));
+        }
+    }
+    while(normalized.endsWith(QLatin1Char('_'))) {
+        normalized.chop(1);
+    }
+    return normalized;
+}
+
+/* Whether each word of an abbreviation starts the corresponding word of a name */
+static bool abbreviates(const QStringList &abbreviation, const QStringList &name)
+{
+    if(abbreviation.count() > name.count()) {
+        return false;
+    }
+    for(int i = 0; i < abbreviation.count(); ++i) {
+        if(!name.at(i).startsWith(abbreviation.at(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Compare>
+static void compareNumbers(const double *values, int count, double number, char *out, Compare compare,
+                           char empty = 0)
+{
+    for(int row = 0; row < count; ++row) {
+        double value = values[row];
+        out[row] = (value == value) ? (compare(value, number) ? 1 : 0) : empty;
+    }
+}
+
+
+FilterExpressionPrivate::FilterExpressionPrivate() :
+    m_Valid(true),
+    m_Current(0),
+    m_Depth(0)
+{
+}
+
+bool FilterExpressionPrivate::setError(const QString &message, int position)
+{
+    m_ErrorString = QObject::tr("%1 at position %2").arg(message).arg(position + 1);
+    return false;
+}
+
+/*!
+   \internal
+   \brief Splits the pattern into tokens; a '-' or '+' directly before a number is part of it.
+ */
+bool FilterExpressionPrivate::tokenize()
+{
+    const QString &text = m_Pattern;
+    int i = 0;
+
+    while(true) {
+        while(i < text.count() && text.at(i).isSpace()) {
+            ++i;
+        }
+
+        Token token;
+        token.position = i;
+
+        if(i >= text.count()) {
+            token.type = Token_End;
+            m_Tokens.append(token);
+            return true;
+        }
+
+        QChar c = text.at(i);
+        QChar next = (i + 1 < text.count()) ? text.at(i + 1) : QChar();
+        QChar afterSign = (i + 2 < text.count()) ? text.at(i + 2) : QChar();
+
+        if(c == QLatin1Char('(') || c == QLatin1Char(')')) {
+            token.type = (c == QLatin1Char('(')) ? Token_Open : Token_Close;
+            token.text = c;
+            ++i;
+        } else if(c == QLatin1Char('&') && next == QLatin1Char('&')) {
+            token.type = Token_And;
+            token.text = QLatin1String("&&");
+            i += 2;
+        } else if(c == QLatin1Char('|') && next == QLatin1Char('|')) {
+            token.type = Token_Or;
+            token.text = QLatin1String("||");
+            i += 2;
+        } else if(c == QLatin1Char('!') || c == QLatin1Char('=') || c == QLatin1Char('<') ||
+                  c == QLatin1Char('>') || c == QLatin1Char('~')) {
+            token.type = Token_Operator;
+            bool equals = (next == QLatin1Char('='));
+            if(c == QLatin1Char('!') && next == QLatin1Char('~')) {
+                token.op = Operator_NotMatch;
+            } else if(c == QLatin1Char('!')) {
+                token.type = equals ? Token_Operator : Token_Not;
+                token.op = Operator_NotEqual;
+            } else if(c == QLatin1Char('=')) {
+                token.op = Operator_Equal;
+            } else if(c == QLatin1Char('<')) {
+                token.op = equals ? Operator_LessEqual : Operator_Less;
+            } else if(c == QLatin1Char('>')) {
+                token.op = equals ? Operator_GreaterEqual : Operator_Greater;
+            } else {
+                token.op = Operator_Match;
+            }
+            int length = (equals || (c == QLatin1Char('!') && next == QLatin1Char('~'))) ? 2 : 1;
+            token.text = text.mid(i, length);
+            i += length;
+        } else if(c == QLatin1Char('"') || c == QLatin1Char('\'')) {
+            token.type = Token_String;
+            ++i;
+            while(i < text.count() && text.at(i) != c) {
+                if(text.at(i) == QLatin1Char('\\') && i + 1 < text.count()) {
+                    ++i;
+                }
+                token.text.append(text.at(i++));
+            }
+            if(i >= text.count()) {
+                return setError(QObject::tr("Unterminated string"), token.position);
+            }
+            ++i;
+        } else if(c.isDigit() || (c == QLatin1Char('.') && next.isDigit()) ||
+                  ((c == QLatin1Char('-') || c == QLatin1Char('+')) &&
+                   (next.isDigit() || (next == QLatin1Char('.') && afterSign.isDigit())))) {
+            int start = i++;
+            while(i < text.count() && (text.at(i).isDigit() || text.at(i) == QLatin1Char('.'))) {
+                ++i;
+            }
+            if(i < text.count() && (text.at(i) == QLatin1Char('e') || text.at(i) == QLatin1Char('E'))) {
+                int exponent = i + 1;
+                if(exponent < text.count() && (text.at(exponent) == QLatin1Char('-') || text.at(exponent) == QLatin1Char('+'))) {
+                    ++exponent;
+                }
+                if(exponent < text.count() && text.at(exponent).isDigit()) {
+                    i = exponent;
+                    while(i < text.count() && text.at(i).isDigit()) {
+                        ++i;
+                    }
+                }
+            }
+            token.type = Token_Number;
+            token.text = text.mid(start, i - start);
+            bool ok = false;
+            token.number = token.text.toDouble(&ok);
+            if(!ok) {
+                return setError(QObject::tr("Invalid number '%1'").arg(token.text), start);
+            }
+        } else if(c.isLetter() || c == QLatin1Char('_') || c == QLatin1Char('$')) {
+            int start = i++;
+            while(i < text.count() && (text.at(i).isLetterOrNumber() || text.at(i) == QLatin1Char('_') ||
+                                       text.at(i) == QLatin1Char('.'))) {
+                ++i;
+            }
+            token.text = text.mid(start, i - start);
+            QString keyword = token.text.toLower();
+            if(keyword == QLatin1String("and")) {
+                token.type = Token_And;
+            } else if(keyword == QLatin1String("or")) {
+                token.type = Token_Or;
+            } else if(keyword == QLatin1String("not")) {
+                token.type = Token_Not;
+            } else {
+                token.type = Token_Name;
+            }
+        } else {
+            return setError(QObject::tr("Unexpected character '%1'").arg(c), i);
+        }
+
+        m_Tokens.append(token);
+    }
+}
+
+bool FilterExpressionPrivate::parseOr()
+{
+    if(!parseAnd()) {
+        return false;
+    }
+
+    while(m_Tokens.at(m_Current).type == Token_Or) {
+        ++m_Current;
+        if(!parseAnd()) {
+            return false;
+        }
+        Node node;
+        node.type = Node_Or;
+        m_Program.append(node);
+    }
+
+    return true;
+}
+
+bool FilterExpressionPrivate::parseAnd()
+{
+    if(!parseNot()) {
+        return false;
+    }
+
+    while(m_Tokens.at(m_Current).type == Token_And) {
+        ++m_Current;
+        if(!parseNot()) {
+            return false;
+        }
+        Node node;
+        node.type = Node_And;
+        m_Program.append(node);
+    }
+
+    return true;
+}
+
+bool FilterExpressionPrivate::parseNot()
+{
+    if(m_Tokens.at(m_Current).type != Token_Not) {
+        return parsePrimary();
+    }
+
+    ++m_Current;
+    if(!parseNot()) {
+        return false;
+    }
+
+    Node node;
+    node.type = Node_Not;
+    m_Program.append(node);
+    return true;
+}
+
+bool FilterExpressionPrivate::parsePrimary()
+{
+    const Token &token = m_Tokens.at(m_Current);
+
+    if(token.type != Token_Open) {
+        return parseComparison();
+    }
+
+    ++m_Current;
+    if(!parseOr()) {
+        return false;
+    }
+
+    if(m_Tokens.at(m_Current).type != Token_Close) {
+        return setError(QObject::tr("Expected ')' to match '('"), token.position);
+    }
+
+    ++m_Current;
+    return true;
+}
+
+bool FilterExpressionPrivate::parseComparison()
+{
+    const Token &name = m_Tokens.at(m_Current);
+    if(name.type == Token_End) {
+        return setError(QObject::tr("Unexpected end of expression"), name.position);
+    }
+    if(name.type != Token_Name && name.type != Token_String) {
+        return setError(QObject::tr("Expected a column name, not '%1'").arg(name.text), name.position);
+    }
+
+    int column = resolveColumn(name);
+    if(column < 0) {
+        return false;
+    }
+    ++m_Current;
+
+    const Token &op = m_Tokens.at(m_Current);
+    if(op.type != Token_Operator) {
+        return setError(QObject::tr("Expected a comparison after '%1'").arg(name.text), op.position);
+    }
+    ++m_Current;
+
+    const Token &value = m_Tokens.at(m_Current);
+    if(value.type != Token_Number && value.type != Token_String && value.type != Token_Name) {
+        return setError(QObject::tr("Expected a value after '%1'").arg(op.text), value.position);
+    }
+    ++m_Current;
+
+    Node node;
+    node.type = Node_Compare;
+    node.op = op.op;
+    node.numeric = (value.type == Token_Number);
+    node.number = value.number;
+    node.string = value.text;
+
+    if(node.op == Operator_Match || node.op == Operator_NotMatch) {
+        node.regExp = QRegExp(value.text, Qt::CaseInsensitive);
+        if(!node.regExp.isValid()) {
+            return setError(QObject::tr("Invalid regular expression (%1)").arg(node.regExp.errorString()),
+                            value.position);
+        }
+    }
+
+    node.slot = m_Columns.indexOf(column);
+    if(node.slot < 0) {
+        node.slot = m_Columns.count();
+        m_Columns.append(column);
+    }
+
+    m_Program.append(node);
+    return true;
+}
+
+/*!
+   \internal
+   \brief Finds the column a name refers to: by \c{$n}, by its exact (normalized) header text, or as the only header
+          it abbreviates.
+ */
+int FilterExpressionPrivate::resolveColumn(const Token &token)
+{
+    if(token.type == Token_Name && token.text.startsWith(QLatin1Char('$'))) {
+        bool ok = false;
+        int column = token.text.mid(1).toInt(&ok) - 1;
+        if(!ok || column < 0 || column >= m_ColumnNames.count()) {
+            setError(QObject::tr("No column %1").arg(token.text), token.position);
+            return -1;
+        }
+        return column;
+    }
+
+    QString name = normalizedName(token.text);
+    QStringList words = name.split(QLatin1Char('_'));
+    QList<int> abbreviated;
+
+    for(int column = 0; column < m_ColumnNames.count(); ++column) {
+        QString header = normalizedName(m_ColumnNames.at(column));
+        if(header == name) {
+            return column;
+        }
+        if(abbreviates(words, header.split(QLatin1Char('_')))) {
+            abbreviated.append(column);
+        }
+    }
+
+    if(abbreviated.count() == 1) {
+        return abbreviated.first();
+    }
+
+    if(abbreviated.isEmpty()) {
+        setError(QObject::tr("Unknown column '%1'").arg(token.text), token.position);
+    } else {
+        QStringList names;
+        foreach(int column, abbreviated) {
+            names.append(QString("'%1'").arg(m_ColumnNames.at(column)));
+        }
+        setError(QObject::tr("Column '%1' could be any of %2").arg(token.text).arg(names.join(", ")), token.position);
+    }
+
+    return -1;
+}
+
+/*!
+   \internal
+   \brief Runs one comparison over \a count rows from \a begin, writing a flag per row to \a out.  Numbers against a
+          numeric column is the fast path; other combinations compare through text.  Empty cells, NaN in a numeric
+          column, satisfy no comparison other than !=.
+ */
+void FilterExpressionPrivate::compareBlock(const Node &node, const FilterExpression::Column &column, int begin,
+                                           int count, char *out, QRegExp &regExp) const
+{
+    bool match = (node.op == Operator_Match || node.op == Operator_NotMatch);
+
+    if(column.numbers && node.numeric && !match) {
+        const double *values = column.numbers + begin;
+        switch(node.op) {
+        case Operator_Equal:        compareNumbers(values, count, node.number, out, std::equal_to<double>());      break;
+        case Operator_NotEqual:     compareNumbers(values, count, node.number, out, std::not_equal_to<double>(), 1); break;
+        case Operator_Less:         compareNumbers(values, count, node.number, out, std::less<double>());          break;
+        case Operator_LessEqual:    compareNumbers(values, count, node.number, out, std::less_equal<double>());    break;
+        case Operator_Greater:      compareNumbers(values, count, node.number, out, std::greater<double>());       break;
+        case Operator_GreaterEqual: compareNumbers(values, count, node.number, out, std::greater_equal<double>()); break;
+        default: break;
+        }
+        return;
+    }
+
+    for(int row = 0; row < count; ++row) {
+        QString text;
+        if(column.strings) {
+            text = column.strings[begin + row];
+        } else {
+            double value = column.numbers ? column.numbers[begin + row] : 0.0;
+            if(value == value) {
+                text = QString::number(value, 'g', 15);
+            }
+        }
+
+        if(match) {
+            bool found = (regExp.indexIn(text) >= 0);
+            out[row] = (found == (node.op == Operator_Match)) ? 1 : 0;
+            continue;
+        }
+
+        int comparison = 0;
+        if(node.numeric) {
+            bool ok = false;
+            double value = text.toDouble(&ok);
+            if(!ok) {
+                out[row] = (node.op == Operator_NotEqual) ? 1 : 0;
+                continue;
+            }
+            comparison = (value < node.number) ? -1 : ((value > node.number) ? 1 : 0);
+        } else {
+            comparison = QString::compare(text, node.string, Qt::CaseInsensitive);
+        }
+
+        bool result = false;
+        switch(node.op) {
+        case Operator_Equal:        result = (comparison == 0); break;
+        case Operator_NotEqual:     result = (comparison != 0); break;
+        case Operator_Less:         result = (comparison < 0);  break;
+        case Operator_LessEqual:    result = (comparison <= 0); break;
+        case Operator_Greater:      result = (comparison > 0);  break;
+        case Operator_GreaterEqual: result = (comparison >= 0); break;
+        default: break;
+        }
+        out[row] = result ? 1 : 0;
+    }
+}
+
+} // namespace ViewManager
+} // namespace Core
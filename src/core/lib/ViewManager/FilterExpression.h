@@ -0,0 +1,73 @@
+/*!
+   \file FilterExpression.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_FILTEREXPRESSION_H
+#define CORE_VIEWMANAGER_FILTEREXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+class QAbstractItemModel;
+
+#include "ViewManagerLibrary.h"
+
+namespace Core {
+namespace ViewManager {
+
+class FilterExpressionPrivate;
+
+class VIEWMANAGER_EXPORT FilterExpression
+{
+    Q_DISABLE_COPY(FilterExpression)
+    DECLARE_PRIVATE(FilterExpression)
+
+public:
+    /* The values of one referenced column; numbers, NaN where empty, when the column is numeric, strings otherwise */
+    struct Column {
+        Column() : numbers(NULL), strings(NULL) {}
+        const double *numbers;
+        const QString *strings;
+    };
+
+    FilterExpression(const QString &pattern, const QStringList &columnNames);
+    ~FilterExpression();
+
+    QString pattern() const;
+    bool isEmpty() const;
+    bool isValid() const;
+    QString errorString() const;
+
+    QList<int> columns() const;
+
+    void evaluateRange(const QVector<Column> &columns, int begin, int end, char *accepted) const;
+    QVector<char> evaluate(const QVector<Column> &columns, int rowCount) const;
+
+    static QStringList columnNames(const QAbstractItemModel *model);
+
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_FILTEREXPRESSION_H
@@ -0,0 +1,134 @@
+/*!
+   \file FilterExpressionPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_FILTEREXPRESSIONPRIVATE_H
+#define CORE_VIEWMANAGER_FILTEREXPRESSIONPRIVATE_H
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public PTGF API.  This header file may change
+// from version to version without notice, or even be removed.
+//
+
+
+#include "FilterExpression.h"
+
+#include <QRegExp>
+
+
+namespace Core {
+namespace ViewManager {
+
+class FilterExpressionPrivate
+{
+    Q_DISABLE_COPY(FilterExpressionPrivate)
+    DECLARE_PUBLIC(FilterExpression)
+
+public:
+    enum TokenType {
+        Token_End = 0,
+        Token_Name,
+        Token_Number,
+        Token_String,
+        Token_Operator,
+        Token_And,
+        Token_Or,
+        Token_Not,
+        Token_Open,
+        Token_Close
+    };
+
+    enum Operator {
+        Operator_Equal = 0,
+        Operator_NotEqual,
+        Operator_Less,
+        Operator_LessEqual,
+        Operator_Greater,
+        Operator_GreaterEqual,
+        Operator_Match,
+        Operator_NotMatch
+    };
+
+    struct Token {
+        Token() : type(Token_End), op(Operator_Equal), number(0.0), position(0) {}
+        TokenType type;
+        Operator op;
+        QString text;
+        double number;
+        int position;
+    };
+
+    enum NodeType {
+        Node_Compare = 0,
+        Node_And,
+        Node_Or,
+        Node_Not
+    };
+
+    /* One step of the postfix program; comparisons push a row mask, the logical operators combine them */
+    struct Node {
+        Node() : type(Node_Compare), slot(0), op(Operator_Equal), numeric(false), number(0.0) {}
+        NodeType type;
+        int slot;
+        Operator op;
+        bool numeric;
+        double number;
+        QString string;
+        QRegExp regExp;
+    };
+
+    FilterExpressionPrivate();
+
+    bool tokenize();
+    bool parseOr();
+    bool parseAnd();
+    bool parseNot();
+    bool parsePrimary();
+    bool parseComparison();
+    int resolveColumn(const Token &token);
+    bool setError(const QString &message, int position);
+
+    void compareBlock(const Node &node, const FilterExpression::Column &column, int begin, int count, char *out,
+                      QRegExp &regExp) const;
+
+private:
+    QString m_Pattern;
+    QStringList m_ColumnNames;
+    QString m_ErrorString;
+    bool m_Valid;
+
+    QList<Token> m_Tokens;
+    int m_Current;
+
+    QVector<Node> m_Program;
+    QList<int> m_Columns;
+    int m_Depth;
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_FILTEREXPRESSIONPRIVATE_H
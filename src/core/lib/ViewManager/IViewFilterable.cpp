@@ -27,7 +27,38 @@
 namespace Core {
 namespace ViewManager {
 
+/*! \class Core::ViewManager::IViewFilterable
+    \brief Interface for views whose rows can be filtered.
 
+    Views filter either with a regular expression over a single column (setViewFilter() and setViewFilterColumn()), or
+    with a FilterExpression over any of their columns (setViewFilterExpression()).  Views that don't support filter
+    expressions need not implement those two functions.
+    \sa FilterExpression
+ */
+
+/*! \fn IViewFilterable::viewFilterExpression()
+    \brief The filter expression currently applied; empty when there is none, or when expressions aren't supported.
+ */
+QString IViewFilterable::viewFilterExpression() const
+{
+    return QString();
+}
+
+/*! \fn IViewFilterable::setViewFilterExpression()
+    \brief Filters the view's rows with \a expression (see FilterExpression), replacing any previous expression; an
+           empty expression removes it.
+    \returns false, with the reason in \a errorMessage if given, when the expression doesn't compile or the view
+             doesn't support filter expressions
+ */
+bool IViewFilterable::setViewFilterExpression(const QString &expression, QString *errorMessage)
+{
+    Q_UNUSED(expression)
+
+    if(errorMessage) {
+        *errorMessage = QObject::tr("This view does not support filter expressions");
+    }
+    return false;
+}
 
 } // namespace ViewManager
 } // namespace Core
@@ -39,11 +39,16 @@ public:
     virtual void setViewFilter(const QString &regex) = 0;
     virtual int viewFilterColumn() const = 0;
     virtual void setViewFilterColumn(int column = 0) = 0;
+
+    virtual QString viewFilterExpression() const;
+    virtual bool setViewFilterExpression(const QString &expression, QString *errorMessage = NULL);
 };
 
 } // namespace ViewManager
 } // namespace Core
 
-Q_DECLARE_INTERFACE(Core::ViewManager::IViewFilterable, "org.krellinst.ptgf.IViewFilterable")
+/* Versioned, since the filter expression methods changed the vtable that plugins built against the interface
+   before them were compiled with */
+Q_DECLARE_INTERFACE(Core::ViewManager::IViewFilterable, "org.krellinst.ptgf.IViewFilterable/2.0")
 
 #endif // CORE_VIEWMANAGER_IVIEWFILTERABLE_H
@@ -0,0 +1,280 @@
+/*!
+   \file MappedColumnarModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MappedColumnarModelPrivate.h"
+
+#include <limits>
+#include <string.h>
+
+namespace Core {
+namespace ViewManager {
+
+/*! \class Core::ViewManager::MappedColumnarModel
+    \brief Read-only columnar table model served straight from a memory-mapped file.
+
+    Opening a file maps it and checks its header and column table; nothing is parsed or copied, so opening a
+    multi-gigabyte file takes about as long as opening a small one, and rows are paged in by the operating system as
+    they are shown.  Files are written with AbstractColumnarModel::save().
+
+    The file format is versioned; all values are in the byte order of the machine that wrote the file, and every
+    offset is in bytes from the start of the file:
+    \list
+    \li Header (64 bytes): the magic "PTGFTBL\0", the byte order mark 0x01020304, the format version (currently 1),
+        the row count (64-bit), the column count, and the offsets of the column table and string index along with
+        the number of strings.
+    \li Column table: 32 bytes per column; its type (AbstractColumnarModel::ColumnType), the length and offset of its
+        UTF-16 name, and the offset of its data.
+    \li Column blocks: one per column, 8-byte aligned; 8-byte integers or doubles, or 4-byte string ids, one per
+        row.
+    \li String index: 16 bytes per string; the offset and length of its UTF-16 text.  Id 0 is the empty string.
+    \endlist
+    \sa AbstractColumnarModel ColumnarModel
+ */
+
+MappedColumnarModel::MappedColumnarModel(QObject *parent) :
+    AbstractColumnarModel(parent),
+    d(new MappedColumnarModelPrivate)
+{
+    d->q = this;
+}
+
+MappedColumnarModel::~MappedColumnarModel()
+{
+}
+
+/*! \fn MappedColumnarModel::open()
+    \brief Maps \a fileName and shows its table, replacing any file already open.  On failure the model is left empty,
+           and errorString() says why.
+ */
+bool MappedColumnarModel::open(const QString &fileName)
+{
+    beginResetModel();
+    d->unmap();
+    bool ok = d->map(fileName);
+    if(!ok) {
+        d->unmap();
+    }
+    endResetModel();
+    return ok;
+}
+
+void MappedColumnarModel::close()
+{
+    beginResetModel();
+    d->unmap();
+    endResetModel();
+}
+
+bool MappedColumnarModel::isOpen() const
+{
+    return d->m_Data != NULL;
+}
+
+QString MappedColumnarModel::fileName() const
+{
+    return d->m_File.fileName();
+}
+
+/*! \fn MappedColumnarModel::fileVersion()
+    \brief The format version of the open file; zero if none is open.
+ */
+quint32 MappedColumnarModel::fileVersion() const
+{
+    return d->m_Version;
+}
+
+QString MappedColumnarModel::errorString() const
+{
+    return d->m_ErrorString;
+}
+
+MappedColumnarModel::ColumnType MappedColumnarModel::columnType(int column) const
+{
+    return d->m_Columns.at(column).type;
+}
+
+QString MappedColumnarModel::columnName(int column) const
+{
+    return d->m_Columns.at(column).name;
+}
+
+const qint64 *MappedColumnarModel::int64Column(int column) const
+{
+    const MappedColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_Int64) ? (const qint64 *)data.data : NULL;
+}
+
+const double *MappedColumnarModel::doubleColumn(int column) const
+{
+    const MappedColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_Double) ? (const double *)data.data : NULL;
+}
+
+const quint32 *MappedColumnarModel::stringColumn(int column) const
+{
+    const MappedColumnarModelPrivate::Column &data = d->m_Columns.at(column);
+    return (data.type == ColumnType_String) ? (const quint32 *)data.data : NULL;
+}
+
+/*! \fn MappedColumnarModel::internedString()
+    \brief Reads the string with \a id out of the mapped file.  Strings are checked against the file's size as they
+           are read, rather than when it is opened.
+ */
+QString MappedColumnarModel::internedString(quint32 id) const
+{
+    if(id >= (quint32)d->m_DictionaryCount) {
+        return QString();
+    }
+
+    const ColumnarFile::String &string = d->m_Dictionary[id];
+    if(string.offset > (quint64)d->m_Size || string.length > ((quint64)d->m_Size - string.offset) / sizeof(ushort)) {
+        return QString();
+    }
+
+    return QString((const QChar *)(d->m_Data + string.offset), string.length);
+}
+
+int MappedColumnarModel::internedStringCount() const
+{
+    return d->m_DictionaryCount;
+}
+
+int MappedColumnarModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_RowCount;
+}
+
+int MappedColumnarModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_Columns.count();
+}
+
+
+
+
+MappedColumnarModelPrivate::MappedColumnarModelPrivate() :
+    m_Data(NULL),
+    m_Size(0),
+    m_RowCount(0),
+    m_Dictionary(NULL),
+    m_DictionaryCount(0),
+    m_Version(0)
+{
+}
+
+/*!
+   \internal
+   \brief Maps \a fileName, and checks that everything reached from its header lies within it.
+ */
+bool MappedColumnarModelPrivate::map(const QString &fileName)
+{
+    m_File.setFileName(fileName);
+    if(!m_File.open(QIODevice::ReadOnly)) {
+        return fail(m_File.errorString());
+    }
+
+    m_Size = m_File.size();
+    if(m_Size < (qint64)sizeof(ColumnarFile::Header)) {
+        return fail(MappedColumnarModel::tr("The file is too small to be a table."));
+    }
+
+    m_Data = m_File.map(0, m_Size);
+    if(!m_Data) {
+        return fail(m_File.errorString());
+    }
+
+    ColumnarFile::Header header;
+    memcpy(&header, m_Data, sizeof(header));
+
+    if(memcmp(header.magic, ColumnarFile::Magic, sizeof(header.magic)) != 0) {
+        return fail(MappedColumnarModel::tr("The file is not a table."));
+    }
+    if(header.byteOrder != ColumnarFile::ByteOrder) {
+        return fail(MappedColumnarModel::tr("The table was written on a machine with a different byte order."));
+    }
+    if(header.version == 0 || header.version > ColumnarFile::Version) {
+        return fail(MappedColumnarModel::tr("The table is in an unsupported format (version %1).").arg(header.version));
+    }
+
+    quint64 size = m_Size;
+    if(header.rowCount > (quint64)std::numeric_limits<int>::max() ||
+            header.dictionaryCount > (quint64)std::numeric_limits<int>::max() ||
+            header.columnTableOffset > size || header.columnCount > (size - header.columnTableOffset) / sizeof(ColumnarFile::Column) ||
+            header.dictionaryOffset > size || header.dictionaryCount > (size - header.dictionaryOffset) / sizeof(ColumnarFile::String) ||
+            header.dictionaryOffset % 8 != 0) {
+        return fail(MappedColumnarModel::tr("The table's header is corrupt."));
+    }
+
+    const ColumnarFile::Column *columns = (const ColumnarFile::Column *)(m_Data + header.columnTableOffset);
+    for(quint32 i = 0; i < header.columnCount; ++i) {
+        const ColumnarFile::Column &column = columns[i];
+
+        if(column.type > AbstractColumnarModel::ColumnType_String || column.dataOffset % 8 != 0 ||
+                column.dataOffset > size || header.rowCount > (size - column.dataOffset) / ColumnarFile::valueSize(column.type) ||
+                column.nameOffset > size || column.nameLength > (size - column.nameOffset) / sizeof(ushort)) {
+            return fail(MappedColumnarModel::tr("Column %1 of the table is corrupt.").arg(i + 1));
+        }
+
+        Column mapped;
+        mapped.type = (AbstractColumnarModel::ColumnType)column.type;
+        mapped.name = QString((const QChar *)(m_Data + column.nameOffset), column.nameLength);
+        mapped.data = m_Data + column.dataOffset;
+        m_Columns.append(mapped);
+    }
+
+    m_RowCount = (int)header.rowCount;
+    m_Dictionary = (const ColumnarFile::String *)(m_Data + header.dictionaryOffset);
+    m_DictionaryCount = (int)header.dictionaryCount;
+    m_Version = header.version;
+    m_ErrorString.clear();
+    return true;
+}
+
+/*!
+   \internal
+   \brief Unmaps and closes the file, leaving the model empty.
+ */
+void MappedColumnarModelPrivate::unmap()
+{
+    m_Columns.clear();
+    m_RowCount = 0;
+    m_Dictionary = NULL;
+    m_DictionaryCount = 0;
+    m_Version = 0;
+
+    if(m_Data) {
+        m_File.unmap(const_cast<uchar *>(m_Data));
+        m_Data = NULL;
+    }
+    m_Size = 0;
+    m_File.close();
+}
+
+bool MappedColumnarModelPrivate::fail(const QString &message)
+{
+    m_ErrorString = message;
+    return false;
+}
+
+} // namespace ViewManager
+} // namespace Core
@@ -0,0 +1,70 @@
+/*!
+   \file MappedColumnarModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_MAPPEDCOLUMNARMODEL_H
+#define CORE_VIEWMANAGER_MAPPEDCOLUMNARMODEL_H
+
+#include "AbstractColumnarModel.h"
+
+namespace Core {
+namespace ViewManager {
+
+class MappedColumnarModelPrivate;
+
+class VIEWMANAGER_EXPORT MappedColumnarModel : public AbstractColumnarModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MappedColumnarModel)
+    DECLARE_PRIVATE(MappedColumnarModel)
+
+public:
+    explicit MappedColumnarModel(QObject *parent = 0);
+    ~MappedColumnarModel();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+
+    QString fileName() const;
+    quint32 fileVersion() const;
+    QString errorString() const;
+
+    virtual ColumnType columnType(int column) const;
+    virtual QString columnName(int column) const;
+
+    virtual const qint64 *int64Column(int column) const;
+    virtual const double *doubleColumn(int column) const;
+    virtual const quint32 *stringColumn(int column) const;
+
+    virtual QString internedString(quint32 id) const;
+    virtual int internedStringCount() const;
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_MAPPEDCOLUMNARMODEL_H
@@ -0,0 +1,122 @@
+/*!
+   \file MappedColumnarModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_MAPPEDCOLUMNARMODELPRIVATE_H
+#define CORE_VIEWMANAGER_MAPPEDCOLUMNARMODELPRIVATE_H
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public PTGF API.  This header file may change
+// from version to version without notice, or even be removed.
+//
+
+
+#include "MappedColumnarModel.h"
+
+#include <QFile>
+
+
+namespace Core {
+namespace ViewManager {
+
+/* The on-disk layout of a columnar table file; see MappedColumnarModel for a description */
+namespace ColumnarFile {
+
+static const char Magic[8] = { 'P', 'T', 'G', 'F', 'T', 'B', 'L', '\0' };
+static const quint32 ByteOrder = 0x01020304;
+static const quint32 Version = 1;
+
+struct Header {
+    char magic[8];
+    quint32 byteOrder;
+    quint32 version;
+    quint64 rowCount;
+    quint32 columnCount;
+    quint32 reserved1;
+    quint64 columnTableOffset;
+    quint64 dictionaryOffset;
+    quint64 dictionaryCount;
+    quint64 reserved2;
+};
+
+struct Column {
+    quint32 type;
+    quint32 nameLength;
+    quint64 nameOffset;
+    quint64 dataOffset;
+    quint64 reserved;
+};
+
+struct String {
+    quint64 offset;
+    quint32 length;
+    quint32 reserved;
+};
+
+inline quint64 align(quint64 offset) { return (offset + 7) & ~(quint64)7; }
+
+inline int valueSize(quint32 type) { return (type == AbstractColumnarModel::ColumnType_String) ? 4 : 8; }
+
+} // namespace ColumnarFile
+
+
+class MappedColumnarModelPrivate
+{
+    Q_DISABLE_COPY(MappedColumnarModelPrivate)
+    DECLARE_PUBLIC(MappedColumnarModel)
+
+public:
+    struct Column {
+        Column() : type(AbstractColumnarModel::ColumnType_Double), data(NULL) {}
+        AbstractColumnarModel::ColumnType type;
+        QString name;
+        const uchar *data;
+    };
+
+    MappedColumnarModelPrivate();
+
+    bool map(const QString &fileName);
+    void unmap();
+    bool fail(const QString &message);
+
+private:
+    QFile m_File;
+    const uchar *m_Data;
+    qint64 m_Size;
+
+    int m_RowCount;
+    QVector<Column> m_Columns;
+    const ColumnarFile::String *m_Dictionary;
+    int m_DictionaryCount;
+
+    quint32 m_Version;
+    QString m_ErrorString;
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_MAPPEDCOLUMNARMODELPRIVATE_H
@@ -0,0 +1,395 @@
+/*!
+   \file PagedModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "PagedModelPrivate.h"
+
+#include <QMutexLocker>
+
+namespace Core {
+namespace ViewManager {
+
+/*! \class Core::ViewManager::PagedModel
+    \brief Table model over a backing store too large to hold in memory, such as the samples of an experiment
+           database.
+
+    Rows are read from the Store a page at a time on a loader thread.  Only the most recently used maximumPages()
+    pages are kept; rows whose page hasn't arrived yet show placeholder(), and are updated with dataChanged() once it
+    does.  Pages are read most recently requested first, so after a long scroll the rows on screen arrive before the
+    ones scrolled past.
+
+    Rows are exposed fetchBatchSize() at a time through canFetchMore() and fetchMore(), which views call as they are
+    scrolled to the end, so the view's own per-row bookkeeping only grows as far as the user has looked.  A batch size
+    of zero exposes every row up front.
+    \code
+    PagedModel *model = new PagedModel(this);
+    model->setStore(new SampleStore(databasePath));
+    tableView->setModel(model);
+    \endcode
+    \sa PagedModel::Store
+ */
+
+/*! \class Core::ViewManager::PagedModel::Store
+    \brief The backing store of a PagedModel.
+    rowCount() and columnNames() are read once, when the store is set; readRows() is then only called from the
+    model's loader thread, and fills \a values with \a count rows of columnNames().count() values each, row by row.
+ */
+
+PagedModel::PagedModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    d(new PagedModelPrivate)
+{
+    d->q = this;
+    connect(&d->m_Loader, SIGNAL(pageReady()), d.data(), SLOT(pageReady()), Qt::QueuedConnection);
+}
+
+PagedModel::~PagedModel()
+{
+    d->stopLoader();
+    delete d->m_Store;
+}
+
+PagedModel::Store *PagedModel::store() const
+{
+    return d->m_Store;
+}
+
+/*! \fn PagedModel::setStore()
+    \brief Replaces the backing store, taking ownership of \a store.  The first page is read straight away, so the
+           view has something to show and size its columns from.
+ */
+void PagedModel::setStore(Store *store)
+{
+    beginResetModel();
+
+    d->clearPages();
+    delete d->m_Store;
+    d->m_Store = store;
+
+    d->m_StoreRows = store ? qMax(0, store->rowCount()) : 0;
+    d->m_ColumnNames = store ? store->columnNames() : QStringList();
+    d->m_RowCount = (d->m_FetchBatchSize > 0) ? qMin(d->m_StoreRows, d->m_FetchBatchSize) : d->m_StoreRows;
+
+    if(d->m_StoreRows > 0) {
+        PagedModelPrivate::Page *page = new PagedModelPrivate::Page;
+        if(d->readPage(0, *page)) {
+            d->m_Pages.insert(0, page);
+        } else {
+            delete page;
+        }
+    }
+
+    endResetModel();
+}
+
+int PagedModel::pageSize() const
+{
+    return d->m_PageSize;
+}
+
+/*! \fn PagedModel::setPageSize()
+    \brief Sets the number of rows read at a time, dropping the pages already read.
+ */
+void PagedModel::setPageSize(int rows)
+{
+    rows = qMax(1, rows);
+    if(rows == d->m_PageSize) {
+        return;
+    }
+
+    beginResetModel();
+    d->clearPages();
+    d->m_PageSize = rows;
+    endResetModel();
+}
+
+int PagedModel::maximumPages() const
+{
+    return d->m_MaximumPages;
+}
+
+/*! \fn PagedModel::setMaximumPages()
+    \brief Sets how many pages are kept in memory; the least recently used page is dropped to make room for another.
+ */
+void PagedModel::setMaximumPages(int pages)
+{
+    d->m_MaximumPages = qMax(1, pages);
+    d->m_Pages.setMaxCost(d->m_MaximumPages);
+}
+
+int PagedModel::fetchBatchSize() const
+{
+    return d->m_FetchBatchSize;
+}
+
+/*! \fn PagedModel::setFetchBatchSize()
+    \brief Sets how many more rows each fetchMore() exposes; zero exposes them all.  Also sets how many rows are
+           exposed when a store is set.
+ */
+void PagedModel::setFetchBatchSize(int rows)
+{
+    d->m_FetchBatchSize = qMax(0, rows);
+}
+
+QVariant PagedModel::placeholder() const
+{
+    return d->m_Placeholder;
+}
+
+/*! \fn PagedModel::setPlaceholder()
+    \brief Sets what is shown for rows whose page is still loading.
+ */
+void PagedModel::setPlaceholder(const QVariant &placeholder)
+{
+    d->m_Placeholder = placeholder;
+}
+
+/*! \fn PagedModel::isRowLoaded()
+    \brief Whether the page holding \a row is in memory.  Unlike data(), this doesn't ask for the page to be loaded.
+ */
+bool PagedModel::isRowLoaded(int row) const
+{
+    return d->m_Pages.contains(row / d->m_PageSize);
+}
+
+int PagedModel::cachedPages() const
+{
+    return d->m_Pages.count();
+}
+
+bool PagedModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && d->m_RowCount < d->m_StoreRows;
+}
+
+void PagedModel::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent)) {
+        return;
+    }
+
+    int remaining = d->m_StoreRows - d->m_RowCount;
+    int count = (d->m_FetchBatchSize > 0) ? qMin(remaining, d->m_FetchBatchSize) : remaining;
+
+    beginInsertRows(QModelIndex(), d->m_RowCount, d->m_RowCount + count - 1);
+    d->m_RowCount += count;
+    endInsertRows();
+}
+
+int PagedModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_RowCount;
+}
+
+int PagedModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_ColumnNames.count();
+}
+
+QVariant PagedModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+
+    int page = index.row() / d->m_PageSize;
+    if(PagedModelPrivate::Page *values = d->m_Pages.object(page)) {
+        int offset = (index.row() - page * d->m_PageSize) * d->m_ColumnNames.count() + index.column();
+        return (offset < values->count()) ? values->at(offset) : QVariant();
+    }
+
+    d->requestPage(page);
+    return d->m_Placeholder;
+}
+
+QVariant PagedModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < d->m_ColumnNames.count()) {
+        return d->m_ColumnNames.at(section);
+    }
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+
+
+
+PagedModelPrivate::PagedModelPrivate() :
+    QObject(NULL),
+    m_Store(NULL),
+    m_Loader(this),
+    m_StoreRows(0),
+    m_RowCount(0),
+    m_PageSize(1024),
+    m_MaximumPages(256),
+    m_FetchBatchSize(100000),
+    m_Placeholder(tr("Loading...")),
+    m_Pages(256),
+    m_Stop(false)
+{
+}
+
+PagedModelPrivate::~PagedModelPrivate()
+{
+}
+
+/*!
+   \internal
+   \brief Stops the loader thread and drops every page read or asked for.
+ */
+void PagedModelPrivate::clearPages()
+{
+    stopLoader();
+    m_Pages.clear();
+    m_Requested.clear();
+    m_Loaded.clear();
+}
+
+/*!
+   \internal
+   \brief Stops the loader thread and waits for it, dropping any requests it hadn't got to.
+ */
+void PagedModelPrivate::stopLoader()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Stop = true;
+        m_Requests.clear();
+        m_Wake.wakeAll();
+    }
+
+    m_Loader.wait();
+
+    QMutexLocker locker(&m_Mutex);
+    m_Stop = false;
+}
+
+/*!
+   \internal
+   \brief Queues \a page for the loader thread, starting it if need be.  Once more pages are waiting than can be
+          kept, the oldest requests are dropped; they have long since scrolled out of view.
+ */
+void PagedModelPrivate::requestPage(int page) const
+{
+    if(m_Requested.contains(page)) {
+        return;
+    }
+
+    QMutexLocker locker(&m_Mutex);
+    m_Requests.append(page);
+    m_Requested.insert(page);
+    while(m_Requests.count() > m_MaximumPages) {
+        m_Requested.remove(m_Requests.takeFirst());
+    }
+    m_Wake.wakeOne();
+    locker.unlock();
+
+    if(!m_Loader.isRunning()) {
+        m_Loader.start(QThread::LowPriority);
+    }
+}
+
+/*!
+   \internal
+   \brief Reads the rows of \a page from the store into \a values.
+ */
+bool PagedModelPrivate::readPage(int page, Page &values)
+{
+    int first = page * m_PageSize;
+    int count = qMin(m_PageSize, m_StoreRows - first);
+    if(!m_Store || count <= 0) {
+        return false;
+    }
+
+    values.reserve(count * m_ColumnNames.count());
+    return m_Store->readRows(first, count, values);
+}
+
+/*!
+   \internal
+   \brief Moves the pages the loader thread has delivered into the cache, and tells the view about their rows.
+ */
+void PagedModelPrivate::pageReady()
+{
+    QMutexLocker locker(&m_Mutex);
+    QHash<int, Page> loaded = m_Loaded;
+    m_Loaded.clear();
+    locker.unlock();
+
+    int columns = m_ColumnNames.count();
+
+    QHash<int, Page>::const_iterator iter;
+    for(iter = loaded.constBegin(); iter != loaded.constEnd(); ++iter) {
+        int page = iter.key();
+        if(!m_Requested.remove(page)) {
+            continue;   // Dropped from the queue, and read anyway
+        }
+
+        m_Pages.insert(page, new Page(iter.value()));
+
+        int first = page * m_PageSize;
+        int last = qMin(first + m_PageSize, m_RowCount) - 1;
+        if(first <= last && columns > 0) {
+            emit q->dataChanged(q->index(first, 0), q->index(last, columns - 1));
+        }
+    }
+}
+
+
+PagedModelLoader::PagedModelLoader(PagedModelPrivate *d) :
+    QThread(),
+    d(d)
+{
+}
+
+void PagedModelLoader::run()
+{
+    forever {
+        QMutexLocker locker(&d->m_Mutex);
+        while(d->m_Requests.isEmpty() && !d->m_Stop) {
+            d->m_Wake.wait(&d->m_Mutex);
+        }
+        if(d->m_Stop) {
+            return;
+        }
+        int page = d->m_Requests.takeLast();
+        locker.unlock();
+
+        // A page that can't be read is delivered empty, and its rows show nothing rather than loading forever
+        PagedModelPrivate::Page values;
+        if(!d->readPage(page, values)) {
+            values.clear();
+        }
+
+        locker.relock();
+        if(d->m_Stop) {
+            return;
+        }
+        d->m_Loaded.insert(page, values);
+        locker.unlock();
+
+        emit pageReady();
+    }
+}
+
+} // namespace ViewManager
+} // namespace Core
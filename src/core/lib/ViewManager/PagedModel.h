@@ -0,0 +1,87 @@
+/*!
+   \file PagedModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_PAGEDMODEL_H
+#define CORE_VIEWMANAGER_PAGEDMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+#include "ViewManagerLibrary.h"
+
+namespace Core {
+namespace ViewManager {
+
+class PagedModelPrivate;
+
+class VIEWMANAGER_EXPORT PagedModel : public QAbstractTableModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PagedModel)
+    DECLARE_PRIVATE(PagedModel)
+
+public:
+    /* The backing store of a PagedModel.  readRows() is only ever called from the model's loader thread. */
+    class VIEWMANAGER_EXPORT Store
+    {
+    public:
+        virtual ~Store() {}
+        virtual int rowCount() const = 0;
+        virtual QStringList columnNames() const = 0;
+        virtual bool readRows(int first, int count, QVector<QVariant> &values) = 0;
+    };
+
+    explicit PagedModel(QObject *parent = 0);
+    ~PagedModel();
+
+    Store *store() const;
+    void setStore(Store *store);
+
+    int pageSize() const;
+    void setPageSize(int rows);
+    int maximumPages() const;
+    void setMaximumPages(int pages);
+    int fetchBatchSize() const;
+    void setFetchBatchSize(int rows);
+
+    QVariant placeholder() const;
+    void setPlaceholder(const QVariant &placeholder);
+
+    bool isRowLoaded(int row) const;
+    int cachedPages() const;
+
+    virtual bool canFetchMore(const QModelIndex &parent) const;
+    virtual void fetchMore(const QModelIndex &parent);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_PAGEDMODEL_H
@@ -0,0 +1,121 @@
+/*!
+   \file PagedModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CORE_VIEWMANAGER_PAGEDMODELPRIVATE_H
+#define CORE_VIEWMANAGER_PAGEDMODELPRIVATE_H
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public PTGF API.  This header file may change
+// from version to version without notice, or even be removed.
+//
+
+
+#include "PagedModel.h"
+
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+
+namespace Core {
+namespace ViewManager {
+
+class PagedModelPrivate;
+
+/* Reads requested pages from the store, most recently requested first */
+class PagedModelLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit PagedModelLoader(PagedModelPrivate *d);
+
+signals:
+    void pageReady();
+
+protected:
+    virtual void run();
+
+private:
+    PagedModelPrivate *d;
+};
+
+class PagedModelPrivate : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(PagedModelPrivate)
+    DECLARE_PUBLIC(PagedModel)
+
+public:
+    typedef QVector<QVariant> Page;
+
+    PagedModelPrivate();
+    ~PagedModelPrivate();
+
+    void clearPages();
+    void stopLoader();
+    void requestPage(int page) const;
+    bool readPage(int page, Page &values);
+
+public slots:
+    void pageReady();
+
+private:
+    PagedModel::Store *m_Store;
+    mutable PagedModelLoader m_Loader;
+
+    int m_StoreRows;
+    int m_RowCount;
+    QStringList m_ColumnNames;
+
+    int m_PageSize;
+    int m_MaximumPages;
+    int m_FetchBatchSize;
+    QVariant m_Placeholder;
+
+    /* GUI thread only: the least recently used pages, and the pages asked for but not yet delivered */
+    mutable QCache<int, Page> m_Pages;
+    mutable QSet<int> m_Requested;
+
+    /* Shared with the loader thread, under m_Mutex */
+    mutable QMutex m_Mutex;
+    mutable QWaitCondition m_Wake;
+    mutable QList<int> m_Requests;
+    QHash<int, Page> m_Loaded;
+    bool m_Stop;
+
+    friend class PagedModelLoader;
+};
+
+} // namespace ViewManager
+} // namespace Core
+
+#endif // CORE_VIEWMANAGER_PAGEDMODELPRIVATE_H
@@ -35,6 +35,10 @@ else:{
 INSTALLS         += target
 
 
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += concurrent
+}
+
 greaterThan(QT_MAJOR_VERSION, 4) {
     qtHaveModule(xml) {
         QT += xml
@@ -46,19 +50,15 @@ greaterThan(QT_MAJOR_VERSION, 4) {
 }
 
 
-###
-### Until we solve the issue with QSqlDatabase being destructed before writing settings to disk,
-### we'll have to keep this section of code disabled
-###
-#greaterThan(QT_MAJOR_VERSION, 4) {
-#    qtHaveModule(sql) {
-#        QT += sql
-#    } else {
+greaterThan(QT_MAJOR_VERSION, 4) {
+    qtHaveModule(sql) {
+        QT += sql
+    } else {
         DEFINES += NO_SQL_MODULE
-#    }
-#} else {
-#    QT += sql
-#}
+    }
+} else {
+    QT += sql
+}
 
 
 HEADERS +=  Global.h \
@@ -98,9 +98,18 @@ HEADERS +=  Global.h \
             SettingManager/SettingManager.h \
             SettingManager/SettingManagerPrivate.h \
             SettingManager/SettingManagerLibrary.h \
+            ViewManager/AbstractColumnarModel.h \
+            ViewManager/ColumnarModel.h \
+            ViewManager/ColumnarModelPrivate.h \
             ViewManager/IView.h \
             ViewManager/IViewFactory.h \
             ViewManager/IViewFilterable.h \
+            ViewManager/FilterExpression.h \
+            ViewManager/FilterExpressionPrivate.h \
+            ViewManager/MappedColumnarModel.h \
+            ViewManager/MappedColumnarModelPrivate.h \
+            ViewManager/PagedModel.h \
+            ViewManager/PagedModelPrivate.h \
             ViewManager/ViewManager.h \
             ViewManager/ViewManagerLibrary.h \
             ViewManager/ViewManagerPrivate.h \
@@ -132,9 +141,14 @@ SOURCES +=  Global.cpp \
             SettingManager/ISettingPageFactory.cpp \
             SettingManager/SettingDialog.cpp \
             SettingManager/SettingManager.cpp \
+            ViewManager/AbstractColumnarModel.cpp \
+            ViewManager/ColumnarModel.cpp \
             ViewManager/IView.cpp \
             ViewManager/IViewFactory.cpp \
             ViewManager/IViewFilterable.cpp \
+            ViewManager/FilterExpression.cpp \
+            ViewManager/MappedColumnarModel.cpp \
+            ViewManager/PagedModel.cpp \
             ViewManager/ViewManager.cpp \
             WindowManager/AboutDialog.cpp \
             WindowManager/AboutWidget.cpp \
@@ -199,7 +213,7 @@ settingManagerHeaders.files = SettingManager/SettingManagerLibrary.h SettingMana
 INSTALLS += settingManagerHeaders
 
 viewManagerHeaders.path = /include/core/lib/ViewManager
-viewManagerHeaders.files = ViewManager/ViewManagerLibrary.h ViewManager/ViewManager.h ViewManager/IView.h ViewManager/IViewFactory.h ViewManager/IViewFilterable.h
+viewManagerHeaders.files = ViewManager/ViewManagerLibrary.h ViewManager/ViewManager.h ViewManager/IView.h ViewManager/IViewFactory.h ViewManager/IViewFilterable.h ViewManager/FilterExpression.h ViewManager/AbstractColumnarModel.h ViewManager/ColumnarModel.h ViewManager/MappedColumnarModel.h ViewManager/PagedModel.h
 INSTALLS += viewManagerHeaders
 
 windowManagerHeaders.path = /include/core/lib/WindowManager
@@ -0,0 +1,336 @@
+/*!
+   \file ProcessFilterModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ProcessFilterModelPrivate.h"
+
+#include <QTimer>
+#include <QSet>
+
+#include "ProcessListModel.h"
+
+namespace Plugins {
+namespace ProcessList {
+
+/*! \class Plugins::ProcessList::ProcessFilterModel
+    \brief Sort/filter proxy for process lists that filters on the command line without rerunning a regex per row.
+
+    In substring mode (the default), the filter is split on '|' into alternatives, and each alternative on whitespace
+    into terms; a process matches when every term of any alternative appears in its command line, case-insensitively.
+    "mpirun|srun|orterun" therefore works the same as it did as a regular expression.  Regular expression mode is
+    still available through setFilterMode(); it follows filterCaseSensitivity(), which is case sensitive by default.
+
+    Each command line is tokenized (folded to lower case, repeated arguments dropped) once per process and cached by
+    PID together with the result of the last evaluation.  A refresh only evaluates processes that are new or whose
+    command line changed, and typing more characters onto a substring filter only re-checks processes that still
+    matched.  Filter text changes are applied after a short delay, so a burst of keystrokes costs one pass.
+
+    When the source is a ProcessTreeModel, a process is kept if it or any of its descendants match.
+    \sa ProcessListModel ProcessTreeModel
+ */
+
+ProcessFilterModel::ProcessFilterModel(QObject *parent) :
+    QSortFilterProxyModel(parent),
+    d(new ProcessFilterModelPrivate)
+{
+    d->q = this;
+
+    connect(d->m_Timer, SIGNAL(timeout()), this, SLOT(applyFilter()));
+}
+
+ProcessFilterModel::~ProcessFilterModel()
+{
+}
+
+QString ProcessFilterModel::filterText() const
+{
+    return d->m_PendingText;
+}
+
+/*!
+   \brief Sets the text to filter by; it is applied once no further change arrives within filterDelay().
+   \sa applyFilter()
+ */
+void ProcessFilterModel::setFilterText(const QString &text)
+{
+    d->m_PendingText = text;
+
+    if(d->m_Timer->interval() > 0) {
+        d->m_Timer->start();
+    } else {
+        applyFilter();
+    }
+}
+
+ProcessFilterModel::FilterMode ProcessFilterModel::filterMode() const
+{
+    return d->m_Mode;
+}
+
+void ProcessFilterModel::setFilterMode(const FilterMode &mode)
+{
+    if(d->m_Mode == mode) {
+        return;
+    }
+
+    d->m_Mode = mode;
+    d->m_Text = QString();
+    applyFilter();
+}
+
+int ProcessFilterModel::filterDelay() const
+{
+    return d->m_Timer->interval();
+}
+
+void ProcessFilterModel::setFilterDelay(const int &msec)
+{
+    d->m_Timer->setInterval(qMax(0, msec));
+}
+
+/*!
+   \brief Applies any pending filter text immediately.
+ */
+void ProcessFilterModel::applyFilter()
+{
+    d->m_Timer->stop();
+
+    QString text = d->m_PendingText;
+    if(text == d->m_Text && !d->m_Text.isNull()) {
+        return;
+    }
+
+    // Typing onto a plain substring filter can only narrow the result
+    bool refined = d->m_Mode == FilterMode_Substring &&
+                   !d->m_Text.isEmpty() &&
+                   !d->m_Text.contains('|') &&
+                   !text.contains('|') &&
+                   text.startsWith(d->m_Text, Qt::CaseInsensitive);
+
+    d->m_Text = text;
+
+    d->m_Alternatives.clear();
+    foreach(QString alternative, text.toLower().split('|', QString::SkipEmptyParts)) {
+        QStringList terms = alternative.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if(!terms.isEmpty()) {
+            d->m_Alternatives.append(terms);
+        }
+    }
+
+    d->m_RegExp = QRegExp(text, filterCaseSensitivity());
+
+    d->m_RefinedGeneration = refined ? d->m_Generation : 0;
+    ++d->m_Generation;
+
+    invalidateFilter();
+}
+
+/*!
+   \brief Drops cached command lines of processes that are no longer in the source model.
+ */
+void ProcessFilterModel::pruneCache()
+{
+    QHash<quint64, ProcessFilterModelPrivate::Entry> entries;
+    if(sourceModel()) {
+        entries.reserve(d->m_Entries.count());
+        d->collectPids(QModelIndex(), entries);
+    }
+    d->m_Entries = entries;
+}
+
+void ProcessFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if(QAbstractItemModel *oldModel = this->sourceModel()) {
+        disconnect(oldModel, 0, d.data(), 0);
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    if(sourceModel) {
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+                d.data(), SLOT(sourceDataChanged(QModelIndex,QModelIndex)));
+    }
+}
+
+bool ProcessFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if(!d->isActive()) {
+        return true;
+    }
+
+    return d->accepts(sourceRow, sourceParent);
+}
+
+
+
+
+ProcessFilterModelPrivate::ProcessFilterModelPrivate() :
+    m_Timer(new QTimer(this)),
+    m_Mode(ProcessFilterModel::FilterMode_Substring),
+    m_Generation(1),
+    m_RefinedGeneration(0)
+{
+    m_Timer->setSingleShot(true);
+    m_Timer->setInterval(150);
+}
+
+ProcessFilterModelPrivate::~ProcessFilterModelPrivate()
+{
+}
+
+/*!
+   \internal
+   \brief Folds a command line to lower case and drops repeated arguments; terms never contain whitespace, so
+          matching against the joined tokens is equivalent to matching against the command line.
+ */
+QString ProcessFilterModelPrivate::tokenize(const QString &command)
+{
+    static const QRegExp rxWhitespace("\\s+");
+
+    QStringList tokens;
+    QSet<QString> seen;
+    foreach(const QString &token, command.toLower().split(rxWhitespace, QString::SkipEmptyParts)) {
+        if(!seen.contains(token)) {
+            seen.insert(token);
+            tokens.append(token);
+        }
+    }
+
+    // Never null, so an empty command line is still only tokenized once
+    QString joined = tokens.join(" ");
+    return joined.isNull() ? QString("") : joined;
+}
+
+bool ProcessFilterModelPrivate::isActive() const
+{
+    if(m_Mode == ProcessFilterModel::FilterMode_Substring) {
+        return !m_Alternatives.isEmpty();
+    }
+
+    return !m_Text.isEmpty() && m_RegExp.isValid();
+}
+
+bool ProcessFilterModelPrivate::accepts(int sourceRow, const QModelIndex &sourceParent)
+{
+    QAbstractItemModel *source = q->sourceModel();
+    QModelIndex pidIndex = source->index(sourceRow, ProcessListModel::Column_Pid, sourceParent);
+    quint64 pid = pidIndex.data().toULongLong();
+    QString command = source->index(sourceRow, ProcessListModel::Column_Command, sourceParent).data().toString();
+
+    bool accepted;
+    {
+        Entry &entry = m_Entries[pid];
+
+        // Unchanged rows share the model's string data, so this is usually just a pointer comparison
+        if(entry.command != command || entry.command.isNull()) {
+            entry.command = command;
+            entry.tokens = QString();
+            entry.generation = 0;
+        }
+
+        if(entry.generation != m_Generation) {
+            if(!(m_RefinedGeneration && entry.generation == m_RefinedGeneration && !entry.accepted)) {
+                entry.accepted = matches(entry);
+            }
+            entry.generation = m_Generation;
+        }
+
+        accepted = entry.accepted;
+    }
+
+    if(accepted) {
+        return true;
+    }
+
+    // Keep parents of matching processes when the source is a tree
+    QModelIndex parent = source->index(sourceRow, 0, sourceParent);
+    int rowCount = source->rowCount(parent);
+    for(int row = 0; row < rowCount; ++row) {
+        if(accepts(row, parent)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ProcessFilterModelPrivate::matches(Entry &entry)
+{
+    if(m_Mode == ProcessFilterModel::FilterMode_RegExp) {
+        return m_RegExp.indexIn(entry.command) >= 0;
+    }
+
+    if(entry.tokens.isNull()) {
+        entry.tokens = tokenize(entry.command);
+    }
+
+    foreach(const QStringList &terms, m_Alternatives) {
+        bool matched = true;
+        foreach(const QString &term, terms) {
+            if(!entry.tokens.contains(term)) {
+                matched = false;
+                break;
+            }
+        }
+
+        if(matched) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+   \internal
+   \brief A changed command line in a tree may change whether its ancestors are kept, which QSortFilterProxyModel
+          doesn't check on its own; only then is the whole filter run again (mostly from the cache).
+ */
+void ProcessFilterModelPrivate::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if(!topLeft.parent().isValid() || !isActive()) {
+        return;
+    }
+
+    if(topLeft.column() > ProcessListModel::Column_Command || bottomRight.column() < ProcessListModel::Column_Command) {
+        return;
+    }
+
+    q->invalidateFilter();
+}
+
+void ProcessFilterModelPrivate::collectPids(const QModelIndex &parent, QHash<quint64, Entry> &entries)
+{
+    QAbstractItemModel *source = q->sourceModel();
+    int rowCount = source->rowCount(parent);
+    for(int row = 0; row < rowCount; ++row) {
+        QModelIndex index = source->index(row, ProcessListModel::Column_Pid, parent);
+        quint64 pid = index.data().toULongLong();
+        if(m_Entries.contains(pid)) {
+            entries.insert(pid, m_Entries.value(pid));
+        }
+        collectPids(index, entries);
+    }
+}
+
+} // namespace ProcessList
+} // namespace Plugins
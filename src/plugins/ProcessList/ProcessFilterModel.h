@@ -0,0 +1,74 @@
+/*!
+   \file ProcessFilterModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSFILTERMODEL_H
+#define PLUGINS_PROCESSLIST_PROCESSFILTERMODEL_H
+
+#include "ProcessListLibrary.h"
+
+#include <QSortFilterProxyModel>
+
+namespace Plugins {
+namespace ProcessList {
+
+class ProcessFilterModelPrivate;
+
+class PROCESSLIST_EXPORT ProcessFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(ProcessFilterModel)
+    Q_DISABLE_COPY(ProcessFilterModel)
+
+public:
+    enum FilterMode {
+        FilterMode_Substring,
+        FilterMode_RegExp
+    };
+
+    explicit ProcessFilterModel(QObject *parent = 0);
+    ~ProcessFilterModel();
+
+    QString filterText() const;
+
+    FilterMode filterMode() const;
+    void setFilterMode(const FilterMode &mode);
+
+    int filterDelay() const;
+    void setFilterDelay(const int &msec);
+
+    virtual void setSourceModel(QAbstractItemModel *sourceModel);
+
+public slots:
+    void setFilterText(const QString &text);
+    void applyFilter();
+    void pruneCache();
+
+protected:
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSFILTERMODEL_H
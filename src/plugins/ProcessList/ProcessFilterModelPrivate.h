@@ -0,0 +1,86 @@
+/*!
+   \file ProcessFilterModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSFILTERMODELPRIVATE_H
+#define PLUGINS_PROCESSLIST_PROCESSFILTERMODELPRIVATE_H
+
+#include "ProcessFilterModel.h"
+
+#include <QHash>
+#include <QStringList>
+#include <QRegExp>
+
+class QTimer;
+
+namespace Plugins {
+namespace ProcessList {
+
+class PROCESSLIST_EXPORT ProcessFilterModelPrivate : QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(ProcessFilterModel)
+    Q_DISABLE_COPY(ProcessFilterModelPrivate)
+
+public:
+    ProcessFilterModelPrivate();
+    ~ProcessFilterModelPrivate();
+
+    struct Entry {
+        Entry() : generation(0), accepted(false) {}
+
+        QString command;
+        QString tokens;
+        quint32 generation;
+        bool accepted;
+    };
+
+    static QString tokenize(const QString &command);
+
+    bool isActive() const;
+    bool accepts(int sourceRow, const QModelIndex &sourceParent);
+    bool matches(Entry &entry);
+    void collectPids(const QModelIndex &parent, QHash<quint64, Entry> &entries);
+
+protected slots:
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    QTimer *m_Timer;
+
+    QString m_PendingText;
+    QString m_Text;
+    ProcessFilterModel::FilterMode m_Mode;
+
+    QList<QStringList> m_Alternatives;
+    QRegExp m_RegExp;
+
+    quint32 m_Generation;
+    quint32 m_RefinedGeneration;
+
+    QHash<quint64, Entry> m_Entries;
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSFILTERMODELPRIVATE_H
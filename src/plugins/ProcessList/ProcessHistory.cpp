@@ -0,0 +1,228 @@
+/*!
+   \file ProcessHistory.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ProcessHistoryPrivate.h"
+
+namespace Plugins {
+namespace ProcessList {
+
+/*! \class Plugins::ProcessList::ProcessHistory
+    \brief Keeps the last few CPU and memory samples of every listed process.
+
+    Samples are held in fixed-size ring buffers, one per process, laid out back to back in a single array per metric.
+    Slots are recycled as soon as a process disappears from a sample, and no more than maximumProcesses() are ever
+    tracked, so memory stays bounded no matter how long the list is refreshed or how many processes come and go.
+
+    \code
+    history.beginSample();
+    history.addSample(pid, cpu, memory);
+    ...
+    history.endSample();
+    \endcode
+    \sa ProcessListModel::history() ProcessHistoryDelegate
+ */
+
+ProcessHistory::ProcessHistory(const int &length, const int &maximumProcesses) :
+    d(new ProcessHistoryPrivate)
+{
+    d->q = this;
+
+    d->m_Length = qMax(1, length);
+    d->m_MaximumProcesses = qMax(0, maximumProcesses);
+}
+
+ProcessHistory::~ProcessHistory()
+{
+}
+
+/*!
+   \brief The number of samples kept per process.
+ */
+int ProcessHistory::length() const
+{
+    return d->m_Length;
+}
+
+/*!
+   \brief Sets the number of samples kept per process; this clears any existing history.
+ */
+void ProcessHistory::setLength(const int &length)
+{
+    if(d->m_Length == qMax(1, length)) {
+        return;
+    }
+
+    clear();
+    d->m_Length = qMax(1, length);
+}
+
+int ProcessHistory::maximumProcesses() const
+{
+    return d->m_MaximumProcesses;
+}
+
+/*!
+   \brief Sets the maximum number of processes tracked at once; this clears any existing history.
+ */
+void ProcessHistory::setMaximumProcesses(const int &maximumProcesses)
+{
+    if(d->m_MaximumProcesses == qMax(0, maximumProcesses)) {
+        return;
+    }
+
+    clear();
+    d->m_MaximumProcesses = qMax(0, maximumProcesses);
+}
+
+/*!
+   \brief Starts a new sample; any process not given an addSample() before endSample() is forgotten.
+ */
+void ProcessHistory::beginSample()
+{
+    ++d->m_Generation;
+}
+
+void ProcessHistory::addSample(const quint64 &pid, const float &cpu, const float &memory)
+{
+    int slot = d->m_SlotForPid.value(pid, -1);
+
+    if(slot < 0) {
+        if(!d->m_FreeSlots.isEmpty()) {
+            slot = d->m_FreeSlots.last();
+            d->m_FreeSlots.removeLast();
+        } else if(d->m_Pids.count() < d->m_MaximumProcesses) {
+            slot = d->m_Pids.count();
+            d->m_Pids.append(0);
+            d->m_Generations.append(0);
+            d->m_Heads.append(0);
+            d->m_Counts.append(0);
+            d->m_Cpu.resize(d->m_Cpu.count() + d->m_Length);
+            d->m_Memory.resize(d->m_Memory.count() + d->m_Length);
+        } else {
+            return;
+        }
+
+        d->m_Pids[slot] = pid;
+        d->m_Heads[slot] = 0;
+        d->m_Counts[slot] = 0;
+        d->m_SlotForPid.insert(pid, slot);
+    }
+
+    int offset = (slot * d->m_Length) + d->m_Heads.at(slot);
+    d->m_Cpu[offset] = cpu;
+    d->m_Memory[offset] = memory;
+
+    d->m_Heads[slot] = (d->m_Heads.at(slot) + 1) % d->m_Length;
+    if(d->m_Counts.at(slot) < d->m_Length) {
+        ++d->m_Counts[slot];
+    }
+
+    d->m_Generations[slot] = d->m_Generation;
+}
+
+/*!
+   \brief Finishes a sample, releasing the slots of processes that weren't part of it.
+ */
+void ProcessHistory::endSample()
+{
+    for(int slot = 0; slot < d->m_Pids.count(); ++slot) {
+        if(d->m_Counts.at(slot) && d->m_Generations.at(slot) != d->m_Generation) {
+            d->m_SlotForPid.remove(d->m_Pids.at(slot));
+            d->m_Counts[slot] = 0;
+            d->m_FreeSlots.append(slot);
+        }
+    }
+}
+
+void ProcessHistory::clear()
+{
+    d->m_Pids.clear();
+    d->m_Generations.clear();
+    d->m_Heads.clear();
+    d->m_Counts.clear();
+    d->m_Cpu.clear();
+    d->m_Memory.clear();
+    d->m_SlotForPid.clear();
+    d->m_FreeSlots.clear();
+}
+
+bool ProcessHistory::contains(const quint64 &pid) const
+{
+    return d->m_SlotForPid.contains(pid);
+}
+
+int ProcessHistory::processCount() const
+{
+    return d->m_SlotForPid.count();
+}
+
+/*!
+   \brief Copies the CPU history of a process into \a values, oldest first.
+   \a values must have room for length() samples.
+   \returns the number of samples copied
+ */
+int ProcessHistory::cpuHistory(const quint64 &pid, float *values) const
+{
+    return d->copyHistory(d->m_Cpu, pid, values);
+}
+
+/*!
+   \brief Copies the memory (RSS) history of a process into \a values, oldest first.
+   \a values must have room for length() samples.
+   \returns the number of samples copied
+ */
+int ProcessHistory::memoryHistory(const quint64 &pid, float *values) const
+{
+    return d->copyHistory(d->m_Memory, pid, values);
+}
+
+
+
+
+ProcessHistoryPrivate::ProcessHistoryPrivate() :
+    m_Length(1),
+    m_MaximumProcesses(0),
+    m_Generation(0)
+{
+}
+
+int ProcessHistoryPrivate::copyHistory(const QVector<float> &samples, const quint64 &pid, float *values) const
+{
+    int slot = m_SlotForPid.value(pid, -1);
+    if(slot < 0) {
+        return 0;
+    }
+
+    const float *ring = samples.constData() + (slot * m_Length);
+    int count = m_Counts.at(slot);
+    int start = (m_Heads.at(slot) - count + m_Length) % m_Length;
+
+    for(int i = 0; i < count; ++i) {
+        values[i] = ring[(start + i) % m_Length];
+    }
+
+    return count;
+}
+
+} // namespace ProcessList
+} // namespace Plugins
@@ -0,0 +1,64 @@
+/*!
+   \file ProcessHistory.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSHISTORY_H
+#define PLUGINS_PROCESSLIST_PROCESSHISTORY_H
+
+#include "ProcessListLibrary.h"
+
+namespace Plugins {
+namespace ProcessList {
+
+class ProcessHistoryPrivate;
+
+class PROCESSLIST_EXPORT ProcessHistory
+{
+    DECLARE_PRIVATE(ProcessHistory)
+    Q_DISABLE_COPY(ProcessHistory)
+
+public:
+    explicit ProcessHistory(const int &length = 60, const int &maximumProcesses = 4096);
+    ~ProcessHistory();
+
+    int length() const;
+    void setLength(const int &length);
+
+    int maximumProcesses() const;
+    void setMaximumProcesses(const int &maximumProcesses);
+
+    void beginSample();
+    void addSample(const quint64 &pid, const float &cpu, const float &memory);
+    void endSample();
+    void clear();
+
+    bool contains(const quint64 &pid) const;
+    int processCount() const;
+
+    int cpuHistory(const quint64 &pid, float *values) const;
+    int memoryHistory(const quint64 &pid, float *values) const;
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSHISTORY_H
@@ -0,0 +1,129 @@
+/*!
+   \file ProcessHistoryDelegate.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ProcessHistoryDelegate.h"
+
+#include <QApplication>
+#include <QPainter>
+#include <QVarLengthArray>
+
+#include "ProcessHistory.h"
+#include "ProcessListModel.h"
+
+namespace Plugins {
+namespace ProcessList {
+
+/*! \class Plugins::ProcessList::ProcessHistoryDelegate
+    \brief Draws CPU (red) and memory (blue) sparklines for a process, straight out of a ProcessHistory.
+
+    The process is identified through the PID column of the row being painted, so the delegate works the same
+    through sorting, filtering and tree proxies.
+    \sa ProcessHistory ProcessListModel::Column_History
+ */
+
+ProcessHistoryDelegate::ProcessHistoryDelegate(QObject *parent) :
+    QStyledItemDelegate(parent),
+    m_History(NULL)
+{
+}
+
+const ProcessHistory *ProcessHistoryDelegate::history() const
+{
+    return m_History;
+}
+
+void ProcessHistoryDelegate::setHistory(const ProcessHistory *history)
+{
+    m_History = history;
+}
+
+void ProcessHistoryDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // Draw the background first
+    QStyleOptionViewItemV4 opt = option;
+    initStyleOption(&opt, index);
+    opt.text = QString();
+    QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &opt, painter);
+
+    if(!m_History) {
+        return;
+    }
+
+    quint64 pid = index.sibling(index.row(), ProcessListModel::Column_Pid).data().toULongLong();
+    if(!m_History->contains(pid)) {
+        return;
+    }
+
+    QVarLengthArray<float, 128> values(m_History->length());
+    QRectF rect = QRectF(option.rect).adjusted(2, 2, -2, -2);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    int count = m_History->memoryHistory(pid, values.data());
+    drawSparkline(painter, rect, values.constData(), count, Qt::darkBlue);
+
+    count = m_History->cpuHistory(pid, values.data());
+    drawSparkline(painter, rect, values.constData(), count, Qt::red);
+
+    painter->restore();
+}
+
+QSize ProcessHistoryDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    return size.expandedTo(QSize(2 * (m_History ? m_History->length() : 0), 0));
+}
+
+/*!
+   \internal
+   \brief Draws the samples right-aligned in \a rect, scaled to their own maximum.
+ */
+void ProcessHistoryDelegate::drawSparkline(QPainter *painter, const QRectF &rect, const float *values, const int &count, const QColor &color) const
+{
+    if(count < 2) {
+        return;
+    }
+
+    float maximum = 0.0f;
+    for(int i = 0; i < count; ++i) {
+        maximum = qMax(maximum, values[i]);
+    }
+    if(maximum <= 0.0f) {
+        maximum = 1.0f;
+    }
+
+    qreal step = rect.width() / qMax(1, m_History->length() - 1);
+    qreal left = rect.right() - (step * (count - 1));
+
+    QVarLengthArray<QPointF, 128> points(count);
+    for(int i = 0; i < count; ++i) {
+        points[i] = QPointF(left + (step * i), rect.bottom() - (rect.height() * (values[i] / maximum)));
+    }
+
+    painter->setPen(QPen(color, 1.0));
+    painter->drawPolyline(points.constData(), count);
+}
+
+} // namespace ProcessList
+} // namespace Plugins
@@ -0,0 +1,59 @@
+/*!
+   \file ProcessHistoryDelegate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSHISTORYDELEGATE_H
+#define PLUGINS_PROCESSLIST_PROCESSHISTORYDELEGATE_H
+
+#include "ProcessListLibrary.h"
+
+#include <QStyledItemDelegate>
+
+namespace Plugins {
+namespace ProcessList {
+
+class ProcessHistory;
+
+class PROCESSLIST_EXPORT ProcessHistoryDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessHistoryDelegate(QObject *parent = 0);
+
+    const ProcessHistory *history() const;
+    void setHistory(const ProcessHistory *history);
+
+    virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    virtual QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+protected:
+    void drawSparkline(QPainter *painter, const QRectF &rect, const float *values, const int &count, const QColor &color) const;
+
+    const ProcessHistory *m_History;
+
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSHISTORYDELEGATE_H
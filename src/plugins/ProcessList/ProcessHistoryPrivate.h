@@ -0,0 +1,67 @@
+/*!
+   \file ProcessHistoryPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSHISTORYPRIVATE_H
+#define PLUGINS_PROCESSLIST_PROCESSHISTORYPRIVATE_H
+
+#include "ProcessHistory.h"
+
+#include <QVector>
+#include <QHash>
+
+namespace Plugins {
+namespace ProcessList {
+
+class ProcessHistoryPrivate
+{
+    DECLARE_PUBLIC(ProcessHistory)
+
+public:
+    ProcessHistoryPrivate();
+    ~ProcessHistoryPrivate() {}
+
+    int copyHistory(const QVector<float> &samples, const quint64 &pid, float *values) const;
+
+private:
+    int m_Length;
+    int m_MaximumProcesses;
+    quint32 m_Generation;
+
+    /* Per slot */
+    QVector<quint64> m_Pids;
+    QVector<quint32> m_Generations;
+    QVector<int> m_Heads;
+    QVector<int> m_Counts;
+
+    /* Per slot, m_Length samples each */
+    QVector<float> m_Cpu;
+    QVector<float> m_Memory;
+
+    QHash<quint64, int> m_SlotForPid;
+    QVector<int> m_FreeSlots;
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSHISTORYPRIVATE_H
@@ -27,16 +27,27 @@ HEADERS              += ProcessListPlugin.h \
                         ProcessListLibrary.h \
                         ProcessListWidget.h \
                         ProcessListModel.h \
-                        ProcessListModelPrivate.h
+                        ProcessListModelPrivate.h \
+                        ProcessTreeModel.h \
+                        ProcessTreeModelPrivate.h \
+                        ProcessHistory.h \
+                        ProcessHistoryPrivate.h \
+                        ProcessHistoryDelegate.h \
+                        ProcessFilterModel.h \
+                        ProcessFilterModelPrivate.h
 
 SOURCES              += ProcessListPlugin.cpp \
                         ProcessListWidget.cpp \
-                        ProcessListModel.cpp
+                        ProcessListModel.cpp \
+                        ProcessTreeModel.cpp \
+                        ProcessHistory.cpp \
+                        ProcessHistoryDelegate.cpp \
+                        ProcessFilterModel.cpp
 
 FORMS                += ProcessListWidget.ui
 
 DEFINES              += PROCESSLIST_LIBRARY
 
 processListPluginHeaders.path = /include/plugins/ProcessList
-processListPluginHeaders.files = ProcessListLibrary.h ProcessListModel.h ProcessListWidget.h
+processListPluginHeaders.files = ProcessListLibrary.h ProcessListModel.h ProcessTreeModel.h ProcessHistory.h ProcessHistoryDelegate.h ProcessFilterModel.h ProcessListWidget.h
 INSTALLS += processListPluginHeaders
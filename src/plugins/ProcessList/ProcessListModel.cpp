@@ -24,12 +24,23 @@
 #include "ProcessListModelPrivate.h"
 
 #include <QProcess>
+#include <QLocale>
+#include <QBrush>
 
 
 static const QString defaultRemoteHostName("localhost");
 static const QString defaultRemoteShell("ssh");
 
 
+static QStandardItem *createItem(const QVariant &value)
+{
+    QStandardItem *item = new QStandardItem();
+    item->setEditable(false);
+    item->setData(value, Qt::DisplayRole);
+    return item;
+}
+
+
 namespace Plugins {
 namespace ProcessList {
 
@@ -44,8 +55,15 @@ ProcessListModel::ProcessListModel(QObject *parent) :
     d->remoteHostName = defaultRemoteHostName;
     d->remoteShell = defaultRemoteShell;
 
-    setHorizontalHeaderItem(0, new QStandardItem(tr("PID")));
-    setHorizontalHeaderItem(1, new QStandardItem(tr("Command")));
+    setHorizontalHeaderItem(Column_Pid, new QStandardItem(tr("PID")));
+    setHorizontalHeaderItem(Column_ParentPid, new QStandardItem(tr("PPID")));
+    setHorizontalHeaderItem(Column_User, new QStandardItem(tr("User")));
+    setHorizontalHeaderItem(Column_State, new QStandardItem(tr("State")));
+    setHorizontalHeaderItem(Column_Cpu, new QStandardItem(tr("%CPU")));
+    setHorizontalHeaderItem(Column_Memory, new QStandardItem(tr("RSS (KiB)")));
+    setHorizontalHeaderItem(Column_Started, new QStandardItem(tr("Started")));
+    setHorizontalHeaderItem(Column_History, new QStandardItem(tr("History")));
+    setHorizontalHeaderItem(Column_Command, new QStandardItem(tr("Command")));
 }
 
 ProcessListModel::~ProcessListModel()
@@ -94,84 +112,14 @@ void ProcessListModel::setRemoteShell(const QString &shell)
     update();
 }
 
+/*!
+   \brief Starts gathering the process list; the model is updated once \c ps finishes.
+   Nothing blocks while \c ps runs, and an update requested while one is still running is dropped.
+   \sa updateStarted() updateFinished()
+ */
 void ProcessListModel::update()
 {
-    QByteArray output = d->getProcessList();
-    if(output.isEmpty()) {
-        return;
-    }
-
-    // BEGIN Parse the process list
-    QStringList lines = QString(output).split('\n');
-    QMap<quint64, QString> processes;
-
-    static const QRegExp rxPid("\\s*PID");
-    static const QRegExp rxCommand("COMMAND\\s*$");
-
-    int commandIndex = 0;
-    foreach(QString line, lines) {
-        if(line.contains(rxPid)) {
-            commandIndex = line.indexOf(rxCommand);
-            continue;
-        }
-
-        bool okay = false;
-        QString trimmed = line.trimmed();
-        quint64 pid = trimmed.left(trimmed.indexOf(' ')).toULongLong(&okay);
-
-        if(okay) {
-            processes.insert(pid, line.right(line.count() - commandIndex));
-        }
-    }
-    // END Parse process list
-
-
-    // BEGIN Remove or merge anything in the existing model
-    bool updating = d->processes.count();
-    foreach(quint64 pid, d->processes.keys()) {
-        QStandardItem *item = d->processes.value(pid);
-        if(!processes.contains(pid)) {
-            removeRow(item->row());
-            d->processes.remove(pid);
-        } else {
-            QModelIndex index = this->index(item->row(), 1);
-            if(index.data().toString() != processes.value(pid)) {
-                setData(index, processes.value(pid), Qt::DisplayRole);
-                if(d->changeBackgroundColorOnUpdate) {
-                    setData(index, QBrush(QColor(Qt::yellow).lighter()), Qt::BackgroundRole);
-                    item->setData(QBrush(QColor(Qt::yellow).lighter()), Qt::BackgroundRole);
-                }
-            } else {
-                if(d->changeBackgroundColorOnUpdate) {
-                    setData(index, QVariant(), Qt::BackgroundRole);
-                    item->setData(QVariant(), Qt::BackgroundRole);
-                }
-            }
-            processes.remove(pid);
-        }
-    }
-    // END Remove or merge anything in the existing model
-
-    // BEGIN Add everything else to the model
-    foreach(quint64 pid, processes.keys()) {
-        QStandardItem *item = new QStandardItem();
-        item->setEditable(false);
-        item->setData(QVariant(pid), Qt::DisplayRole);
-        d->processes.insert(pid, item);
-        appendRow(item);
-
-        QStandardItem *commandItem = new QStandardItem();
-        commandItem->setEditable(false);
-        commandItem->setText(processes.value(pid));
-        setItem(item->row(), 1, commandItem);
-
-        if(d->changeBackgroundColorOnUpdate && updating) {
-            item->setData(QBrush(QColor(Qt::green).lighter()), Qt::BackgroundRole);
-            commandItem->setData(QBrush(QColor(Qt::green).lighter()), Qt::BackgroundRole);
-        }
-    }
-    // END Add everything else to the model
-
+    d->startProcessList();
 }
 
 
@@ -199,11 +147,22 @@ void ProcessListModel::setChangeBackgroundColorOnUpdate(const bool &change)
 }
 
 
+/*!
+   \brief The CPU and memory samples gathered over the last several updates.
+   \sa ProcessHistoryDelegate
+ */
+ProcessHistory *ProcessListModel::history() const
+{
+    return &d->history;
+}
 
 
 
-ProcessListModelPrivate::ProcessListModelPrivate()
+ProcessListModelPrivate::ProcessListModelPrivate() :
+    process(new QProcess(this))
 {
+    process->setReadChannel(QProcess::StandardOutput);
+    connect(process, SIGNAL(finished(int)), this, SLOT(processListFinished()));
 
 }
 
@@ -212,11 +171,18 @@ ProcessListModelPrivate::~ProcessListModelPrivate()
 
 }
 
-QByteArray ProcessListModelPrivate::getProcessList()
+void ProcessListModelPrivate::startProcessList()
 {
+    if(process->state() != QProcess::NotRunning) {
+        return;
+    }
+
     QString program = "/bin/ps";
     QStringList arguments;
-    arguments << "w" << "w" << "x" << "o" << "pid,command";
+    // Empty headers drop the header line, and the command goes last so it can keep its spaces
+    arguments << "w" << "w" << "x"
+              << "-o" << "pid=" << "-o" << "ppid=" << "-o" << "user=" << "-o" << "stat="
+              << "-o" << "pcpu=" << "-o" << "rss=" << "-o" << "lstart=" << "-o" << "args=";
 
     // If it's not the local system that we're gathering from, use the remote shell to get the list
     if(remoteHostName != "localhost") {
@@ -226,19 +192,174 @@ QByteArray ProcessListModelPrivate::getProcessList()
         program = remoteShell;
     }
 
-    QProcess process;
-    process.start(program, arguments);
+    // Keep the start time in a format we know how to parse
+    QStringList environment = QProcess::systemEnvironment();
+    environment << "LC_ALL=C";
 
-    if(!process.waitForStarted()) {
-        return QByteArray();
+    process->setEnvironment(environment);
+    process->start(program, arguments);
+}
+
+void ProcessListModelPrivate::processListFinished()
+{
+    QByteArray output = process->readAllStandardOutput();
+    if(output.isEmpty()) {
+        return;
     }
 
-    if(!process.waitForFinished()) {
-        return QByteArray();
+    applyProcessList(output);
+}
+
+/*!
+   \internal
+   \brief Merges a freshly parsed process list into the model.
+ */
+void ProcessListModelPrivate::applyProcessList(const QByteArray &output)
+{
+    QMap<quint64, ProcessInfo> parsed = parseProcessList(output);
+
+    history.beginSample();
+    foreach(const ProcessInfo &info, parsed) {
+        history.addSample(info.pid, (float)info.cpu, (float)info.memory);
+    }
+    history.endSample();
+
+    emit q->updateStarted();
+
+    // BEGIN Remove or merge anything in the existing model
+    bool updating = processes.count();
+    foreach(quint64 pid, processes.keys()) {
+        QStandardItem *item = processes.value(pid);
+        if(!parsed.contains(pid)) {
+            q->removeRow(item->row());
+            processes.remove(pid);
+        } else {
+            const ProcessInfo &info = parsed[pid];
+            int row = item->row();
+
+            setItemData(q->item(row, ProcessListModel::Column_ParentPid), QVariant(info.parentPid));
+            setItemData(q->item(row, ProcessListModel::Column_User), QVariant(info.user));
+            setItemData(q->item(row, ProcessListModel::Column_State), QVariant(info.state));
+            setItemData(q->item(row, ProcessListModel::Column_Cpu), QVariant(info.cpu));
+            setItemData(q->item(row, ProcessListModel::Column_Memory), QVariant(info.memory));
+            setItemData(q->item(row, ProcessListModel::Column_Started), QVariant(info.started));
+
+            bool changed = q->item(row, ProcessListModel::Column_Command)->text() != info.command;
+            if(changed) {
+                setItemData(q->item(row, ProcessListModel::Column_Command), QVariant(info.command));
+            }
+
+            if(changeBackgroundColorOnUpdate) {
+                QVariant background = changed ? QVariant(QBrush(QColor(Qt::yellow).lighter())) : QVariant();
+                for(int column = 0; column < ProcessListModel::Column_Count; ++column) {
+                    setItemData(q->item(row, column), background, Qt::BackgroundRole);
+                }
+            }
+
+            parsed.remove(pid);
+        }
+    }
+    // END Remove or merge anything in the existing model
+
+    // BEGIN Add everything else to the model
+    QMap<quint64, ProcessInfo>::const_iterator iter;
+    for(iter = parsed.constBegin(); iter != parsed.constEnd(); ++iter) {
+        const ProcessInfo &info = iter.value();
+
+        QList<QStandardItem *> items;
+        items << createItem(QVariant(info.pid))
+              << createItem(QVariant(info.parentPid))
+              << createItem(QVariant(info.user))
+              << createItem(QVariant(info.state))
+              << createItem(QVariant(info.cpu))
+              << createItem(QVariant(info.memory))
+              << createItem(QVariant(info.started))
+              << createItem(QVariant())
+              << createItem(QVariant(info.command));
+
+        if(changeBackgroundColorOnUpdate && updating) {
+            foreach(QStandardItem *item, items) {
+                item->setData(QBrush(QColor(Qt::green).lighter()), Qt::BackgroundRole);
+            }
+        }
+
+        processes.insert(info.pid, items.first());
+        q->appendRow(items);
+    }
+    // END Add everything else to the model
+
+    emit q->updateFinished();
+}
+
+/*!
+   \internal
+   \brief Parses the output of the \c ps run by startProcessList().
+   Every column ahead of the command is a single token, except the start time which is five; the command is the rest
+   of the line, spaces and all.  Splitting on tokens rather than header offsets keeps working when a wide value (a
+   long user name, say) pushes the following columns to the right.
+ */
+QMap<quint64, ProcessInfo> ProcessListModelPrivate::parseProcessList(const QByteArray &output)
+{
+    static const int FieldCount = 11;
+
+    QMap<quint64, ProcessInfo> processes;
+
+    foreach(const QString &line, QString::fromLocal8Bit(output).split('\n')) {
+        QStringList fields;
+        int position = 0;
+        int length = line.length();
+
+        while(fields.count() < FieldCount) {
+            while(position < length && line.at(position).isSpace()) {
+                ++position;
+            }
+            if(position >= length) {
+                break;
+            }
+
+            int start = position;
+            while(position < length && !line.at(position).isSpace()) {
+                ++position;
+            }
+            fields.append(line.mid(start, position - start));
+        }
+
+        while(position < length && line.at(position).isSpace()) {
+            ++position;
+        }
+
+        bool okay = false;
+        ProcessInfo info;
+
+        // A header line, if the remote ps printed one anyway, fails here too
+        info.pid = fields.value(0).toULongLong(&okay);
+        if(!okay || fields.count() < FieldCount) {
+            continue;
+        }
+
+        info.parentPid = fields.at(1).toULongLong();
+        info.user = fields.at(2);
+        info.state = fields.at(3);
+        info.cpu = fields.at(4).toDouble();
+        info.memory = fields.at(5).toULongLong();
+        info.started = QLocale::c().toDateTime(QStringList(fields.mid(6, 5)).join(" "), "ddd MMM d hh:mm:ss yyyy");
+        info.command = line.mid(position).trimmed();
+
+        processes.insert(info.pid, info);
     }
 
-    return process.readAll();
+    return processes;
+}
 
+/*!
+   \internal
+   \brief Only touches the item when the value differs, so a refresh doesn't emit a dataChanged for every cell.
+ */
+void ProcessListModelPrivate::setItemData(QStandardItem *item, const QVariant &value, int role)
+{
+    if(item->data(role) != value) {
+        item->setData(value, role);
+    }
 }
 
 
@@ -32,6 +32,7 @@ namespace Plugins {
 namespace ProcessList {
 
 class ProcessListModelPrivate;
+class ProcessHistory;
 
 
 class PROCESSLIST_EXPORT ProcessListModel : public QStandardItemModel
@@ -41,6 +42,19 @@ class PROCESSLIST_EXPORT ProcessListModel : public QStandardItemModel
     Q_DISABLE_COPY(ProcessListModel)
 
 public:
+    enum Columns {
+        Column_Pid = 0,
+        Column_ParentPid,
+        Column_User,
+        Column_State,
+        Column_Cpu,
+        Column_Memory,
+        Column_Started,
+        Column_History,
+        Column_Command,
+        Column_Count
+    };
+
     explicit ProcessListModel(QObject *parent = 0);
     ~ProcessListModel();
 
@@ -53,9 +67,15 @@ public:
     bool changeBackgroundColorOnUpdate() const;
     void setChangeBackgroundColorOnUpdate(const bool &change);
 
+    ProcessHistory *history() const;
+
 public slots:
     void update();
 
+signals:
+    void updateStarted();
+    void updateFinished();
+
 };
 
 
@@ -25,10 +25,28 @@
 #define PLUGINS_PROCESSLIST_PROCESSLISTPRIVATE_H
 
 #include "ProcessListModel.h"
+#include "ProcessHistory.h"
+
+#include <QDateTime>
+#include <QProcess>
 
 namespace Plugins {
 namespace ProcessList {
 
+struct ProcessInfo
+{
+    ProcessInfo() : pid(0), parentPid(0), cpu(0.0), memory(0) {}
+
+    quint64 pid;
+    quint64 parentPid;
+    QString user;
+    QString state;
+    double cpu;
+    quint64 memory;
+    QDateTime started;
+    QString command;
+};
+
 class PROCESSLIST_EXPORT ProcessListModelPrivate : QObject
 {
     Q_OBJECT
@@ -39,14 +57,24 @@ public:
     ProcessListModelPrivate();
     ~ProcessListModelPrivate();
 
-    QByteArray getProcessList();
+    void startProcessList();
+    void applyProcessList(const QByteArray &output);
+    static QMap<quint64, ProcessInfo> parseProcessList(const QByteArray &output);
+
+    void setItemData(QStandardItem *item, const QVariant &value, int role = Qt::DisplayRole);
 
+    QProcess *process;
     bool changeBackgroundColorOnUpdate;
 
     QString remoteHostName;
     QString remoteShell;
 
     QMap<quint64, QStandardItem *> processes;
+
+    ProcessHistory history;
+
+protected slots:
+    void processListFinished();
 };
 
 } // namespace ProcessList
@@ -25,8 +25,11 @@
 #include "ui_ProcessListWidget.h"
 
 #include "ProcessListModel.h"
+#include "ProcessTreeModel.h"
+#include "ProcessFilterModel.h"
+#include "ProcessHistoryDelegate.h"
 
-#include <QSortFilterProxyModel>
+#include <QTimer>
 
 namespace Plugins {
 namespace ProcessList {
@@ -37,12 +40,22 @@ ProcessListWidget::ProcessListWidget(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    proxyModel = new QSortFilterProxyModel();
-    proxyModel->setFilterKeyColumn(1);
-    proxyModel->setFilterRole(Qt::DisplayRole);
+    treeModel = new ProcessTreeModel(this);
+
+    proxyModel = new ProcessFilterModel(this);
     proxyModel->setDynamicSortFilter(true);
     ui->trvProcesses->setModel(proxyModel);
-    connect(ui->txtProcessFilter, SIGNAL(textChanged(QString)), proxyModel, SLOT(setFilterRegExp(QString)));
+    connect(ui->txtProcessFilter, SIGNAL(textChanged(QString)), proxyModel, SLOT(setFilterText(QString)));
+    connect(ui->chkFilterRegExp, SIGNAL(toggled(bool)), this, SLOT(updateFilterMode()));
+    connect(ui->chkProcessTree, SIGNAL(toggled(bool)), this, SLOT(updateProcessTree()));
+
+    historyDelegate = new ProcessHistoryDelegate(this);
+    ui->trvProcesses->setItemDelegateForColumn(ProcessListModel::Column_History, historyDelegate);
+
+    refreshTimer = new QTimer(this);
+    connect(ui->spnRefreshInterval, SIGNAL(valueChanged(int)), this, SLOT(updateRefreshInterval()));
+
+    updateProcessTree();
 }
 
 ProcessListWidget::~ProcessListWidget()
@@ -53,7 +66,7 @@ ProcessListWidget::~ProcessListWidget()
 
 ProcessListModel *ProcessListWidget::model() const
 {
-    return qobject_cast<ProcessListModel *>(proxyModel->sourceModel());
+    return qobject_cast<ProcessListModel *>(treeModel->sourceModel());
 }
 void ProcessListWidget::setModel(ProcessListModel *model)
 {
@@ -65,12 +78,18 @@ void ProcessListWidget::setModel(ProcessListModel *model)
 
     if(oldModel) {
         disconnect(ui->btnRefresh, SIGNAL(clicked()), oldModel, SLOT(update()));
+        disconnect(refreshTimer, SIGNAL(timeout()), oldModel, SLOT(update()));
+        disconnect(oldModel, SIGNAL(updateFinished()), this, SLOT(modelUpdated()));
     }
 
-    proxyModel->setSourceModel(model);
+    treeModel->setSourceModel(model);
+    historyDelegate->setHistory(model ? model->history() : NULL);
+    updateProcessTree();
 
     if(model) {
         connect(ui->btnRefresh, SIGNAL(clicked()), model, SLOT(update()));
+        connect(refreshTimer, SIGNAL(timeout()), model, SLOT(update()));
+        connect(model, SIGNAL(updateFinished()), this, SLOT(modelUpdated()));
     }
 
 }
@@ -80,9 +99,99 @@ QString ProcessListWidget::filter() const
 {
     return ui->txtProcessFilter->text();
 }
+
+/*!
+   \brief Filters the command lines by a case sensitive regular expression.
+   The filter box is switched to regular expression mode; use setFilterText() for the tokenized substring filter.
+ */
 void ProcessListWidget::setFilter(const QString &filter)
 {
+    ui->chkFilterRegExp->setChecked(true);
     ui->txtProcessFilter->setText(filter);
+    proxyModel->applyFilter();
+}
+
+/*!
+   \brief Filters the command lines by case insensitive terms, as typed into the filter box in substring mode.
+   \sa ProcessFilterModel
+ */
+void ProcessListWidget::setFilterText(const QString &text)
+{
+    ui->chkFilterRegExp->setChecked(false);
+    ui->txtProcessFilter->setText(text);
+    proxyModel->applyFilter();
+}
+
+void ProcessListWidget::updateFilterMode()
+{
+    if(ui->chkFilterRegExp->isChecked()) {
+        proxyModel->setFilterMode(ProcessFilterModel::FilterMode_RegExp);
+    } else {
+        proxyModel->setFilterMode(ProcessFilterModel::FilterMode_Substring);
+    }
+}
+
+
+/*!
+   \brief Whether processes are nested under their parent process (e.g. ranks under their launcher).
+   \sa ProcessTreeModel
+ */
+bool ProcessListWidget::processTree() const
+{
+    return ui->chkProcessTree->isChecked();
+}
+void ProcessListWidget::setProcessTree(const bool &processTree)
+{
+    ui->chkProcessTree->setChecked(processTree);
+}
+
+void ProcessListWidget::updateProcessTree()
+{
+    bool tree = processTree();
+
+    if(tree) {
+        proxyModel->setSourceModel(treeModel);
+    } else {
+        proxyModel->setSourceModel(model());
+    }
+
+    ui->trvProcesses->setRootIsDecorated(tree);
+    ui->trvProcesses->setItemsExpandable(tree);
+
+    if(tree) {
+        ui->trvProcesses->expandAll();
+    }
+}
+
+
+/*!
+   \brief The automatic refresh interval in milliseconds; zero when only refreshing manually.
+ */
+int ProcessListWidget::refreshInterval() const
+{
+    return ui->spnRefreshInterval->value() * 1000;
+}
+void ProcessListWidget::setRefreshInterval(const int &msec)
+{
+    ui->spnRefreshInterval->setValue(msec / 1000);
+}
+
+void ProcessListWidget::updateRefreshInterval()
+{
+    int interval = refreshInterval();
+    if(interval > 0) {
+        refreshTimer->start(interval);
+    } else {
+        refreshTimer->stop();
+    }
+}
+
+void ProcessListWidget::modelUpdated()
+{
+    proxyModel->pruneCache();
+
+    // Every sparkline moved, even on rows whose values didn't
+    ui->trvProcesses->viewport()->update();
 }
 
 
@@ -96,7 +205,7 @@ QStringList ProcessListWidget::selectedPids() const
     QStringList selectedPids;
     QItemSelectionModel *selectionModel = ui->trvProcesses->selectionModel();
     foreach(QModelIndex index, selectionModel->selectedIndexes()) {
-        if(index.column() == 0) {
+        if(index.column() == ProcessListModel::Column_Pid) {
             QString value = index.data(Qt::DisplayRole).toString();
             if(selectedPids.contains(value)) {
                 selectedPids.append(value);
@@ -111,7 +220,7 @@ QStringList ProcessListWidget::selectedCommands() const
     QStringList selectedCommands;
     QItemSelectionModel *selectionModel = ui->trvProcesses->selectionModel();
     foreach(QModelIndex index, selectionModel->selectedIndexes()) {
-        if(index.column() == 1) {
+        if(index.column() == ProcessListModel::Column_Command) {
             QString value = index.data(Qt::DisplayRole).toString();
             if(selectedCommands.contains(value)) {
                 selectedCommands.append(value);
@@ -26,8 +26,8 @@
 
 #include <QWidget>
 
-class QSortFilterProxyModel;
 class QItemSelectionModel;
+class QTimer;
 
 namespace Plugins {
 namespace ProcessList {
@@ -35,6 +35,9 @@ namespace ProcessList {
 namespace Ui { class ProcessListWidget; }
 
 class ProcessListModel;
+class ProcessTreeModel;
+class ProcessFilterModel;
+class ProcessHistoryDelegate;
 
 class ProcessListWidget : public QWidget
 {
@@ -49,14 +52,30 @@ public:
 
     QString filter() const;
     void setFilter(const QString &filter);
+    void setFilterText(const QString &text);
+
+    bool processTree() const;
+    void setProcessTree(const bool &processTree);
+
+    int refreshInterval() const;
+    void setRefreshInterval(const int &msec);
 
     QItemSelectionModel *selectionModel() const;
     QStringList selectedPids() const;
     QStringList selectedCommands() const;
 
+private slots:
+    void updateProcessTree();
+    void updateFilterMode();
+    void updateRefreshInterval();
+    void modelUpdated();
+
 private:
     Ui::ProcessListWidget *ui;
-    QSortFilterProxyModel *proxyModel;
+    ProcessFilterModel *proxyModel;
+    ProcessTreeModel *treeModel;
+    ProcessHistoryDelegate *historyDelegate;
+    QTimer *refreshTimer;
 };
 
 } // namespace ProcessList
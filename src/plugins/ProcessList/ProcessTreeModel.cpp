@@ -0,0 +1,388 @@
+/*!
+   \file ProcessTreeModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ProcessTreeModelPrivate.h"
+
+#include "ProcessListModel.h"
+
+namespace Plugins {
+namespace ProcessList {
+
+/*! \class Plugins::ProcessList::ProcessTreeModel
+    \brief Proxy that nests each process under its parent, using the PPID column of a ProcessListModel.
+
+    The tree is rebuilt in a single linear pass from the parent links whenever the source changes structure.  Child
+    lists are kept in one contiguous array (indexed by offsets per parent) rather than a list per process.  Processes
+    whose parent isn't in the source model are placed at the top level.
+
+    When the source is a ProcessListModel, a whole refresh is handled as at most one layout change, and persistent
+    indexes (selections, expanded items) follow their process by PID.  A refresh that adds, removes or reparents no
+    process only forwards the changed cells, so a filter on top doesn't have to look at every row again.
+    \sa ProcessListModel
+ */
+
+ProcessTreeModel::ProcessTreeModel(QObject *parent) :
+    QAbstractProxyModel(parent),
+    d(new ProcessTreeModelPrivate)
+{
+    d->q = this;
+}
+
+ProcessTreeModel::~ProcessTreeModel()
+{
+}
+
+void ProcessTreeModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    beginResetModel();
+
+    if(QAbstractItemModel *oldModel = this->sourceModel()) {
+        disconnect(oldModel, 0, d.data(), 0);
+    }
+
+    QAbstractProxyModel::setSourceModel(sourceModel);
+
+    if(sourceModel) {
+        if(qobject_cast<ProcessListModel *>(sourceModel)) {
+            connect(sourceModel, SIGNAL(updateStarted()), d.data(), SLOT(sourceUpdateStarted()));
+            connect(sourceModel, SIGNAL(updateFinished()), d.data(), SLOT(sourceUpdateFinished()));
+        }
+
+        connect(sourceModel, SIGNAL(modelAboutToBeReset()), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(modelReset()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(columnsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(columnsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(layoutAboutToBeChanged()), d.data(), SLOT(sourceLayoutAboutToBeChanged()));
+        connect(sourceModel, SIGNAL(layoutChanged()), d.data(), SLOT(sourceLayoutChanged()));
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), d.data(), SLOT(sourceDataChanged(QModelIndex,QModelIndex)));
+    }
+
+    d->rebuild();
+
+    endResetModel();
+}
+
+QModelIndex ProcessTreeModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if(!proxyIndex.isValid() || !sourceModel()) {
+        return QModelIndex();
+    }
+
+    return sourceModel()->index(d->nodeForIndex(proxyIndex), proxyIndex.column());
+}
+
+QModelIndex ProcessTreeModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if(!sourceIndex.isValid() || sourceIndex.row() >= d->m_Parents.count()) {
+        return QModelIndex();
+    }
+
+    int node = sourceIndex.row();
+    return createIndex(d->m_RowInParent.at(node), sourceIndex.column(), static_cast<quint32>(d->m_Parents.at(node)));
+}
+
+QModelIndex ProcessTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if(row < 0 || column < 0 || row >= rowCount(parent) || column >= columnCount(parent)) {
+        return QModelIndex();
+    }
+
+    return createIndex(row, column, static_cast<quint32>(d->nodeForIndex(parent)));
+}
+
+QModelIndex ProcessTreeModel::parent(const QModelIndex &child) const
+{
+    if(!child.isValid()) {
+        return QModelIndex();
+    }
+
+    int node = (int)child.internalId();
+    if(node == d->rootNode()) {
+        return QModelIndex();
+    }
+
+    return createIndex(d->m_RowInParent.at(node), 0, static_cast<quint32>(d->m_Parents.at(node)));
+}
+
+int ProcessTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid() && parent.column() != 0) {
+        return 0;
+    }
+
+    int node = d->nodeForIndex(parent);
+    return d->m_ChildOffsets.at(node + 1) - d->m_ChildOffsets.at(node);
+}
+
+int ProcessTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+
+    if(!sourceModel()) {
+        return 0;
+    }
+
+    return sourceModel()->columnCount();
+}
+
+bool ProcessTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+QVariant ProcessTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation == Qt::Horizontal && sourceModel()) {
+        return sourceModel()->headerData(section, orientation, role);
+    }
+
+    return QAbstractProxyModel::headerData(section, orientation, role);
+}
+
+
+
+
+ProcessTreeModelPrivate::ProcessTreeModelPrivate() :
+    m_Updating(false),
+    m_RelayoutPending(false)
+{
+    m_ChildOffsets.fill(0, 2);
+}
+
+ProcessTreeModelPrivate::~ProcessTreeModelPrivate()
+{
+}
+
+int ProcessTreeModelPrivate::nodeForIndex(const QModelIndex &index) const
+{
+    if(!index.isValid()) {
+        return rootNode();
+    }
+
+    return childRow((int)index.internalId(), index.row());
+}
+
+/*!
+   \internal
+   \brief Resolves the parent of every source row through a PID lookup table, then lays out the child lists.
+ */
+void ProcessTreeModelPrivate::rebuild()
+{
+    QAbstractItemModel *source = q->sourceModel();
+    int count = source ? source->rowCount() : 0;
+
+    m_RowForPid.clear();
+    m_RowForPid.reserve(count);
+    for(int row = 0; row < count; ++row) {
+        m_RowForPid.insert(source->index(row, ProcessListModel::Column_Pid).data().toULongLong(), row);
+    }
+
+    m_Parents.resize(count);
+    for(int row = 0; row < count; ++row) {
+        quint64 parentPid = source->index(row, ProcessListModel::Column_ParentPid).data().toULongLong();
+        int parent = m_RowForPid.value(parentPid, count);
+        m_Parents[row] = (parent == row) ? count : parent;
+    }
+
+    buildChildren();
+
+    // Anything unreachable from the root is part of a parent loop (PID reuse); hoist it to the top level
+    QVector<bool> reached(count, false);
+    QVector<int> pending;
+    pending.reserve(count);
+    pending.append(count);
+    while(!pending.isEmpty()) {
+        int node = pending.last();
+        pending.removeLast();
+        for(int i = m_ChildOffsets.at(node); i < m_ChildOffsets.at(node + 1); ++i) {
+            reached[m_Children.at(i)] = true;
+            pending.append(m_Children.at(i));
+        }
+    }
+
+    if(reached.contains(false)) {
+        for(int row = 0; row < count; ++row) {
+            if(!reached.at(row)) {
+                m_Parents[row] = count;
+            }
+        }
+        buildChildren();
+    }
+}
+
+/*!
+   \internal
+   \brief Counting sort of the rows by parent, so each parent's children are contiguous and keep their source order.
+ */
+void ProcessTreeModelPrivate::buildChildren()
+{
+    int count = m_Parents.count();
+
+    m_ChildOffsets.fill(0, count + 2);
+    for(int row = 0; row < count; ++row) {
+        ++m_ChildOffsets[m_Parents.at(row) + 1];
+    }
+    for(int node = 1; node < m_ChildOffsets.count(); ++node) {
+        m_ChildOffsets[node] += m_ChildOffsets.at(node - 1);
+    }
+
+    QVector<int> next = m_ChildOffsets;
+    m_Children.resize(count);
+    m_RowInParent.resize(count);
+    for(int row = 0; row < count; ++row) {
+        int parent = m_Parents.at(row);
+        int position = next[parent]++;
+        m_Children[position] = row;
+        m_RowInParent[row] = position - m_ChildOffsets.at(parent);
+    }
+}
+
+void ProcessTreeModelPrivate::beginRelayout()
+{
+    emit q->layoutAboutToBeChanged();
+
+    m_PersistentIndexes = q->persistentIndexList();
+    m_PersistentPids.clear();
+    foreach(const QModelIndex &index, m_PersistentIndexes) {
+        QModelIndex pidIndex = q->sourceModel()->index(nodeForIndex(index), ProcessListModel::Column_Pid);
+        m_PersistentPids.append(qMakePair(pidIndex.data().toULongLong(), index.column()));
+    }
+}
+
+void ProcessTreeModelPrivate::endRelayout()
+{
+    rebuild();
+
+    QModelIndexList persistentIndexes;
+    for(int i = 0; i < m_PersistentPids.count(); ++i) {
+        int node = m_RowForPid.value(m_PersistentPids.at(i).first, -1);
+        if(node < 0) {
+            persistentIndexes.append(QModelIndex());
+        } else {
+            persistentIndexes.append(q->createIndex(m_RowInParent.at(node), m_PersistentPids.at(i).second,
+                                                    static_cast<quint32>(m_Parents.at(node))));
+        }
+    }
+
+    q->changePersistentIndexList(m_PersistentIndexes, persistentIndexes);
+    m_PersistentIndexes.clear();
+    m_PersistentPids.clear();
+
+    emit q->layoutChanged();
+}
+
+/*!
+   \internal
+   \brief Starts the refresh's layout change, the first time the refresh is about to change the tree's structure.
+   The source rows are still those of the current mapping at that point, so persistent indexes can be resolved to PIDs.
+ */
+void ProcessTreeModelPrivate::structureAboutToChange()
+{
+    if(!m_RelayoutPending) {
+        m_RelayoutPending = true;
+        beginRelayout();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceUpdateStarted()
+{
+    m_Updating = true;
+    m_RelayoutPending = false;
+}
+
+void ProcessTreeModelPrivate::sourceUpdateFinished()
+{
+    m_Updating = false;
+
+    if(m_RelayoutPending) {
+        m_RelayoutPending = false;
+        endRelayout();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceAboutToBeReset()
+{
+    if(m_Updating) {
+        structureAboutToChange();
+    } else {
+        q->beginResetModel();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceReset()
+{
+    if(!m_Updating) {
+        rebuild();
+        q->endResetModel();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceLayoutAboutToBeChanged()
+{
+    if(m_Updating) {
+        structureAboutToChange();
+    } else {
+        beginRelayout();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceLayoutChanged()
+{
+    if(!m_Updating) {
+        endRelayout();
+    }
+}
+
+void ProcessTreeModelPrivate::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // Once the structure has changed mid-refresh the mapping is stale; the layout change at the end covers these rows
+    if(m_RelayoutPending) {
+        return;
+    }
+
+    if(topLeft.column() <= ProcessListModel::Column_ParentPid && bottomRight.column() >= ProcessListModel::Column_ParentPid) {
+        // Only the parent links changed so far, so the current mapping still resolves persistent indexes
+        if(m_Updating) {
+            structureAboutToChange();
+        } else {
+            beginRelayout();
+            endRelayout();
+        }
+        return;
+    }
+
+    for(int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        QModelIndex first = q->mapFromSource(topLeft.sibling(row, topLeft.column()));
+        QModelIndex last = q->mapFromSource(bottomRight.sibling(row, bottomRight.column()));
+        emit q->dataChanged(first, last);
+    }
+}
+
+} // namespace ProcessList
+} // namespace Plugins
@@ -0,0 +1,63 @@
+/*!
+   \file ProcessTreeModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSTREEMODEL_H
+#define PLUGINS_PROCESSLIST_PROCESSTREEMODEL_H
+
+#include "ProcessListLibrary.h"
+
+#include <QAbstractProxyModel>
+
+namespace Plugins {
+namespace ProcessList {
+
+class ProcessTreeModelPrivate;
+
+class PROCESSLIST_EXPORT ProcessTreeModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(ProcessTreeModel)
+    Q_DISABLE_COPY(ProcessTreeModel)
+
+public:
+    explicit ProcessTreeModel(QObject *parent = 0);
+    ~ProcessTreeModel();
+
+    virtual void setSourceModel(QAbstractItemModel *sourceModel);
+
+    virtual QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    virtual QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+
+    virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    virtual QModelIndex parent(const QModelIndex &child) const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSTREEMODEL_H
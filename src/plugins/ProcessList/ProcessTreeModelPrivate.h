@@ -0,0 +1,83 @@
+/*!
+   \file ProcessTreeModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_PROCESSLIST_PROCESSTREEMODELPRIVATE_H
+#define PLUGINS_PROCESSLIST_PROCESSTREEMODELPRIVATE_H
+
+#include "ProcessTreeModel.h"
+
+#include <QVector>
+#include <QHash>
+#include <QPair>
+
+namespace Plugins {
+namespace ProcessList {
+
+class PROCESSLIST_EXPORT ProcessTreeModelPrivate : QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(ProcessTreeModel)
+    Q_DISABLE_COPY(ProcessTreeModelPrivate)
+
+public:
+    ProcessTreeModelPrivate();
+    ~ProcessTreeModelPrivate();
+
+    void rebuild();
+    void buildChildren();
+    void beginRelayout();
+    void endRelayout();
+    void structureAboutToChange();
+
+    int childRow(int node, int row) const { return m_Children.at(m_ChildOffsets.at(node) + row); }
+    int nodeForIndex(const QModelIndex &index) const;
+    int rootNode() const { return m_Parents.count(); }
+
+protected slots:
+    void sourceUpdateStarted();
+    void sourceUpdateFinished();
+    void sourceAboutToBeReset();
+    void sourceReset();
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    bool m_Updating;
+    bool m_RelayoutPending;
+
+    /* One node per source row; the node index is the source row, and the root is the node past the end */
+    QVector<int> m_Parents;
+    QVector<int> m_RowInParent;
+    QVector<int> m_ChildOffsets;
+    QVector<int> m_Children;
+    QHash<quint64, int> m_RowForPid;
+
+    QModelIndexList m_PersistentIndexes;
+    QList<QPair<quint64, int> > m_PersistentPids;
+};
+
+} // namespace ProcessList
+} // namespace Plugins
+
+#endif // PLUGINS_PROCESSLIST_PROCESSTREEMODELPRIVATE_H
@@ -31,17 +31,23 @@ namespace Plugins {
 namespace SourceView {
 
 class SourceView;
+struct LanguageDefinition;
 
 class SOURCEVIEW_EXPORT ISourceViewFactory
 {
 public:
     virtual SourceView *sourceViewWidget(const QString &text) = 0;
+    virtual SourceView *sourceViewWidgetForFile(const QString &fileName) = 0;
+    virtual SourceView *sourceViewWidgetForLocation(const QString &fileName, int lineNumber) = 0;
+    virtual bool registerLanguage(const LanguageDefinition &definition) = 0;
 };
 
 } // namespace SourceView
 } // namespace Plugins
 
 
-Q_DECLARE_INTERFACE(Plugins::SourceView::ISourceViewFactory, "org.krellinst.ptgf.ISourceViewFactory")
+/* Versioned with each method added, since plugins built before it don't implement it: 2.0 loads files, 3.0 opens
+   located sources, 4.0 registers languages */
+Q_DECLARE_INTERFACE(Plugins::SourceView::ISourceViewFactory, "org.krellinst.ptgf.ISourceViewFactory/4.0")
 
 #endif // PLUGINS_SOURCEVIEW_ISOURCEVIEWFACTORY_H
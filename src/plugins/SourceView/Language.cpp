@@ -0,0 +1,238 @@
+/*!
+   \file Language.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Language.h"
+
+#include <climits>
+#include <string.h>
+
+#include "LanguageRegistry.h"
+
+namespace Plugins {
+namespace SourceView {
+
+KeywordTable::KeywordTable() :
+    m_Mask(0),
+    m_MinLength(1),
+    m_MaxLength(0),
+    m_CaseInsensitive(false)
+{
+}
+
+/*! \internal
+    \brief Fills the table with \a words, each of the kind at the same index in \a kinds; a word listed twice keeps
+           its first kind.
+ */
+void KeywordTable::build(const QVector<QString> &words, const QVector<Kind> &kinds, bool caseInsensitive)
+{
+    m_CaseInsensitive = caseInsensitive;
+    m_MinLength = INT_MAX;
+    m_MaxLength = 0;
+
+    // At most a quarter full
+    int size = 64;
+    while(size < words.count() * 4) {
+        size *= 2;
+    }
+    m_Slots = QVector<Slot>(size);
+    m_Mask = size - 1;
+
+    for(int i = 0; i < words.count(); ++i) {
+        QString word = caseInsensitive ? words.at(i).toLower() : words.at(i);
+        int length = word.length();
+        if(!length || find(word.constData(), length) != Kind_None) {
+            continue;
+        }
+
+        uint slot = hash(word.at(0).unicode(), word.at(length - 1).unicode(), length) & m_Mask;
+        while(m_Slots.at(slot).length) {
+            slot = (slot + 1) & m_Mask;
+        }
+        m_Slots[slot].word = word;
+        m_Slots[slot].length = length;
+        m_Slots[slot].kind = kinds.at(i);
+
+        m_MinLength = qMin(m_MinLength, length);
+        m_MaxLength = qMax(m_MaxLength, length);
+    }
+}
+
+
+Language::Language(const LanguageDefinition &definition) :
+    name(definition.name),
+    escape(definition.escape.unicode()),
+    preprocessor(definition.preprocessor),
+    caseInsensitive(definition.caseSensitivity == Qt::CaseInsensitive)
+{
+    memset(m_Starts, 0, sizeof(m_Starts));
+
+    QVector<QString> words;
+    QVector<KeywordTable::Kind> kinds;
+    foreach(const QString &word, definition.keywords) {
+        words.append(word);
+        kinds.append(KeywordTable::Kind_Keyword);
+    }
+    foreach(const QString &word, definition.dataTypes) {
+        words.append(word);
+        kinds.append(KeywordTable::Kind_DataType);
+    }
+    foreach(const QString &word, definition.specials) {
+        words.append(word);
+        kinds.append(KeywordTable::Kind_Special);
+    }
+    keywords.build(words, kinds, caseInsensitive);
+
+    foreach(const QString &prefix, definition.specialPrefixes) {
+        if(!prefix.isEmpty()) {
+            specialPrefixes.append(caseInsensitive ? prefix.toLower() : prefix);
+        }
+    }
+
+    // Longer starts first, so that a triple quote isn't taken for a single one
+    QList<QPair<QString, QString> > delimiters = definition.blockComments + definition.blockQuotes;
+    for(int length = 8; length > 0; --length) {
+        for(int i = 0; i < delimiters.count(); ++i) {
+            const QPair<QString, QString> &delimiter = delimiters.at(i);
+            if(qMin(delimiter.first.length(), 8) != length || delimiter.second.isEmpty()) {
+                continue;
+            }
+            Block block;
+            block.start = delimiter.first;
+            block.end = delimiter.second;
+            block.quote = (i >= definition.blockComments.count());
+            blocks.append(block);
+            mark(block.start, Start_Block);
+        }
+    }
+
+    foreach(const QString &marker, definition.lineComments) {
+        if(!marker.isEmpty()) {
+            lineComments.append(marker);
+            mark(marker, Start_LineComment);
+        }
+    }
+
+    for(int i = 0; i < definition.quotes.length(); ++i) {
+        mark(definition.quotes.mid(i, 1), Start_Quote);
+    }
+
+    for(int i = 0; i < definition.columnOneComments.length(); ++i) {
+        mark(definition.columnOneComments.mid(i, 1), Start_ColumnOneComment);
+    }
+}
+
+/*! \internal
+    \brief Notes that a token starting with the first character of \a text may be a \a start; tokens must start with
+           an ASCII character.
+ */
+void Language::mark(const QString &text, uchar start)
+{
+    ushort c = text.at(0).unicode();
+    if(c < 0x80) {
+        m_Starts[c] |= start;
+    }
+}
+
+static inline bool startsWith(const QChar *data, int length, const QString &text)
+{
+    int count = text.length();
+    if(count > length) {
+        return false;
+    }
+    const QChar *other = text.constData();
+    for(int i = 0; i < count; ++i) {
+        if(data[i] != other[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! \internal
+    \brief Returns how many comments and quotes of \a definition may span lines, each of which becomes a Block.
+ */
+int Language::blockCount(const LanguageDefinition &definition)
+{
+    QList<QPair<QString, QString> > delimiters = definition.blockComments + definition.blockQuotes;
+    int count = 0;
+    for(int i = 0; i < delimiters.count(); ++i) {
+        if(!delimiters.at(i).first.isEmpty() && !delimiters.at(i).second.isEmpty()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/*! \internal
+    \brief Returns the index of the block starting at \a data, or -1 if none does.
+ */
+int Language::blockAt(const QChar *data, int length) const
+{
+    for(int i = 0; i < blocks.count(); ++i) {
+        if(startsWith(data, length, blocks.at(i).start)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool Language::lineCommentAt(const QChar *data, int length) const
+{
+    for(int i = 0; i < lineComments.count(); ++i) {
+        if(startsWith(data, length, lineComments.at(i))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*! \internal
+    \brief Whether \a word is longer than, and starts with, one of the special prefixes, such as "MPI_".
+ */
+bool Language::hasSpecialPrefix(const QChar *word, int length) const
+{
+    for(int i = 0; i < specialPrefixes.count(); ++i) {
+        const QString &prefix = specialPrefixes.at(i);
+        int count = prefix.length();
+        if(length <= count) {
+            continue;
+        }
+        int j = 0;
+        if(caseInsensitive) {
+            while(j < count && foldCase(word[j].unicode()) == prefix.at(j).unicode()) {
+                ++j;
+            }
+        } else {
+            while(j < count && word[j] == prefix.at(j)) {
+                ++j;
+            }
+        }
+        if(j == count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace SourceView
+} // namespace Plugins
@@ -0,0 +1,167 @@
+/*!
+   \file Language.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_LANGUAGE_H
+#define PLUGINS_SOURCEVIEW_LANGUAGE_H
+
+#include <QString>
+#include <QVector>
+
+namespace Plugins {
+namespace SourceView {
+
+struct LanguageDefinition;
+
+/* Folds ASCII letters to lower case, for the languages whose words aren't case sensitive */
+static inline ushort foldCase(ushort c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/* A language's keywords, data types and special words, looked up in an open-addressed table hashed on a word's
+   length and its first and last characters.  The table is sized when it's filled so that nearly every lookup is
+   settled by the first slot. */
+class KeywordTable
+{
+public:
+    enum Kind {
+        Kind_None = 0,
+        Kind_Keyword,
+        Kind_DataType,
+        Kind_Special
+    };
+
+    KeywordTable();
+
+    void build(const QVector<QString> &words, const QVector<Kind> &kinds, bool caseInsensitive);
+
+    inline Kind find(const QChar *word, int length) const
+    {
+        if(length < m_MinLength || length > m_MaxLength) {
+            return Kind_None;
+        }
+
+        ushort first = word[0].unicode();
+        ushort last = word[length - 1].unicode();
+        if(m_CaseInsensitive) {
+            first = foldCase(first);
+            last = foldCase(last);
+        }
+
+        const Slot *slots = m_Slots.constData();
+        for(uint slot = hash(first, last, length) & m_Mask; slots[slot].length; slot = (slot + 1) & m_Mask) {
+            const Slot &entry = slots[slot];
+            if(entry.length != length) {
+                continue;
+            }
+            const QChar *candidate = entry.word.constData();
+            int i = 0;
+            if(m_CaseInsensitive) {
+                while(i < length && foldCase(word[i].unicode()) == candidate[i].unicode()) {
+                    ++i;
+                }
+            } else {
+                while(i < length && word[i].unicode() == candidate[i].unicode()) {
+                    ++i;
+                }
+            }
+            if(i == length) {
+                return entry.kind;
+            }
+        }
+
+        return Kind_None;
+    }
+
+private:
+    struct Slot {
+        Slot() : length(0), kind(Kind_None) {}
+        QString word;
+        int length;
+        Kind kind;
+    };
+
+    static inline uint hash(ushort first, ushort last, int length)
+    {
+        return (uint)first * 31 + (uint)last * 7 + (uint)length * 131;
+    }
+
+    QVector<Slot> m_Slots;
+    uint m_Mask;
+    int m_MinLength;
+    int m_MaxLength;
+    bool m_CaseInsensitive;
+};
+
+/* A LanguageDefinition compiled into the tables SyntaxHighlighter tokenizes with: the keyword table, and for each
+   ASCII character, what a token starting with it might be */
+class Language
+{
+public:
+    explicit Language(const LanguageDefinition &definition);
+
+    enum Starts {
+        Start_Block = 0x1,
+        Start_LineComment = 0x2,
+        Start_Quote = 0x4,
+        Start_ColumnOneComment = 0x8
+    };
+
+    /* Comments or quotes that may span lines; a line's state holds which one it ends inside of, so a language may
+       have no more than MaxBlocks of them */
+    struct Block {
+        QString start;
+        QString end;
+        bool quote;
+    };
+    enum { MaxBlocks = 7 };
+    static int blockCount(const LanguageDefinition &definition);
+
+    inline uchar starts(ushort c) const
+    {
+        return (c < 0x80) ? m_Starts[c] : 0;
+    }
+
+    int blockAt(const QChar *data, int length) const;
+    bool lineCommentAt(const QChar *data, int length) const;
+    bool hasSpecialPrefix(const QChar *word, int length) const;
+
+    QString name;
+    KeywordTable keywords;
+    QVector<Block> blocks;
+    QVector<QString> lineComments;
+    QVector<QString> specialPrefixes;
+    ushort escape;
+    bool preprocessor;
+    bool caseInsensitive;
+
+private:
+    void mark(const QString &text, uchar start);
+
+    uchar m_Starts[0x80];
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_LANGUAGE_H
@@ -0,0 +1,315 @@
+/*!
+   \file LanguageRegistry.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "LanguageRegistry.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include "Language.h"
+
+namespace Plugins {
+namespace SourceView {
+
+/* The language of sources nothing else is found for */
+static const char *DefaultLanguage = "C++";
+
+static QStringList words(const char *list[])
+{
+    QStringList result;
+    for(int i = 0; list[i]; ++i) {
+        result.append(QLatin1String(list[i]));
+    }
+    return result;
+}
+
+static LanguageDefinition cppDefinition()
+{
+    static const char *suffixes[] = {
+        "c", "cc", "cpp", "cxx", "c++", "C", "h", "hh", "hpp", "hxx", "h++", "H", "inl", "tcc", "ipp", NULL
+    };
+    static const char *keywords[] = {
+        "asm", "break", "case", "catch", "class", "const_cast", "continue", "default", "delete", "do",
+        "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "friend", "for", "goto", "if",
+        "inline", "namespace", "new", "operator", "private", "protected", "public", "reinterpret_cast", "return",
+        "sizeof", "static_cast", "struct", "switch", "template", "this", "throw", "true", "try", "typedef",
+        "typeid", "type_info", "typename", "union", "using", "virtual", "while", "and", "and_eq", "bad_cast",
+        "bad_typeid", "bitand", "bitor", "compl", "not", "not_eq", "or", "or_eq", "xor", "xor_eq", NULL
+    };
+    static const char *dataTypes[] = {
+        "auto", "bool", "char", "const", "double", "float", "int", "long", "mutable", "register", "short",
+        "signed", "static", "unsigned", "void", "volatile", "uchar", "uint", "int8_t", "int16_t", "int32_t",
+        "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "wchar_t", NULL
+    };
+
+    LanguageDefinition definition;
+    definition.name = DefaultLanguage;
+    definition.suffixes = words(suffixes);
+    definition.keywords = words(keywords);
+    definition.dataTypes = words(dataTypes);
+    definition.specialPrefixes << "MPI_";
+    definition.lineComments << "//";
+    definition.blockComments << qMakePair(QString("/*"), QString("*/"));
+    definition.quotes = "\"'";
+    definition.escape = '\\';
+    definition.preprocessor = true;
+    return definition;
+}
+
+static LanguageDefinition fortranDefinition()
+{
+    static const char *suffixes[] = {
+        "f90", "f95", "f03", "f08", "F90", "F95", "F03", "F08", NULL
+    };
+    static const char *keywords[] = {
+        "program", "end", "module", "submodule", "contains", "use", "only", "implicit", "none", "subroutine",
+        "function", "result", "recursive", "pure", "elemental", "call", "return", "stop", "if", "then", "else",
+        "elseif", "endif", "do", "enddo", "while", "concurrent", "select", "case", "default", "where", "elsewhere",
+        "forall", "goto", "continue", "cycle", "exit", "allocate", "deallocate", "nullify", "interface", "type",
+        "class", "extends", "abstract", "procedure", "generic", "operator", "assignment", "associate", "block",
+        "intent", "in", "out", "inout", "parameter", "save", "common", "data", "equivalence", "namelist",
+        "external", "intrinsic", "public", "private", "optional", "pointer", "target", "allocatable", "dimension",
+        "sequence", "entry", "include", "print", "write", "read", "open", "close", "inquire", "format", "rewind",
+        "backspace", NULL
+    };
+    static const char *dataTypes[] = {
+        "integer", "real", "double", "precision", "complex", "logical", "character", NULL
+    };
+
+    LanguageDefinition definition;
+    definition.name = "Fortran";
+    definition.suffixes = words(suffixes);
+    definition.caseSensitivity = Qt::CaseInsensitive;
+    definition.keywords = words(keywords);
+    definition.dataTypes = words(dataTypes);
+    definition.specialPrefixes << "MPI_";
+    definition.lineComments << "!";
+    definition.quotes = "\"'";
+    definition.preprocessor = true;
+    return definition;
+}
+
+static LanguageDefinition fixedFormFortranDefinition()
+{
+    static const char *suffixes[] = {
+        "f", "for", "f77", "ftn", "F", "FOR", "F77", "FTN", NULL
+    };
+
+    LanguageDefinition definition = fortranDefinition();
+    definition.name = "Fortran (fixed form)";
+    definition.suffixes = words(suffixes);
+    definition.columnOneComments = "cC*";
+    return definition;
+}
+
+static LanguageDefinition pythonDefinition()
+{
+    static const char *suffixes[] = {
+        "py", "pyw", "pyi", NULL
+    };
+    static const char *keywords[] = {
+        "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class", "continue", "def",
+        "del", "elif", "else", "except", "exec", "finally", "for", "from", "global", "if", "import", "in", "is",
+        "lambda", "nonlocal", "not", "or", "pass", "print", "raise", "return", "try", "while", "with", "yield",
+        NULL
+    };
+    static const char *dataTypes[] = {
+        "bool", "bytearray", "bytes", "complex", "dict", "float", "frozenset", "int", "list", "object", "set",
+        "str", "tuple", NULL
+    };
+
+    LanguageDefinition definition;
+    definition.name = "Python";
+    definition.suffixes = words(suffixes);
+    definition.firstLinePatterns << "#!*python*";
+    definition.keywords = words(keywords);
+    definition.dataTypes = words(dataTypes);
+    definition.specials << "MPI";
+    definition.lineComments << "#";
+    definition.blockQuotes << qMakePair(QString("\"\"\""), QString("\"\"\""))
+                           << qMakePair(QString("'''"), QString("'''"));
+    definition.quotes = "\"'";
+    definition.escape = '\\';
+    return definition;
+}
+
+
+/*! \class Plugins::SourceView::LanguageDefinition
+    \brief Describes how to highlight a language, and which files are in it.
+
+    The \a suffixes pick the language for a file; those matching case-sensitively win over those that only match
+    ignoring case.  For a file none matches, the \a firstLinePatterns (wildcards, such as "#!*python*") are tried on
+    its first line.
+
+    Words in \a keywords, \a dataTypes and \a specials, and words longer than and starting with one of the
+    \a specialPrefixes (such as "MPI_"), are highlighted; \a caseSensitivity applies to all of them.  Comments run
+    from one of the \a lineComments to the end of the line, or span lines between the delimiters of
+    \a blockComments; \a blockQuotes are quotes that may span lines.  The \a quotes characters start quotes ending
+    at the same character, in which \a escape, if set, escapes the next character.  Lines starting with one of the
+    \a columnOneComments characters are comments, as in fixed-form Fortran.  With \a preprocessor, C preprocessor
+    directives and "#if 0" regions are highlighted.
+
+    Every delimiter must start with an ASCII character.
+    \sa LanguageRegistry
+ */
+LanguageDefinition::LanguageDefinition() :
+    caseSensitivity(Qt::CaseSensitive),
+    preprocessor(false)
+{
+}
+
+
+/*! \class Plugins::SourceView::LanguageRegistry
+    \brief The languages SyntaxHighlighter can highlight, and which files are in which.
+
+    C and C++, free and fixed-form Fortran, and Python are built in; plugins add languages with registerLanguage(),
+    or through ISourceViewFactory::registerLanguage().  Each definition is compiled into its keyword table and
+    tokenizer tables once, when it's registered, and shared by every highlighter of the language; so how long a line
+    takes to highlight doesn't depend on how many languages there are.
+    \sa LanguageDefinition
+ */
+
+LanguageRegistry::LanguageRegistry()
+{
+    registerLanguage(cppDefinition());
+    registerLanguage(fortranDefinition());
+    registerLanguage(fixedFormFortranDefinition());
+    registerLanguage(pythonDefinition());
+}
+
+LanguageRegistry::~LanguageRegistry()
+{
+    qDeleteAll(m_Languages);
+}
+
+LanguageRegistry &LanguageRegistry::instance()
+{
+    static LanguageRegistry *m_Instance = new LanguageRegistry();
+    return *m_Instance;
+}
+
+/*! \fn LanguageRegistry::registerLanguage()
+    \brief Compiles and adds the language of \a definition; returns false if a language by its name already is, or
+           if it has more than seven comments and quotes that may span lines, which is as many as a line's state
+           can tell apart.
+
+    The language's suffixes and first line patterns take over from those of the languages registered before it.
+ */
+bool LanguageRegistry::registerLanguage(const LanguageDefinition &definition)
+{
+    if(definition.name.isEmpty() || m_Names.contains(definition.name)) {
+        return false;
+    }
+
+    if(Language::blockCount(definition) > Language::MaxBlocks) {
+        return false;
+    }
+
+    int id = m_Languages.count();
+    m_Languages.append(new Language(definition));
+    m_Names.insert(definition.name, id);
+
+    foreach(const QString &suffix, definition.suffixes) {
+        m_Suffixes.insert(suffix, id);
+    }
+
+    foreach(const QString &pattern, definition.firstLinePatterns) {
+        m_FirstLinePatterns.prepend(qMakePair(QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard), id));
+    }
+
+    return true;
+}
+
+QStringList LanguageRegistry::languages() const
+{
+    QStringList names;
+    foreach(const Language *language, m_Languages) {
+        names.append(language->name);
+    }
+    return names;
+}
+
+bool LanguageRegistry::contains(const QString &name) const
+{
+    return m_Names.contains(name);
+}
+
+/*! \fn LanguageRegistry::defaultLanguage()
+    \brief The language of sources no other language is found for: C++.
+ */
+QString LanguageRegistry::defaultLanguage() const
+{
+    return DefaultLanguage;
+}
+
+/*! \fn LanguageRegistry::languageForFile()
+    \brief Returns the language of \a fileName, by its suffix, or failing that by its first line; or the default
+           language.
+ */
+QString LanguageRegistry::languageForFile(const QString &fileName) const
+{
+    QString suffix = QFileInfo(fileName).suffix();
+    int id = m_Suffixes.value(suffix, -1);
+    if(id < 0) {
+        id = m_Suffixes.value(suffix.toLower(), -1);
+    }
+    if(id >= 0) {
+        return m_Languages.at(id)->name;
+    }
+
+    QFile file(fileName);
+    if(!m_FirstLinePatterns.isEmpty() && file.open(QIODevice::ReadOnly)) {
+        QString language = languageForFirstLine(QString::fromUtf8(file.readLine(1024)));
+        if(!language.isEmpty()) {
+            return language;
+        }
+    }
+
+    return DefaultLanguage;
+}
+
+/*! \fn LanguageRegistry::languageForFirstLine()
+    \brief Returns the language whose first line patterns match \a line, such as a "#!" line; or an empty string.
+ */
+QString LanguageRegistry::languageForFirstLine(const QString &line) const
+{
+    QString trimmed = line.trimmed();
+    for(int i = 0; i < m_FirstLinePatterns.count(); ++i) {
+        if(m_FirstLinePatterns.at(i).first.exactMatch(trimmed)) {
+            return m_Languages.at(m_FirstLinePatterns.at(i).second)->name;
+        }
+    }
+    return QString();
+}
+
+/*! \internal
+    \brief The compiled language named \a name, or NULL; it lives as long as the registry.
+ */
+const Language *LanguageRegistry::language(const QString &name) const
+{
+    int id = m_Names.value(name, -1);
+    return (id < 0) ? NULL : m_Languages.at(id);
+}
+
+} // namespace SourceView
+} // namespace Plugins
@@ -0,0 +1,94 @@
+/*!
+   \file LanguageRegistry.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_LANGUAGEREGISTRY_H
+#define PLUGINS_SOURCEVIEW_LANGUAGEREGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QRegExp>
+#include <QStringList>
+
+#include "SourceViewLibrary.h"
+
+namespace Plugins {
+namespace SourceView {
+
+class Language;
+
+struct SOURCEVIEW_EXPORT LanguageDefinition
+{
+    LanguageDefinition();
+
+    QString name;
+    QStringList suffixes;
+    QStringList firstLinePatterns;
+    Qt::CaseSensitivity caseSensitivity;
+
+    QStringList keywords;
+    QStringList dataTypes;
+    QStringList specials;
+    QStringList specialPrefixes;
+
+    QStringList lineComments;
+    QString columnOneComments;
+    QList<QPair<QString, QString> > blockComments;
+    QList<QPair<QString, QString> > blockQuotes;
+    QString quotes;
+    QChar escape;
+    bool preprocessor;
+};
+
+class SOURCEVIEW_EXPORT LanguageRegistry
+{
+public:
+    static LanguageRegistry &instance();
+
+    bool registerLanguage(const LanguageDefinition &definition);
+    QStringList languages() const;
+    bool contains(const QString &name) const;
+
+    QString defaultLanguage() const;
+    QString languageForFile(const QString &fileName) const;
+    QString languageForFirstLine(const QString &line) const;
+
+    const Language *language(const QString &name) const;
+
+protected:
+    LanguageRegistry();
+    ~LanguageRegistry();
+
+private:
+    Q_DISABLE_COPY(LanguageRegistry)
+
+    QList<Language *> m_Languages;
+    QHash<QString, int> m_Names;
+    QHash<QString, int> m_Suffixes;
+    QList<QPair<QRegExp, int> > m_FirstLinePatterns;
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_LANGUAGEREGISTRY_H
@@ -0,0 +1,265 @@
+/*!
+   \file SourceDocumentCache.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SourceDocumentCache.h"
+
+#include <QFileInfo>
+#include <QPlainTextDocumentLayout>
+#include <QTextDocument>
+
+#include "SourceLoader.h"
+
+namespace Plugins {
+namespace SourceView {
+
+uint qHash(const SourceDocumentCache::Key &key)
+{
+    return qHash(key.path) ^ (uint)key.size ^ (uint)key.modified.toTime_t();
+}
+
+/*! \class Plugins::SourceView::SourceDocumentCache
+    \brief Shares the documents of source files between the SourceViews showing them, and keeps recently shown ones
+           around so that showing them again is immediate.
+
+    A document is looked up by the file's canonical path, modification time and size, so a file that changed on disk
+    gets a new document.  The text, layout and highlighting of a shared document are those of every view showing it;
+    views show cached documents read-only.
+
+    The file is loaded into a new document in the background, once for every view sharing it: a view opening it while
+    it's still loading waits for the same load, which keeps going for as long as any view shows the document.
+    loadFinished() is emitted once the whole file is in the document.  A document no view shows any more before it
+    finished loading is let go, rather than kept incomplete.
+
+    Documents no view shows any more are kept, most recently used first, while the memory all the documents use stays
+    within memoryBudget(); beyond that, the least recently used are let go.
+    \sa SourceView::openFile()
+ */
+
+SourceDocumentCache::SourceDocumentCache(QObject *parent) :
+    QObject(parent),
+    m_MemoryBudget(256 * 1024 * 1024),
+    m_MemoryUsage(0)
+{
+}
+
+SourceDocumentCache::~SourceDocumentCache()
+{
+    m_Loaders.clear();
+    foreach(Entry *entry, m_Documents) {
+        delete entry->loader;
+        delete entry;
+    }
+}
+
+SourceDocumentCache &SourceDocumentCache::instance()
+{
+    static SourceDocumentCache *m_Instance = new SourceDocumentCache();
+    return *m_Instance;
+}
+
+/*! \fn SourceDocumentCache::acquire()
+    \brief Returns the document for the current version of \a fileName, to be given back with release() once it's no
+           longer shown; or NULL if the file doesn't exist or can't be read.
+
+    If the document wasn't cached, the file starts loading into it; isLoading() tells whether it still is.
+ */
+QTextDocument *SourceDocumentCache::acquire(const QString &fileName)
+{
+    QFileInfo fileInfo(fileName);
+    if(!fileInfo.exists()) {
+        return NULL;
+    }
+
+    Key key;
+    key.path = fileInfo.canonicalFilePath();
+    key.modified = fileInfo.lastModified();
+    key.size = fileInfo.size();
+
+    Entry *entry = m_Entries.value(key);
+    if(!entry) {
+        QTextDocument *document = new QTextDocument(this);
+        document->setDocumentLayout(new QPlainTextDocumentLayout(document));
+
+        SourceLoader *loader = new SourceLoader(this);
+        if(!loader->start(fileName, document)) {
+            delete loader;
+            delete document;
+            return NULL;
+        }
+        connect(loader, SIGNAL(finished()), this, SLOT(loaderFinished()));
+
+        entry = new Entry;
+        entry->key = key;
+        entry->document = document;
+        entry->loader = loader;
+        entry->loadState = LoadState_Loading;
+        entry->references = 0;
+        entry->memoryUsage = 0;
+        m_Entries.insert(key, entry);
+        m_Documents.insert(document, entry);
+        m_Loaders.insert(loader, entry);
+    }
+
+    if(entry->references++ == 0) {
+        m_Unused.removeOne(entry);
+    }
+
+    return entry->document;
+}
+
+/*! \fn SourceDocumentCache::release()
+    \brief Gives back a \a document from acquire(); one that hasn't finished loading is dropped from the cache once no
+           view shows it.
+ */
+void SourceDocumentCache::release(QTextDocument *document)
+{
+    Entry *entry = m_Documents.value(document);
+    if(!entry) {
+        return;
+    }
+
+    // The text, plus a rough allowance for the layout and formats of each line
+    m_MemoryUsage -= entry->memoryUsage;
+    entry->memoryUsage = (qint64)document->characterCount() * sizeof(QChar) + (qint64)document->blockCount() * 256;
+    m_MemoryUsage += entry->memoryUsage;
+
+    if(--entry->references > 0) {
+        return;
+    }
+
+    if(entry->loadState != LoadState_Finished) {
+        remove(entry);
+        return;
+    }
+
+    m_Unused.prepend(entry);
+    evict();
+}
+
+/*! \fn SourceDocumentCache::isLoading()
+    \brief Whether the file of \a document is still being loaded into it.
+ */
+bool SourceDocumentCache::isLoading(QTextDocument *document) const
+{
+    Entry *entry = m_Documents.value(document);
+    return entry && entry->loadState == LoadState_Loading;
+}
+
+/*! \fn SourceDocumentCache::waitForLine()
+    \brief Blocks until line \a lineNumber (counting from one) is in \a document, or the whole file is.
+ */
+void SourceDocumentCache::waitForLine(QTextDocument *document, int lineNumber)
+{
+    Entry *entry = m_Documents.value(document);
+    if(entry && entry->loader) {
+        entry->loader->waitForLine(lineNumber);
+    }
+}
+
+/*! \fn SourceDocumentCache::memoryBudget()
+    \brief The memory the cached documents may use before those no view shows are let go, least recently used first;
+           256 MB by default.
+ */
+qint64 SourceDocumentCache::memoryBudget() const
+{
+    return m_MemoryBudget;
+}
+
+void SourceDocumentCache::setMemoryBudget(qint64 bytes)
+{
+    m_MemoryBudget = bytes;
+    evict();
+}
+
+/*! \fn SourceDocumentCache::memoryUsage()
+    \brief An estimate of the memory used by the cached documents, as of when they were last released.
+ */
+qint64 SourceDocumentCache::memoryUsage() const
+{
+    return m_MemoryUsage;
+}
+
+int SourceDocumentCache::count() const
+{
+    return m_Documents.count();
+}
+
+/*! \fn SourceDocumentCache::clear()
+    \brief Lets go of every document no view shows.
+ */
+void SourceDocumentCache::clear()
+{
+    while(!m_Unused.isEmpty()) {
+        remove(m_Unused.takeLast());
+    }
+}
+
+/*! \internal
+    \brief Lets go of the least recently used documents no view shows, until the rest fit in the budget.
+ */
+void SourceDocumentCache::evict()
+{
+    while(m_MemoryUsage > m_MemoryBudget && !m_Unused.isEmpty()) {
+        remove(m_Unused.takeLast());
+    }
+}
+
+/*! \internal
+    \brief Drops \a entry and deletes its document, stopping its load; views may still be letting go of it, so it's
+           deleted later.
+ */
+void SourceDocumentCache::remove(Entry *entry)
+{
+    m_Entries.remove(entry->key);
+    m_Documents.remove(entry->document);
+    m_MemoryUsage -= entry->memoryUsage;
+
+    if(entry->loader) {
+        m_Loaders.remove(entry->loader);
+        delete entry->loader;
+    }
+
+    entry->document->deleteLater();
+    delete entry;
+}
+
+/*! \internal
+    \brief Marks the document of the loader that finished as loaded, for every view sharing it, and lets the loader go.
+ */
+void SourceDocumentCache::loaderFinished()
+{
+    SourceLoader *loader = qobject_cast<SourceLoader *>(sender());
+    Entry *entry = m_Loaders.take(loader);
+    if(!entry) {
+        return;
+    }
+
+    entry->loader = NULL;
+    entry->loadState = LoadState_Finished;
+    loader->deleteLater();
+
+    emit loadFinished(entry->document);
+}
+
+} // namespace SourceView
+} // namespace Plugins
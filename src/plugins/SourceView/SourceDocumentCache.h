@@ -0,0 +1,115 @@
+/*!
+   \file SourceDocumentCache.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_SOURCEDOCUMENTCACHE_H
+#define PLUGINS_SOURCEVIEW_SOURCEDOCUMENTCACHE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+
+#include "SourceViewLibrary.h"
+
+class QTextDocument;
+
+namespace Plugins {
+namespace SourceView {
+
+class SourceLoader;
+
+class SOURCEVIEW_EXPORT SourceDocumentCache : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SourceDocumentCache)
+
+public:
+    static SourceDocumentCache &instance();
+
+    QTextDocument *acquire(const QString &fileName);
+    void release(QTextDocument *document);
+
+    bool isLoading(QTextDocument *document) const;
+    void waitForLine(QTextDocument *document, int lineNumber);
+
+    qint64 memoryBudget() const;
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryUsage() const;
+
+    int count() const;
+    void clear();
+
+signals:
+    void loadFinished(QTextDocument *document);
+
+protected slots:
+    void loaderFinished();
+
+protected:
+    explicit SourceDocumentCache(QObject *parent = 0);
+    ~SourceDocumentCache();
+
+    /* What identifies a version of a file: its canonical path, modification time and size */
+    struct Key {
+        QString path;
+        QDateTime modified;
+        qint64 size;
+        bool operator==(const Key &other) const
+        {
+            return size == other.size && modified == other.modified && path == other.path;
+        }
+    };
+    friend uint qHash(const Key &key);
+
+    /* Whether a document's file has been read yet; every view sharing it waits for the same load.  A file that can't
+       be read gets no entry at all */
+    enum LoadState {
+        LoadState_Loading,
+        LoadState_Finished
+    };
+
+    struct Entry {
+        Key key;
+        QTextDocument *document;
+        SourceLoader *loader;
+        LoadState loadState;
+        int references;
+        qint64 memoryUsage;
+    };
+
+    Entry *entry(QTextDocument *document) const;
+    void evict();
+    void remove(Entry *entry);
+
+    QHash<Key, Entry *> m_Entries;
+    QHash<QTextDocument *, Entry *> m_Documents;
+    QHash<SourceLoader *, Entry *> m_Loaders;
+    QList<Entry *> m_Unused;
+    qint64 m_MemoryBudget;
+    qint64 m_MemoryUsage;
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_SOURCEDOCUMENTCACHE_H
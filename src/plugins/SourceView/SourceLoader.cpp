@@ -0,0 +1,253 @@
+/*!
+   \file SourceLoader.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SourceLoader.h"
+
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QtConcurrentRun>
+
+#include <string.h>
+
+namespace Plugins {
+namespace SourceView {
+
+/*! \class Plugins::SourceView::SourceLoader
+    \internal
+    \brief Loads a file into a document without holding up the user interface.
+
+    The file is memory-mapped, and decoded from UTF-8 on a worker thread in chunks of about a megabyte that end on
+    line breaks.  Decoded chunks are appended to the document in batches from a timer, so the first lines can be read
+    and scrolled while the rest are still loading.  waitForLine() appends chunks as soon as they're decoded,
+    up to the one holding the line asked for.
+ */
+
+SourceLoader::SourceLoader(QObject *parent) :
+    QObject(parent),
+    m_Document(NULL),
+    m_Loading(false),
+    m_UndoRedoEnabled(true),
+    m_Data(NULL),
+    m_Size(0),
+    m_Decoded(false)
+{
+    m_PollTimer.setInterval(PollInterval);
+    connect(&m_PollTimer, SIGNAL(timeout()), this, SLOT(appendChunks()));
+}
+
+SourceLoader::~SourceLoader()
+{
+    cancel();
+}
+
+/*! \fn SourceLoader::start()
+    \brief Empties \a document and starts loading \a fileName into it; returns false if the file can't be read.
+ */
+bool SourceLoader::start(const QString &fileName, QTextDocument *document)
+{
+    cancel();
+
+    m_ErrorString.clear();
+    m_File.setFileName(fileName);
+    if(!m_File.open(QIODevice::ReadOnly)) {
+        m_ErrorString = m_File.errorString();
+        return false;
+    }
+
+    m_Size = m_File.size();
+    m_Data = (m_Size > 0) ? (const char *)m_File.map(0, m_Size) : NULL;
+    if(!m_Data) {
+        // Not every file can be mapped, such as those that aren't regular files
+        m_Buffer = m_File.readAll();
+        m_Data = m_Buffer.constData();
+        m_Size = m_Buffer.size();
+    }
+
+    m_Cancelled.fetchAndStoreOrdered(0);
+    m_Chunks.clear();
+    m_Decoded = false;
+
+    // The undo stack would keep a second copy of everything appended
+    m_Document = document;
+    m_UndoRedoEnabled = m_Document->isUndoRedoEnabled();
+    m_Document->setUndoRedoEnabled(false);
+    m_Document->clear();
+
+    m_Loading = true;
+    m_PollTimer.start();
+    m_Future = QtConcurrent::run(&SourceLoader::decode, this);
+    return true;
+}
+
+/*! \fn SourceLoader::cancel()
+    \brief Stops loading, leaving the lines loaded so far in the document.
+ */
+void SourceLoader::cancel()
+{
+    if(!m_Loading) {
+        return;
+    }
+
+    m_Cancelled.fetchAndStoreOrdered(1);
+    m_Future.waitForFinished();
+    end();
+}
+
+bool SourceLoader::isLoading() const
+{
+    return m_Loading;
+}
+
+QString SourceLoader::errorString() const
+{
+    return m_ErrorString;
+}
+
+/*! \fn SourceLoader::waitForLine()
+    \brief Blocks until line \a lineNumber (counting from one) is in the document, or the whole file is.
+ */
+void SourceLoader::waitForLine(int lineNumber)
+{
+    // Chunks end on line breaks, so a line is whole once a later one has started
+    while(m_Loading && m_Document->blockCount() <= lineNumber) {
+        QString text;
+        bool more = false;
+        if(takeChunks(text, true, more)) {
+            append(text);
+        }
+        if(!more) {
+            end();
+        }
+    }
+}
+
+/*! \internal
+    \brief Appends a batch of the chunks decoded since the last time, and finishes once every chunk has been.
+ */
+void SourceLoader::appendChunks()
+{
+    QString text;
+    bool more = false;
+    if(takeChunks(text, false, more)) {
+        append(text);
+    }
+    if(!more) {
+        end();
+    }
+}
+
+/*! \internal
+    \brief Takes up to a batch of decoded chunks into \a text, waiting for one if \a wait is set; returns false when
+           there were none.  \a more is set if chunks are left, or still to be decoded.
+ */
+bool SourceLoader::takeChunks(QString &text, bool wait, bool &more)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    while(wait && m_Chunks.isEmpty() && !m_Decoded) {
+        m_ChunkDecoded.wait(&m_Mutex);
+    }
+
+    int count = qMin(m_Chunks.count(), (int)BatchChunks);
+    for(int i = 0; i < count; ++i) {
+        text += m_Chunks.takeFirst();
+    }
+
+    more = !m_Chunks.isEmpty() || !m_Decoded;
+    return count > 0;
+}
+
+/*! \internal
+    \brief Appends \a text to the end of the document, keeping the views of it where they are.
+ */
+void SourceLoader::append(const QString &text)
+{
+    QTextCursor cursor(m_Document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+}
+
+/*! \internal
+    \brief Finishes loading, letting go of the file.
+ */
+void SourceLoader::end()
+{
+    if(!m_Loading) {
+        return;
+    }
+
+    m_Loading = false;
+    m_PollTimer.stop();
+
+    m_Chunks.clear();
+    m_Data = NULL;
+    m_Size = 0;
+    m_Buffer.clear();
+    m_File.close();
+
+    m_Document->setUndoRedoEnabled(m_UndoRedoEnabled);
+    m_Document = NULL;
+
+    emit finished();
+}
+
+/*! \internal
+    \brief Runs on a worker thread, decoding the file a chunk at a time.
+ */
+void SourceLoader::decode(SourceLoader *loader)
+{
+    const char *data = loader->m_Data;
+    qint64 size = loader->m_Size;
+    qint64 offset = 0;
+
+    // Skip a UTF-8 byte order mark
+    if(size >= 3 && (uchar)data[0] == 0xef && (uchar)data[1] == 0xbb && (uchar)data[2] == 0xbf) {
+        offset = 3;
+    }
+
+#if QT_VERSION >= 0x050000
+    while(offset < size && !loader->m_Cancelled.load()) {
+#else
+    while(offset < size && !(int)loader->m_Cancelled) {
+#endif
+        qint64 end = qMin(offset + (qint64)ChunkSize, size);
+        if(end < size) {
+            const char *lineEnd = (const char *)memchr(data + end, '\n', (size_t)(size - end));
+            end = lineEnd ? (lineEnd - data) + 1 : size;
+        }
+
+        QString chunk = QString::fromUtf8(data + offset, (int)(end - offset));
+        offset = end;
+
+        QMutexLocker locker(&loader->m_Mutex);
+        loader->m_Chunks.append(chunk);
+        loader->m_ChunkDecoded.wakeAll();
+    }
+
+    QMutexLocker locker(&loader->m_Mutex);
+    loader->m_Decoded = true;
+    loader->m_ChunkDecoded.wakeAll();
+}
+
+} // namespace SourceView
+} // namespace Plugins
@@ -0,0 +1,99 @@
+/*!
+   \file SourceLoader.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_SOURCELOADER_H
+#define PLUGINS_SOURCEVIEW_SOURCELOADER_H
+
+#include <QObject>
+#include <QFile>
+#include <QFuture>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QStringList>
+#include <QTimer>
+#include <QAtomicInt>
+
+class QTextDocument;
+
+namespace Plugins {
+namespace SourceView {
+
+class SourceLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SourceLoader(QObject *parent = 0);
+    ~SourceLoader();
+
+    bool start(const QString &fileName, QTextDocument *document);
+    void cancel();
+
+    bool isLoading() const;
+    QString errorString() const;
+
+    void waitForLine(int lineNumber);
+
+signals:
+    void finished();
+
+protected slots:
+    void appendChunks();
+
+private:
+    bool takeChunks(QString &text, bool wait, bool &more);
+    void append(const QString &text);
+    void end();
+
+    static void decode(SourceLoader *loader);
+
+    QTextDocument *m_Document;
+    bool m_Loading;
+    bool m_UndoRedoEnabled;
+    QString m_ErrorString;
+    QTimer m_PollTimer;
+
+    QFile m_File;
+    QByteArray m_Buffer;
+    const char *m_Data;
+    qint64 m_Size;
+
+    QFuture<void> m_Future;
+    QAtomicInt m_Cancelled;
+    QMutex m_Mutex;
+    QWaitCondition m_ChunkDecoded;
+    QStringList m_Chunks;
+    bool m_Decoded;
+
+    /* The size of the chunks the file is decoded in, in bytes; how often decoded chunks are appended, in
+       milliseconds; and how many are appended at a time, to keep the view responsive */
+    enum {
+        ChunkSize = 1024 * 1024,
+        PollInterval = 50,
+        BatchChunks = 8
+    };
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_SOURCELOADER_H
@@ -0,0 +1,631 @@
+/*!
+   \file SourceLocator.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SourceLocator.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <string.h>
+
+namespace Plugins {
+namespace SourceView {
+
+/* Identifies an index file, and the version of its layout */
+static const quint32 IndexMagic = 0x50534c58;
+static const quint32 IndexVersion = 2;
+
+/* Orders posting lists by length */
+struct PostingLess
+{
+    bool operator()(const QVector<int> &a, const QVector<int> &b) const { return a.count() < b.count(); }
+};
+
+/*! \class Plugins::SourceView::SourceLocator
+    \brief Finds source files under a set of root directories, by the paths they were built from and by their
+           content.
+
+    Performance data names source files by the paths they had where they were built, which often don't exist where
+    the data is looked at.  The locator crawls its roots() on a worker thread, indexing every file by name, and every
+    text file by the three-byte sequences (trigrams) in its lines; locate() then finds the file whose path ends the
+    most like a given one, and search() reads only the files holding every trigram of the text searched for.  Only
+    the list of files holding each trigram is kept, not the trigrams of each file.
+
+    The index is kept in indexFileName(), and is loaded from it on the first refresh(), so the locator is usable
+    right away.  Refreshing reads again only the files whose modification time or size changed since they were
+    indexed.
+ */
+
+SourceLocator::SourceLocator(QObject *parent) :
+    QObject(parent),
+    m_Index(NULL),
+    m_Indexing(false),
+    m_Refresh(false)
+{
+    connect(&m_LoadWatcher, SIGNAL(finished()), this, SLOT(loaded()));
+    connect(&m_BuildWatcher, SIGNAL(finished()), this, SLOT(built()));
+}
+
+SourceLocator::~SourceLocator()
+{
+    cancel();
+    delete m_Index;
+}
+
+SourceLocator &SourceLocator::instance()
+{
+    static SourceLocator *m_Instance = new SourceLocator();
+    return *m_Instance;
+}
+
+/*! \fn SourceLocator::roots()
+    \brief The directories searched, with everything below them except hidden files and directories.
+ */
+QStringList SourceLocator::roots() const
+{
+    return m_Roots;
+}
+
+void SourceLocator::setRoots(const QStringList &roots)
+{
+    m_Roots.clear();
+    foreach(const QString &root, roots) {
+        QString path = QDir::cleanPath(QDir(root).absolutePath());
+        if(!m_Roots.contains(path)) {
+            m_Roots.append(path);
+        }
+    }
+
+    refresh();
+}
+
+/*! \fn SourceLocator::indexFileName()
+    \brief Where the index is kept between sessions; if empty, it isn't kept.
+ */
+QString SourceLocator::indexFileName() const
+{
+    return m_IndexFileName;
+}
+
+void SourceLocator::setIndexFileName(const QString &fileName)
+{
+    m_IndexFileName = fileName;
+}
+
+/*! \fn SourceLocator::isIndexing()
+    \brief Whether the index is being loaded or refreshed; until it is, lookups use the index as it was.
+ */
+bool SourceLocator::isIndexing() const
+{
+    return m_Indexing;
+}
+
+/*! \fn SourceLocator::waitForIndex()
+    \brief Blocks until the index is loaded and refreshed.
+ */
+void SourceLocator::waitForIndex()
+{
+    while(m_Indexing) {
+        m_LoadWatcher.waitForFinished();
+        m_BuildWatcher.waitForFinished();
+        QCoreApplication::sendPostedEvents(&m_LoadWatcher, 0);
+        QCoreApplication::sendPostedEvents(&m_BuildWatcher, 0);
+    }
+}
+
+int SourceLocator::fileCount() const
+{
+    return m_Index ? m_Index->files.count() : 0;
+}
+
+/*! \fn SourceLocator::locate()
+    \brief Returns the indexed file with the same name as \a fileName whose path ends with the most of the same
+           directories; or \a fileName itself if it exists, and an empty string if nothing matches.
+ */
+QString SourceLocator::locate(const QString &fileName) const
+{
+    if(QFileInfo(fileName).isFile()) {
+        return fileName;
+    }
+
+    if(!m_Index) {
+        return QString();
+    }
+
+    QString path = QDir::fromNativeSeparators(fileName);
+    QString name = path.mid(path.lastIndexOf('/') + 1);
+
+    int best = -1;
+    int bestScore = -1;
+    foreach(int id, m_Index->names.value(name)) {
+        const QString &candidate = m_Index->files.at(id).path;
+
+        // Count the path components both end with
+        int a = path.length();
+        int b = candidate.length();
+        int score = 0;
+        while(a > 0 && b > 0 && path.at(a - 1) == candidate.at(b - 1)) {
+            --a;
+            --b;
+            if(path.at(a) == '/') {
+                ++score;
+            }
+        }
+        if(a == 0 || b == 0) {
+            ++score;
+        }
+
+        if(score > bestScore) {
+            best = id;
+            bestScore = score;
+        }
+    }
+
+    return (best < 0) ? QString() : m_Index->files.at(best).path;
+}
+
+/*! \fn SourceLocator::search()
+    \brief Returns up to \a maxMatches lines holding \a text, in the indexed text files, like grep -F.
+
+    Only the files holding every trigram of \a text are read, so a search costs about as much as reading the files
+    that might match.  Files changed since they were last indexed may be missed until the next refresh().
+ */
+QList<SourceLocator::Match> SourceLocator::search(const QString &text, Qt::CaseSensitivity cs, int maxMatches) const
+{
+    QList<Match> matches;
+    if(!m_Index || text.isEmpty()) {
+        return matches;
+    }
+
+    // Trigrams are indexed folded to ASCII lower case; other bytes differ between cases
+    QByteArray query = text.toUtf8();
+    QVector<quint32> wanted = trigrams(query.constData(), query.size());
+    if(cs == Qt::CaseInsensitive) {
+        QVector<quint32> ascii;
+        foreach(quint32 trigram, wanted) {
+            if(!(trigram & 0x808080)) {
+                ascii.append(trigram);
+            }
+        }
+        wanted = ascii;
+    }
+
+    QVector<int> candidates;
+    if(wanted.isEmpty()) {
+        candidates.reserve(m_Index->files.count());
+        for(int id = 0; id < m_Index->files.count(); ++id) {
+            candidates.append(id);
+        }
+    } else {
+        // Intersect the posting lists, shortest first
+        QList<QVector<int> > postings;
+        foreach(quint32 trigram, wanted) {
+            QVector<int> posting = m_Index->postings.value(trigram);
+            if(posting.isEmpty()) {
+                return matches;
+            }
+            postings.append(posting);
+        }
+        std::sort(postings.begin(), postings.end(), PostingLess());
+
+        candidates = postings.first();
+        for(int i = 1; i < postings.count() && !candidates.isEmpty(); ++i) {
+            const QVector<int> &posting = postings.at(i);
+            QVector<int> intersection(candidates.count());
+            QVector<int>::iterator end = std::set_intersection(candidates.constBegin(), candidates.constEnd(),
+                                                               posting.constBegin(), posting.constEnd(),
+                                                               intersection.begin());
+            intersection.resize(end - intersection.begin());
+            candidates = intersection;
+        }
+    }
+
+    // Candidates are read a line at a time, of no more than the largest file searched; an exact search compares the
+    // UTF-8, and decodes only the lines matching
+    foreach(int id, candidates) {
+        const File &file = m_Index->files.at(id);
+        if(!file.text) {
+            continue;
+        }
+
+        QFile source(file.path);
+        if(!source.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        int lineNumber = 0;
+        while(!source.atEnd()) {
+            QByteArray bytes = source.readLine(MaxIndexedSize);
+            ++lineNumber;
+
+            if(cs == Qt::CaseSensitive ? !bytes.contains(query) : !QString::fromUtf8(bytes).contains(text, cs)) {
+                continue;
+            }
+
+            if(bytes.endsWith('\n')) {
+                bytes.chop(1);
+            }
+            if(bytes.endsWith('\r')) {
+                bytes.chop(1);
+            }
+
+            Match match;
+            match.fileName = file.path;
+            match.lineNumber = lineNumber;
+            match.line = QString::fromUtf8(bytes);
+            matches.append(match);
+
+            if(matches.count() >= maxMatches) {
+                return matches;
+            }
+        }
+    }
+
+    return matches;
+}
+
+/*! \fn SourceLocator::refresh()
+    \brief Brings the index up to date with the roots in the background, first loading it from indexFileName() if
+           it hasn't been; indexUpdated() is emitted each time a new index is in use.
+ */
+void SourceLocator::refresh()
+{
+    if(m_Indexing) {
+        m_Refresh = true;
+        return;
+    }
+
+    m_Cancelled.fetchAndStoreOrdered(0);
+    m_Indexing = true;
+
+    if(!m_Index && !m_IndexFileName.isEmpty() && QFile::exists(m_IndexFileName)) {
+        m_LoadWatcher.setFuture(QtConcurrent::run(&SourceLocator::load, this, m_IndexFileName));
+    } else {
+        startBuild();
+    }
+}
+
+/*! \fn SourceLocator::cancel()
+    \brief Stops loading or refreshing the index, keeping the one in use.
+ */
+void SourceLocator::cancel()
+{
+    if(!m_Indexing) {
+        return;
+    }
+
+    m_Cancelled.fetchAndStoreOrdered(1);
+    m_Refresh = false;
+    waitForIndex();
+}
+
+/*! \internal
+    \brief Whether cancel() was called; checked by the worker as it goes.
+ */
+bool SourceLocator::cancelled() const
+{
+#if QT_VERSION >= 0x050000
+    return m_Cancelled.load();
+#else
+    return (int)m_Cancelled;
+#endif
+}
+
+/*! \internal
+    \brief Starts crawling the roots, reusing what the index in use knows of unchanged files.
+ */
+void SourceLocator::startBuild()
+{
+    m_BuildWatcher.setFuture(QtConcurrent::run(&SourceLocator::build, this, m_Roots, (const Index *)m_Index,
+                                               m_IndexFileName));
+}
+
+/*! \internal
+    \brief Uses the index loaded from disk, if it could be, until the refresh it's followed by is done.
+ */
+void SourceLocator::loaded()
+{
+    Index *index = m_LoadWatcher.result();
+    if(index) {
+        delete m_Index;
+        m_Index = index;
+        emit indexUpdated();
+    }
+
+    if(cancelled()) {
+        m_Indexing = false;
+    } else {
+        startBuild();
+    }
+}
+
+/*! \internal
+    \brief Uses the refreshed index, and refreshes again if asked to meanwhile.
+ */
+void SourceLocator::built()
+{
+    Index *index = m_BuildWatcher.result();
+    m_Indexing = false;
+
+    if(index) {
+        delete m_Index;
+        m_Index = index;
+        emit indexUpdated();
+    }
+
+    if(m_Refresh) {
+        m_Refresh = false;
+        refresh();
+    }
+}
+
+/*! \internal
+    \brief Runs on a worker thread, reading an index written by save(); returns NULL if it can't be read.
+ */
+SourceLocator::Index *SourceLocator::load(SourceLocator *locator, QString fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return NULL;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic;
+    quint32 version;
+    qint32 count;
+    stream >> magic >> version;
+    if(magic != IndexMagic || version != IndexVersion) {
+        return NULL;
+    }
+
+    Index *index = new Index;
+    stream >> index->roots >> count;
+    index->files.resize(qMax(0, count));
+    for(int i = 0; i < index->files.count(); ++i) {
+        if((i & 0xff) == 0 && locator->cancelled()) {
+            delete index;
+            return NULL;
+        }
+
+        File &entry = index->files[i];
+        stream >> entry.path >> entry.modified >> entry.size >> entry.text;
+    }
+    stream >> index->postings;
+
+    if(stream.status() != QDataStream::Ok) {
+        delete index;
+        return NULL;
+    }
+
+    buildNames(index);
+    return index;
+}
+
+/*! \internal
+    \brief Runs on a worker thread, crawling \a roots into a new index, which is saved to \a fileName; returns NULL if
+           cancelled.  Files \a previous knows with the same modification time and size aren't read again; their
+           entries in its posting lists are carried over instead.
+ */
+SourceLocator::Index *SourceLocator::build(SourceLocator *locator, QStringList roots, const Index *previous,
+                                           QString fileName)
+{
+    QHash<QString, int> known;
+    if(previous) {
+        known.reserve(previous->files.count());
+        for(int i = 0; i < previous->files.count(); ++i) {
+            known.insert(previous->files.at(i).path, i);
+        }
+    }
+
+    Index *index = new Index;
+    index->roots = roots;
+
+    // The id each file of the previous index has in the new one, if it's unchanged
+    QVector<int> unchanged(previous ? previous->files.count() : 0, -1);
+
+    QSet<QString> seen;
+    foreach(const QString &root, roots) {
+        QDirIterator iterator(root, QDir::Files, QDirIterator::Subdirectories);
+        while(iterator.hasNext()) {
+            if((index->files.count() & 0xff) == 0 && locator->cancelled()) {
+                delete index;
+                return NULL;
+            }
+
+            QString path = iterator.next();
+            if(roots.count() > 1) {
+                // Roots may nest
+                if(seen.contains(path)) {
+                    continue;
+                }
+                seen.insert(path);
+            }
+
+            QFileInfo info = iterator.fileInfo();
+            File file;
+            file.path = path;
+            file.modified = info.lastModified().toTime_t();
+            file.size = info.size();
+
+            int id = known.value(path, -1);
+            if(id >= 0 && previous->files.at(id).modified == file.modified && previous->files.at(id).size == file.size) {
+                file.text = previous->files.at(id).text;
+                unchanged[id] = index->files.count();
+            } else {
+                foreach(quint32 trigram, indexFile(file)) {
+                    index->postings[trigram].append(index->files.count());
+                }
+            }
+
+            index->files.append(file);
+        }
+    }
+
+    if(previous) {
+        QHash<quint32, QVector<int> >::const_iterator i;
+        for(i = previous->postings.constBegin(); i != previous->postings.constEnd(); ++i) {
+            if(locator->cancelled()) {
+                delete index;
+                return NULL;
+            }
+
+            QVector<int> posting;
+            foreach(int id, i.value()) {
+                if(unchanged.at(id) >= 0) {
+                    posting.append(unchanged.at(id));
+                }
+            }
+            if(!posting.isEmpty()) {
+                index->postings[i.key()] += posting;
+            }
+        }
+    }
+
+    // Searches intersect the posting lists, which need to be in order
+    QHash<quint32, QVector<int> >::iterator i;
+    for(i = index->postings.begin(); i != index->postings.end(); ++i) {
+        std::sort(i.value().begin(), i.value().end());
+        i.value().squeeze();
+    }
+
+    buildNames(index);
+
+    if(!fileName.isEmpty()) {
+        save(index, fileName);
+    }
+
+    return index;
+}
+
+/*! \internal
+    \brief Writes \a index to \a fileName, through a temporary file so that a crash never leaves half an index.
+ */
+bool SourceLocator::save(const Index *index, const QString &fileName)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QString temporaryFileName = fileName + ".tmp";
+    QFile file(temporaryFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream << IndexMagic << IndexVersion << index->roots << (qint32)index->files.count();
+    foreach(const File &entry, index->files) {
+        stream << entry.path << entry.modified << entry.size << entry.text;
+    }
+    stream << index->postings;
+    file.close();
+
+    if(stream.status() != QDataStream::Ok || file.error() != QFile::NoError) {
+        QFile::remove(temporaryFileName);
+        return false;
+    }
+
+    QFile::remove(fileName);
+    return QFile::rename(temporaryFileName, fileName);
+}
+
+/*! \internal
+    \brief Reads \a file to tell whether it's text, and if so, returns the trigrams it holds.
+ */
+QVector<quint32> SourceLocator::indexFile(File &file)
+{
+    file.text = false;
+
+    if(file.size > MaxIndexedSize) {
+        return QVector<quint32>();
+    }
+
+    QFile source(file.path);
+    if(!source.open(QIODevice::ReadOnly)) {
+        return QVector<quint32>();
+    }
+
+    QByteArray data = source.read(MaxIndexedSize);
+    if(memchr(data.constData(), '\0', qMin(data.size(), (int)BinaryCheckSize))) {
+        return QVector<quint32>();
+    }
+
+    file.text = true;
+    return trigrams(data.constData(), data.size());
+}
+
+/*! \internal
+    \brief Indexes the files of \a index by name; the lists of files are in order.
+ */
+void SourceLocator::buildNames(Index *index)
+{
+    for(int id = 0; id < index->files.count(); ++id) {
+        const File &file = index->files.at(id);
+        index->names[file.path.mid(file.path.lastIndexOf('/') + 1)].append(id);
+    }
+}
+
+/*! \internal
+    \brief Returns the sorted, distinct trigrams of the \a size bytes at \a data, folded to ASCII lower case; those
+           spanning lines are left out, since a search never does.
+ */
+QVector<quint32> SourceLocator::trigrams(const char *data, int size)
+{
+    QVector<quint32> result;
+    result.reserve(size);
+
+    quint32 trigram = 0;
+    int length = 0;
+    for(int i = 0; i < size; ++i) {
+        uchar c = data[i];
+        if(c == '\n' || c == '\r') {
+            length = 0;
+            continue;
+        }
+        if(c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+
+        trigram = ((trigram << 8) | c) & 0xffffff;
+        if(++length >= 3) {
+            result.append(trigram);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.resize(std::unique(result.begin(), result.end()) - result.begin());
+    result.squeeze();
+    return result;
+}
+
+} // namespace SourceView
+} // namespace Plugins
@@ -0,0 +1,127 @@
+/*!
+   \file SourceLocator.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_SOURCELOCATOR_H
+#define PLUGINS_SOURCEVIEW_SOURCELOCATOR_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+
+#include "SourceViewLibrary.h"
+
+namespace Plugins {
+namespace SourceView {
+
+class SOURCEVIEW_EXPORT SourceLocator : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SourceLocator)
+
+public:
+    static SourceLocator &instance();
+
+    QStringList roots() const;
+    void setRoots(const QStringList &roots);
+
+    QString indexFileName() const;
+    void setIndexFileName(const QString &fileName);
+
+    bool isIndexing() const;
+    void waitForIndex();
+    int fileCount() const;
+
+    QString locate(const QString &fileName) const;
+
+    struct Match {
+        QString fileName;
+        int lineNumber;
+        QString line;
+    };
+    QList<Match> search(const QString &text, Qt::CaseSensitivity cs = Qt::CaseSensitive, int maxMatches = 1000) const;
+
+public slots:
+    void refresh();
+    void cancel();
+
+signals:
+    void indexUpdated();
+
+protected:
+    explicit SourceLocator(QObject *parent = 0);
+    ~SourceLocator();
+
+    struct File {
+        QString path;
+        qint64 modified;
+        qint64 size;
+        bool text;
+    };
+
+    struct Index {
+        QStringList roots;
+        QVector<File> files;
+        QHash<QString, QVector<int> > names;
+        QHash<quint32, QVector<int> > postings;
+    };
+
+    static Index *load(SourceLocator *locator, QString fileName);
+    static Index *build(SourceLocator *locator, QStringList roots, const Index *previous, QString fileName);
+    static bool save(const Index *index, const QString &fileName);
+    static QVector<quint32> indexFile(File &file);
+    static void buildNames(Index *index);
+    static QVector<quint32> trigrams(const char *data, int size);
+
+    bool cancelled() const;
+    void startBuild();
+
+protected slots:
+    void loaded();
+    void built();
+
+private:
+    QStringList m_Roots;
+    QString m_IndexFileName;
+    Index *m_Index;
+    bool m_Indexing;
+    bool m_Refresh;
+
+    QFutureWatcher<Index *> m_LoadWatcher;
+    QFutureWatcher<Index *> m_BuildWatcher;
+    QAtomicInt m_Cancelled;
+
+    /* Files larger than this, in bytes, are found by name but not searched; and how much of the start of a file is
+       checked for binary content */
+    enum {
+        MaxIndexedSize = 4 * 1024 * 1024,
+        BinaryCheckSize = 8 * 1024
+    };
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_SOURCELOCATOR_H
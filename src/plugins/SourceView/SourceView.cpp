@@ -28,23 +28,69 @@
 #include <QResizeEvent>
 #include <QEvent>
 #include <QPainter>
+#include <QMouseEvent>
 #include <QToolTip>
+#include <QTextDocument>
+
+#include <algorithm>
 
 #ifdef QT_DEBUG
 #include <QDebug>
 #endif
 
 #include "SyntaxHighlighter.h"
+#include "ViewportHighlighter.h"
+#include "SourceLoader.h"
+#include "SourceDocumentCache.h"
+#include "LanguageRegistry.h"
 
 
 namespace Plugins {
 namespace SourceView {
 
+/* Colors for the levels of line metric heat, from pale yellow to red, for the side bar; and paler ones for the line
+   backgrounds.  Level 0 isn't drawn. */
+static const QVector<QRgb> &heatColors(bool background)
+{
+    static QVector<QRgb> sideBarColors;
+    static QVector<QRgb> backgroundColors;
+
+    if(sideBarColors.isEmpty()) {
+        sideBarColors.resize(256);
+        backgroundColors.resize(256);
+        for(int level = 0; level < 256; ++level) {
+            int hue = 60 - level * 60 / 255;
+            int saturation = 40 + level * 215 / 255;
+            sideBarColors[level] = QColor::fromHsv(hue, saturation, 255).rgb();
+            backgroundColors[level] = QColor::fromHsv(hue, saturation / 3, 255).rgb();
+        }
+    }
+
+    return background ? backgroundColors : sideBarColors;
+}
+
+/* Orders indexes into an array of line numbers by their line numbers */
+struct LineNumberLess
+{
+    LineNumberLess(const QVector<int> &lineNumbers) : lineNumbers(lineNumbers) {}
+    bool operator()(int a, int b) const { return lineNumbers.at(a) < lineNumbers.at(b); }
+    const QVector<int> &lineNumbers;
+};
+
 SourceView::SourceView(QWidget *parent) :
     QPlainTextEdit(parent),
     m_SideBarArea(new SideBarArea(this)),
-    m_SyntaxHighlighter(new SyntaxHighlighter(this->document()))
+    m_OverviewRuler(new OverviewRuler(this)),
+    m_SyntaxHighlighter(new SyntaxHighlighter(this->document())),
+    m_ViewportHighlighter(NULL),
+    m_SourceLoader(NULL),
+    m_SharedDocument(NULL),
+    m_LineMetricBackground(true),
+    m_OverviewDirty(true)
 {
+    // Keep the highlighter when the document is swapped for a shared one
+    m_SyntaxHighlighter->setParent(this);
+
     connect(this, SIGNAL(blockCountChanged(int)), this, SLOT(updateSideBarAreaWidth(int)));
     connect(this, SIGNAL(updateRequest(QRect,int)), this, SLOT(updateSideBarArea(QRect,int)));
     connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(highlightCurrentLine()));
@@ -59,10 +105,90 @@ SourceView::SourceView(QWidget *parent) :
 
 SourceView::~SourceView()
 {
+    // Stop loading while the document the loader appends to is still there
+    delete m_SourceLoader;
+    m_SourceLoader = NULL;
+
+    if(m_SharedDocument) {
+        SourceDocumentCache::instance().release(m_SharedDocument);
+    }
+}
+
+/*! \fn SourceView::loadFile()
+    \brief Replaces the text with the contents of \a fileName, which is decoded as UTF-8 and appended in the
+           background; returns false if the file can't be read.  The file is highlighted as the language the
+           LanguageRegistry finds for it.
+
+    The view can be used while the file loads; loadFinished() is emitted once it has.
+    \sa isLoading()
+ */
+bool SourceView::loadFile(const QString &fileName)
+{
+    releaseSharedDocument();
+    m_SyntaxHighlighter->setLanguage(LanguageRegistry::instance().languageForFile(fileName));
+
+    if(!m_SourceLoader) {
+        m_SourceLoader = new SourceLoader(this);
+        connect(m_SourceLoader, SIGNAL(finished()), this, SIGNAL(loadFinished()));
+    }
+
+    return m_SourceLoader->start(fileName, document());
 }
 
+/*! \fn SourceView::openFile()
+    \brief Shows \a fileName read-only, in a document shared with the other SourceViews showing the same version of the
+           file; returns false if the file can't be read.
+
+    If no view has shown the file lately, it's loaded in the background as with loadFile(), and kept in the
+    SourceDocumentCache for the next view to open it.  A view opening the file while it's still loading shows it as
+    it loads, and emits loadFinished() along with the others once it has.  Shared documents are always highlighted
+    lazily.
+    \sa SourceDocumentCache
+ */
+bool SourceView::openFile(const QString &fileName)
+{
+    QTextDocument *document = SourceDocumentCache::instance().acquire(fileName);
+    if(!document) {
+        return loadFile(fileName);
+    }
+
+    m_SyntaxHighlighter->setLanguage(LanguageRegistry::instance().languageForFile(fileName));
+    setSharedDocument(document);
+
+    if(!isLoading()) {
+        emit loadFinished();
+    }
+    return true;
+}
+
+bool SourceView::isLoading() const
+{
+    if(m_SharedDocument) {
+        return SourceDocumentCache::instance().isLoading(m_SharedDocument);
+    }
+    return m_SourceLoader && m_SourceLoader->isLoading();
+}
+
+/*! \fn SourceView::errorString()
+    \brief Why the last loadFile() failed.
+ */
+QString SourceView::errorString() const
+{
+    return m_SourceLoader ? m_SourceLoader->errorString() : QString();
+}
+
+/*! \fn SourceView::setCurrentLineNumber()
+    \brief Moves the cursor to the start of line \a lineNumber, counting from one, and scrolls it into the middle of
+           the view.  While a file is loading, this waits for no more of it than the line.
+ */
 void SourceView::setCurrentLineNumber(const int &lineNumber)
 {
+    if(m_SharedDocument) {
+        SourceDocumentCache::instance().waitForLine(m_SharedDocument, lineNumber);
+    } else if(isLoading()) {
+        m_SourceLoader->waitForLine(lineNumber);
+    }
+
     const QTextBlock &block = document()->findBlockByNumber(lineNumber-1);
     QTextCursor cursor(block);
     cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, 0);
@@ -78,11 +204,283 @@ void SourceView::addAnnotation(int lineNumber, QString toolTip, QColor color)
     annotation.color = color;
 
     m_Annotations[lineNumber] = annotation;
+    invalidateOverview();
 }
 
 void SourceView::removeAnnotation(int lineNumber)
 {
-    m_Annotations.remove(lineNumber);
+    if(m_Annotations.remove(lineNumber)) {
+        invalidateOverview();
+    }
+}
+
+/*! \fn SourceView::lazyHighlighting()
+    \brief Whether only the lines in view are highlighted as they're shown, with the rest of the document highlighted
+           in the background.  Off by default; it keeps the time to first show a very large file from depending on
+           its size.
+ */
+bool SourceView::lazyHighlighting() const
+{
+    return m_ViewportHighlighter != NULL;
+}
+
+void SourceView::setLazyHighlighting(bool lazy)
+{
+    if(lazy == lazyHighlighting() || m_SharedDocument) {
+        return;
+    }
+
+    if(lazy) {
+        m_SyntaxHighlighter->setDocument(NULL);
+        m_ViewportHighlighter = new ViewportHighlighter(this, m_SyntaxHighlighter);
+    } else {
+        delete m_ViewportHighlighter;
+        m_ViewportHighlighter = NULL;
+        ViewportHighlighter::forget(document());
+        m_SyntaxHighlighter->setDocument(document());
+    }
+}
+
+/*! \fn SourceView::language()
+    \brief The name of the language the text is highlighted as; C++ unless set, or found for a file when it's
+           loaded.
+    \sa LanguageRegistry
+ */
+QString SourceView::language() const
+{
+    return m_SyntaxHighlighter->language();
+}
+
+/*! \fn SourceView::setLanguage()
+    \brief Highlights the text as the language registered as \a name; returns false if there's no such language.
+ */
+bool SourceView::setLanguage(const QString &name)
+{
+    if(name == language()) {
+        return LanguageRegistry::instance().contains(name);
+    }
+
+    if(!m_SyntaxHighlighter->setLanguage(name)) {
+        return false;
+    }
+
+    if(m_ViewportHighlighter) {
+        m_ViewportHighlighter->rehighlight();
+    } else {
+        m_SyntaxHighlighter->rehighlight();
+    }
+    return true;
+}
+
+/*! \internal
+    \brief Shows \a document, acquired from the SourceDocumentCache, in place of the current one.
+ */
+void SourceView::setSharedDocument(QTextDocument *document)
+{
+    if(document == m_SharedDocument) {
+        SourceDocumentCache::instance().release(document);
+        return;
+    }
+
+    delete m_ViewportHighlighter;
+    m_ViewportHighlighter = NULL;
+    m_SyntaxHighlighter->setDocument(NULL);
+
+    QTextDocument *previous = m_SharedDocument;
+    if(m_SourceLoader) {
+        m_SourceLoader->cancel();
+    }
+    m_SharedDocument = document;
+
+    setDocument(document);
+    setReadOnly(true);
+    setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_ViewportHighlighter = new ViewportHighlighter(this, m_SyntaxHighlighter);
+
+    connect(&SourceDocumentCache::instance(), SIGNAL(loadFinished(QTextDocument*)),
+            this, SLOT(sharedDocumentLoaded(QTextDocument*)), Qt::UniqueConnection);
+
+    if(previous) {
+        SourceDocumentCache::instance().release(previous);
+    }
+}
+
+/*! \internal
+    \brief Gives the shared document back to the SourceDocumentCache, and goes back to a document of the view's own.
+ */
+void SourceView::releaseSharedDocument()
+{
+    if(!m_SharedDocument) {
+        return;
+    }
+
+    disconnect(&SourceDocumentCache::instance(), SIGNAL(loadFinished(QTextDocument*)),
+               this, SLOT(sharedDocumentLoaded(QTextDocument*)));
+
+    QTextDocument *document = m_SharedDocument;
+    m_SharedDocument = NULL;
+
+    delete m_ViewportHighlighter;
+    m_ViewportHighlighter = NULL;
+
+    // An empty document of the view's own
+    setDocument(NULL);
+    setReadOnly(false);
+    m_SyntaxHighlighter->setDocument(this->document());
+
+    SourceDocumentCache::instance().release(document);
+}
+
+/*! \internal
+    \brief Passes on the end of the load of the shared document, when \a document is it.
+ */
+void SourceView::sharedDocumentLoaded(QTextDocument *document)
+{
+    if(document == m_SharedDocument) {
+        emit loadFinished();
+    }
+}
+
+/*! \fn SourceView::setLineMetrics()
+    \brief Attaches a metric, such as samples or time, to lines; \a values holds the metric of the line at the same
+           index in \a lineNumbers (counting from one).  Replaces any metrics attached before.
+
+    The lines are colored by how their metric compares to the largest one, in the side bar and, unless turned off
+    with setLineMetricBackground(), behind the text.  A line's tooltip shows its metric and share of the total.
+    Metrics for the same line are added together.  The line numbers don't need to be sorted, but sorting them
+    first saves sorting them here.
+ */
+void SourceView::setLineMetrics(const QVector<int> &lineNumbers, const QVector<double> &values, const QString &name)
+{
+    int count = qMin(lineNumbers.count(), values.count());
+
+    QVector<int> order(count);
+    bool sorted = true;
+    for(int i = 0; i < count; ++i) {
+        order[i] = i;
+        sorted = sorted && (i == 0 || lineNumbers.at(i - 1) <= lineNumbers.at(i));
+    }
+    if(!sorted) {
+        std::sort(order.begin(), order.end(), LineNumberLess(lineNumbers));
+    }
+
+    LineMetrics metrics;
+    metrics.name = name;
+    metrics.lineNumbers.reserve(count);
+    metrics.values.reserve(count);
+    for(int i = 0; i < count; ++i) {
+        int lineNumber = lineNumbers.at(order.at(i));
+        double value = values.at(order.at(i));
+        if(!metrics.lineNumbers.isEmpty() && metrics.lineNumbers.last() == lineNumber) {
+            metrics.values.last() += value;
+        } else {
+            metrics.lineNumbers.append(lineNumber);
+            metrics.values.append(value);
+        }
+    }
+
+    count = metrics.values.count();
+    metrics.runningTotals.resize(count);
+    metrics.heat.resize(count);
+
+    double total = 0.0;
+    for(int i = 0; i < count; ++i) {
+        total += metrics.values.at(i);
+        metrics.runningTotals[i] = total;
+        metrics.maximum = qMax(metrics.maximum, metrics.values.at(i));
+    }
+
+    // The heat of each line is worked out once, so painting is just a look-up
+    for(int i = 0; i < count; ++i) {
+        double value = metrics.values.at(i);
+        metrics.heat[i] = (value > 0.0) ? (uchar)(1 + (int)(value / metrics.maximum * 254.0 + 0.5)) : 0;
+    }
+
+    m_LineMetrics = metrics;
+
+    viewport()->update();
+    m_SideBarArea->update();
+    invalidateOverview();
+}
+
+void SourceView::clearLineMetrics()
+{
+    m_LineMetrics = LineMetrics();
+
+    viewport()->update();
+    m_SideBarArea->update();
+    invalidateOverview();
+}
+
+QString SourceView::lineMetricName() const
+{
+    return m_LineMetrics.name;
+}
+
+bool SourceView::hasLineMetric(int lineNumber) const
+{
+    return lineMetricIndex(lineNumber) >= 0;
+}
+
+/*! \fn SourceView::lineMetric()
+    \brief The metric of line \a lineNumber, or zero if it has none.
+ */
+double SourceView::lineMetric(int lineNumber) const
+{
+    int index = lineMetricIndex(lineNumber);
+    return (index < 0) ? 0.0 : m_LineMetrics.values.at(index);
+}
+
+/*! \fn SourceView::lineMetricTotal()
+    \brief The sum of the metrics of the lines from \a firstLineNumber to \a lastLineNumber, such as those of a
+           function.
+ */
+double SourceView::lineMetricTotal(int firstLineNumber, int lastLineNumber) const
+{
+    const QVector<int> &lineNumbers = m_LineMetrics.lineNumbers;
+    int first = std::lower_bound(lineNumbers.constBegin(), lineNumbers.constEnd(), firstLineNumber) - lineNumbers.constBegin();
+    int end = std::upper_bound(lineNumbers.constBegin(), lineNumbers.constEnd(), lastLineNumber) - lineNumbers.constBegin();
+    if(end <= first) {
+        return 0.0;
+    }
+
+    const QVector<double> &runningTotals = m_LineMetrics.runningTotals;
+    return runningTotals.at(end - 1) - ((first > 0) ? runningTotals.at(first - 1) : 0.0);
+}
+
+bool SourceView::lineMetricBackground() const
+{
+    return m_LineMetricBackground;
+}
+
+/*! \fn SourceView::setLineMetricBackground()
+    \brief Sets whether lines with metrics are colored behind their text as well as in the side bar; on by default.
+ */
+void SourceView::setLineMetricBackground(bool enabled)
+{
+    m_LineMetricBackground = enabled;
+    viewport()->update();
+}
+
+/*! \internal
+    \brief The index of the metric of line \a lineNumber, or -1 if it has none.
+ */
+int SourceView::lineMetricIndex(int lineNumber) const
+{
+    const QVector<int> &lineNumbers = m_LineMetrics.lineNumbers;
+    QVector<int>::const_iterator it = std::lower_bound(lineNumbers.constBegin(), lineNumbers.constEnd(), lineNumber);
+    return (it != lineNumbers.constEnd() && *it == lineNumber) ? (it - lineNumbers.constBegin()) : -1;
+}
+
+/*! \internal
+    \brief Builds the tooltip of a line's metric when it's asked for.
+ */
+QString SourceView::lineMetricToolTip(int index) const
+{
+    double value = m_LineMetrics.values.at(index);
+    double total = m_LineMetrics.runningTotals.last();
+    QString name = m_LineMetrics.name.isEmpty() ? tr("Metric") : m_LineMetrics.name;
+    return tr("%1: %2 (%3% of total)").arg(name).arg(value).arg((total != 0.0) ? value / total * 100.0 : 0.0, 0, 'f', 2);
 }
 
 int SourceView::sideBarAreaWidth()
@@ -98,13 +496,30 @@ int SourceView::sideBarAreaWidth()
 void SourceView::updateSideBarAreaWidth(int newBlockCount)
 {
     Q_UNUSED(newBlockCount)
-    setViewportMargins(sideBarAreaWidth(), 0, 0, 0);
+    layoutMargins();
+
+    // Lines map to different rows of the overview ruler
+    invalidateOverview();
+}
+
+/*! \internal
+    \brief Makes room for the side bar, and the overview ruler beside it, to the left of the text.
+ */
+void SourceView::layoutMargins()
+{
+    int sideBarWidth = sideBarAreaWidth();
+    setViewportMargins(sideBarWidth + overviewRulerWidth(), 0, 0, 0);
+
+    QRect cr = contentsRect();
+    m_SideBarArea->setGeometry(QRect(cr.left(), cr.top(), sideBarWidth, cr.height()));
+    m_OverviewRuler->setGeometry(QRect(cr.left() + sideBarWidth, cr.top(), overviewRulerWidth(), cr.height()));
 }
 
 void SourceView::updateSideBarArea(const QRect &rect, int dy)
 {
     if(dy) {
         m_SideBarArea->scroll(0, dy);
+        m_OverviewRuler->update();
     } else {
         m_SideBarArea->update(0, rect.y(), m_SideBarArea->width(), rect.height());
     }
@@ -114,12 +529,49 @@ void SourceView::updateSideBarArea(const QRect &rect, int dy)
     }
 }
 
+/*! \fn SourceView::paintEvent()
+    \brief Colors the backgrounds of the visible lines with metrics, then has the text drawn over them.
+ */
+void SourceView::paintEvent(QPaintEvent *event)
+{
+    const QVector<int> &lineNumbers = m_LineMetrics.lineNumbers;
+
+    if(m_LineMetricBackground && !lineNumbers.isEmpty()) {
+        QPainter painter(viewport());
+        const QVector<QRgb> &colors = heatColors(true);
+
+        QTextBlock block = firstVisibleBlock();
+        QPointF offset = contentOffset();
+        int index = std::lower_bound(lineNumbers.constBegin(), lineNumbers.constEnd(), block.blockNumber() + 1) - lineNumbers.constBegin();
+
+        while(block.isValid() && index < lineNumbers.count()) {
+            QRectF rect = blockBoundingGeometry(block).translated(offset);
+            if(rect.top() > event->rect().bottom()) {
+                break;
+            }
+
+            int lineNumber = block.blockNumber() + 1;
+            if(lineNumbers.at(index) == lineNumber) {
+                uchar heat = m_LineMetrics.heat.at(index);
+                if(heat && block.isVisible()) {
+                    rect.setLeft(0);
+                    rect.setRight(viewport()->width());
+                    painter.fillRect(rect, QColor(colors.at(heat)));
+                }
+                ++index;
+            }
+
+            block = block.next();
+        }
+    }
+
+    QPlainTextEdit::paintEvent(event);
+}
+
 void SourceView::resizeEvent(QResizeEvent *e)
 {
     QPlainTextEdit::resizeEvent(e);
-
-    QRect cr = contentsRect();
-    m_SideBarArea->setGeometry(QRect(cr.left(), cr.top(), sideBarAreaWidth(), cr.height()));
+    layoutMargins();
 }
 
 void SourceView::highlightCurrentLine()
@@ -147,15 +599,26 @@ void SourceView::sideBarAreaPaintEvent(QPaintEvent *event)
     int top = (int) blockBoundingGeometry(block).translated(contentOffset()).top();
     int bottom = top + (int) blockBoundingRect(block).height();
 
+    const QVector<int> &lineNumbers = m_LineMetrics.lineNumbers;
+    const QVector<QRgb> &colors = heatColors(false);
+    int metric = std::lower_bound(lineNumbers.constBegin(), lineNumbers.constEnd(), blockNumber + 1) - lineNumbers.constBegin();
+
     while (block.isValid() && top <= event->rect().bottom()) {
+        bool hasMetric = (metric < lineNumbers.count() && lineNumbers.at(metric) == blockNumber + 1);
+
         if (block.isVisible() && bottom >= event->rect().top()) {
+            if(hasMetric && m_LineMetrics.heat.at(metric)) {
+                painter.fillRect(0, top, m_SideBarArea->width(), bottom - top, QColor(colors.at(m_LineMetrics.heat.at(metric))));
+            }
+
             QString number = QString::number(blockNumber + 1);
             painter.setPen(Qt::darkGray);
 
             painter.drawText(0, top, m_SideBarArea->width(), fontMetrics().height(), Qt::AlignRight, number);
 
-            if(m_Annotations.contains(blockNumber + 1)) {
-                Annotation annotation = m_Annotations.value(blockNumber+1);
+            QMap<int, Annotation>::const_iterator annotationIt = m_Annotations.constFind(blockNumber + 1);
+            if(annotationIt != m_Annotations.constEnd()) {
+                const Annotation &annotation = annotationIt.value();
                 QBrush brush = painter.brush();
                 if(brush.color() != annotation.color) {
                     brush.setColor(annotation.color);
@@ -167,6 +630,10 @@ void SourceView::sideBarAreaPaintEvent(QPaintEvent *event)
             }
         }
 
+        if(hasMetric) {
+            ++metric;
+        }
+
         block = block.next();
         top = bottom;
         bottom = top + (int) blockBoundingRect(block).height();
@@ -174,6 +641,144 @@ void SourceView::sideBarAreaPaintEvent(QPaintEvent *event)
     }
 }
 
+/*! \fn SourceView::overviewRulerVisible()
+    \brief Whether the strip beside the side bar showing the whole file's line metrics and annotations is shown; on
+           by default.  Clicking or dragging in it moves to the lines under the mouse.
+ */
+bool SourceView::overviewRulerVisible() const
+{
+    return !m_OverviewRuler->isHidden();
+}
+
+void SourceView::setOverviewRulerVisible(bool visible)
+{
+    m_OverviewRuler->setVisible(visible);
+    layoutMargins();
+}
+
+int SourceView::overviewRulerWidth() const
+{
+    return m_OverviewRuler->isHidden() ? 0 : (int)OverviewRulerWidth;
+}
+
+/*! \internal
+    \brief Has the overview ruler's picture drawn again when it's next shown.
+ */
+void SourceView::invalidateOverview()
+{
+    m_OverviewDirty = true;
+    m_OverviewRuler->update();
+}
+
+/*! \internal
+    \brief Draws the whole file into the overview ruler's picture, one row of pixels at a time: the left half of each
+           row in the hottest metric color of the lines it covers, the right half in the color of their annotations.
+
+    This takes time in proportion to the number of line metrics and annotations plus the size of the ruler, not to
+    the number of lines.
+ */
+void SourceView::renderOverview()
+{
+    QSize size = m_OverviewRuler->size();
+    if(m_OverviewImage.size() != size) {
+        m_OverviewImage = QImage(size, QImage::Format_RGB32);
+    }
+    m_OverviewDirty = false;
+
+    int width = size.width();
+    int height = size.height();
+    if(width <= 0 || height <= 0) {
+        return;
+    }
+
+    qint64 lines = qMax(1, blockCount());
+    QVector<uchar> rowHeat(height, 0);
+    QVector<QRgb> rowMarks(height, 0);
+
+    const QVector<int> &lineNumbers = m_LineMetrics.lineNumbers;
+    for(int i = 0; i < lineNumbers.count(); ++i) {
+        uchar heat = m_LineMetrics.heat.at(i);
+        qint64 lineNumber = lineNumbers.at(i);
+        if(!heat || lineNumber < 1 || lineNumber > lines) {
+            continue;
+        }
+
+        int first = (int)((lineNumber - 1) * height / lines);
+        int last = qMax(first, (int)(lineNumber * height / lines) - 1);
+        for(int row = first; row <= last; ++row) {
+            rowHeat[row] = qMax(rowHeat.at(row), heat);
+        }
+    }
+
+    for(QMap<int, Annotation>::const_iterator it = m_Annotations.constBegin(); it != m_Annotations.constEnd(); ++it) {
+        qint64 lineNumber = it.key();
+        if(lineNumber < 1 || lineNumber > lines) {
+            continue;
+        }
+
+        // At least two rows, to be seen in long files
+        int first = (int)((lineNumber - 1) * height / lines);
+        int last = qMin(height - 1, qMax(first + 1, (int)(lineNumber * height / lines) - 1));
+        QRgb color = it.value().color.rgb();
+        for(int row = first; row <= last; ++row) {
+            rowMarks[row] = color;
+        }
+    }
+
+    const QVector<QRgb> &colors = heatColors(false);
+    QRgb background = QColor(Qt::lightGray).rgb();
+    int markStart = width / 2;
+    for(int row = 0; row < height; ++row) {
+        QRgb *pixels = reinterpret_cast<QRgb *>(m_OverviewImage.scanLine(row));
+        QRgb color = rowHeat.at(row) ? colors.at(rowHeat.at(row)) : background;
+        QRgb mark = rowMarks.at(row) ? rowMarks.at(row) : color;
+        for(int x = 0; x < markStart; ++x) {
+            pixels[x] = color;
+        }
+        for(int x = markStart; x < width; ++x) {
+            pixels[x] = mark;
+        }
+    }
+}
+
+/*! \fn SourceView::overviewRulerPaintEvent()
+    \brief Shows the overview ruler's picture, drawing it again first if it's out of date, and marks the lines in
+           view over it.
+ */
+void SourceView::overviewRulerPaintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    if(m_OverviewDirty || m_OverviewImage.size() != m_OverviewRuler->size()) {
+        renderOverview();
+    }
+
+    QPainter painter(m_OverviewRuler);
+    painter.drawImage(0, 0, m_OverviewImage);
+
+    qint64 lines = qMax(1, blockCount());
+    int height = m_OverviewRuler->height();
+    qint64 first = firstVisibleBlock().blockNumber();
+    qint64 visible = viewport()->height() / qMax(1, fontMetrics().height());
+    int top = (int)(first * height / lines);
+    int bottom = qMax(top + 2, (int)((first + visible) * height / lines));
+    painter.fillRect(0, top, m_OverviewRuler->width(), bottom - top, QColor(0, 0, 0, 48));
+}
+
+/*! \fn SourceView::overviewRulerMouseEvent()
+    \brief Moves to the line under the mouse, while the left button is pressed over the overview ruler.
+ */
+void SourceView::overviewRulerMouseEvent(QMouseEvent *event)
+{
+    if(!(event->buttons() & Qt::LeftButton)) {
+        return;
+    }
+
+    int height = qMax(1, m_OverviewRuler->height());
+    qint64 y = qBound(0, event->pos().y(), height - 1);
+    setCurrentLineNumber((int)(y * qMax(1, blockCount()) / height) + 1);
+}
+
 bool SourceView::event(QEvent *event)
 {
     if(event->type() == QEvent::ToolTip) {
@@ -188,14 +793,31 @@ bool SourceView::event(QEvent *event)
 
         QTextCursor cursor = cursorForPosition(position);
         int lineNumber = cursor.blockNumber() + 1;
-        if(!m_Annotations.contains(lineNumber)) {
+
+        QString toolTip;
+        bool found = false;
+        QMap<int, Annotation>::const_iterator annotation = m_Annotations.constFind(lineNumber);
+        if(annotation != m_Annotations.constEnd()) {
+            toolTip = annotation.value().toolTip;
+            found = true;
+        }
+
+        int metric = lineMetricIndex(lineNumber);
+        if(metric >= 0) {
+            if(!toolTip.isEmpty()) {
+                toolTip.append(QLatin1Char('\n'));
+            }
+            toolTip.append(lineMetricToolTip(metric));
+            found = true;
+        }
+
+        if(!found) {
             QToolTip::hideText();
             event->ignore();
             return true;
         }
 
-        Annotation annotation = m_Annotations.value(lineNumber);
-        QToolTip::showText(helpEvent->globalPos(), annotation.toolTip);
+        QToolTip::showText(helpEvent->globalPos(), toolTip);
         return true;
     }
 
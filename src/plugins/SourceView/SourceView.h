@@ -27,10 +27,14 @@
 #include <QPlainTextEdit>
 #include <QSize>
 #include <QColor>
+#include <QVector>
+#include <QImage>
 
 class QPaintEvent;
+class QMouseEvent;
 class QResizeEvent;
 class QEvent;
+class QTextDocument;
 
 #include "SourceViewLibrary.h"
 
@@ -38,6 +42,8 @@ namespace Plugins {
 namespace SourceView {
 
 class SyntaxHighlighter;
+class ViewportHighlighter;
+class SourceLoader;
 
 class SOURCEVIEW_EXPORT SourceView : public QPlainTextEdit
 {
@@ -46,15 +52,45 @@ public:
     explicit SourceView(QWidget *parent = 0);
     ~SourceView();
 
+    bool loadFile(const QString &fileName);
+    bool openFile(const QString &fileName);
+    bool isLoading() const;
+    QString errorString() const;
+
     void setCurrentLineNumber(const int &lineNumber);
 
     void addAnnotation(int lineNumber, QString toolTip = QString(), QColor color = QColor("orange"));
     void removeAnnotation(int lineNumber);
 
+    void setLineMetrics(const QVector<int> &lineNumbers, const QVector<double> &values, const QString &name = QString());
+    void clearLineMetrics();
+    QString lineMetricName() const;
+    bool hasLineMetric(int lineNumber) const;
+    double lineMetric(int lineNumber) const;
+    double lineMetricTotal(int firstLineNumber, int lastLineNumber) const;
+    bool lineMetricBackground() const;
+    void setLineMetricBackground(bool enabled);
+
+    bool lazyHighlighting() const;
+    void setLazyHighlighting(bool lazy);
+
+    QString language() const;
+    bool setLanguage(const QString &name);
+
+    bool overviewRulerVisible() const;
+    void setOverviewRulerVisible(bool visible);
+
+signals:
+    void loadFinished();
+
 protected:
+    void paintEvent(QPaintEvent *event);
     void resizeEvent(QResizeEvent *event);
     void sideBarAreaPaintEvent(QPaintEvent *event);
     int sideBarAreaWidth();
+    void overviewRulerPaintEvent(QPaintEvent *event);
+    void overviewRulerMouseEvent(QMouseEvent *event);
+    int overviewRulerWidth() const;
     void refreshStatements();
 
     bool event(QEvent *event);
@@ -63,15 +99,52 @@ private slots:
     void updateSideBarAreaWidth(int newBlockCount);
     void highlightCurrentLine();
     void updateSideBarArea(const QRect &, int);
+    void sharedDocumentLoaded(QTextDocument *document);
 
 private:
     QWidget *m_SideBarArea;
+    QWidget *m_OverviewRuler;
     SyntaxHighlighter *m_SyntaxHighlighter;
+    ViewportHighlighter *m_ViewportHighlighter;
+    SourceLoader *m_SourceLoader;
+    QTextDocument *m_SharedDocument;
+
+    void setSharedDocument(QTextDocument *document);
+    void releaseSharedDocument();
 
     struct Annotation { QColor color; QString toolTip; };
     QMap<int, Annotation> m_Annotations;
 
+    /* Per-line metrics, sorted by line number, with the running totals and heat color of each */
+    struct LineMetrics {
+        LineMetrics() : maximum(0.0) {}
+        QString name;
+        QVector<int> lineNumbers;
+        QVector<double> values;
+        QVector<double> runningTotals;
+        QVector<uchar> heat;
+        double maximum;
+    };
+    LineMetrics m_LineMetrics;
+    bool m_LineMetricBackground;
+
+    int lineMetricIndex(int lineNumber) const;
+    QString lineMetricToolTip(int index) const;
+
+    /* The overview ruler's picture of the whole file, drawn again only once the metrics, annotations, line count or
+       ruler size change */
+    QImage m_OverviewImage;
+    bool m_OverviewDirty;
+
+    void invalidateOverview();
+    void renderOverview();
+    void layoutMargins();
+
+    enum { OverviewRulerWidth = 12 };
+
     friend class SideBarArea;
+    friend class OverviewRuler;
+    friend class ViewportHighlighter;
 };
 
 class SOURCEVIEW_EXPORT SideBarArea : public QWidget
@@ -85,6 +158,19 @@ private:
     SourceView *m_SourceView;
 };
 
+class SOURCEVIEW_EXPORT OverviewRuler : public QWidget
+{
+public:
+    OverviewRuler(SourceView *sourceView) : QWidget(sourceView) { m_SourceView = sourceView; }
+    QSize sizeHint() const { return QSize(m_SourceView->overviewRulerWidth(), 0); }
+protected:
+    void paintEvent(QPaintEvent *event) { m_SourceView->overviewRulerPaintEvent(event); }
+    void mousePressEvent(QMouseEvent *event) { m_SourceView->overviewRulerMouseEvent(event); }
+    void mouseMoveEvent(QMouseEvent *event) { m_SourceView->overviewRulerMouseEvent(event); }
+private:
+    SourceView *m_SourceView;
+};
+
 } // namespace SourceView
 } // namespace Plugins
 
@@ -17,6 +17,10 @@
 
 include(../plugins.pri)
 
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += concurrent
+}
+
 CONFIG(debug, debug|release) {
   TARGET            = SourceViewD
 } else {
@@ -26,12 +30,24 @@ CONFIG(debug, debug|release) {
 HEADERS            += SourceViewPlugin.h \
                       SourceView.h \
                       SyntaxHighlighter.h \
+                      Language.h \
+                      LanguageRegistry.h \
+                      ViewportHighlighter.h \
+                      SourceLoader.h \
+                      SourceDocumentCache.h \
+                      SourceLocator.h \
                       ISourceViewFactory.h \
                       SourceViewLibrary.h
 
 SOURCES            += SourceViewPlugin.cpp \
                       SourceView.cpp \
                       SyntaxHighlighter.cpp \
+                      Language.cpp \
+                      LanguageRegistry.cpp \
+                      ViewportHighlighter.cpp \
+                      SourceLoader.cpp \
+                      SourceDocumentCache.cpp \
+                      SourceLocator.cpp \
                       ISourceViewFactory.cpp
 
 #debug: DEFINES    += SOURCEVIEW_DEBUG
@@ -39,5 +55,5 @@ SOURCES            += SourceViewPlugin.cpp \
 DEFINES      += SOURCEVIEW_LIBRARY
 
 sourceViewPluginHeaders.path = /include/plugins/SourceView
-sourceViewPluginHeaders.files = SourceViewLibrary.h ISourceViewFactory.h SourceView.h
+sourceViewPluginHeaders.files = SourceViewLibrary.h ISourceViewFactory.h SourceView.h SyntaxHighlighter.h LanguageRegistry.h SourceDocumentCache.h SourceLocator.h
 INSTALLS += sourceViewPluginHeaders
@@ -23,12 +23,25 @@
 
 #include "SourceViewPlugin.h"
 
+
+#if QT_VERSION >= 0x050000
+#  include <QStandardPaths>
+#else
+#  include <QDesktopServices>
+#endif
+
 #include <PluginManager/PluginManager.h>
+#include <SettingManager/SettingManager.h>
 #include "SourceView.h"
+#include "SourceLocator.h"
+#include "LanguageRegistry.h"
 
 namespace Plugins {
 namespace SourceView {
 
+/* Texts longer than this, in characters or bytes, are highlighted as they're shown */
+static const int LazyHighlightingThreshold = 1024 * 1024;
+
 /*! \namespace Plugins::SourceView
     \brief Contains the SourceViewPlugin.
  */
@@ -74,6 +87,23 @@ bool SourceViewPlugin::initialize(QStringList &args, QString *err)
         Core::PluginManager::PluginManager &pluginManager = Core::PluginManager::PluginManager::instance();
         pluginManager.addObject(this);
 
+        // Index the configured source roots in the background, starting from the index kept last session
+#if QT_VERSION >= 0x050000
+        QString dataPath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+#else
+        QString dataPath = QDesktopServices::storageLocation(QDesktopServices::DataLocation);
+#endif
+        Core::SettingManager::SettingManager &settingManager = Core::SettingManager::SettingManager::instance();
+        settingManager.setGroup("Plugins/SourceView");
+        QStringList sourceRoots = settingManager.value("sourceRoots").toStringList();
+        settingManager.endGroup();
+
+        SourceLocator &sourceLocator = SourceLocator::instance();
+        sourceLocator.setIndexFileName(QString("%1/SourceLocator.index").arg(dataPath));
+        if(!sourceRoots.isEmpty()) {
+            sourceLocator.setRoots(sourceRoots);
+        }
+
     } catch(...) {
         return false;
     }
@@ -87,6 +117,7 @@ bool SourceViewPlugin::initialize(QStringList &args, QString *err)
  */
 void SourceViewPlugin::shutdown()
 {
+    SourceLocator::instance().cancel();
 }
 
 /*!
@@ -119,13 +150,73 @@ QList<Core::PluginManager::Dependency> SourceViewPlugin::dependencies()
     return m_Dependencies;
 }
 
+/*!
+   \fn SourceViewPlugin::sourceViewWidget()
+   \brief Returns a new SourceView showing \a text; large texts are highlighted lazily.  The language is C++ unless
+          the first line, such as a "#!" line, says otherwise.
+   \sa SourceView::setLazyHighlighting()
+ */
 SourceView *SourceViewPlugin::sourceViewWidget(const QString &text)
 {
     SourceView *view = new SourceView();
+    view->setLazyHighlighting(text.length() > LazyHighlightingThreshold);
+
+    QString language = LanguageRegistry::instance().languageForFirstLine(text.left(text.indexOf('\n')));
+    if(!language.isEmpty()) {
+        view->setLanguage(language);
+    }
+
     view->setPlainText(text);
     return view;
 }
 
+/*!
+   \fn SourceViewPlugin::sourceViewWidgetForFile()
+   \brief Returns a new SourceView showing \a fileName, or NULL if the file can't be read.  The file is loaded in
+          the background, unless another view has shown it lately, in which case its document is shared.
+   \sa SourceView::openFile()
+ */
+SourceView *SourceViewPlugin::sourceViewWidgetForFile(const QString &fileName)
+{
+    SourceView *view = new SourceView();
+    if(!view->openFile(fileName)) {
+        delete view;
+        return NULL;
+    }
+    return view;
+}
+
+/*!
+   \fn SourceViewPlugin::sourceViewWidgetForLocation()
+   \brief Returns a new SourceView showing line \a lineNumber of \a fileName, or NULL if the file can't be found.
+          A path that doesn't exist here, such as one the code was built from, is looked for in the source roots.
+   \sa SourceLocator::locate()
+ */
+SourceView *SourceViewPlugin::sourceViewWidgetForLocation(const QString &fileName, int lineNumber)
+{
+    QString located = SourceLocator::instance().locate(fileName);
+    if(located.isEmpty()) {
+        return NULL;
+    }
+
+    SourceView *view = sourceViewWidgetForFile(located);
+    if(view) {
+        view->setCurrentLineNumber(lineNumber);
+    }
+    return view;
+}
+
+/*!
+   \fn SourceViewPlugin::registerLanguage()
+   \brief Adds a language SourceViews can highlight; returns false if one by the same name already exists, or if
+          the definition has more multi-line comments and quotes than a language can have.
+   \sa LanguageRegistry::registerLanguage()
+ */
+bool SourceViewPlugin::registerLanguage(const LanguageDefinition &definition)
+{
+    return LanguageRegistry::instance().registerLanguage(definition);
+}
+
 } // namespace SourceView
 } // namespace Plugins
 
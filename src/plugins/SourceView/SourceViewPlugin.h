@@ -60,6 +60,9 @@ public:
 
     /* ISourceViewFactory Interface */
     SourceView *sourceViewWidget(const QString &text);
+    SourceView *sourceViewWidgetForFile(const QString &fileName);
+    SourceView *sourceViewWidgetForLocation(const QString &fileName, int lineNumber);
+    bool registerLanguage(const LanguageDefinition &definition);
 
 protected:
     QString m_Name;
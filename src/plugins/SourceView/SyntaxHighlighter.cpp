@@ -23,140 +23,362 @@
 
 #include "SyntaxHighlighter.h"
 
+#include "Language.h"
+#include "LanguageRegistry.h"
+
 namespace Plugins {
 namespace SourceView {
 
+static inline bool isIdentifierStart(ushort c)
+{
+    if(c < 0x80) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+    return QChar(c).isLetter();
+}
+
+static inline bool isIdentifierPart(ushort c)
+{
+    if(c < 0x80) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+    return QChar(c).isLetterOrNumber();
+}
+
+static inline bool isSpace(ushort c)
+{
+    return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\r';
+}
+
+static inline bool matches(const QChar *data, int length, const char *word)
+{
+    int i = 0;
+    for(; word[i]; ++i) {
+        if(i >= length || data[i].unicode() != (ushort)(uchar)word[i]) {
+            return false;
+        }
+    }
+    return i == length;
+}
+
+/* The preprocessor directives that change how the following lines are highlighted */
+enum Directive {
+    Directive_None,
+    Directive_Other,
+    Directive_If,
+    Directive_IfZero,
+    Directive_Else,
+    Directive_EndIf,
+    Directive_Include
+};
+
+/* Reads a directive at the start of a line; \a end is left just past its name */
+static Directive readDirective(const QChar *data, int length, int &start, int &end)
+{
+    int i = 0;
+    while(i < length && isSpace(data[i].unicode())) {
+        ++i;
+    }
+    if(i == length || data[i].unicode() != '#') {
+        return Directive_None;
+    }
+
+    start = i++;
+    while(i < length && isSpace(data[i].unicode())) {
+        ++i;
+    }
+    int name = i;
+    while(i < length && isIdentifierPart(data[i].unicode())) {
+        ++i;
+    }
+    end = i;
+
+    const QChar *word = data + name;
+    int wordLength = end - name;
+    if(matches(word, wordLength, "ifdef") || matches(word, wordLength, "ifndef")) {
+        return Directive_If;
+    } else if(matches(word, wordLength, "if")) {
+        // "#if 0", optionally followed by a comment, starts a disabled region
+        while(i < length && isSpace(data[i].unicode())) {
+            ++i;
+        }
+        if(i < length && data[i].unicode() == '0') {
+            ++i;
+            while(i < length && isSpace(data[i].unicode())) {
+                ++i;
+            }
+            if(i == length || (i + 1 < length && data[i].unicode() == '/' &&
+                               (data[i + 1].unicode() == '/' || data[i + 1].unicode() == '*'))) {
+                return Directive_IfZero;
+            }
+        }
+        return Directive_If;
+    } else if(matches(word, wordLength, "else") || matches(word, wordLength, "elif")) {
+        return Directive_Else;
+    } else if(matches(word, wordLength, "endif")) {
+        return Directive_EndIf;
+    } else if(matches(word, wordLength, "include") || matches(word, wordLength, "import")) {
+        return Directive_Include;
+    }
+    return Directive_Other;
+}
+
+
+/*! \class Plugins::SourceView::SyntaxHighlighter
+    \brief Highlights source in one of the languages of the LanguageRegistry, C++ by default: keywords, data types,
+           MPI calls, preprocessor directives, quotes, comments, and code disabled with "#if 0".
+
+    Each line is tokenized in a single pass, driven by the tables the language was compiled into when it was
+    registered; identifiers are looked up in the language's keyword table.  Which comment or quote a line ends
+    inside of, and how many nested conditionals deep inside an "#if 0" it ends, is kept in its block state.
+    \sa LanguageRegistry
+ */
+
 SyntaxHighlighter::SyntaxHighlighter(QTextDocument *parent) :
     QSyntaxHighlighter(parent)
 {
     init();
 }
 
+SyntaxHighlighter::SyntaxHighlighter(QObject *parent) :
+    QSyntaxHighlighter(parent)
+{
+    init();
+}
+
 void SyntaxHighlighter::init()
 {
-    QStringList keywords;
-    keywords << "asm" << "break" << "case" << "catch" << "class" << "const_cast" << "continue" << "default" << "delete"
-             << "do" << "dynamic_cast" << "else" << "enum" << "explicit" << "export" << "extern" << "false" << "friend"
-             << "for" << "goto" << "if" << "inline" << "namespace" << "new" << "operator" << "private" << "protected"
-             << "public" << "reinterpret_cast" << "return" << "sizeof" << "static_cast" << "struct" << "switch"
-             << "template" << "this" << "throw" << "true" << "try" << "typedef" << "typeid" << "type_info"
-             << "typename" << "union" << "using" << "virtual" << "while" << "and" << "and_eq" << "bad_cast"
-             << "bad_typeid" << "bitand" << "bitor" << "compl" << "not" << "not_eq" << "or" << "or_eq" << "xor"
-             << "xor_eq";
-
-    QString keywordPattern;
-    keywordPattern.append("\\b(");
-    keywordPattern.append(keywords.join("|"));
-    keywordPattern.append(")\\b");
-    m_Keywords.setPattern(keywordPattern);
-
-
-    QStringList dataTypes;
-    dataTypes << "auto" << "bool" << "char" << "const" << "double" << "float" << "int" << "long" << "mutable"
-              << "register" << "short" << "signed" << "static" << "unsigned" << "void" << "volatile" << "uchar"
-              << "uint" << "int8_t" << "int16_t" << "int32_t" << "int64_t" << "uint8_t" << "uint16_t" << "uint32_t"
-              << "uint64_t" << "wchar_t";
-
-    QString dataTypePattern;
-    dataTypePattern.append("\\b(");
-    dataTypePattern.append(dataTypes.join("|"));
-    dataTypePattern.append(")\\b");
-    m_DataTypes.setPattern(dataTypePattern);
+    LanguageRegistry &registry = LanguageRegistry::instance();
+    m_Language = registry.language(registry.defaultLanguage());
 
+    m_KeywordFormat.setForeground(Qt::darkYellow);
+    m_DataTypeFormat.setForeground(Qt::darkMagenta);
+    m_MpiFormat.setForeground(Qt::red);
+    m_PreprocessorFormat.setForeground(Qt::darkBlue);
+    m_QuoteFormat.setForeground(Qt::darkGreen);
+    m_CommentFormat.setForeground(Qt::darkGreen);
+    m_DisabledFormat.setForeground(Qt::darkGray);
 }
 
+/*! \fn SyntaxHighlighter::language()
+    \brief The name of the language highlighted.
+ */
+QString SyntaxHighlighter::language() const
+{
+    return m_Language->name;
+}
 
-void SyntaxHighlighter::highlightBlock(const QString &text)
+/*! \fn SyntaxHighlighter::setLanguage()
+    \brief Highlights the language registered as \a name from now on; returns false if there's no such language.
+           The document isn't highlighted again until rehighlight() is called.
+ */
+bool SyntaxHighlighter::setLanguage(const QString &name)
 {
-    int index = text.indexOf(m_Keywords);
-    while (index >= 0) {
-        int length = m_Keywords.matchedLength();
-        setFormat(index, length, Qt::darkYellow);
-        index = text.indexOf(m_Keywords, index + length);
+    const Language *language = LanguageRegistry::instance().language(name);
+    if(!language) {
+        return false;
     }
 
-    index = text.indexOf(m_DataTypes);
-    while (index >= 0) {
-        int length = m_DataTypes.matchedLength();
-        setFormat(index, length, Qt::darkMagenta);
-        index = text.indexOf(m_DataTypes, index + length);
-    }
+    m_Language = language;
+    return true;
+}
 
-    static QRegExp mpiMethod("\\bMPI_\\w+\\b");
-    index = text.indexOf(mpiMethod);
-    while (index >= 0) {
-        int length = mpiMethod.matchedLength();
-        setFormat(index, length, Qt::red);
-        index = text.indexOf(mpiMethod, index + length);
-    }
+/*! \fn SyntaxHighlighter::highlightLine()
+    \brief Highlights one line of text, starting in \a state, the state the previous line ended in (0 for the first
+           line), without a document; the formats are returned in \a formats, and the state the line ends in is
+           returned.
 
-    static QRegExp preprocessor("#\\s*\\w+\\b");
-    index = text.indexOf(preprocessor);
-    while (index >= 0) {
-        int length = preprocessor.matchedLength();
-        setFormat(index, length, Qt::darkBlue);
-        index = text.indexOf(preprocessor, index + length);
-    }
+    This lets a caller highlight only the lines it shows, such as a SourceView's visible lines.
+ */
+int SyntaxHighlighter::highlightLine(const QString &text, int state, QList<QTextLayout::FormatRange> &formats)
+{
+    state = lex(text, state);
 
-    static QRegExp quote("(\".*\")|('.')|(<\\s*[\\w\\.]+\\s*>)");
-    index = text.indexOf(quote);
-    while (index >= 0) {
-        int length = quote.matchedLength();
-        setFormat(index, length, Qt::darkGreen);
-        index = text.indexOf(quote, index + length);
+    formats.clear();
+    for(int i = 0; i < m_Spans.count(); ++i) {
+        const Span &span = m_Spans.at(i);
+        QTextLayout::FormatRange range;
+        range.start = span.start;
+        range.length = span.length;
+        range.format = *span.format;
+        formats.append(range);
     }
 
-    static QRegExp oneLineComment("(//.*$)");
-    index = text.indexOf(oneLineComment);
-    while (index >= 0) {
-        int length = oneLineComment.matchedLength();
-        setFormat(index, length, Qt::darkGreen);
-        index = text.indexOf(oneLineComment, index + length);
+    return state;
+}
+
+void SyntaxHighlighter::highlightBlock(const QString &text)
+{
+    int state = lex(text, qMax(previousBlockState(), 0));
+
+    for(int i = 0; i < m_Spans.count(); ++i) {
+        const Span &span = m_Spans.at(i);
+        setFormat(span.start, span.length, *span.format);
     }
 
-//    if(currentBlockState() != 1) {
-//        /* Multi-line preprocessor */
-//        static QRegExp startIf("^\\s*#\\s*if\\s*0\\s*$");
-//        static QRegExp endIf("^\\s*#\\s*endif\\s*$");
+    setCurrentBlockState(state);
+}
 
-//        if(startIf.exactMatch(text)) {
-//            setCurrentBlockState(2);
-//        }
+/*! \internal
+    \brief Tokenizes a line starting in \a state, leaving its formats in m_Spans, and returns the state it ends in.
+ */
+int SyntaxHighlighter::lex(const QString &text, int state)
+{
+    const Language &language = *m_Language;
+    const QChar *data = text.constData();
+    const int length = text.length();
 
-//        if(currentBlockState() == 2) {
-//            setFormat(0, text.length(), Qt::darkGray);
-//        }
+    m_Spans.clear();
 
-//        if(endIf.exactMatch(text)) {
-//            setCurrentBlockState(0);
-//        }
-//    }
+    int block = (state & State_BlockMask) - 1;
+    int disabledDepth = state >> State_DisabledShift;
+    bool disabled = (disabledDepth > 0);
 
-    /* Multi-line comments */
-    static QRegExp startExpression("/\\*");
-    static QRegExp endExpression("\\*/");
+    int i = 0;
+    int blockStart = 0;
+    bool include = false;
 
-    setCurrentBlockState(0);
+    if(block < 0 && length > 0 && (language.starts(data[0].unicode()) & Language::Start_ColumnOneComment)) {
+        addSpan(0, length, m_CommentFormat);
+        i = length;
+    } else if(block < 0 && language.preprocessor) {
+        int start = 0;
+        int end = 0;
+        switch(readDirective(data, length, start, end)) {
+        case Directive_None:
+            break;
+        case Directive_If:
+            if(disabledDepth > 0) {
+                ++disabledDepth;
+            }
+            break;
+        case Directive_IfZero:
+            if(disabledDepth > 0) {
+                ++disabledDepth;
+            } else {
+                disabledDepth = 1;
+                disabled = true;
+            }
+            break;
+        case Directive_Else:
+            if(disabledDepth == 1) {
+                disabledDepth = 0;
+                disabled = false;
+            }
+            break;
+        case Directive_EndIf:
+            if(disabledDepth > 0) {
+                --disabledDepth;
+            }
+            break;
+        case Directive_Include:
+            include = true;
+            break;
+        case Directive_Other:
+            break;
+        }
 
-    int startIndex = 0;
-    if(previousBlockState() != 1) {
-        startIndex = text.indexOf(startExpression);
+        if(!disabled && end > start) {
+            addSpan(start, end - start, m_PreprocessorFormat);
+            i = end;
+        }
     }
 
-    while(startIndex >= 0) {
-       int endIndex = text.indexOf(endExpression, startIndex);
-       int commentLength;
-       if(endIndex == -1) {
-           setCurrentBlockState(1);
-           commentLength = text.length() - startIndex;
-       } else {
-           commentLength = endIndex - startIndex + endExpression.matchedLength();
-       }
-       setFormat(startIndex, commentLength, Qt::darkGreen);
-       startIndex = text.indexOf(startExpression, startIndex + commentLength);
+    while(i < length) {
+        if(block >= 0) {
+            const Language::Block &open = language.blocks.at(block);
+            const QTextCharFormat &format = open.quote ? m_QuoteFormat : m_CommentFormat;
+            int end = text.indexOf(open.end, i);
+            if(end < 0) {
+                addSpan(blockStart, length - blockStart, format);
+                i = length;
+                break;
+            }
+            end += open.end.length();
+            addSpan(blockStart, end - blockStart, format);
+            block = -1;
+            i = end;
+            continue;
+        }
+
+        ushort c = data[i].unicode();
+        uchar starts = language.starts(c);
+
+        if(starts & Language::Start_Block) {
+            block = language.blockAt(data + i, length - i);
+            if(block >= 0) {
+                blockStart = i;
+                i += language.blocks.at(block).start.length();
+                continue;
+            }
+        }
+
+        if((starts & Language::Start_LineComment) && language.lineCommentAt(data + i, length - i)) {
+            addSpan(i, length - i, m_CommentFormat);
+            break;
+        }
+
+        if((starts & Language::Start_Quote) || (c == '<' && include)) {
+            ushort close = (c == '<') ? '>' : c;
+            ushort escape = (c == '<') ? 0 : language.escape;
+            int start = i++;
+            while(i < length && data[i].unicode() != close) {
+                if(escape && data[i].unicode() == escape) {
+                    ++i;
+                }
+                ++i;
+            }
+            i = qMin(i + 1, length);
+            addSpan(start, i - start, m_QuoteFormat);
+            include = false;
+            continue;
+        }
+
+        if(isIdentifierStart(c)) {
+            int start = i++;
+            while(i < length && isIdentifierPart(data[i].unicode())) {
+                ++i;
+            }
+
+            const QChar *word = data + start;
+            int wordLength = i - start;
+            if(language.hasSpecialPrefix(word, wordLength)) {
+                addSpan(start, wordLength, m_MpiFormat);
+            } else {
+                switch(language.keywords.find(word, wordLength)) {
+                case KeywordTable::Kind_Keyword:
+                    addSpan(start, wordLength, m_KeywordFormat);
+                    break;
+                case KeywordTable::Kind_DataType:
+                    addSpan(start, wordLength, m_DataTypeFormat);
+                    break;
+                case KeywordTable::Kind_Special:
+                    addSpan(start, wordLength, m_MpiFormat);
+                    break;
+                case KeywordTable::Kind_None:
+                    break;
+                }
+            }
+            continue;
+        }
+
+        if(c >= '0' && c <= '9') {
+            // Skip the whole number, so suffixes and hex digits aren't taken for identifiers
+            while(i < length && (isIdentifierPart(data[i].unicode()) || data[i].unicode() == '.')) {
+                ++i;
+            }
+            continue;
+        }
+
+        ++i;
     }
 
+    if(disabled) {
+        m_Spans.clear();
+        addSpan(0, length, m_DisabledFormat);
+    }
 
+    return (block + 1) | (disabledDepth << State_DisabledShift);
 }
 
 } // namespace SourceView
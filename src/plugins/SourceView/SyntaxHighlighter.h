@@ -25,30 +25,64 @@
 #define PLUGINS_SOURCEVIEW_SYNTAXHIGHLIGHTER_H
 
 #include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+#include <QTextLayout>
+#include <QVector>
+
+#include "SourceViewLibrary.h"
 
 namespace Plugins {
 namespace SourceView {
 
-class SyntaxHighlighter : public QSyntaxHighlighter
+class Language;
+
+class SOURCEVIEW_EXPORT SyntaxHighlighter : public QSyntaxHighlighter
 {
     Q_OBJECT
 public:
     explicit SyntaxHighlighter(QTextDocument *parent);
+    explicit SyntaxHighlighter(QObject *parent = 0);
 
-    void init();
+    QString language() const;
+    bool setLanguage(const QString &name);
 
+    int highlightLine(const QString &text, int state, QList<QTextLayout::FormatRange> &formats);
+
+protected:
     void highlightBlock(const QString &text);
 
 private:
-    QRegExp m_Keywords;
-    QRegExp m_DataTypes;
+    void init();
+    int lex(const QString &text, int state);
+
+    struct Span {
+        int start;
+        int length;
+        const QTextCharFormat *format;
+    };
+
+    inline void addSpan(int start, int length, const QTextCharFormat &format)
+    {
+        Span span = { start, length, &format };
+        m_Spans.append(span);
+    }
+
+    const Language *m_Language;
+    QVector<Span> m_Spans;
+
+    QTextCharFormat m_KeywordFormat;
+    QTextCharFormat m_DataTypeFormat;
+    QTextCharFormat m_MpiFormat;
+    QTextCharFormat m_PreprocessorFormat;
+    QTextCharFormat m_QuoteFormat;
+    QTextCharFormat m_CommentFormat;
+    QTextCharFormat m_DisabledFormat;
 
+    /* A block's state holds which of the language's multi-line comments or quotes it ends inside of, plus one, and
+       how deep inside an "#if 0" it ends */
     enum States {
-        State_NormalState = -1,
-        State_InsideComment,
-        State_InsideDoubleQuote,
-        State_InsideSingleQuote,
-        State_InsideAngleBracketQuote
+        State_BlockMask = 0x7,
+        State_DisabledShift = 3
     };
 
 };
@@ -0,0 +1,241 @@
+/*!
+   \file ViewportHighlighter.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ViewportHighlighter.h"
+
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QTime>
+#include <QVariant>
+
+#include "SourceView.h"
+#include "SyntaxHighlighter.h"
+
+namespace Plugins {
+namespace SourceView {
+
+/* Dynamic properties of the document: whether its lines hold a ViewportHighlighter's states, and whether one is
+   applying formats to it, which the others highlighting the same shared document must ignore */
+static const char *HighlightedProperty = "ViewportHighlighted";
+static const char *ApplyingProperty = "ViewportHighlighterApplying";
+
+/*! \class Plugins::SourceView::ViewportHighlighter
+    \internal
+    \brief Highlights a SourceView's visible lines, and a few past them, as they come into view; the rest of the
+           document is highlighted in short slices whenever the event loop is idle.
+
+    Unlike a QSyntaxHighlighter, nothing is highlighted when text is set, so the time to first show a document doesn't
+    grow with its size.  A line coming into view before the lines above it have been highlighted starts from the
+    state of the line above it, if known, and otherwise from the initial state.  The idle slices go through the
+    document in order, carrying the state forward, and highlight again any line that started from a different
+    state.
+ */
+
+ViewportHighlighter::ViewportHighlighter(SourceView *view, SyntaxHighlighter *highlighter) :
+    QObject(view),
+    m_View(view),
+    m_Highlighter(highlighter),
+    m_NextBlock(0)
+{
+    m_Timer.setInterval(0);
+    connect(&m_Timer, SIGNAL(timeout()), this, SLOT(highlightSlice()));
+
+    connect(view->document(), SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChanged(int,int,int)));
+    connect(view, SIGNAL(updateRequest(QRect,int)), this, SLOT(highlightVisibleBlocks()));
+
+    // A document another view highlighted only needs checking, in the idle slices
+    QTextDocument *document = view->document();
+    if(document->property(HighlightedProperty).toBool()) {
+        m_Timer.start();
+    } else {
+        document->setProperty(HighlightedProperty, true);
+        rehighlight();
+    }
+}
+
+ViewportHighlighter::~ViewportHighlighter()
+{
+}
+
+/*! \fn ViewportHighlighter::forget()
+    \brief Marks \a document as no longer holding a ViewportHighlighter's states, for when something else is to
+           highlight it.
+ */
+void ViewportHighlighter::forget(QTextDocument *document)
+{
+    document->setProperty(HighlightedProperty, QVariant());
+}
+
+/*! \fn ViewportHighlighter::rehighlight()
+    \brief Forgets every line's highlighting, and starts over.
+ */
+void ViewportHighlighter::rehighlight()
+{
+    QTextDocument *document = m_View->document();
+    contentsChanged(0, 0, document->characterCount());
+}
+
+/*! \fn ViewportHighlighter::highlightVisibleBlocks()
+    \brief Highlights the visible lines and the look-ahead past them, where they aren't already highlighted from the
+           state the line above them ended in.
+ */
+void ViewportHighlighter::highlightVisibleBlocks()
+{
+    if(applying()) {
+        return;
+    }
+
+    int lineHeight = qMax(1, m_View->fontMetrics().height());
+    int count = m_View->viewport()->height() / lineHeight + 1 + LookAhead;
+
+    QTextBlock first;
+    QTextBlock last;
+    QTextBlock block = m_View->firstVisibleBlock();
+    for(int i = 0; i < count && block.isValid(); ++i, block = block.next()) {
+        if(highlight(block)) {
+            if(!first.isValid()) {
+                first = block;
+            }
+            last = block;
+        }
+    }
+
+    markDirty(first, last);
+}
+
+/*! \internal
+    \brief Drops the highlighting of the changed lines, and has the idle slices go through the document again from the
+           first of them.
+ */
+void ViewportHighlighter::contentsChanged(int position, int removed, int added)
+{
+    Q_UNUSED(removed)
+
+    if(applying()) {
+        return;
+    }
+
+    QTextDocument *document = m_View->document();
+    QTextBlock block = document->findBlock(position);
+    if(!block.isValid()) {
+        block = document->lastBlock();
+    }
+    QTextBlock last = document->findBlock(position + added);
+
+    m_NextBlock = qMin(m_NextBlock, block.blockNumber());
+    for(; block.isValid(); block = block.next()) {
+        block.setUserState(-1);
+        if(block == last) {
+            break;
+        }
+    }
+
+    m_Timer.start();
+}
+
+/*! \internal
+    \brief Highlights lines in document order for a few milliseconds, after first seeing to the visible ones.
+ */
+void ViewportHighlighter::highlightSlice()
+{
+    highlightVisibleBlocks();
+
+    QTime timer;
+    timer.start();
+
+    QTextBlock first;
+    QTextBlock last;
+    QTextBlock block = m_View->document()->findBlockByNumber(m_NextBlock);
+    while(block.isValid()) {
+        if(highlight(block)) {
+            if(!first.isValid()) {
+                first = block;
+            }
+            last = block;
+        }
+
+        block = block.next();
+        ++m_NextBlock;
+
+        if((m_NextBlock & 0xff) == 0 && timer.elapsed() >= SliceTime) {
+            break;
+        }
+    }
+
+    markDirty(first, last);
+
+    if(!block.isValid()) {
+        m_Timer.stop();
+    }
+}
+
+/*! \internal
+    \brief Highlights \a block unless it's already highlighted from the state the line above it ended in; returns
+           whether it was.
+ */
+bool ViewportHighlighter::highlight(QTextBlock &block)
+{
+    int incoming = 0;
+    QTextBlock previous = block.previous();
+    if(previous.isValid() && previous.userState() >= 0) {
+        incoming = previous.userState() & State_OutgoingMask;
+    }
+
+    int state = block.userState();
+    if(state >= 0 && (state >> State_IncomingShift) == incoming) {
+        return false;
+    }
+
+    QList<QTextLayout::FormatRange> formats;
+    int outgoing = m_Highlighter->highlightLine(block.text(), incoming, formats);
+    block.setUserState((incoming << State_IncomingShift) | (outgoing & State_OutgoingMask));
+    block.layout()->setAdditionalFormats(formats);
+
+    return true;
+}
+
+/*! \internal
+    \brief Has the document lay out the lines from \a first to \a last again, to show their new formats.
+ */
+void ViewportHighlighter::markDirty(const QTextBlock &first, const QTextBlock &last)
+{
+    if(!first.isValid()) {
+        return;
+    }
+
+    QTextDocument *document = m_View->document();
+    document->setProperty(ApplyingProperty, true);
+    document->markContentsDirty(first.position(), last.position() + last.length() - first.position());
+    document->setProperty(ApplyingProperty, QVariant());
+}
+
+/*! \internal
+    \brief Whether the document is being laid out again to show new formats, rather than changed.
+ */
+bool ViewportHighlighter::applying() const
+{
+    return m_View->document()->property(ApplyingProperty).toBool();
+}
+
+} // namespace SourceView
+} // namespace Plugins
@@ -0,0 +1,83 @@
+/*!
+   \file ViewportHighlighter.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_SOURCEVIEW_VIEWPORTHIGHLIGHTER_H
+#define PLUGINS_SOURCEVIEW_VIEWPORTHIGHLIGHTER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QTextBlock>
+
+class QTextDocument;
+
+namespace Plugins {
+namespace SourceView {
+
+class SourceView;
+class SyntaxHighlighter;
+
+class ViewportHighlighter : public QObject
+{
+    Q_OBJECT
+public:
+    ViewportHighlighter(SourceView *view, SyntaxHighlighter *highlighter);
+    ~ViewportHighlighter();
+
+    static void forget(QTextDocument *document);
+
+public slots:
+    void rehighlight();
+    void highlightVisibleBlocks();
+
+protected slots:
+    void contentsChanged(int position, int removed, int added);
+    void highlightSlice();
+
+private:
+    bool highlight(QTextBlock &block);
+    void markDirty(const QTextBlock &first, const QTextBlock &last);
+    bool applying() const;
+
+    SourceView *m_View;
+    SyntaxHighlighter *m_Highlighter;
+
+    QTimer m_Timer;
+    int m_NextBlock;
+
+    /* A highlighted block's user state holds both the state it started in and the state it ended in */
+    enum States {
+        State_IncomingShift = 15,
+        State_OutgoingMask = 0x7fff
+    };
+
+    /* Lines highlighted past the last visible one, and how long an idle slice goes on, in milliseconds */
+    enum {
+        LookAhead = 50,
+        SliceTime = 10
+    };
+};
+
+} // namespace SourceView
+} // namespace Plugins
+
+#endif // PLUGINS_SOURCEVIEW_VIEWPORTHIGHLIGHTER_H
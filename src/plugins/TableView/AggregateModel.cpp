@@ -0,0 +1,1181 @@
+/*!
+   \file AggregateModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AggregateModelPrivate.h"
+
+#include <QThread>
+#include <QVarLengthArray>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+
+namespace Plugins {
+namespace TableView {
+
+using Core::ViewManager::AbstractColumnarModel;
+
+/*! \class Plugins::TableView::AggregateModel
+    \brief Groups the rows of a source model by the values of one or more of its columns, such as functions by module,
+           rank or node, with a row per group.
+
+    Each group row holds the group's keys, its row count, and for each value column the sum, percentage of the total
+    sum, minimum, maximum and mean of its values, as selected by setFunctions().  Value columns default to every
+    numeric column that isn't a group column.  Percentage columns have a '%' in their titles, so a Delegate draws them
+    as bars.
+
+    Grouping hashes the rows' key values.  The whole source is aggregated in parallel, a slice of rows per thread,
+    and the per-thread groups are merged afterwards; sources larger than asynchronousThreshold() are aggregated in the
+    background, while the old groups stay shown.  After that, rows the source inserts, removes or changes are folded
+    into the groups they belong to, rather than aggregating everything again.  Groups are listed in the order their
+    first row appears in the source.
+    \sa AggregateView
+ */
+
+AggregateModel::AggregateModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    d(new AggregateModelPrivate)
+{
+    d->q = this;
+    connect(&d->m_Watcher, SIGNAL(finished()), d.data(), SLOT(jobFinished()));
+    connect(&d->m_RestartTimer, SIGNAL(timeout()), d.data(), SLOT(restartJob()));
+}
+
+AggregateModel::~AggregateModel()
+{
+    d->cancelJob();
+}
+
+QAbstractItemModel *AggregateModel::sourceModel() const
+{
+    return d->m_SourceModel;
+}
+
+void AggregateModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if(d->m_SourceModel) {
+        disconnect(d->m_SourceModel, 0, d.data(), 0);
+    }
+
+    d->m_SourceModel = sourceModel;
+    d->m_Columnar = qobject_cast<AbstractColumnarModel *>(sourceModel);
+
+    if(sourceModel) {
+        connect(sourceModel, SIGNAL(modelReset()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(layoutChanged()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceRowsInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceRowsRemoved(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), d.data(), SLOT(sourceDataChanged(QModelIndex,QModelIndex)));
+    }
+
+    d->configure();
+}
+
+/*! \fn AggregateModel::groupColumns()
+    \brief The source columns rows are grouped by; with none, every row falls into a single group of grand totals.
+ */
+QList<int> AggregateModel::groupColumns() const
+{
+    return d->m_GroupColumns;
+}
+
+void AggregateModel::setGroupColumns(const QList<int> &columns)
+{
+    d->m_GroupColumns = columns;
+    d->configure();
+}
+
+/*! \fn AggregateModel::valueColumns()
+    \brief The source columns aggregated for each group; when empty, the default, every numeric column that isn't a
+           group column.
+ */
+QList<int> AggregateModel::valueColumns() const
+{
+    return d->m_ValueColumns;
+}
+
+void AggregateModel::setValueColumns(const QList<int> &columns)
+{
+    d->m_ValueColumns = columns;
+    d->configure();
+}
+
+/*! \fn AggregateModel::functions()
+    \brief The aggregates shown for each value column; all of them by default.  The row count of each group is always
+           shown.
+ */
+AggregateModel::Functions AggregateModel::functions() const
+{
+    return d->m_Functions;
+}
+
+void AggregateModel::setFunctions(Functions functions)
+{
+    d->m_Functions = functions;
+    d->configure(false);
+}
+
+/*! \fn AggregateModel::asynchronousThreshold()
+    \brief Sources with more rows than this are aggregated in the background; so are bigger insertions.
+    \sa isBusy() waitForFinished()
+ */
+int AggregateModel::asynchronousThreshold() const
+{
+    return d->m_AsynchronousThreshold;
+}
+
+void AggregateModel::setAsynchronousThreshold(int rows)
+{
+    d->m_AsynchronousThreshold = rows;
+}
+
+/*! \fn AggregateModel::isBusy()
+    \brief Whether the source is being aggregated in the background.
+ */
+bool AggregateModel::isBusy() const
+{
+    return !d->m_Job.isNull() || d->m_RestartTimer.isActive();
+}
+
+/*! \fn AggregateModel::waitForFinished()
+    \brief Blocks until any background aggregation has finished, and applies its groups.
+ */
+void AggregateModel::waitForFinished()
+{
+    if(d->m_RestartTimer.isActive()) {
+        d->m_RestartTimer.stop();
+        d->startJob(true);
+    }
+
+    if(d->m_Job.isNull()) {
+        return;
+    }
+
+    d->m_Watcher.waitForFinished();
+    d->jobFinished();
+}
+
+int AggregateModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_VisibleGroups;
+}
+
+int AggregateModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_Columns.count();
+}
+
+QVariant AggregateModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= d->m_VisibleGroups || index.column() >= d->m_Columns.count() ||
+            (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return QVariant();
+    }
+
+    const AggregateTable &table = d->m_Table;
+    const AggregateColumn &column = d->m_Columns.at(index.column());
+    int group = index.row();
+    int value = group * table.valueCount + column.index;
+
+    switch(column.kind) {
+    case AggregateColumn::Kind_Key:
+        return d->keyValue(column.index, table.groupKeys.at(group * table.keyCount + column.index));
+    case AggregateColumn::Kind_Count:
+        return QVariant((qlonglong)table.counts.at(group));
+    case AggregateColumn::Kind_Sum:
+        return QVariant(table.sums.at(value));
+    case AggregateColumn::Kind_PercentOfTotal:
+    {
+        double total = d->m_Totals.at(column.index);
+        return QVariant((total != 0.0) ? (table.sums.at(value) * 100.0) / total : 0.0);
+    }
+    case AggregateColumn::Kind_Min:
+        return table.valueCounts.at(value) ? QVariant(table.mins.at(value)) : QVariant();
+    case AggregateColumn::Kind_Max:
+        return table.valueCounts.at(value) ? QVariant(table.maxs.at(value)) : QVariant();
+    case AggregateColumn::Kind_Mean:
+        return table.valueCounts.at(value) ? QVariant(table.sums.at(value) / table.valueCounts.at(value)) : QVariant();
+    }
+
+    return QVariant();
+}
+
+QVariant AggregateModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole || section < 0 || section >= d->m_Columns.count()) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    const AggregateColumn &column = d->m_Columns.at(section);
+    if(column.kind == AggregateColumn::Kind_Count) {
+        return tr("Count");
+    }
+
+    QString title;
+    if(d->m_SourceModel) {
+        int sourceColumn = (column.kind == AggregateColumn::Kind_Key) ? d->m_Keys.at(column.index).column :
+                                                                        d->m_ActiveValueColumns.at(column.index);
+        title = d->m_SourceModel->headerData(sourceColumn, Qt::Horizontal).toString();
+    }
+
+    switch(column.kind) {
+    case AggregateColumn::Kind_Sum:
+        return tr("Sum of %1").arg(title);
+    case AggregateColumn::Kind_PercentOfTotal:
+        return tr("Sum of %1 (%)").arg(title);
+    case AggregateColumn::Kind_Min:
+        return tr("Min of %1").arg(title);
+    case AggregateColumn::Kind_Max:
+        return tr("Max of %1").arg(title);
+    case AggregateColumn::Kind_Mean:
+        return tr("Mean of %1").arg(title);
+    default:
+        return title;
+    }
+}
+
+
+
+
+static inline bool isCancelled(const QAtomicInt &flag)
+{
+#if QT_VERSION >= 0x050000
+    return flag.load() != 0;
+#else
+    return (int)flag != 0;
+#endif
+}
+
+static inline bool isNumeric(const QVariant &value)
+{
+    switch(value.userType()) {
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static inline quint64 doubleBits(double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline double bitsDouble(quint64 bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Below this many rows, aggregating on more than one thread isn't worth starting them */
+static const int ParallelRows = 65536;
+
+
+
+
+void AggregateRows::insert(int at, const AggregateRows &rows)
+{
+    for(int key = 0; key < keys.count(); ++key) {
+        keys[key].insert(at, rows.count, 0);
+        memcpy(keys[key].data() + at, rows.keys.at(key).constData(), rows.count * sizeof(quint64));
+    }
+    for(int value = 0; value < values.count(); ++value) {
+        values[value].insert(at, rows.count, 0.0);
+        memcpy(values[value].data() + at, rows.values.at(value).constData(), rows.count * sizeof(double));
+    }
+    count += rows.count;
+}
+
+void AggregateRows::remove(int at, int count)
+{
+    for(int key = 0; key < keys.count(); ++key) {
+        keys[key].remove(at, count);
+    }
+    for(int value = 0; value < values.count(); ++value) {
+        values[value].remove(at, count);
+    }
+    this->count -= count;
+}
+
+
+
+
+void AggregateTable::reset(int keyCount, int valueCount)
+{
+    this->keyCount = keyCount;
+    this->valueCount = valueCount;
+    groupKeys.clear();
+    firstRows.clear();
+    counts.clear();
+    valueCounts.clear();
+    sums.clear();
+    mins.clear();
+    maxs.clear();
+    buckets.fill(-1, 16);
+    mask = 15;
+}
+
+uint AggregateTable::hash(const quint64 *key) const
+{
+    uint h = 2166136261u;
+    for(int i = 0; i < keyCount; ++i) {
+        quint64 code = key[i];
+        code ^= code >> 33;
+        code *= Q_UINT64_C(0xff51afd7ed558ccd);
+        code ^= code >> 33;
+        h = (h ^ (uint)code) * 16777619u;
+    }
+    return h;
+}
+
+/* The bucket holding the group with this key, or the empty bucket it would go in */
+int AggregateTable::lookup(const quint64 *key, uint hash) const
+{
+    const int *bucket = buckets.constData();
+    const quint64 *keys = groupKeys.constData();
+    uint i = hash & mask;
+    while(bucket[i] >= 0) {
+        if(memcmp(keys + (qint64)bucket[i] * keyCount, key, keyCount * sizeof(quint64)) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return (int)i;
+}
+
+int AggregateTable::findOrInsert(const AggregateRows &rows, int row, int sourceRow)
+{
+    QVarLengthArray<quint64, 8> key(keyCount);
+    for(int i = 0; i < keyCount; ++i) {
+        key[i] = rows.keys.at(i).at(row);
+    }
+
+    int bucket = lookup(key.constData(), hash(key.constData()));
+    if(buckets.at(bucket) >= 0) {
+        return buckets.at(bucket);
+    }
+
+    int group = count();
+    for(int i = 0; i < keyCount; ++i) {
+        groupKeys.append(key[i]);
+    }
+    firstRows.append(sourceRow);
+    counts.append(0);
+    for(int i = 0; i < valueCount; ++i) {
+        valueCounts.append(0);
+        sums.append(0.0);
+        mins.append(std::numeric_limits<double>::infinity());
+        maxs.append(-std::numeric_limits<double>::infinity());
+    }
+
+    buckets[bucket] = group;
+    if((uint)count() * 2 > mask) {
+        grow();
+    }
+    return group;
+}
+
+void AggregateTable::add(int group, const AggregateRows &rows, int row)
+{
+    ++counts[group];
+    for(int value = 0; value < valueCount; ++value) {
+        double x = rows.values.at(value).at(row);
+        if(x == x) {
+            int i = group * valueCount + value;
+            ++valueCounts[i];
+            sums[i] += x;
+            mins[i] = qMin(mins.at(i), x);
+            maxs[i] = qMax(maxs.at(i), x);
+        }
+    }
+}
+
+/* Takes a row out of a group; returns true if it held one of the group's extremes, which then need finding again */
+bool AggregateTable::subtract(int group, const AggregateRows &rows, int row)
+{
+    bool stale = false;
+    --counts[group];
+    for(int value = 0; value < valueCount; ++value) {
+        double x = rows.values.at(value).at(row);
+        if(x == x) {
+            int i = group * valueCount + value;
+            --valueCounts[i];
+            sums[i] -= x;
+            stale = stale || x <= mins.at(i) || x >= maxs.at(i);
+        }
+    }
+    return stale;
+}
+
+void AggregateTable::resetExtremes(int group)
+{
+    for(int value = 0; value < valueCount; ++value) {
+        mins[group * valueCount + value] = std::numeric_limits<double>::infinity();
+        maxs[group * valueCount + value] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+void AggregateTable::addExtremes(int group, const AggregateRows &rows, int row)
+{
+    for(int value = 0; value < valueCount; ++value) {
+        double x = rows.values.at(value).at(row);
+        if(x == x) {
+            int i = group * valueCount + value;
+            mins[i] = qMin(mins.at(i), x);
+            maxs[i] = qMax(maxs.at(i), x);
+        }
+    }
+}
+
+/* Folds group \a group of another table into this one; returns the group it went into */
+int AggregateTable::merge(const AggregateTable &other, int group)
+{
+    const quint64 *key = other.groupKeys.constData() + (qint64)group * keyCount;
+    int bucket = lookup(key, hash(key));
+    int target = buckets.at(bucket);
+
+    if(target < 0) {
+        target = count();
+        for(int i = 0; i < keyCount; ++i) {
+            groupKeys.append(key[i]);
+        }
+        firstRows.append(other.firstRows.at(group));
+        counts.append(0);
+        for(int i = 0; i < valueCount; ++i) {
+            valueCounts.append(0);
+            sums.append(0.0);
+            mins.append(std::numeric_limits<double>::infinity());
+            maxs.append(-std::numeric_limits<double>::infinity());
+        }
+        buckets[bucket] = target;
+        if((uint)count() * 2 > mask) {
+            grow();
+        }
+    }
+
+    counts[target] += other.counts.at(group);
+    firstRows[target] = qMin(firstRows.at(target), other.firstRows.at(group));
+    for(int value = 0; value < valueCount; ++value) {
+        int from = group * valueCount + value;
+        int to = target * valueCount + value;
+        valueCounts[to] += other.valueCounts.at(from);
+        sums[to] += other.sums.at(from);
+        mins[to] = qMin(mins.at(to), other.mins.at(from));
+        maxs[to] = qMax(maxs.at(to), other.maxs.at(from));
+    }
+
+    return target;
+}
+
+/* Drops a group, moving later groups down; the caller rehashes once it is done removing */
+void AggregateTable::removeGroup(int group)
+{
+    groupKeys.remove(group * keyCount, keyCount);
+    firstRows.remove(group);
+    counts.remove(group);
+    valueCounts.remove(group * valueCount, valueCount);
+    sums.remove(group * valueCount, valueCount);
+    mins.remove(group * valueCount, valueCount);
+    maxs.remove(group * valueCount, valueCount);
+}
+
+void AggregateTable::rehash()
+{
+    uint size = 16;
+    while(size < (uint)count() * 2 + 2) {
+        size *= 2;
+    }
+
+    buckets.fill(-1, size);
+    mask = size - 1;
+    for(int group = 0; group < count(); ++group) {
+        const quint64 *key = groupKeys.constData() + (qint64)group * keyCount;
+        buckets[lookup(key, hash(key))] = group;
+    }
+}
+
+void AggregateTable::grow()
+{
+    rehash();
+}
+
+
+
+
+/* The rows one thread aggregates on its own, before the threads' groups are merged */
+struct AggregatePart
+{
+    AggregatePart() : rows(NULL), cancelled(NULL), first(0), last(0) {}
+
+    const AggregateRows *rows;
+    const QAtomicInt *cancelled;
+    int first;
+    int last;
+    AggregateTable table;
+    QVector<int> rowGroups;
+    QVector<int> merged;
+};
+
+static void aggregatePart(AggregatePart &part)
+{
+    part.table.reset(part.rows->keys.count(), part.rows->values.count());
+    part.rowGroups.resize(part.last - part.first);
+
+    for(int row = part.first; row < part.last; ++row) {
+        if((row & 0xffff) == 0 && isCancelled(*part.cancelled)) {
+            return;
+        }
+        int group = part.table.findOrInsert(*part.rows, row, row);
+        part.table.add(group, *part.rows, row);
+        part.rowGroups[row - part.first] = group;
+    }
+}
+
+static void translatePart(AggregatePart &part)
+{
+    int *groups = part.rowGroups.data();
+    const int *merged = part.merged.constData();
+    for(int i = 0; i < part.rowGroups.count(); ++i) {
+        groups[i] = merged[groups[i]];
+    }
+}
+
+
+
+
+AggregateModelPrivate::AggregateModelPrivate() :
+    QObject(NULL),
+    m_Columnar(NULL),
+    m_Functions(AggregateModel::Function_All),
+    m_AsynchronousThreshold(10000),
+    m_VisibleGroups(0),
+    m_Dirty(false),
+    m_Changed(false)
+{
+    m_RestartTimer.setSingleShot(true);
+    m_RestartTimer.setInterval(0);
+}
+
+AggregateModelPrivate::~AggregateModelPrivate()
+{
+}
+
+/*!
+   \internal
+   \brief Works out how each group column is read, which columns are aggregated and the columns of the model; then,
+          unless only the functions changed, aggregates the source again.
+ */
+void AggregateModelPrivate::configure(bool recompute)
+{
+    q->beginResetModel();
+
+    if(recompute) {
+        cancelJob();
+        m_RestartTimer.stop();
+
+        m_Keys.clear();
+        m_ActiveValueColumns.clear();
+        m_Rows = AggregateRows();
+        m_RowGroups.clear();
+        m_GroupRows.clear();
+        m_Table.reset(0, 0);
+        m_Totals.clear();
+        m_DirtyGroups.clear();
+        m_VisibleGroups = 0;
+
+        int columnCount = m_SourceModel ? m_SourceModel->columnCount() : 0;
+        foreach(int column, m_GroupColumns) {
+            if(column < 0 || column >= columnCount) {
+                continue;
+            }
+            AggregateKey key;
+            key.column = column;
+            if(m_Columnar) {
+                switch(m_Columnar->columnType(column)) {
+                case AbstractColumnarModel::ColumnType_Int64:
+                    key.kind = AggregateKey::Kind_Int64;
+                    break;
+                case AbstractColumnarModel::ColumnType_Double:
+                    key.kind = AggregateKey::Kind_Double;
+                    break;
+                case AbstractColumnarModel::ColumnType_String:
+                    key.kind = AggregateKey::Kind_ColumnarString;
+                    break;
+                }
+            }
+            m_Keys.append(key);
+        }
+
+        if(!m_ValueColumns.isEmpty()) {
+            foreach(int column, m_ValueColumns) {
+                if(column >= 0 && column < columnCount) {
+                    m_ActiveValueColumns.append(column);
+                }
+            }
+        } else {
+            for(int column = 0; column < columnCount; ++column) {
+                if(m_GroupColumns.contains(column)) {
+                    continue;
+                }
+                bool numeric = false;
+                if(m_Columnar) {
+                    numeric = (m_Columnar->columnType(column) != AbstractColumnarModel::ColumnType_String);
+                } else if(m_SourceModel->rowCount() > 0) {
+                    numeric = isNumeric(m_SourceModel->index(0, column).data());
+                }
+                if(numeric) {
+                    m_ActiveValueColumns.append(column);
+                }
+            }
+        }
+
+        m_Table.reset(m_Keys.count(), m_ActiveValueColumns.count());
+        m_Totals.fill(0.0, m_ActiveValueColumns.count());
+    }
+
+    m_Columns.clear();
+    if(m_SourceModel) {
+        for(int key = 0; key < m_Keys.count(); ++key) {
+            m_Columns.append(AggregateColumn(AggregateColumn::Kind_Key, key));
+        }
+        m_Columns.append(AggregateColumn(AggregateColumn::Kind_Count));
+        for(int value = 0; value < m_ActiveValueColumns.count(); ++value) {
+            if(m_Functions & AggregateModel::Function_Sum) {
+                m_Columns.append(AggregateColumn(AggregateColumn::Kind_Sum, value));
+            }
+            if(m_Functions & AggregateModel::Function_PercentOfTotal) {
+                m_Columns.append(AggregateColumn(AggregateColumn::Kind_PercentOfTotal, value));
+            }
+            if(m_Functions & AggregateModel::Function_Min) {
+                m_Columns.append(AggregateColumn(AggregateColumn::Kind_Min, value));
+            }
+            if(m_Functions & AggregateModel::Function_Max) {
+                m_Columns.append(AggregateColumn(AggregateColumn::Kind_Max, value));
+            }
+            if(m_Functions & AggregateModel::Function_Mean) {
+                m_Columns.append(AggregateColumn(AggregateColumn::Kind_Mean, value));
+            }
+        }
+    }
+
+    q->endResetModel();
+
+    if(recompute) {
+        startJob();
+    }
+}
+
+/*!
+   \internal
+   \brief Reads the key codes and values of \a count source rows from \a first, on the GUI thread.  The typed columns
+          of a columnar model are copied as they are; text keys are interned.
+ */
+void AggregateModelPrivate::readRows(int first, int count, AggregateRows &rows)
+{
+    rows.count = count;
+    rows.keys.resize(m_Keys.count());
+    rows.values.resize(m_ActiveValueColumns.count());
+
+    for(int key = 0; key < m_Keys.count(); ++key) {
+        AggregateKey &reader = m_Keys[key];
+        QVector<quint64> &codes = rows.keys[key];
+        codes.resize(count);
+
+        switch(reader.kind) {
+        case AggregateKey::Kind_Int64:
+            memcpy(codes.data(), m_Columnar->int64Column(reader.column) + first, count * sizeof(quint64));
+            break;
+        case AggregateKey::Kind_Double:
+            memcpy(codes.data(), m_Columnar->doubleColumn(reader.column) + first, count * sizeof(quint64));
+            break;
+        case AggregateKey::Kind_ColumnarString:
+        {
+            const quint32 *ids = m_Columnar->stringColumn(reader.column) + first;
+            for(int row = 0; row < count; ++row) {
+                codes[row] = ids[row];
+            }
+            break;
+        }
+        case AggregateKey::Kind_Text:
+            for(int row = 0; row < count; ++row) {
+                QString text = m_SourceModel->index(first + row, reader.column).data().toString();
+                QHash<QString, quint32>::const_iterator id = reader.ids.constFind(text);
+                if(id == reader.ids.constEnd()) {
+                    id = reader.ids.insert(text, reader.texts.count());
+                    reader.texts.append(text);
+                }
+                codes[row] = id.value();
+            }
+            break;
+        }
+    }
+
+    for(int value = 0; value < m_ActiveValueColumns.count(); ++value) {
+        int column = m_ActiveValueColumns.at(value);
+        QVector<double> &values = rows.values[value];
+        values.resize(count);
+
+        if(m_Columnar) {
+            switch(m_Columnar->columnType(column)) {
+            case AbstractColumnarModel::ColumnType_Int64:
+            {
+                const qint64 *source = m_Columnar->int64Column(column) + first;
+                for(int row = 0; row < count; ++row) {
+                    values[row] = (double)source[row];
+                }
+                break;
+            }
+            case AbstractColumnarModel::ColumnType_Double:
+                memcpy(values.data(), m_Columnar->doubleColumn(column) + first, count * sizeof(double));
+                break;
+            case AbstractColumnarModel::ColumnType_String:
+                values.fill(std::numeric_limits<double>::quiet_NaN());
+                break;
+            }
+        } else {
+            for(int row = 0; row < count; ++row) {
+                QVariant data = m_SourceModel->index(first + row, column).data();
+                values[row] = isNumeric(data) ? data.toDouble() : std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Turns a key code back into the value it stands for.
+ */
+QVariant AggregateModelPrivate::keyValue(int key, quint64 code) const
+{
+    const AggregateKey &reader = m_Keys.at(key);
+    switch(reader.kind) {
+    case AggregateKey::Kind_Int64:
+        return QVariant((qlonglong)code);
+    case AggregateKey::Kind_Double:
+        return QVariant(bitsDouble(code));
+    case AggregateKey::Kind_ColumnarString:
+        return m_SourceModel ? QVariant(m_Columnar->internedString((quint32)code)) : QVariant();
+    case AggregateKey::Kind_Text:
+        return reader.texts.value((int)code);
+    }
+    return QVariant();
+}
+
+/*!
+   \internal
+   \brief Reads every source row, and aggregates them; on a worker if there are more than the asynchronous threshold.
+ */
+void AggregateModelPrivate::startJob(bool synchronous)
+{
+    cancelJob();
+
+    if(!m_SourceModel) {
+        return;
+    }
+
+    QSharedPointer<AggregateJob> job(new AggregateJob);
+    m_Rows = AggregateRows();
+    readRows(0, m_SourceModel->rowCount(), m_Rows);
+    job->rows = m_Rows;
+
+    if(synchronous || job->rows.count <= m_AsynchronousThreshold) {
+        runJob(job);
+        applyJob(job);
+        return;
+    }
+
+    m_Job = job;
+    m_Watcher.setFuture(QtConcurrent::run(&AggregateModelPrivate::runJob, job));
+    emit q->busyChanged(true);
+}
+
+void AggregateModelPrivate::cancelJob()
+{
+    if(m_Job.isNull()) {
+        return;
+    }
+
+    m_Job->cancelled.fetchAndStoreRelaxed(1);
+    m_Job.clear();
+    emit q->busyChanged(false);
+}
+
+/*!
+   \internal
+   \brief Worker side of a job: each thread hashes a slice of the rows into groups of its own, and the groups are then
+          merged in row order, so they keep the order their first rows appear in.  Touches nothing but the job.
+ */
+void AggregateModelPrivate::runJob(QSharedPointer<AggregateJob> job)
+{
+    const AggregateRows &rows = job->rows;
+    int threads = (rows.count < ParallelRows) ? 1 : qMax(1, QThread::idealThreadCount());
+
+    QVector<AggregatePart> parts(threads);
+    for(int i = 0; i < threads; ++i) {
+        parts[i].rows = &rows;
+        parts[i].cancelled = &job->cancelled;
+        parts[i].first = (int)(((qint64)rows.count * i) / threads);
+        parts[i].last = (int)(((qint64)rows.count * (i + 1)) / threads);
+    }
+    if(threads > 1) {
+        QtConcurrent::blockingMap(parts, aggregatePart);
+    } else {
+        aggregatePart(parts[0]);
+    }
+
+    if(isCancelled(job->cancelled)) {
+        return;
+    }
+
+    job->table.reset(rows.keys.count(), rows.values.count());
+    for(int i = 0; i < threads; ++i) {
+        AggregatePart &part = parts[i];
+        part.merged.resize(part.table.count());
+        for(int group = 0; group < part.table.count(); ++group) {
+            part.merged[group] = job->table.merge(part.table, group);
+        }
+    }
+    if(threads > 1) {
+        QtConcurrent::blockingMap(parts, translatePart);
+    } else {
+        translatePart(parts[0]);
+    }
+
+    job->rowGroups.resize(rows.count);
+    for(int i = 0; i < threads; ++i) {
+        const AggregatePart &part = parts.at(i);
+        memcpy(job->rowGroups.data() + part.first, part.rowGroups.constData(), part.rowGroups.count() * sizeof(int));
+    }
+
+    job->groupRows.resize(job->table.count());
+    for(int group = 0; group < job->table.count(); ++group) {
+        job->groupRows[group].reserve((int)job->table.counts.at(group));
+    }
+    for(int row = 0; row < rows.count; ++row) {
+        job->groupRows[job->rowGroups.at(row)].append(row);
+    }
+}
+
+void AggregateModelPrivate::restartJob()
+{
+    startJob();
+}
+
+void AggregateModelPrivate::jobFinished()
+{
+    if(m_Job.isNull() || !m_Watcher.future().isFinished()) {
+        return;
+    }
+
+    QSharedPointer<AggregateJob> job = m_Job;
+    m_Job.clear();
+
+    applyJob(job);
+    emit q->busyChanged(false);
+}
+
+/*!
+   \internal
+   \brief Swaps in the groups of a finished job.
+ */
+void AggregateModelPrivate::applyJob(const QSharedPointer<AggregateJob> &job)
+{
+    q->beginResetModel();
+
+    m_Table = job->table;
+    m_RowGroups = job->rowGroups;
+    m_GroupRows = job->groupRows;
+    m_DirtyGroups.fill(0, m_Table.count());
+
+    m_Totals.fill(0.0, m_Table.valueCount);
+    for(int group = 0; group < m_Table.count(); ++group) {
+        for(int value = 0; value < m_Table.valueCount; ++value) {
+            m_Totals[value] += m_Table.sums.at(group * m_Table.valueCount + value);
+        }
+    }
+
+    m_VisibleGroups = m_Table.count();
+    q->endResetModel();
+}
+
+/*!
+   \internal
+   \brief Adds source row \a row, already in m_Rows, to its group.
+ */
+void AggregateModelPrivate::addRow(int row)
+{
+    int group = m_Table.findOrInsert(m_Rows, row, row);
+    if(group >= m_DirtyGroups.count()) {
+        m_DirtyGroups.resize(group + 1);
+        m_DirtyGroups[group] = 0;
+        m_GroupRows.resize(group + 1);
+    }
+
+    m_Table.add(group, m_Rows, row);
+    m_Table.firstRows[group] = qMin(m_Table.firstRows.at(group), row);
+    m_RowGroups[row] = group;
+
+    QVector<int> &rows = m_GroupRows[group];
+    rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+
+    for(int value = 0; value < m_Table.valueCount; ++value) {
+        double x = m_Rows.values.at(value).at(row);
+        if(x == x) {
+            m_Totals[value] += x;
+        }
+    }
+    m_Changed = true;
+}
+
+/*!
+   \internal
+   \brief Takes source row \a row, still in m_Rows, out of its group; a group that loses an extreme is marked to
+          have its rows scanned again by finishUpdate().
+ */
+void AggregateModelPrivate::removeRow(int row)
+{
+    int group = m_RowGroups.at(row);
+    if(m_Table.subtract(group, m_Rows, row)) {
+        m_DirtyGroups[group] = 1;
+        m_Dirty = true;
+    }
+
+    QVector<int> &rows = m_GroupRows[group];
+    rows.erase(std::lower_bound(rows.begin(), rows.end(), row));
+    m_Table.firstRows[group] = rows.isEmpty() ? std::numeric_limits<int>::max() : rows.first();
+
+    for(int value = 0; value < m_Table.valueCount; ++value) {
+        double x = m_Rows.values.at(value).at(row);
+        if(x == x) {
+            m_Totals[value] -= x;
+        }
+    }
+    m_Changed = true;
+}
+
+/*!
+   \internal
+   \brief Moves the source rows from \a from on by \a count, negative for rows removed, in every group's row list
+          and first row.
+ */
+void AggregateModelPrivate::shiftGroupRows(int from, int count)
+{
+    for(int group = 0; group < m_GroupRows.count(); ++group) {
+        QVector<int> &rows = m_GroupRows[group];
+        int *row = std::lower_bound(rows.begin(), rows.end(), from);
+        for(int *end = rows.end(); row != end; ++row) {
+            *row += count;
+        }
+        if(m_Table.firstRows.at(group) >= from && m_Table.firstRows.at(group) != std::numeric_limits<int>::max()) {
+            m_Table.firstRows[group] += count;
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Finishes an incremental update: finds the extremes of groups that lost one from their own rows, drops
+          groups left empty, shows new groups and announces the changed values.
+ */
+void AggregateModelPrivate::finishUpdate()
+{
+    if(m_Dirty) {
+        for(int group = 0; group < m_Table.count(); ++group) {
+            if(m_DirtyGroups.at(group)) {
+                m_Table.resetExtremes(group);
+                foreach(int row, m_GroupRows.at(group)) {
+                    m_Table.addExtremes(group, m_Rows, row);
+                }
+            }
+        }
+        m_DirtyGroups.fill(0, m_Table.count());
+        m_Dirty = false;
+    }
+
+    if(m_Table.counts.contains(0)) {
+        QVector<int> renumbered(m_Table.count());
+        int next = 0;
+        for(int group = 0; group < m_Table.count(); ++group) {
+            renumbered[group] = m_Table.counts.at(group) ? next++ : -1;
+        }
+
+        for(int group = m_Table.count() - 1; group >= 0; --group) {
+            if(m_Table.counts.at(group)) {
+                continue;
+            }
+            if(group < m_VisibleGroups) {
+                q->beginRemoveRows(QModelIndex(), group, group);
+                m_Table.removeGroup(group);
+                m_GroupRows.remove(group);
+                --m_VisibleGroups;
+                q->endRemoveRows();
+            } else {
+                m_Table.removeGroup(group);
+                m_GroupRows.remove(group);
+            }
+        }
+
+        for(int row = 0; row < m_RowGroups.count(); ++row) {
+            m_RowGroups[row] = renumbered.at(m_RowGroups.at(row));
+        }
+        m_Table.rehash();
+        m_DirtyGroups.fill(0, m_Table.count());
+    }
+
+    if(m_Table.count() > m_VisibleGroups) {
+        q->beginInsertRows(QModelIndex(), m_VisibleGroups, m_Table.count() - 1);
+        m_VisibleGroups = m_Table.count();
+        q->endInsertRows();
+    }
+
+    // Every percentage moves with the totals, so every group is announced
+    if(m_Changed && m_VisibleGroups > 0) {
+        emit q->dataChanged(q->index(0, 0), q->index(m_VisibleGroups - 1, m_Columns.count() - 1));
+    }
+    m_Changed = false;
+}
+
+void AggregateModelPrivate::sourceReset()
+{
+    configure();
+}
+
+/*!
+   \internal
+   \brief Adds inserted rows to their groups, unless there are so many that aggregating everything in the
+          background is quicker.
+ */
+void AggregateModelPrivate::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if(parent.isValid()) {
+        return;
+    }
+
+    int count = last - first + 1;
+    if(!m_Job.isNull() || m_RestartTimer.isActive() || count > m_AsynchronousThreshold) {
+        cancelJob();
+        m_RestartTimer.start();
+        return;
+    }
+
+    AggregateRows inserted;
+    readRows(first, count, inserted);
+    m_Rows.insert(first, inserted);
+    m_RowGroups.insert(first, count, -1);
+
+    // Appended rows, the usual case, move nothing
+    if(first < m_Rows.count - count) {
+        shiftGroupRows(first, count);
+    }
+
+    for(int row = first; row <= last; ++row) {
+        addRow(row);
+    }
+    finishUpdate();
+}
+
+/*!
+   \internal
+   \brief Takes removed rows out of their groups.
+ */
+void AggregateModelPrivate::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if(parent.isValid()) {
+        return;
+    }
+
+    if(!m_Job.isNull() || m_RestartTimer.isActive()) {
+        cancelJob();
+        m_RestartTimer.start();
+        return;
+    }
+
+    int count = last - first + 1;
+    for(int row = first; row <= last; ++row) {
+        removeRow(row);
+    }
+
+    m_Rows.remove(first, count);
+    m_RowGroups.remove(first, count);
+    shiftGroupRows(last + 1, -count);
+    finishUpdate();
+}
+
+/*!
+   \internal
+   \brief Moves changed rows between groups, if a group or value column changed.
+ */
+void AggregateModelPrivate::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if(!topLeft.isValid() || !bottomRight.isValid() || topLeft.parent().isValid()) {
+        return;
+    }
+
+    bool relevant = false;
+    for(int column = topLeft.column(); column <= bottomRight.column() && !relevant; ++column) {
+        relevant = m_GroupColumns.contains(column) || m_ActiveValueColumns.contains(column);
+    }
+    if(!relevant) {
+        return;
+    }
+
+    if(!m_Job.isNull() || m_RestartTimer.isActive()) {
+        cancelJob();
+        m_RestartTimer.start();
+        return;
+    }
+
+    int first = topLeft.row();
+    int count = bottomRight.row() - first + 1;
+    AggregateRows changed;
+    readRows(first, count, changed);
+
+    for(int i = 0; i < count; ++i) {
+        int row = first + i;
+        removeRow(row);
+        for(int key = 0; key < m_Keys.count(); ++key) {
+            m_Rows.keys[key][row] = changed.keys.at(key).at(i);
+        }
+        for(int value = 0; value < m_ActiveValueColumns.count(); ++value) {
+            m_Rows.values[value][row] = changed.values.at(value).at(i);
+        }
+        addRow(row);
+    }
+    finishUpdate();
+}
+
+} // namespace TableView
+} // namespace Plugins
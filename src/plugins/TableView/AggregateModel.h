@@ -0,0 +1,88 @@
+/*!
+   \file AggregateModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_AGGREGATEMODEL_H
+#define PLUGINS_TABLEVIEW_AGGREGATEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+
+#include "TableViewLibrary.h"
+
+namespace Plugins {
+namespace TableView {
+
+class AggregateModelPrivate;
+
+class TABLEVIEW_EXPORT AggregateModel : public QAbstractTableModel
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(AggregateModel)
+    Q_DISABLE_COPY(AggregateModel)
+
+public:
+    enum Function {
+        Function_Sum            = 0x01,
+        Function_PercentOfTotal = 0x02,
+        Function_Min            = 0x04,
+        Function_Max            = 0x08,
+        Function_Mean           = 0x10,
+        Function_All            = 0x1f
+    };
+    Q_DECLARE_FLAGS(Functions, Function)
+
+    explicit AggregateModel(QObject *parent = 0);
+    ~AggregateModel();
+
+    QAbstractItemModel *sourceModel() const;
+    void setSourceModel(QAbstractItemModel *sourceModel);
+
+    QList<int> groupColumns() const;
+    void setGroupColumns(const QList<int> &columns);
+    QList<int> valueColumns() const;
+    void setValueColumns(const QList<int> &columns);
+    Functions functions() const;
+    void setFunctions(Functions functions);
+
+    int asynchronousThreshold() const;
+    void setAsynchronousThreshold(int rows);
+
+    bool isBusy() const;
+    void waitForFinished();
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+signals:
+    void busyChanged(bool busy);
+
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(AggregateModel::Functions)
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_AGGREGATEMODEL_H
@@ -0,0 +1,210 @@
+/*!
+   \file AggregateModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_AGGREGATEMODELPRIVATE_H
+#define PLUGINS_TABLEVIEW_AGGREGATEMODELPRIVATE_H
+
+#include "AggregateModel.h"
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include <ViewManager/AbstractColumnarModel.h>
+
+namespace Plugins {
+namespace TableView {
+
+/* The group keys and values of a run of source rows: a key code per row for each group column, and a value per row
+   (NaN where there is none) for each value column */
+struct AggregateRows
+{
+    AggregateRows() : count(0) {}
+
+    void insert(int at, const AggregateRows &rows);
+    void remove(int at, int count);
+
+    int count;
+    QVector<QVector<quint64> > keys;
+    QVector<QVector<double> > values;
+};
+
+/* Running totals per group, found by hashing their key codes */
+class AggregateTable
+{
+public:
+    AggregateTable() : keyCount(0), valueCount(0), mask(0) {}
+
+    void reset(int keyCount, int valueCount);
+    int count() const { return counts.count(); }
+
+    int findOrInsert(const AggregateRows &rows, int row, int sourceRow);
+    void add(int group, const AggregateRows &rows, int row);
+    bool subtract(int group, const AggregateRows &rows, int row);
+    void resetExtremes(int group);
+    void addExtremes(int group, const AggregateRows &rows, int row);
+    int merge(const AggregateTable &other, int group);
+    void removeGroup(int group);
+    void rehash();
+
+    int keyCount;
+    int valueCount;
+
+    QVector<quint64> groupKeys;
+    QVector<int> firstRows;
+    QVector<qint64> counts;
+    QVector<qint64> valueCounts;
+    QVector<double> sums;
+    QVector<double> mins;
+    QVector<double> maxs;
+
+private:
+    uint hash(const quint64 *key) const;
+    int lookup(const quint64 *key, uint hash) const;
+    void grow();
+
+    QVector<int> buckets;
+    uint mask;
+};
+
+/* What a worker needs to aggregate every row at once */
+struct AggregateJob
+{
+    AggregateRows rows;
+    QAtomicInt cancelled;
+
+    AggregateTable table;
+    QVector<int> rowGroups;
+    QVector<QVector<int> > groupRows;
+};
+
+/* How one group column's key codes are read, and turned back into values to show */
+struct AggregateKey
+{
+    enum Kind {
+        Kind_Int64,
+        Kind_Double,
+        Kind_ColumnarString,
+        Kind_Text
+    };
+
+    AggregateKey() : column(0), kind(Kind_Text) {}
+
+    int column;
+    Kind kind;
+    QHash<QString, quint32> ids;
+    QVector<QString> texts;
+};
+
+/* One column of the aggregate model */
+struct AggregateColumn
+{
+    enum Kind {
+        Kind_Key,
+        Kind_Count,
+        Kind_Sum,
+        Kind_PercentOfTotal,
+        Kind_Min,
+        Kind_Max,
+        Kind_Mean
+    };
+
+    AggregateColumn(Kind kind = Kind_Count, int index = 0) : kind(kind), index(index) {}
+
+    Kind kind;
+    int index;
+};
+
+class AggregateModelPrivate : public QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(AggregateModel)
+    Q_DISABLE_COPY(AggregateModelPrivate)
+
+public:
+    AggregateModelPrivate();
+    ~AggregateModelPrivate();
+
+    void configure(bool recompute = true);
+    void readRows(int first, int count, AggregateRows &rows);
+    QVariant keyValue(int key, quint64 code) const;
+
+    void startJob(bool synchronous = false);
+    void cancelJob();
+    void applyJob(const QSharedPointer<AggregateJob> &job);
+
+    void addRow(int row);
+    void removeRow(int row);
+    void shiftGroupRows(int from, int count);
+    void finishUpdate();
+
+    static void runJob(QSharedPointer<AggregateJob> job);
+
+protected slots:
+    void restartJob();
+    void jobFinished();
+    void sourceReset();
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    QPointer<QAbstractItemModel> m_SourceModel;
+    const Core::ViewManager::AbstractColumnarModel *m_Columnar;
+
+    QList<int> m_GroupColumns;
+    QList<int> m_ValueColumns;
+    QList<int> m_ActiveValueColumns;
+    AggregateModel::Functions m_Functions;
+    int m_AsynchronousThreshold;
+
+    QVector<AggregateKey> m_Keys;
+    QVector<AggregateColumn> m_Columns;
+
+    AggregateRows m_Rows;
+    QVector<int> m_RowGroups;
+
+    /* The source rows of each group, in order, so a group that loses an extreme is scanned again on its own */
+    QVector<QVector<int> > m_GroupRows;
+    AggregateTable m_Table;
+    QVector<double> m_Totals;
+    int m_VisibleGroups;
+
+    QVector<char> m_DirtyGroups;
+    bool m_Dirty;
+    bool m_Changed;
+
+    QSharedPointer<AggregateJob> m_Job;
+    QFutureWatcher<void> m_Watcher;
+    QTimer m_RestartTimer;
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_AGGREGATEMODELPRIVATE_H
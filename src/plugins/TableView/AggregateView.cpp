@@ -0,0 +1,127 @@
+/*!
+   \file AggregateView.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AggregateView.h"
+
+#include <QAction>
+#include <QHeaderView>
+#include <QMenu>
+
+namespace Plugins {
+namespace TableView {
+
+/*! \class Plugins::TableView::AggregateView
+    \brief A TableView of an AggregateModel over the model it is given: one row per group of that model's rows.
+
+    Rows are grouped by the first column at first; the context menu of the header picks the columns to group by.
+    \sa AggregateModel AggregateViewFactory
+ */
+
+AggregateView::AggregateView(QWidget *parent) :
+    TableView(parent)
+{
+    m_AggregateModel.setGroupColumns(QList<int>() << 0);
+
+    horizontalHeader()->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(horizontalHeader(), SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(headerMenuRequested(QPoint)));
+}
+
+AggregateView::~AggregateView()
+{
+}
+
+/*! \fn AggregateView::model()
+    \brief The model being aggregated, rather than the aggregate model shown.
+    \reimp TableView::model()
+    \sa aggregateModel()
+ */
+QAbstractItemModel *AggregateView::model() const
+{
+    return m_AggregateModel.sourceModel();
+}
+
+/*! \fn AggregateView::setModel()
+    \brief Aggregates \a model, and shows the groups.
+    \reimp TableView::setModel()
+ */
+void AggregateView::setModel(QAbstractItemModel *model)
+{
+    m_AggregateModel.setSourceModel(model);
+    TableView::setModel(&m_AggregateModel);
+}
+
+AggregateModel *AggregateView::aggregateModel()
+{
+    return &m_AggregateModel;
+}
+
+/*! \fn AggregateView::headerMenuRequested()
+    \brief Offers each column of the source model to group by.
+    \internal
+ */
+void AggregateView::headerMenuRequested(const QPoint &pos)
+{
+    QAbstractItemModel *source = m_AggregateModel.sourceModel();
+    if(!source) {
+        return;
+    }
+
+    QList<int> groupColumns = m_AggregateModel.groupColumns();
+
+    QMenu menu(this);
+    for(int column = 0; column < source->columnCount(); ++column) {
+        QAction *action = menu.addAction(tr("Group by %1").arg(source->headerData(column, Qt::Horizontal).toString()));
+        action->setCheckable(true);
+        action->setChecked(groupColumns.contains(column));
+        action->setData(column);
+        connect(action, SIGNAL(triggered()), this, SLOT(groupByTriggered()));
+    }
+
+    menu.exec(horizontalHeader()->mapToGlobal(pos));
+}
+
+/*! \fn AggregateView::groupByTriggered()
+    \brief Adds the column of the triggered menu entry to the group columns, or takes it away.
+    \internal
+ */
+void AggregateView::groupByTriggered()
+{
+    QAction *action = qobject_cast<QAction *>(sender());
+    if(!action) {
+        return;
+    }
+
+    QList<int> groupColumns = m_AggregateModel.groupColumns();
+    int column = action->data().toInt();
+    if(action->isChecked()) {
+        groupColumns.append(column);
+    } else {
+        groupColumns.removeAll(column);
+    }
+
+    m_AggregateModel.setGroupColumns(groupColumns);
+    resizeColumnsToContents();
+}
+
+} // namespace TableView
+} // namespace Plugins
@@ -0,0 +1,69 @@
+/*!
+   \file AggregateViewFactory.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "AggregateViewFactory.h"
+
+#include <QAbstractItemModel>
+
+#include <ViewManager/PagedModel.h>
+
+#include "AggregateView.h"
+
+namespace Plugins {
+namespace TableView {
+
+/*! \class Plugins::TableView::AggregateViewFactory
+    \brief Makes the "Aggregate View" available through the Core::ViewManager::ViewManager; registered by the
+           TableViewPlugin alongside its own "Table View".
+    \sa AggregateView
+ */
+
+AggregateViewFactory::AggregateViewFactory(QObject *parent) :
+    QObject(parent)
+{
+}
+
+QString AggregateViewFactory::viewName()
+{
+    return "Aggregate View";
+}
+
+bool AggregateViewFactory::viewHandles(QAbstractItemModel *model)
+{
+    /* Any table can be grouped, except one that only holds pages of its rows at a time */
+    return !qobject_cast<Core::ViewManager::PagedModel *>(model);
+}
+
+QAbstractItemView *AggregateViewFactory::viewWidget(QAbstractItemModel *model)
+{
+    if(!viewHandles(model)) {
+        return NULL;
+    }
+
+    AggregateView *aggregateView = new AggregateView();
+    aggregateView->setModel(model);
+    return aggregateView;
+}
+
+} // namespace TableView
+} // namespace Plugins
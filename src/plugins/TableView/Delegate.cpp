@@ -23,10 +23,16 @@
 
 #include "Delegate.h"
 
+#include <QAbstractProxyModel>
 #include <QApplication>
 #include <QHelpEvent>
+#include <QPainter>
 #include <QDebug>
 
+#include <string.h>
+
+#include <ViewManager/AbstractColumnarModel.h>
+
 namespace Plugins {
 namespace TableView {
 
@@ -40,52 +46,234 @@ namespace TableView {
     \brief Constructor.
  */
 Delegate::Delegate(QObject *parent) :
-    QStyledItemDelegate(parent)
+    QStyledItemDelegate(parent),
+    m_Model(NULL),
+    m_Columnar(NULL),
+    m_ColumnarResolved(false),
+    m_DisplayTexts(4096),
+    m_PercentBars(8 * 1024 * 1024)
 {
 }
 
 /*! \fn Delegate::paint()
     \brief Handles special case items (like percentage values).
+
+    Whether a column holds percentages (a '%' in its header) is looked up once per column and cached until the
+    model's header data, columns or layout change.  Percentage bars are rendered once per hundredth of a percent,
+    size and state, and then blitted from a pixmap cache.  When the view shows a columnar model, percentages are read
+    straight out of its double columns rather than through a QVariant.
     \reimp QStyledItemDelegate::paint()
-    \sa sizeHint() selected() deselected()
+    \sa sizeHint() selected() deselected() clearRenderCache()
  */
 void Delegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    QString headerTitle = index.model()->headerData(index.column(), Qt::Horizontal, Qt::DisplayRole).toString();
-    int indexDataType = index.data().userType();
-    if((indexDataType == QVariant::Double || indexDataType == QMetaType::Float) && headerTitle.contains("%")) {
-
-        // Draw the background first
-        QStyleOptionViewItemV4 opt = option;
-        initStyleOption(&opt, index);
-        opt.text = QString();
-        QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &opt, painter);
-
-        // Setup the progress bar
-        double progress = index.data().toDouble();
-        QStyleOptionProgressBarV2 progressBarOption;
-        progressBarOption.state = opt.state;
-        progressBarOption.palette = opt.palette;
-        progressBarOption.palette.setBrush(QPalette::WindowText, Qt::red);
-        progressBarOption.fontMetrics = opt.fontMetrics;
-        progressBarOption.minimum = 0;
-        progressBarOption.maximum = 100;
+    if(columnKind(index) == ColumnKind_Percent) {
+        bool isPercent = false;
+        double progress = 0.0;
+
+        QModelIndex sourceIndex;
+        if(const Core::ViewManager::AbstractColumnarModel *columnar = columnarModel(index, &sourceIndex)) {
+            if(const double *values = columnar->doubleColumn(sourceIndex.column())) {
+                progress = values[sourceIndex.row()];
+                isPercent = true;
+            }
+        } else {
+            QVariant data = index.data();
+            int indexDataType = data.userType();
+            if(indexDataType == QVariant::Double || indexDataType == QMetaType::Float) {
+                progress = data.toDouble();
+                isPercent = true;
+            }
+        }
+
+        if(isPercent) {
+            // Draw the background first
+            QStyleOptionViewItemV4 opt = option;
+            initStyleOption(&opt, index);
+            opt.text = QString();
+            QApplication::style()->drawControl(QStyle::CE_ItemViewItem, &opt, painter);
+
+            drawPercentBar(painter, opt, progress);
+            return;
+        }
+    }
+
+    QStyledItemDelegate::paint(painter, option, index);
+}
+
+/*! \fn Delegate::drawPercentBar()
+    \brief Draws a progress bar for a percentage value, using a cached rendering when possible.
+    \internal
+ */
+void Delegate::drawPercentBar(QPainter *painter, const QStyleOptionViewItemV4 &option, const double &progress) const
+{
+    // Setup the progress bar
+    QStyleOptionProgressBarV2 progressBarOption;
+    progressBarOption.state = option.state;
+    progressBarOption.palette = option.palette;
+    progressBarOption.palette.setBrush(QPalette::WindowText, Qt::red);
+    progressBarOption.fontMetrics = option.fontMetrics;
+    progressBarOption.minimum = 0;
+    progressBarOption.maximum = 100;
+    progressBarOption.textVisible = true;
+
+    // Don't exceed a maximum height, or it looks silly
+    QRect rect(option.rect);
+    QPoint center = rect.center();
+    rect.setHeight( ((rect.height() <= rect.width()/5)? rect.height(): rect.width()/5) );
+    rect.moveCenter(center);
+
+    // Bars are cached per hundredth of a percent (the precision of the text), size and the state bits that show
+    qint64 bucket = qRound64(progress * 100.0);
+    bool cacheable = (bucket >= 0 && bucket < (1 << 14) && rect.width() > 0 && rect.width() < (1 << 16) &&
+                      rect.height() > 0 && rect.height() < (1 << 12));
+
+    if(!cacheable) {
         progressBarOption.progress = (int)progress;
         progressBarOption.text = QString("%1%").arg(progress, 5, 'f', 2, QChar(0x2002));
-        progressBarOption.textVisible = true;
-
-        // Don't exceed a maximum height, or it looks silly
-        QRect rect(option.rect);
-        QPoint center = rect.center();
-        rect.setHeight( ((rect.height() <= rect.width()/5)? rect.height(): rect.width()/5) );
-        rect.moveCenter(center);
         progressBarOption.rect = rect;
-
         QApplication::style()->drawControl(QStyle::CE_ProgressBar, &progressBarOption, painter);
         return;
     }
 
-    QStyledItemDelegate::paint(painter, option, index);
+    quint64 state = 0;
+    if(option.state & QStyle::State_Enabled) { state |= 1; }
+    if(option.state & QStyle::State_Active) { state |= 2; }
+    if(option.state & QStyle::State_Selected) { state |= 4; }
+
+    quint64 key = (quint64)bucket | ((quint64)rect.width() << 14) | ((quint64)rect.height() << 30) | (state << 42);
+
+    QPixmap *pixmap = m_PercentBars.object(key);
+    if(!pixmap) {
+        double value = bucket / 100.0;
+        progressBarOption.progress = (int)value;
+        progressBarOption.text = QString("%1%").arg(value, 5, 'f', 2, QChar(0x2002));
+        progressBarOption.rect = QRect(QPoint(0, 0), rect.size());
+
+        pixmap = new QPixmap(rect.size());
+        pixmap->fill(Qt::transparent);
+        QPainter pixmapPainter(pixmap);
+        QApplication::style()->drawControl(QStyle::CE_ProgressBar, &progressBarOption, &pixmapPainter);
+        pixmapPainter.end();
+
+        QPixmap rendered = *pixmap;
+        if(!m_PercentBars.insert(key, pixmap, rect.width() * rect.height() * 4)) {
+            painter->drawPixmap(rect.topLeft(), rendered);
+            return;
+        }
+    }
+
+    painter->drawPixmap(rect.topLeft(), *pixmap);
+}
+
+/*! \fn Delegate::columnKind()
+    \brief Returns how cells in the column of \a index are rendered, reading the header only the first time.
+    \internal
+ */
+Delegate::ColumnKind Delegate::columnKind(const QModelIndex &index) const
+{
+    const QAbstractItemModel *model = index.model();
+    if(!model) {
+        return ColumnKind_Normal;
+    }
+
+    if(model != m_Model) {
+        if(m_Model) {
+            disconnect(m_Model, 0, this, 0);
+        }
+
+        m_Model = model;
+        m_ColumnKinds.clear();
+        m_ColumnarResolved = false;
+
+        connect(model, SIGNAL(headerDataChanged(Qt::Orientation,int,int)), this, SLOT(invalidateColumnKinds()));
+        connect(model, SIGNAL(modelReset()), this, SLOT(invalidateColumnKinds()));
+        connect(model, SIGNAL(layoutChanged()), this, SLOT(invalidateColumnKinds()));
+        connect(model, SIGNAL(columnsInserted(QModelIndex,int,int)), this, SLOT(invalidateColumnKinds()));
+        connect(model, SIGNAL(columnsRemoved(QModelIndex,int,int)), this, SLOT(invalidateColumnKinds()));
+        connect(model, SIGNAL(destroyed()), this, SLOT(modelDestroyed()));
+    }
+
+    int column = index.column();
+    if(column >= m_ColumnKinds.count()) {
+        m_ColumnKinds.resize(model->columnCount());
+        if(column >= m_ColumnKinds.count()) {
+            return ColumnKind_Normal;
+        }
+    }
+
+    if(m_ColumnKinds.at(column) == ColumnKind_Unknown) {
+        QString headerTitle = model->headerData(column, Qt::Horizontal, Qt::DisplayRole).toString();
+        m_ColumnKinds[column] = headerTitle.contains("%") ? ColumnKind_Percent : ColumnKind_Normal;
+    }
+
+    return (ColumnKind)m_ColumnKinds.at(column);
+}
+
+/*! \fn Delegate::columnarModel()
+    \brief Returns the Core::ViewManager::AbstractColumnarModel behind the model of \a index, looking through any
+           proxy models, and sets \a sourceIndex to the matching index in it; NULL if the data doesn't come from one.
+    \internal
+ */
+const Core::ViewManager::AbstractColumnarModel *Delegate::columnarModel(const QModelIndex &index, QModelIndex *sourceIndex) const
+{
+    if(!m_ColumnarResolved) {
+        m_Columnar = NULL;
+        const QAbstractItemModel *model = index.model();
+        while(const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel *>(model)) {
+            model = proxy->sourceModel();
+        }
+        m_Columnar = qobject_cast<const Core::ViewManager::AbstractColumnarModel *>(model);
+        m_ColumnarResolved = true;
+    }
+
+    if(!m_Columnar) {
+        return NULL;
+    }
+
+    QModelIndex source = index;
+    while(const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel *>(source.model())) {
+        source = proxy->mapToSource(source);
+    }
+
+    if(!source.isValid() || source.model() != m_Columnar) {
+        return NULL;
+    }
+
+    *sourceIndex = source;
+    return m_Columnar;
+}
+
+/*! \fn Delegate::invalidateColumnKinds()
+    \brief Forgets the cached column kinds, so they are looked up again from the header on the next paint.
+    \internal
+ */
+void Delegate::invalidateColumnKinds()
+{
+    m_ColumnKinds.clear();
+    m_ColumnarResolved = false;
+}
+
+/*! \fn Delegate::modelDestroyed()
+    \internal
+ */
+void Delegate::modelDestroyed()
+{
+    m_Model = NULL;
+    m_ColumnKinds.clear();
+    m_ColumnarResolved = false;
+}
+
+/*! \fn Delegate::clearRenderCache()
+    \brief Drops all cached column kinds, display strings and percentage bars.
+    Call this after changing the style, palette or font of the view.
+ */
+void Delegate::clearRenderCache()
+{
+    m_ColumnKinds.clear();
+    m_ColumnarResolved = false;
+    m_DisplayTexts.clear();
+    m_PercentBars.clear();
 }
 
 QSize Delegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
@@ -121,21 +309,56 @@ void Delegate::deselected(const QModelIndex &index)
     }
 }
 
+/*! \fn Delegate::displayText()
+    \brief Formats numbers with fixed precision and padding.
+    Formatted strings are kept in a least-recently-used cache keyed by value and format.
+    \reimp QStyledItemDelegate::displayText()
+ */
 QString Delegate::displayText(const QVariant &value, const QLocale& locale) const
 {
+    QPair<quint64, int> key;
     switch (value.userType()) {
     case QMetaType::Float:
     case QVariant::Double:
-        return QString("%1").arg(value.toDouble(), 10, 'f', 6, QChar(0x2002));
+    {
+        double number = value.toDouble();
+        memcpy(&key.first, &number, sizeof(number));
+        key.second = QVariant::Double;
+        break;
+    }
     case QVariant::Int:
     case QVariant::LongLong:
-        return QString("%1").arg(value.toLongLong(), 4, 10, QChar(0x2002));
+        key.first = (quint64)value.toLongLong();
+        key.second = QVariant::LongLong;
+        break;
     case QVariant::UInt:
     case QVariant::ULongLong:
-        return QString("%1").arg(value.toULongLong(), 4, 10, QChar(0x2002));
+        key.first = value.toULongLong();
+        key.second = QVariant::ULongLong;
+        break;
     default:
         return QStyledItemDelegate::displayText(value, locale);
     }
+
+    if(QString *text = m_DisplayTexts.object(key)) {
+        return *text;
+    }
+
+    QString text;
+    switch (key.second) {
+    case QVariant::Double:
+        text = QString("%1").arg(value.toDouble(), 10, 'f', 6, QChar(0x2002));
+        break;
+    case QVariant::LongLong:
+        text = QString("%1").arg(value.toLongLong(), 4, 10, QChar(0x2002));
+        break;
+    default:
+        text = QString("%1").arg(value.toULongLong(), 4, 10, QChar(0x2002));
+        break;
+    }
+
+    m_DisplayTexts.insert(key, new QString(text));
+    return text;
 }
 
 
@@ -26,9 +26,19 @@
 
 #include <QStyledItemDelegate>
 #include <QSet>
+#include <QVector>
+#include <QCache>
+#include <QPair>
+#include <QPixmap>
 
 #include "TableViewLibrary.h"
 
+namespace Core {
+namespace ViewManager {
+class AbstractColumnarModel;
+}
+}
+
 namespace Plugins {
 namespace TableView {
 
@@ -46,9 +56,32 @@ public slots:
     virtual void selected(const QModelIndex &index);
     virtual void deselected(const QModelIndex &index);
 
+    void clearRenderCache();
+
+protected slots:
+    void invalidateColumnKinds();
+    void modelDestroyed();
+
 protected:
+    enum ColumnKind {
+        ColumnKind_Unknown = 0,
+        ColumnKind_Normal,
+        ColumnKind_Percent
+    };
+
+    ColumnKind columnKind(const QModelIndex &index) const;
+    const Core::ViewManager::AbstractColumnarModel *columnarModel(const QModelIndex &index, QModelIndex *sourceIndex) const;
+    void drawPercentBar(QPainter *painter, const QStyleOptionViewItemV4 &option, const double &progress) const;
+
     QSet<QModelIndex> m_SelectedRows;
 
+    mutable const QAbstractItemModel *m_Model;
+    mutable QVector<char> m_ColumnKinds;
+    mutable const Core::ViewManager::AbstractColumnarModel *m_Columnar;
+    mutable bool m_ColumnarResolved;
+    mutable QCache<QPair<quint64, int>, QString> m_DisplayTexts;
+    mutable QCache<quint64, QPixmap> m_PercentBars;
+
 };
 
 } // namespace TableView
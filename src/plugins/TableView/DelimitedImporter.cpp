@@ -0,0 +1,979 @@
+/*!
+   \file DelimitedImporter.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DelimitedImporterPrivate.h"
+
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+
+#include <CoreWindow/CoreWindow.h>
+
+#include <limits>
+#include <string.h>
+
+namespace Plugins {
+namespace TableView {
+
+using Core::ViewManager::AbstractColumnarModel;
+using Core::ViewManager::ColumnarModel;
+
+/*! \class Plugins::TableView::DelimitedImporter
+    \brief Imports comma, tab or semicolon separated text, such as the CSV exports of other profilers, into a
+           Core::ViewManager::ColumnarModel for a TableView.
+
+    The text is split into chunks at line boundaries (quoted fields may span lines), and the chunks are parsed on all
+    cores at once.  Each column is stored as integers if every value in it is one, as doubles if every value is a
+    number or empty (empty fields being NaN, which the model shows as no value), and as interned strings otherwise.  Chunks are appended to model() in order as soon as they are parsed,
+    so the first rows show while the rest of the file is still being read.  Should a later chunk need a column to be
+    widened (a string in a column of numbers, say), the model is rebuilt with the wider type once parsing is done.
+
+    Progress is shown in the main window's status bar, through Core::CoreWindow::CoreWindow::addProgressBar(), and
+    reported through progressChanged().  Cancelling keeps the rows already imported.
+    \code
+    DelimitedImporter *importer = new DelimitedImporter(this);
+    tableView->setModel(importer->model());
+    importer->start(fileName);
+    \endcode
+    \sa Core::ViewManager::ColumnarModel TableView
+ */
+
+DelimitedImporter::DelimitedImporter(QObject *parent) :
+    QObject(parent),
+    d(new DelimitedImporterPrivate)
+{
+    d->q = this;
+    d->m_Model = new ColumnarModel(this);
+
+    connect(&d->m_Watcher, SIGNAL(finished()), d.data(), SLOT(jobFinished()));
+    connect(&d->m_PollTimer, SIGNAL(timeout()), d.data(), SLOT(appendParsedChunks()));
+}
+
+DelimitedImporter::~DelimitedImporter()
+{
+    cancel();
+    d->m_Watcher.waitForFinished();
+    d->end(false);
+}
+
+/*! \fn DelimitedImporter::delimiter()
+    \brief The field delimiter; zero, the default, picks whichever of comma, tab or semicolon is most common in the
+           first line.
+ */
+char DelimitedImporter::delimiter() const
+{
+    return d->m_Delimiter;
+}
+
+void DelimitedImporter::setDelimiter(char delimiter)
+{
+    d->m_Delimiter = delimiter;
+}
+
+/*! \fn DelimitedImporter::hasHeader()
+    \brief Whether the first line holds the column names; true by default.
+ */
+bool DelimitedImporter::hasHeader() const
+{
+    return d->m_HasHeader;
+}
+
+void DelimitedImporter::setHasHeader(bool hasHeader)
+{
+    d->m_HasHeader = hasHeader;
+}
+
+/*! \fn DelimitedImporter::progressVisible()
+    \brief Whether a progress bar is shown in the main window's status bar while importing; true by default.
+ */
+bool DelimitedImporter::progressVisible() const
+{
+    return d->m_ProgressVisible;
+}
+
+void DelimitedImporter::setProgressVisible(bool visible)
+{
+    d->m_ProgressVisible = visible;
+}
+
+/*! \fn DelimitedImporter::start()
+    \brief Starts importing \a fileName in the background, replacing the contents of model().  The file is memory
+           mapped rather than read.  Any import already running is cancelled first.
+ */
+bool DelimitedImporter::start(const QString &fileName)
+{
+    cancel();
+    d->m_Watcher.waitForFinished();
+    d->end(false);
+    d->reset();
+
+    d->m_File.setFileName(fileName);
+    if(!d->m_File.open(QIODevice::ReadOnly)) {
+        d->m_ErrorString = d->m_File.errorString();
+        return false;
+    }
+
+    d->m_Source.size = d->m_File.size();
+    if(d->m_Source.size > 0) {
+        d->m_Source.data = (const char *)d->m_File.map(0, d->m_Source.size);
+        if(!d->m_Source.data) {
+            d->m_ErrorString = d->m_File.errorString();
+            d->m_File.close();
+            return false;
+        }
+    }
+
+    return d->begin();
+}
+
+/*! \fn DelimitedImporter::start()
+    \brief Starts importing \a text, such as the contents of the clipboard, in the background.
+ */
+bool DelimitedImporter::start(const QByteArray &text)
+{
+    cancel();
+    d->m_Watcher.waitForFinished();
+    d->end(false);
+    d->reset();
+
+    d->m_Text = text;
+    d->m_Source.data = d->m_Text.constData();
+    d->m_Source.size = d->m_Text.size();
+
+    return d->begin();
+}
+
+bool DelimitedImporter::isRunning() const
+{
+    return d->m_Running;
+}
+
+/*! \fn DelimitedImporter::waitForFinished()
+    \brief Blocks until the import has finished, and returns whether it succeeded.
+ */
+bool DelimitedImporter::waitForFinished()
+{
+    while(d->m_Running) {
+        d->m_Watcher.waitForFinished();
+        d->jobFinished();
+    }
+    return d->m_ErrorString.isEmpty();
+}
+
+/*! \fn DelimitedImporter::model()
+    \brief The model the text is imported into; it belongs to the importer, and is reused by every import.
+ */
+ColumnarModel *DelimitedImporter::model() const
+{
+    return d->m_Model;
+}
+
+QString DelimitedImporter::errorString() const
+{
+    return d->m_ErrorString;
+}
+
+/*! \fn DelimitedImporter::cancel()
+    \brief Stops the import as soon as the workers notice, keeping the rows already in the model.
+ */
+void DelimitedImporter::cancel()
+{
+    d->m_Source.cancelled.fetchAndStoreOrdered(1);
+}
+
+
+
+
+static inline bool isSet(const QAtomicInt &flag)
+{
+#if QT_VERSION >= 0x050000
+    return flag.loadAcquire() != 0;
+#else
+    return (int)flag != 0;
+#endif
+}
+
+/* Chunks are a few megabytes; enough to keep every core busy without holding many unappended rows */
+static const qint64 ChunkSize = 4 * 1024 * 1024;
+
+/* How often the GUI thread picks up parsed chunks, in milliseconds */
+static const int PollInterval = 50;
+
+static const double PowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(char c)
+{
+    return (unsigned)(c - '0') <= 9;
+}
+
+static bool parseInteger(const char *text, int length, qint64 *value)
+{
+    int i = 0;
+    bool negative = false;
+    if(i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = (text[i] == '-');
+        ++i;
+    }
+    if(i == length || length - i > 18) {
+        return false;
+    }
+
+    qint64 result = 0;
+    for(; i < length; ++i) {
+        if(!isDigit(text[i])) {
+            return false;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
+
+/* Numbers of up to 15 significant digits with a small exponent convert exactly with one multiplication or division;
+   anything else goes through Qt's (locale independent) conversion */
+static bool parseDouble(const char *text, int length, double *value)
+{
+    int i = 0;
+    bool negative = false;
+    if(i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = (text[i] == '-');
+        ++i;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    bool exact = true;
+
+    for(; i < length && isDigit(text[i]); ++i) {
+        any = true;
+        if(digits < 19) {
+            mantissa = mantissa * 10 + (text[i] - '0');
+            digits += (mantissa != 0) ? 1 : 0;
+        } else {
+            ++exponent;
+            exact = false;
+        }
+    }
+    if(i < length && text[i] == '.') {
+        for(++i; i < length && isDigit(text[i]); ++i) {
+            any = true;
+            if(digits < 19) {
+                mantissa = mantissa * 10 + (text[i] - '0');
+                digits += (mantissa != 0) ? 1 : 0;
+                --exponent;
+            } else {
+                exact = false;
+            }
+        }
+    }
+    if(!any) {
+        return false;
+    }
+
+    if(i < length && (text[i] == 'e' || text[i] == 'E')) {
+        bool negativeExponent = false;
+        if(++i < length && (text[i] == '-' || text[i] == '+')) {
+            negativeExponent = (text[i] == '-');
+            ++i;
+        }
+        int e = 0;
+        bool exponentDigits = false;
+        for(; i < length && isDigit(text[i]); ++i) {
+            e = qMin(e * 10 + (text[i] - '0'), 100000);
+            exponentDigits = true;
+        }
+        if(!exponentDigits) {
+            return false;
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if(i != length) {
+        return false;
+    }
+
+    if(exact && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double result = (double)mantissa;
+        result = (exponent < 0) ? result / PowersOfTen[-exponent] : result * PowersOfTen[exponent];
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    bool ok = false;
+    *value = QByteArray(text, length).toDouble(&ok);
+    return ok;
+}
+
+/*
+   Calls visitor.field(row, column, offset, length, quoted) for every field of every non-blank line starting in
+   [begin, end), and a zero length field for each column a short line is missing.  A source without a column count
+   yet (while reading the first line) gets every field.  Stops after maxRows rows, or when
+   the import is cancelled, and returns the offset just past the last line read.
+ */
+template <typename Visitor>
+static qint64 scanRows(const ImportSource &source, qint64 begin, qint64 end, int maxRows, Visitor &visitor)
+{
+    const char *data = source.data;
+    const char delimiter = source.delimiter;
+    const int columns = source.columnCount;
+
+    qint64 pos = begin;
+    int row = 0;
+    while(pos < end && row < maxRows) {
+        if((row & 0xfff) == 0 && row > 0 && isSet(source.cancelled)) {
+            break;
+        }
+
+        // Skip blank lines
+        if(data[pos] == '\n') {
+            ++pos;
+            continue;
+        }
+        if(data[pos] == '\r' && pos + 1 < end && data[pos + 1] == '\n') {
+            pos += 2;
+            continue;
+        }
+
+        const char *found = (const char *)memchr(data + pos, '\n', end - pos);
+        qint64 lineEnd = found ? (found - data) : end;
+
+        int column = 0;
+        forever {
+            qint64 fieldStart = pos;
+            qint64 fieldEnd;
+            bool quoted = false;
+
+            if(pos < end && data[pos] == '"') {
+                quoted = true;
+                fieldStart = ++pos;
+                while(pos < end) {
+                    if(data[pos] == '"') {
+                        if(pos + 1 < end && data[pos + 1] == '"') {
+                            pos += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++pos;
+                }
+                fieldEnd = pos;
+                while(pos < end && data[pos] != delimiter && data[pos] != '\n') {
+                    ++pos;
+                }
+                // The quotes may have hidden line breaks
+                if(pos > lineEnd) {
+                    found = (const char *)memchr(data + pos, '\n', end - pos);
+                    lineEnd = found ? (found - data) : end;
+                }
+            } else {
+                found = (const char *)memchr(data + pos, delimiter, lineEnd - pos);
+                pos = found ? (found - data) : lineEnd;
+                fieldEnd = pos;
+                if(fieldEnd > fieldStart && pos == lineEnd && data[fieldEnd - 1] == '\r') {
+                    --fieldEnd;
+                }
+            }
+
+            if(columns == 0 || column < columns) {
+                visitor.field(row, column, fieldStart, (int)(fieldEnd - fieldStart), quoted);
+            }
+            ++column;
+
+            if(pos >= end || data[pos] == '\n') {
+                ++pos;
+                break;
+            }
+            ++pos;
+        }
+
+        for(; column < columns; ++column) {
+            visitor.field(row, column, pos, 0, false);
+        }
+        ++row;
+    }
+
+    return qMin(pos, end);
+}
+
+/* Reads the fields of the header line */
+struct HeaderVisitor
+{
+    explicit HeaderVisitor(const char *data) : data(data) {}
+    void field(int, int, qint64 offset, int length, bool quoted)
+    {
+        QByteArray text(data + offset, length);
+        if(quoted) {
+            text.replace("\"\"", "\"");
+        }
+        names.append(QString::fromUtf8(text.constData(), text.size()).trimmed());
+    }
+    const char *data;
+    QStringList names;
+};
+
+/* Stores every field as narrowly as its column in this chunk allows, collecting text once a column turns out not to
+   be numeric; textFrom is the row each column did so at */
+struct ParseVisitor
+{
+    ParseVisitor(ImportChunk *chunk) : data(chunk->source->data), columns(chunk->columns.data()),
+        textFrom(chunk->columns.count(), -1) {}
+
+    void field(int row, int column, qint64 offset, int length, bool quoted)
+    {
+        ImportColumn &target = columns[column];
+
+        if(target.type != AbstractColumnarModel::ColumnType_String) {
+            const char *text = data + offset;
+            int size = length;
+            while(size > 0 && *text == ' ') {
+                ++text;
+                --size;
+            }
+            while(size > 0 && text[size - 1] == ' ') {
+                --size;
+            }
+
+            // Integers can't hold an empty field, so the first one makes the column doubles, with NaN for it
+            qint64 integer = 0;
+            double number = std::numeric_limits<double>::quiet_NaN();
+            if(target.type == AbstractColumnarModel::ColumnType_Int64) {
+                if(size > 0 && parseInteger(text, size, &integer)) {
+                    target.integers.append(integer);
+                    return;
+                }
+                if(size == 0 || parseDouble(text, size, &number)) {
+                    target.numbers.reserve(target.integers.capacity());
+                    foreach(qint64 value, target.integers) {
+                        target.numbers.append((double)value);
+                    }
+                    target.integers.clear();
+                    target.numbers.append(number);
+                    target.type = AbstractColumnarModel::ColumnType_Double;
+                    return;
+                }
+            } else {
+                if(size == 0) {
+                    target.numbers.append(number);
+                    return;
+                }
+                if(parseInteger(text, size, &integer)) {
+                    target.numbers.append((double)integer);
+                    return;
+                }
+                if(parseDouble(text, size, &number)) {
+                    target.numbers.append(number);
+                    return;
+                }
+            }
+
+            target.integers.clear();
+            target.numbers.clear();
+            target.type = AbstractColumnarModel::ColumnType_String;
+            textFrom[column] = row;
+        }
+
+        ImportSpan span = { offset, length, quoted };
+        target.spans.append(span);
+    }
+
+    const char *data;
+    ImportColumn *columns;
+    QVector<int> textFrom;
+};
+
+/* Collects the text of the first limits[column] rows of each column */
+struct TextVisitor
+{
+    TextVisitor(const QVector<int> &limits) : limits(limits), spans(limits.count()) {}
+
+    void field(int row, int column, qint64 offset, int length, bool quoted)
+    {
+        if(row < limits.at(column)) {
+            ImportSpan span = { offset, length, quoted };
+            spans[column].append(span);
+        }
+    }
+
+    QVector<int> limits;
+    QVector<QVector<ImportSpan> > spans;
+};
+
+/* Counts the quotes in a block, so chunk boundaries can tell whether they fall inside a quoted field */
+struct QuoteBlock
+{
+    const char *data;
+    qint64 begin;
+    qint64 end;
+    qint64 quotes;
+};
+
+static void countQuotes(QuoteBlock &block)
+{
+    qint64 quotes = 0;
+    const char *pos = block.data + block.begin;
+    const char *end = block.data + block.end;
+    while(pos < end && (pos = (const char *)memchr(pos, '"', end - pos))) {
+        ++quotes;
+        ++pos;
+    }
+    block.quotes = quotes;
+}
+
+static QString fieldText(const char *data, const ImportSpan &span)
+{
+    if(!span.quoted) {
+        return QString::fromUtf8(data + span.offset, span.length);
+    }
+
+    QByteArray text(data + span.offset, span.length);
+    text.replace("\"\"", "\"");
+    return QString::fromUtf8(text.constData(), text.size());
+}
+
+
+
+
+DelimitedImporterPrivate::DelimitedImporterPrivate() :
+    QObject(NULL),
+    m_Delimiter(0),
+    m_HasHeader(true),
+    m_ProgressVisible(true),
+    m_NextChunk(0),
+    m_Deferred(false),
+    m_Reparsing(false),
+    m_Running(false),
+    m_Model(NULL)
+{
+    m_PollTimer.setInterval(PollInterval);
+}
+
+DelimitedImporterPrivate::~DelimitedImporterPrivate()
+{
+    reset();
+}
+
+/*!
+   \internal
+   \brief Drops the chunks and the text of the last import, and empties the model.
+ */
+void DelimitedImporterPrivate::reset()
+{
+    qDeleteAll(m_Chunks);
+    m_Chunks.clear();
+    m_Reparse.clear();
+    m_Prepared.fetchAndStoreOrdered(0);
+    m_NextChunk = 0;
+    m_Deferred = false;
+    m_Reparsing = false;
+    m_ColumnNames.clear();
+    m_ModelTypes.clear();
+    m_ErrorString.clear();
+
+    if(m_Model) {
+        m_Model->clear();
+    }
+
+    m_Source.data = NULL;
+    m_Source.size = 0;
+    m_Source.dataStart = 0;
+    m_Source.columnCount = 0;
+    m_Source.cancelled.fetchAndStoreOrdered(0);
+
+    m_Text.clear();
+    m_File.close();
+}
+
+/*!
+   \internal
+   \brief Puts up the progress bar, and starts splitting the text into chunks and parsing them.
+ */
+bool DelimitedImporterPrivate::begin()
+{
+    static const char empty[1] = { 0 };
+    if(!m_Source.data) {
+        m_Source.data = empty;
+    }
+
+    Core::CoreWindow::CoreWindow &coreWindow = Core::CoreWindow::CoreWindow::instance();
+    if(m_ProgressVisible && coreWindow.initialized()) {
+        m_ProgressBar = coreWindow.addProgressBar();
+        m_ProgressBar->setRange(0, 100);
+        m_ProgressBar->setValue(0);
+        m_ProgressBar->show();
+    }
+
+    m_Running = true;
+    m_PollTimer.start();
+    m_Watcher.setFuture(QtConcurrent::run(&DelimitedImporterPrivate::prepare, this));
+    return true;
+}
+
+/*!
+   \internal
+   \brief Finishes the import, taking down the progress bar and letting go of the text.
+ */
+void DelimitedImporterPrivate::end(bool ok, const QString &errorString)
+{
+    if(!m_Running) {
+        return;
+    }
+
+    m_Running = false;
+    m_PollTimer.stop();
+
+    if(m_ProgressBar) {
+        Core::CoreWindow::CoreWindow::instance().removeProgressBar(m_ProgressBar);
+        delete m_ProgressBar;
+    }
+
+    if(!ok) {
+        m_ErrorString = errorString.isEmpty() ? DelimitedImporter::tr("The import was cancelled.") : errorString;
+    }
+
+    qDeleteAll(m_Chunks);
+    m_Chunks.clear();
+    m_Reparse.clear();
+    m_Text.clear();
+    m_File.close();
+
+    emit q->finished(ok);
+}
+
+/*!
+   \internal
+   \brief Runs on a worker: picks the delimiter, reads the header, splits the text into chunks of whole lines and
+          parses them all in parallel.
+ */
+void DelimitedImporterPrivate::prepare(DelimitedImporterPrivate *d)
+{
+    ImportSource &source = d->m_Source;
+    const char *data = source.data;
+    qint64 size = source.size;
+
+    // Skip a UTF-8 byte order mark
+    qint64 start = (size >= 3 && memcmp(data, "\xef\xbb\xbf", 3) == 0) ? 3 : 0;
+
+    const char *lineEnd = (const char *)memchr(data + start, '\n', size - start);
+    qint64 firstLineEnd = lineEnd ? (lineEnd - data) : size;
+
+    source.delimiter = d->m_Delimiter;
+    if(!source.delimiter) {
+        int commas = 0, tabs = 0, semicolons = 0;
+        for(qint64 pos = start; pos < firstLineEnd; ++pos) {
+            commas += (data[pos] == ',') ? 1 : 0;
+            tabs += (data[pos] == '\t') ? 1 : 0;
+            semicolons += (data[pos] == ';') ? 1 : 0;
+        }
+        source.delimiter = (tabs >= commas && tabs >= semicolons && tabs > 0) ? '\t' :
+                           (semicolons > commas) ? ';' : ',';
+    }
+
+    // The first line gives the number of columns, and their names if it is a header
+    source.columnCount = 0;
+    HeaderVisitor header(data);
+    qint64 headerEnd = scanRows(source, start, size, 1, header);
+    source.columnCount = header.names.count();
+
+    if(d->m_HasHeader) {
+        d->m_ColumnNames = header.names;
+        source.dataStart = headerEnd;
+    } else {
+        for(int column = 0; column < source.columnCount; ++column) {
+            d->m_ColumnNames.append(DelimitedImporter::tr("Column %1").arg(column + 1));
+        }
+        source.dataStart = start;
+    }
+
+    // Split at the first line break after each nominal boundary that isn't inside quotes
+    QVector<QuoteBlock> blocks;
+    for(qint64 pos = source.dataStart; pos < size; pos += ChunkSize) {
+        QuoteBlock block = { data, pos, qMin(pos + ChunkSize, size), 0 };
+        blocks.append(block);
+    }
+    QtConcurrent::blockingMap(blocks, countQuotes);
+
+    qint64 quotes = 0;
+    qint64 chunkBegin = source.dataStart;
+    for(int i = 0; i < blocks.count(); ++i) {
+        if(i > 0) {
+            bool inQuotes = (quotes % 2) != 0;
+            qint64 pos = blocks.at(i).begin;
+            while(pos < size && (inQuotes || data[pos] != '\n')) {
+                inQuotes = (data[pos] == '"') ? !inQuotes : inQuotes;
+                ++pos;
+            }
+            qint64 boundary = qMin(pos + 1, size);
+            if(boundary > chunkBegin) {
+                ImportChunk *chunk = new ImportChunk;
+                chunk->source = &source;
+                chunk->begin = chunkBegin;
+                chunk->end = boundary;
+                d->m_Chunks.append(chunk);
+                chunkBegin = boundary;
+            }
+        }
+        quotes += blocks.at(i).quotes;
+    }
+    if(chunkBegin < size) {
+        ImportChunk *chunk = new ImportChunk;
+        chunk->source = &source;
+        chunk->begin = chunkBegin;
+        chunk->end = size;
+        d->m_Chunks.append(chunk);
+    }
+
+    d->m_Prepared.fetchAndStoreRelease(1);
+
+    if(!isSet(source.cancelled)) {
+        QtConcurrent::blockingMap(d->m_Chunks, parseChunk);
+    }
+}
+
+/*!
+   \internal
+   \brief Runs on a worker: parses one chunk into typed columns, and marks it parsed.
+ */
+void DelimitedImporterPrivate::parseChunk(ImportChunk *&chunk)
+{
+    const ImportSource &source = *chunk->source;
+    if(isSet(source.cancelled)) {
+        return;
+    }
+
+    chunk->columns = QVector<ImportColumn>(source.columnCount);
+    int estimatedRows = (int)qMin((qint64)(1 << 24), (chunk->end - chunk->begin) / (4 * qMax(1, source.columnCount)));
+    for(int column = 0; column < source.columnCount; ++column) {
+        chunk->columns[column].integers.reserve(estimatedRows);
+    }
+
+    ParseVisitor visitor(chunk);
+    scanRows(source, chunk->begin, chunk->end, std::numeric_limits<int>::max(), visitor);
+
+    // Columns that stopped being numeric part way through still need the text of their earlier rows
+    QVector<int> limits(source.columnCount, 0);
+    bool collect = false;
+    for(int column = 0; column < source.columnCount; ++column) {
+        if(visitor.textFrom.at(column) > 0) {
+            limits[column] = visitor.textFrom.at(column);
+            collect = true;
+        }
+    }
+    if(collect) {
+        collectText(chunk, limits);
+    }
+
+    chunk->rows = 0;
+    chunk->types.resize(source.columnCount);
+    for(int column = 0; column < source.columnCount; ++column) {
+        ImportColumn &data = chunk->columns[column];
+        chunk->types[column] = data.type;
+        chunk->rows = qMax(chunk->rows, data.integers.count() + data.numbers.count() + data.spans.count());
+    }
+
+    chunk->parsed.fetchAndStoreRelease(1);
+}
+
+/*!
+   \internal
+   \brief Collects the text of the first \a limits rows of each column of \a chunk, ahead of any text it already has.
+ */
+void DelimitedImporterPrivate::collectText(ImportChunk *chunk, const QVector<int> &limits)
+{
+    int maxRows = 0;
+    foreach(int limit, limits) {
+        maxRows = qMax(maxRows, limit);
+    }
+
+    TextVisitor visitor(limits);
+    scanRows(*chunk->source, chunk->begin, chunk->end, maxRows, visitor);
+
+    for(int column = 0; column < limits.count(); ++column) {
+        if(limits.at(column) > 0) {
+            chunk->columns[column].spans = visitor.spans.at(column) + chunk->columns.at(column).spans;
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Copies a parsed chunk into the model, converting its columns to the model's types, and frees it.
+ */
+void DelimitedImporterPrivate::appendChunk(ImportChunk *chunk)
+{
+    const char *data = m_Source.data;
+    int first = m_Model->beginAppendRows(chunk->rows);
+
+    for(int column = 0; column < m_ModelTypes.count(); ++column) {
+        ImportColumn &values = chunk->columns[column];
+
+        switch(m_ModelTypes.at(column)) {
+        case AbstractColumnarModel::ColumnType_Int64:
+            for(int row = 0; row < values.integers.count(); ++row) {
+                m_Model->setInt64(first + row, column, values.integers.at(row));
+            }
+            break;
+
+        case AbstractColumnarModel::ColumnType_Double:
+            if(values.type == AbstractColumnarModel::ColumnType_Int64) {
+                for(int row = 0; row < values.integers.count(); ++row) {
+                    m_Model->setDouble(first + row, column, (double)values.integers.at(row));
+                }
+            } else {
+                for(int row = 0; row < values.numbers.count(); ++row) {
+                    m_Model->setDouble(first + row, column, values.numbers.at(row));
+                }
+            }
+            break;
+
+        case AbstractColumnarModel::ColumnType_String:
+            if(values.type != AbstractColumnarModel::ColumnType_String) {
+                QVector<int> limits(m_ModelTypes.count(), 0);
+                limits[column] = chunk->rows;
+                values.spans.clear();
+                collectText(chunk, limits);
+            }
+            for(int row = 0; row < values.spans.count(); ++row) {
+                m_Model->setString(first + row, column, fieldText(data, values.spans.at(row)));
+            }
+            break;
+        }
+    }
+
+    m_Model->endAppendRows();
+    chunk->columns.clear();
+}
+
+/*!
+   \internal
+   \brief Appends, in order, every chunk parsed since the last call, and updates the progress.  The model's columns
+          are typed after the first chunk; a chunk that needs a wider type holds back the rest until the end.
+ */
+void DelimitedImporterPrivate::appendParsedChunks()
+{
+    if(!isSet(m_Prepared) || m_Reparsing) {
+        return;
+    }
+
+    int rows = m_Model->rowCount();
+    while(!m_Deferred && m_NextChunk < m_Chunks.count() && isSet(m_Chunks.at(m_NextChunk)->parsed)) {
+        ImportChunk *chunk = m_Chunks.at(m_NextChunk);
+
+        if(m_ModelTypes.isEmpty()) {
+            m_ModelTypes = chunk->types;
+            for(int column = 0; column < m_ModelTypes.count(); ++column) {
+                m_Model->addColumn(m_ColumnNames.at(column), m_ModelTypes.at(column));
+            }
+        }
+
+        for(int column = 0; column < m_ModelTypes.count(); ++column) {
+            if(chunk->types.at(column) > m_ModelTypes.at(column)) {
+                m_Deferred = true;
+            }
+        }
+        if(m_Deferred) {
+            break;
+        }
+
+        appendChunk(chunk);
+        ++m_NextChunk;
+    }
+
+    int parsed = 0;
+    foreach(const ImportChunk *chunk, m_Chunks) {
+        parsed += isSet(chunk->parsed) ? 1 : 0;
+    }
+    int percent = m_Chunks.isEmpty() ? 100 : (parsed * 100) / m_Chunks.count();
+    if(m_ProgressBar) {
+        m_ProgressBar->setValue(percent);
+    }
+    emit q->progressChanged(percent);
+
+    if(m_Model->rowCount() != rows) {
+        emit q->rowsAvailable(m_Model->rowCount());
+    }
+}
+
+/*!
+   \internal
+   \brief Called when the workers are done; appends what's left, or rebuilds the model with widened column types.
+ */
+void DelimitedImporterPrivate::jobFinished()
+{
+    if(!m_Running || !m_Watcher.future().isFinished()) {
+        return;
+    }
+
+    if(isSet(m_Source.cancelled)) {
+        end(false);
+        return;
+    }
+
+    if(!m_Reparsing) {
+        appendParsedChunks();
+
+        if(!m_Deferred) {
+            if(m_ModelTypes.isEmpty()) {
+                foreach(const QString &name, m_ColumnNames) {
+                    m_Model->addColumn(name, AbstractColumnarModel::ColumnType_String);
+                }
+            }
+            end(true);
+            return;
+        }
+
+        // The chunks already appended were freed, and have to be parsed again
+        m_Reparse = m_Chunks.mid(0, m_NextChunk);
+        foreach(ImportChunk *chunk, m_Reparse) {
+            chunk->parsed.fetchAndStoreOrdered(0);
+        }
+        m_Reparsing = true;
+        m_Watcher.setFuture(QtConcurrent::map(m_Reparse, parseChunk));
+        return;
+    }
+
+    QVector<AbstractColumnarModel::ColumnType> types(m_ColumnNames.count(), AbstractColumnarModel::ColumnType_Int64);
+    foreach(const ImportChunk *chunk, m_Chunks) {
+        for(int column = 0; column < types.count(); ++column) {
+            types[column] = qMax(types.at(column), chunk->types.at(column));
+        }
+    }
+
+    m_Model->clear();
+    m_ModelTypes = types;
+    for(int column = 0; column < m_ModelTypes.count(); ++column) {
+        m_Model->addColumn(m_ColumnNames.at(column), m_ModelTypes.at(column));
+    }
+    foreach(ImportChunk *chunk, m_Chunks) {
+        appendChunk(chunk);
+    }
+
+    emit q->rowsAvailable(m_Model->rowCount());
+    end(true);
+}
+
+} // namespace TableView
+} // namespace Plugins
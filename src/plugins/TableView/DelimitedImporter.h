@@ -0,0 +1,81 @@
+/*!
+   \file DelimitedImporter.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_DELIMITEDIMPORTER_H
+#define PLUGINS_TABLEVIEW_DELIMITEDIMPORTER_H
+
+#include <QObject>
+#include <QByteArray>
+
+#include "TableViewLibrary.h"
+
+namespace Core {
+namespace ViewManager {
+class ColumnarModel;
+}
+}
+
+namespace Plugins {
+namespace TableView {
+
+class DelimitedImporterPrivate;
+
+class TABLEVIEW_EXPORT DelimitedImporter : public QObject
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(DelimitedImporter)
+    Q_DISABLE_COPY(DelimitedImporter)
+
+public:
+    explicit DelimitedImporter(QObject *parent = 0);
+    ~DelimitedImporter();
+
+    char delimiter() const;
+    void setDelimiter(char delimiter);
+    bool hasHeader() const;
+    void setHasHeader(bool hasHeader);
+    bool progressVisible() const;
+    void setProgressVisible(bool visible);
+
+    bool start(const QString &fileName);
+    bool start(const QByteArray &text);
+    bool isRunning() const;
+    bool waitForFinished();
+
+    Core::ViewManager::ColumnarModel *model() const;
+    QString errorString() const;
+
+public slots:
+    void cancel();
+
+signals:
+    void progressChanged(int percent);
+    void rowsAvailable(int rows);
+    void finished(bool ok);
+
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_DELIMITEDIMPORTER_H
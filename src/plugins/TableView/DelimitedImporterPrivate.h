@@ -0,0 +1,142 @@
+/*!
+   \file DelimitedImporterPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_DELIMITEDIMPORTERPRIVATE_H
+#define PLUGINS_TABLEVIEW_DELIMITEDIMPORTERPRIVATE_H
+
+#include "DelimitedImporter.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QProgressBar>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+#include <ViewManager/ColumnarModel.h>
+
+namespace Plugins {
+namespace TableView {
+
+/* Where a field lies in the text, for columns that turn out not to be numeric */
+struct ImportSpan
+{
+    qint64 offset;
+    int length;
+    bool quoted;
+};
+
+/* The values of one column within one chunk, held as narrowly as they allow: integers, then doubles, then text */
+struct ImportColumn
+{
+    ImportColumn() : type(Core::ViewManager::AbstractColumnarModel::ColumnType_Int64) {}
+
+    Core::ViewManager::AbstractColumnarModel::ColumnType type;
+    QVector<qint64> integers;
+    QVector<double> numbers;
+    QVector<ImportSpan> spans;
+};
+
+/* The text being imported, and what every worker needs to know about it */
+struct ImportSource
+{
+    ImportSource() : data(NULL), size(0), dataStart(0), delimiter(','), columnCount(0) {}
+
+    const char *data;
+    qint64 size;
+    qint64 dataStart;
+    char delimiter;
+    int columnCount;
+    QAtomicInt cancelled;
+};
+
+/* A run of whole lines, parsed on its own by one worker */
+struct ImportChunk
+{
+    ImportChunk() : source(NULL), begin(0), end(0), rows(0) {}
+
+    const ImportSource *source;
+    qint64 begin;
+    qint64 end;
+    int rows;
+    QVector<ImportColumn> columns;
+    QVector<Core::ViewManager::AbstractColumnarModel::ColumnType> types;
+    QAtomicInt parsed;
+};
+
+class DelimitedImporterPrivate : public QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(DelimitedImporter)
+    Q_DISABLE_COPY(DelimitedImporterPrivate)
+
+public:
+    DelimitedImporterPrivate();
+    ~DelimitedImporterPrivate();
+
+    bool begin();
+    void end(bool ok, const QString &errorString = QString());
+    void appendChunk(ImportChunk *chunk);
+    void reset();
+
+    static void prepare(DelimitedImporterPrivate *d);
+    static void parseChunk(ImportChunk *&chunk);
+    static void collectText(ImportChunk *chunk, const QVector<int> &limits);
+
+protected slots:
+    void appendParsedChunks();
+    void jobFinished();
+
+private:
+    char m_Delimiter;
+    bool m_HasHeader;
+    bool m_ProgressVisible;
+
+    QFile m_File;
+    QByteArray m_Text;
+    ImportSource m_Source;
+    QStringList m_ColumnNames;
+
+    QList<ImportChunk *> m_Chunks;
+    QList<ImportChunk *> m_Reparse;
+    QAtomicInt m_Prepared;
+    int m_NextChunk;
+    bool m_Deferred;
+    bool m_Reparsing;
+    bool m_Running;
+
+    Core::ViewManager::ColumnarModel *m_Model;
+    QVector<Core::ViewManager::AbstractColumnarModel::ColumnType> m_ModelTypes;
+
+    QFutureWatcher<void> m_Watcher;
+    QTimer m_PollTimer;
+    QPointer<QProgressBar> m_ProgressBar;
+    QString m_ErrorString;
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_DELIMITEDIMPORTERPRIVATE_H
@@ -0,0 +1,627 @@
+/*!
+   \file DerivedColumnModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DerivedColumnModelPrivate.h"
+
+namespace Plugins {
+namespace TableView {
+
+using Core::ViewManager::AbstractColumnarModel;
+
+/*! \class Plugins::TableView::DerivedColumnModel
+    \brief Shows the columns of a columnar source model, followed by columns computed from them, such as the
+           percentage of a column's total, the ratio of two columns, or the change from a baseline column.
+
+    Derived columns are declared with addDerivedColumn(); their inputs are source columns or earlier derived columns.
+    Nothing is computed until a column's values are first asked for, and then the whole column is computed at once,
+    in a tight loop over the inputs' typed column data, and kept until an input changes.  Derived columns are double
+    columns of the model, so sorting, filtering and drawing them takes the same columnar fast paths as source
+    columns do.
+
+    Rows the source inserts or removes, and values it changes, are passed on; derived columns that read a changed
+    column are dropped from the cache and reported as changed too.
+ */
+
+/* An input of a derived column, in whichever numeric type it's stored */
+struct DerivedInput
+{
+    DerivedInput() : int64s(NULL), doubles(NULL) {}
+
+    const qint64 *int64s;
+    const double *doubles;
+};
+
+/* A value to add into a sum; empty cells, stored as NaN, add nothing */
+template <typename T>
+static inline double summand(T value)
+{
+    double number = (double)value;
+    return (number == number) ? number : 0.0;
+}
+
+template <typename T>
+static double columnSum(const T *values, int count)
+{
+    // Independent partial sums keep the adds from waiting on each other
+    double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+    for(; i + 4 <= count; i += 4) {
+        sums[0] += summand(values[i]);
+        sums[1] += summand(values[i + 1]);
+        sums[2] += summand(values[i + 2]);
+        sums[3] += summand(values[i + 3]);
+    }
+    for(; i < count; ++i) {
+        sums[0] += summand(values[i]);
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+template <typename T>
+static void scaleColumn(const T *values, int count, double factor, double *out)
+{
+    for(int i = 0; i < count; ++i) {
+        out[i] = (double)values[i] * factor;
+    }
+}
+
+struct RatioOperation
+{
+    static inline double apply(double a, double b) { return (b != 0.0) ? a / b : 0.0; }
+};
+
+struct DifferenceOperation
+{
+    static inline double apply(double a, double b) { return a - b; }
+};
+
+struct PercentChangeOperation
+{
+    static inline double apply(double a, double b) { return (b != 0.0) ? (a - b) / b * 100.0 : 0.0; }
+};
+
+template <typename Operation, typename A, typename B>
+static void combineColumns(const A *a, const B *b, int count, double *out)
+{
+    for(int i = 0; i < count; ++i) {
+        out[i] = Operation::apply((double)a[i], (double)b[i]);
+    }
+}
+
+template <typename Operation, typename A>
+static void combineColumns(const A *a, const DerivedInput &b, int count, double *out)
+{
+    if(b.int64s) {
+        combineColumns<Operation>(a, b.int64s, count, out);
+    } else {
+        combineColumns<Operation>(a, b.doubles, count, out);
+    }
+}
+
+template <typename Operation>
+static void combineColumns(const DerivedInput &a, const DerivedInput &b, int count, double *out)
+{
+    if(a.int64s) {
+        combineColumns<Operation>(a.int64s, b, count, out);
+    } else {
+        combineColumns<Operation>(a.doubles, b, count, out);
+    }
+}
+
+
+DerivedColumnModel::DerivedColumnModel(QObject *parent) :
+    AbstractColumnarModel(parent),
+    d(new DerivedColumnModelPrivate)
+{
+    d->q = this;
+}
+
+DerivedColumnModel::~DerivedColumnModel()
+{
+}
+
+AbstractColumnarModel *DerivedColumnModel::sourceModel() const
+{
+    return d->m_SourceModel;
+}
+
+/*! \fn DerivedColumnModel::setSourceModel()
+    \brief Shows \a sourceModel, dropping any derived columns declared for the previous source.
+ */
+void DerivedColumnModel::setSourceModel(AbstractColumnarModel *sourceModel)
+{
+    beginResetModel();
+
+    if(d->m_SourceModel) {
+        disconnect(d->m_SourceModel, 0, d.data(), 0);
+    }
+
+    d->m_SourceModel = sourceModel;
+    d->m_SourceColumns = sourceModel ? sourceModel->columnCount() : 0;
+    d->m_Columns.clear();
+
+    if(sourceModel) {
+        connect(sourceModel, SIGNAL(modelAboutToBeReset()), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(modelReset()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(layoutAboutToBeChanged()), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(layoutChanged()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)),
+                d.data(), SLOT(sourceRowsAboutToBeInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceRowsInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+                d.data(), SLOT(sourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceRowsRemoved(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)),
+                d.data(), SLOT(sourceColumnsAboutToBeInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(columnsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceColumnsInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(columnsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceColumnsRemoved(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(headerDataChanged(Qt::Orientation,int,int)), this, SIGNAL(headerDataChanged(Qt::Orientation,int,int)));
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), d.data(), SLOT(sourceDataChanged(QModelIndex,QModelIndex)));
+    }
+
+    endResetModel();
+}
+
+/*! \fn DerivedColumnModel::addDerivedColumn()
+    \brief Appends a column computed from \a column, and for the two-column operations from \a baseColumn, and
+           returns its model column; or -1 if either input isn't a numeric column of this model.
+
+    Operation_PercentOfTotal is each value's percentage of the column's total; Operation_Ratio is column / baseColumn;
+    Operation_Difference is column - baseColumn; and Operation_PercentChange is the percentage change from
+    baseColumn to column.  Dividing by zero gives zero.  Without a \a title, one is made from the input columns' names;
+    percentage-of-total columns get a '%' in their titles, so a Delegate draws them as bars.
+ */
+int DerivedColumnModel::addDerivedColumn(Operation operation, int column, int baseColumn, const QString &title)
+{
+    bool binary = (operation != Operation_PercentOfTotal);
+    if(!d->isNumeric(column) || (binary && !d->isNumeric(baseColumn))) {
+        return -1;
+    }
+
+    DerivedColumn derived;
+    derived.operation = operation;
+    derived.inputs[0] = column;
+    derived.inputs[1] = binary ? baseColumn : -1;
+    derived.title = title;
+
+    if(derived.title.isEmpty()) {
+        QString name = columnName(column);
+        QString baseName = binary ? columnName(baseColumn) : QString();
+        switch(operation) {
+        case Operation_PercentOfTotal:
+            derived.title = tr("%1 (% of total)").arg(name);
+            break;
+        case Operation_Ratio:
+            derived.title = tr("%1 / %2").arg(name).arg(baseName);
+            break;
+        case Operation_Difference:
+            derived.title = tr("%1 - %2").arg(name).arg(baseName);
+            break;
+        case Operation_PercentChange:
+            // Unbounded, so kept out of the percentage bars
+            derived.title = tr("%1 change from %2").arg(name).arg(baseName);
+            break;
+        }
+    }
+
+    int modelColumn = columnCount();
+    beginInsertColumns(QModelIndex(), modelColumn, modelColumn);
+    d->m_Columns.append(derived);
+    endInsertColumns();
+
+    return modelColumn;
+}
+
+/*! \fn DerivedColumnModel::removeDerivedColumn()
+    \brief Removes the derived model \a column, along with any derived columns that read it.
+ */
+void DerivedColumnModel::removeDerivedColumn(int column)
+{
+    if(!isDerivedColumn(column)) {
+        return;
+    }
+
+    beginResetModel();
+
+    QVector<int> map(columnCount());
+    for(int i = 0; i < d->m_SourceColumns; ++i) {
+        map[i] = i;
+    }
+    map[column] = -1;
+    d->remap(map, d->m_SourceColumns);
+
+    endResetModel();
+}
+
+void DerivedColumnModel::clearDerivedColumns()
+{
+    if(d->m_Columns.isEmpty()) {
+        return;
+    }
+
+    beginRemoveColumns(QModelIndex(), d->m_SourceColumns, columnCount() - 1);
+    d->m_Columns.clear();
+    endRemoveColumns();
+}
+
+int DerivedColumnModel::derivedColumnCount() const
+{
+    return d->m_Columns.count();
+}
+
+bool DerivedColumnModel::isDerivedColumn(int column) const
+{
+    return column >= d->m_SourceColumns && column < columnCount();
+}
+
+DerivedColumnModel::ColumnType DerivedColumnModel::columnType(int column) const
+{
+    if(column >= d->m_SourceColumns || !d->m_SourceModel) {
+        return ColumnType_Double;
+    }
+    return d->m_SourceModel->columnType(column);
+}
+
+QString DerivedColumnModel::columnName(int column) const
+{
+    if(isDerivedColumn(column)) {
+        return d->m_Columns.at(column - d->m_SourceColumns).title;
+    }
+    return d->m_SourceModel ? d->m_SourceModel->columnName(column) : QString();
+}
+
+const qint64 *DerivedColumnModel::int64Column(int column) const
+{
+    if(column >= d->m_SourceColumns || !d->m_SourceModel) {
+        return NULL;
+    }
+    return d->m_SourceModel->int64Column(column);
+}
+
+/*! \fn DerivedColumnModel::doubleColumn()
+    \brief Returns the values of a double source column, or of a derived column, computing them first if they
+           aren't cached.
+ */
+const double *DerivedColumnModel::doubleColumn(int column) const
+{
+    if(isDerivedColumn(column)) {
+        return d->compute(column - d->m_SourceColumns);
+    }
+    if(!d->m_SourceModel || column >= d->m_SourceColumns) {
+        return NULL;
+    }
+    return d->m_SourceModel->doubleColumn(column);
+}
+
+const quint32 *DerivedColumnModel::stringColumn(int column) const
+{
+    if(column >= d->m_SourceColumns || !d->m_SourceModel) {
+        return NULL;
+    }
+    return d->m_SourceModel->stringColumn(column);
+}
+
+QString DerivedColumnModel::internedString(quint32 id) const
+{
+    return d->m_SourceModel ? d->m_SourceModel->internedString(id) : QString();
+}
+
+int DerivedColumnModel::internedStringCount() const
+{
+    return d->m_SourceModel ? d->m_SourceModel->internedStringCount() : 0;
+}
+
+QVector<quint32> DerivedColumnModel::internedStringRanks(Qt::CaseSensitivity cs) const
+{
+    return d->m_SourceModel ? d->m_SourceModel->internedStringRanks(cs) : QVector<quint32>();
+}
+
+int DerivedColumnModel::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid() || !d->m_SourceModel) ? 0 : d->m_SourceModel->rowCount();
+}
+
+int DerivedColumnModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : d->m_SourceColumns + d->m_Columns.count();
+}
+
+
+/***** PRIVATE IMPLEMENTATION *****/
+
+DerivedColumnModelPrivate::DerivedColumnModelPrivate() :
+    QObject(NULL),
+    m_SourceColumns(0)
+{
+}
+
+DerivedColumnModelPrivate::~DerivedColumnModelPrivate()
+{
+}
+
+/*! \internal
+    \brief Whether \a column is a numeric column of the model: an integer or double source column, or a derived one.
+ */
+bool DerivedColumnModelPrivate::isNumeric(int column) const
+{
+    if(column < 0 || column >= m_SourceColumns + m_Columns.count() || !m_SourceModel) {
+        return false;
+    }
+    return column >= m_SourceColumns ||
+            m_SourceModel->columnType(column) != AbstractColumnarModel::ColumnType_String;
+}
+
+/*! \internal
+    \brief Computes the values of derived column \a derived, and of any derived inputs it has, unless they're cached.
+ */
+const double *DerivedColumnModelPrivate::compute(int derived)
+{
+    DerivedColumn &column = m_Columns[derived];
+    if(column.valid) {
+        return column.values.constData();
+    }
+
+    int count = m_SourceModel ? m_SourceModel->rowCount() : 0;
+
+    DerivedInput inputs[2];
+    for(int i = 0; i < 2 && count > 0; ++i) {
+        int input = column.inputs[i];
+        if(input < 0) {
+            continue;
+        } else if(input >= m_SourceColumns) {
+            inputs[i].doubles = compute(input - m_SourceColumns);
+        } else if(m_SourceModel->columnType(input) == AbstractColumnarModel::ColumnType_Int64) {
+            inputs[i].int64s = m_SourceModel->int64Column(input);
+        } else {
+            inputs[i].doubles = m_SourceModel->doubleColumn(input);
+        }
+    }
+
+    column.values.resize(count);
+    double *out = column.values.data();
+
+    bool binary = (column.inputs[1] >= 0);
+    if(count == 0 || (!inputs[0].int64s && !inputs[0].doubles) ||
+            (binary && !inputs[1].int64s && !inputs[1].doubles)) {
+        column.values.fill(0.0);
+        column.valid = true;
+        return column.values.constData();
+    }
+
+    switch(column.operation) {
+    case DerivedColumnModel::Operation_PercentOfTotal:
+    {
+        double total = inputs[0].int64s ? columnSum(inputs[0].int64s, count) : columnSum(inputs[0].doubles, count);
+        double factor = (total != 0.0) ? 100.0 / total : 0.0;
+        if(inputs[0].int64s) {
+            scaleColumn(inputs[0].int64s, count, factor, out);
+        } else {
+            scaleColumn(inputs[0].doubles, count, factor, out);
+        }
+        break;
+    }
+    case DerivedColumnModel::Operation_Ratio:
+        combineColumns<RatioOperation>(inputs[0], inputs[1], count, out);
+        break;
+    case DerivedColumnModel::Operation_Difference:
+        combineColumns<DifferenceOperation>(inputs[0], inputs[1], count, out);
+        break;
+    case DerivedColumnModel::Operation_PercentChange:
+        combineColumns<PercentChangeOperation>(inputs[0], inputs[1], count, out);
+        break;
+    }
+
+    column.valid = true;
+    return column.values.constData();
+}
+
+/*! \internal
+    \brief Drops every cached derived column.
+ */
+void DerivedColumnModelPrivate::invalidate()
+{
+    for(int i = 0; i < m_Columns.count(); ++i) {
+        DerivedColumn &column = m_Columns[i];
+        column.valid = false;
+        column.values = QVector<double>();
+    }
+}
+
+/*! \internal
+    \brief Renumbers the inputs of the derived columns after the model's columns change; \a map holds the new number
+           of each old source column and derived column, or -1 for those that are gone.  Derived columns reading a
+           column that's gone are removed as well.
+ */
+void DerivedColumnModelPrivate::remap(QVector<int> map, int sourceColumns)
+{
+    int oldSourceColumns = m_SourceColumns;
+    map.resize(oldSourceColumns + m_Columns.count());
+
+    QVector<DerivedColumn> columns;
+    for(int i = 0; i < m_Columns.count(); ++i) {
+        DerivedColumn column = m_Columns.at(i);
+        bool keep = (map.at(oldSourceColumns + i) >= 0);
+        for(int j = 0; j < 2 && keep; ++j) {
+            if(column.inputs[j] >= 0) {
+                column.inputs[j] = map.at(column.inputs[j]);
+                keep = (column.inputs[j] >= 0);
+            }
+        }
+
+        map[oldSourceColumns + i] = keep ? sourceColumns + columns.count() : -1;
+        if(keep) {
+            columns.append(column);
+        }
+    }
+
+    m_Columns = columns;
+    m_SourceColumns = sourceColumns;
+}
+
+void DerivedColumnModelPrivate::sourceAboutToBeReset()
+{
+    q->beginResetModel();
+}
+
+void DerivedColumnModelPrivate::sourceReset()
+{
+    m_SourceColumns = m_SourceModel ? m_SourceModel->columnCount() : 0;
+    invalidate();
+    q->endResetModel();
+}
+
+void DerivedColumnModelPrivate::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    if(!parent.isValid()) {
+        q->beginInsertRows(QModelIndex(), first, last);
+    }
+}
+
+void DerivedColumnModelPrivate::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+
+    if(!parent.isValid()) {
+        invalidate();
+        q->endInsertRows();
+    }
+}
+
+void DerivedColumnModelPrivate::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if(!parent.isValid()) {
+        q->beginRemoveRows(QModelIndex(), first, last);
+    }
+}
+
+void DerivedColumnModelPrivate::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first)
+    Q_UNUSED(last)
+
+    if(!parent.isValid()) {
+        invalidate();
+        q->endRemoveRows();
+    }
+}
+
+/* Source columns come before the derived ones, so they're inserted at the same place in this model */
+void DerivedColumnModelPrivate::sourceColumnsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    if(!parent.isValid()) {
+        q->beginInsertColumns(QModelIndex(), first, last);
+    }
+}
+
+void DerivedColumnModelPrivate::sourceColumnsInserted(const QModelIndex &parent, int first, int last)
+{
+    if(parent.isValid()) {
+        return;
+    }
+
+    int count = last - first + 1;
+    QVector<int> map(m_SourceColumns + m_Columns.count());
+    for(int i = 0; i < map.count(); ++i) {
+        map[i] = (i < first) ? i : i + count;
+    }
+    remap(map, m_SourceColumns + count);
+
+    q->endInsertColumns();
+}
+
+void DerivedColumnModelPrivate::sourceColumnsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent)
+
+    int count = last - first + 1;
+    QVector<int> map(m_SourceColumns + m_Columns.count());
+    for(int i = 0; i < map.count(); ++i) {
+        map[i] = (i < first) ? i : (i <= last) ? -1 : i - count;
+    }
+    remap(map, m_SourceColumns - count);
+    invalidate();
+
+    q->endResetModel();
+}
+
+/*! \internal
+    \brief Passes on changed source values, and drops the derived columns that read them.  Percentages of a column's
+           total change on every row when any of the column's values do; the other operations only on the rows that
+           changed.
+ */
+void DerivedColumnModelPrivate::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if(topLeft.parent().isValid()) {
+        return;
+    }
+
+    emit q->dataChanged(q->index(topLeft.row(), topLeft.column()), q->index(bottomRight.row(), bottomRight.column()));
+
+    // How each derived column is affected: not at all, on the changed rows, or on every row
+    enum { Unchanged = 0, ChangedRows, AllRows };
+    QVector<int> changes(m_SourceColumns + m_Columns.count(), Unchanged);
+    for(int column = topLeft.column(); column <= bottomRight.column() && column < m_SourceColumns; ++column) {
+        changes[column] = ChangedRows;
+    }
+
+    int firstChanged = -1;
+    int lastChanged = -1;
+    bool allRows = false;
+    for(int i = 0; i < m_Columns.count(); ++i) {
+        DerivedColumn &column = m_Columns[i];
+        int change = Unchanged;
+        for(int j = 0; j < 2; ++j) {
+            if(column.inputs[j] >= 0) {
+                change = qMax(change, changes.at(column.inputs[j]));
+            }
+        }
+        if(change == Unchanged) {
+            continue;
+        }
+        if(column.operation == DerivedColumnModel::Operation_PercentOfTotal) {
+            change = AllRows;
+        }
+
+        int modelColumn = m_SourceColumns + i;
+        changes[modelColumn] = change;
+        column.valid = false;
+        column.values = QVector<double>();
+
+        if(firstChanged < 0) {
+            firstChanged = modelColumn;
+        }
+        lastChanged = modelColumn;
+        allRows = allRows || (change == AllRows);
+    }
+
+    if(firstChanged >= 0) {
+        int firstRow = allRows ? 0 : topLeft.row();
+        int lastRow = allRows ? q->rowCount() - 1 : bottomRight.row();
+        emit q->dataChanged(q->index(firstRow, firstChanged), q->index(lastRow, lastChanged));
+    }
+}
+
+} // namespace TableView
+} // namespace Plugins
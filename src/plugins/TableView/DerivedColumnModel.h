@@ -0,0 +1,81 @@
+/*!
+   \file DerivedColumnModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODEL_H
+#define PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODEL_H
+
+#include <ViewManager/AbstractColumnarModel.h>
+
+#include "TableViewLibrary.h"
+
+namespace Plugins {
+namespace TableView {
+
+class DerivedColumnModelPrivate;
+
+class TABLEVIEW_EXPORT DerivedColumnModel : public Core::ViewManager::AbstractColumnarModel
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(DerivedColumnModel)
+    Q_DISABLE_COPY(DerivedColumnModel)
+
+public:
+    enum Operation {
+        Operation_PercentOfTotal,
+        Operation_Ratio,
+        Operation_Difference,
+        Operation_PercentChange
+    };
+
+    explicit DerivedColumnModel(QObject *parent = 0);
+    ~DerivedColumnModel();
+
+    Core::ViewManager::AbstractColumnarModel *sourceModel() const;
+    void setSourceModel(Core::ViewManager::AbstractColumnarModel *sourceModel);
+
+    int addDerivedColumn(Operation operation, int column, int baseColumn = -1, const QString &title = QString());
+    void removeDerivedColumn(int column);
+    void clearDerivedColumns();
+    int derivedColumnCount() const;
+    bool isDerivedColumn(int column) const;
+
+    virtual ColumnType columnType(int column) const;
+    virtual QString columnName(int column) const;
+
+    virtual const qint64 *int64Column(int column) const;
+    virtual const double *doubleColumn(int column) const;
+    virtual const quint32 *stringColumn(int column) const;
+
+    virtual QString internedString(quint32 id) const;
+    virtual int internedStringCount() const;
+    virtual QVector<quint32> internedStringRanks(Qt::CaseSensitivity cs = Qt::CaseSensitive) const;
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODEL_H
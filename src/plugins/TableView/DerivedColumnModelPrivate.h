@@ -0,0 +1,89 @@
+/*!
+   \file DerivedColumnModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODELPRIVATE_H
+#define PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODELPRIVATE_H
+
+#include "DerivedColumnModel.h"
+
+#include <QPointer>
+#include <QVector>
+
+namespace Plugins {
+namespace TableView {
+
+/* One derived column: its operation, and the model columns it reads.  Inputs below the source's column count are
+   source columns; the rest are earlier derived columns.  Values are computed when first asked for, and kept until an
+   input changes. */
+struct DerivedColumn
+{
+    DerivedColumn() : operation(DerivedColumnModel::Operation_PercentOfTotal), valid(false)
+    {
+        inputs[0] = inputs[1] = -1;
+    }
+
+    DerivedColumnModel::Operation operation;
+    QString title;
+    int inputs[2];
+
+    QVector<double> values;
+    bool valid;
+};
+
+class DerivedColumnModelPrivate : public QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(DerivedColumnModel)
+    Q_DISABLE_COPY(DerivedColumnModelPrivate)
+
+public:
+    DerivedColumnModelPrivate();
+    ~DerivedColumnModelPrivate();
+
+    bool isNumeric(int column) const;
+    const double *compute(int derived);
+    void invalidate();
+    void remap(QVector<int> map, int sourceColumns);
+
+protected slots:
+    void sourceAboutToBeReset();
+    void sourceReset();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceColumnsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceColumnsInserted(const QModelIndex &parent, int first, int last);
+    void sourceColumnsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    QPointer<Core::ViewManager::AbstractColumnarModel> m_SourceModel;
+    int m_SourceColumns;
+    QVector<DerivedColumn> m_Columns;
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_DERIVEDCOLUMNMODELPRIVATE_H
@@ -0,0 +1,1337 @@
+/*!
+   \file SortFilterProxyModel.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SortFilterProxyModelPrivate.h"
+
+#include <QtConcurrentRun>
+#include <QThread>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+namespace Plugins {
+namespace TableView {
+
+/*! \class Plugins::TableView::SortFilterProxyModel
+    \brief Flat sorting and filtering proxy that does the heavy lifting on worker threads.
+
+    Offers the parts of QSortFilterProxyModel's interface that TableView uses.  Rather than comparing QVariants on the
+    GUI thread, the sort column is read once into a typed array (numbers or strings), and a permutation of the source
+    rows is sorted with a parallel merge sort.  Filtering runs the filter regular expression, and any filter expression
+    (see setFilterExpression()), over chunks of rows in parallel.
+    Keys are kept until the source data changes, so reversing the order or re-filtering doesn't read the model again.
+
+    Models with more rows than asynchronousThreshold() are sorted in the background; the view keeps its current order
+    until the new mapping is swapped in with a single layout change.  Starting another sort or filter while one is
+    running cancels the first.
+
+    Rows appended to the end of the source model are gathered for a frame, and then inserted into the existing order
+    by binary search, so a table receiving a steady stream of rows isn't re-sorted for each one.  Persistent indexes
+    (and so the selection) stay on their rows throughout.
+    \sa TableView QSortFilterProxyModel
+ */
+
+/*! \fn SortFilterProxyModel::streamedRowsAboutToBeInserted()
+    \brief Emitted before a batch of appended source rows is inserted, whether as rowsInserted() or a layout change.
+    \sa streamedRowsInserted()
+ */
+
+/*! \fn SortFilterProxyModel::streamedRowsInserted()
+    \brief Emitted once a batch of appended source rows has been inserted.
+    \sa streamedRowsAboutToBeInserted()
+ */
+
+/*! \fn SortFilterProxyModel::busyChanged()
+    \brief Emitted when a background sort or filter starts (\a busy is true) and when its result has been applied.
+ */
+
+SortFilterProxyModel::SortFilterProxyModel(QObject *parent) :
+    QAbstractProxyModel(parent),
+    d(new SortFilterProxyModelPrivate)
+{
+    d->q = this;
+}
+
+SortFilterProxyModel::~SortFilterProxyModel()
+{
+    d->cancelJob();
+}
+
+void SortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    d->cancelJob();
+
+    beginResetModel();
+
+    if(QAbstractItemModel *oldModel = this->sourceModel()) {
+        disconnect(oldModel, 0, d.data(), 0);
+    }
+
+    QAbstractProxyModel::setSourceModel(sourceModel);
+
+    if(sourceModel) {
+        connect(sourceModel, SIGNAL(modelAboutToBeReset()), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(modelReset()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)), d.data(), SLOT(sourceRowsAboutToBeInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceRowsInserted(QModelIndex,int,int)));
+        connect(sourceModel, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsAboutToBeInserted(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(columnsInserted(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(columnsRemoved(QModelIndex,int,int)), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(layoutAboutToBeChanged()), d.data(), SLOT(sourceAboutToBeReset()));
+        connect(sourceModel, SIGNAL(layoutChanged()), d.data(), SLOT(sourceReset()));
+        connect(sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), d.data(), SLOT(sourceDataChanged(QModelIndex,QModelIndex)));
+    }
+
+    d->invalidateKeys();
+    d->resetMapping();
+    if(!d->compileFilterExpression(d->m_FilterExpressionPattern)) {
+        d->m_FilterExpression.clear();
+    }
+
+    endResetModel();
+
+    d->startJob();
+}
+
+QModelIndex SortFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if(!proxyIndex.isValid() || !sourceModel() || proxyIndex.row() >= d->m_ProxyToSource.count()) {
+        return QModelIndex();
+    }
+
+    return sourceModel()->index(d->m_ProxyToSource.at(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex SortFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if(!sourceIndex.isValid()) {
+        return QModelIndex();
+    }
+
+    int row = d->proxyRowForSource(sourceIndex.row());
+    if(row < 0) {
+        return QModelIndex();
+    }
+
+    return createIndex(row, sourceIndex.column());
+}
+
+/*! \fn SortFilterProxyModel::sourceRows()
+    \brief The source row shown at each proxy row, in proxy order.  The vector is implicitly shared, so this is a cheap
+           snapshot of the current sorting and filtering, for walking every row without a QModelIndex apiece.
+    \sa mapToSource()
+ */
+QVector<int> SortFilterProxyModel::sourceRows() const
+{
+    return d->m_ProxyToSource;
+}
+
+QModelIndex SortFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if(row < 0 || column < 0 || row >= rowCount(parent) || column >= columnCount(parent)) {
+        return QModelIndex();
+    }
+
+    return createIndex(row, column);
+}
+
+QModelIndex SortFilterProxyModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int SortFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid()) {
+        return 0;
+    }
+
+    return d->m_ProxyToSource.count();
+}
+
+int SortFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid() || !sourceModel()) {
+        return 0;
+    }
+
+    return sourceModel()->columnCount();
+}
+
+QVariant SortFilterProxyModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(!sourceModel()) {
+        return QVariant();
+    }
+
+    if(orientation == Qt::Vertical) {
+        if(section < 0 || section >= d->m_ProxyToSource.count()) {
+            return QVariant();
+        }
+        section = d->m_ProxyToSource.at(section);
+    }
+
+    return sourceModel()->headerData(section, orientation, role);
+}
+
+/*! \fn SortFilterProxyModel::sort()
+    \brief Sorts by \a column in \a order; a column of -1 returns to the source model's order.
+    \reimp QAbstractItemModel::sort()
+ */
+void SortFilterProxyModel::sort(int column, Qt::SortOrder order)
+{
+    d->m_SortColumn = column;
+    d->m_SortOrder = order;
+    d->startJob();
+}
+
+int SortFilterProxyModel::sortColumn() const
+{
+    return d->m_SortColumn;
+}
+
+Qt::SortOrder SortFilterProxyModel::sortOrder() const
+{
+    return d->m_SortOrder;
+}
+
+int SortFilterProxyModel::sortRole() const
+{
+    return d->m_SortRole;
+}
+
+void SortFilterProxyModel::setSortRole(int role)
+{
+    if(d->m_SortRole == role) {
+        return;
+    }
+
+    d->m_SortRole = role;
+    d->m_SortKeys.clear();
+    d->startJob();
+}
+
+Qt::CaseSensitivity SortFilterProxyModel::sortCaseSensitivity() const
+{
+    return d->m_SortCaseSensitivity;
+}
+
+void SortFilterProxyModel::setSortCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if(d->m_SortCaseSensitivity == cs) {
+        return;
+    }
+
+    d->m_SortCaseSensitivity = cs;
+    d->m_SortKeys.clear();
+    d->startJob();
+}
+
+QRegExp SortFilterProxyModel::filterRegExp() const
+{
+    return d->m_FilterRegExp;
+}
+
+void SortFilterProxyModel::setFilterRegExp(const QRegExp &regExp)
+{
+    d->m_FilterRegExp = regExp;
+    d->startJob();
+}
+
+void SortFilterProxyModel::setFilterRegExp(const QString &pattern)
+{
+    setFilterRegExp(QRegExp(pattern, d->m_FilterRegExp.caseSensitivity(), d->m_FilterRegExp.patternSyntax()));
+}
+
+int SortFilterProxyModel::filterKeyColumn() const
+{
+    return d->m_FilterKeyColumn;
+}
+
+/*! \fn SortFilterProxyModel::setFilterKeyColumn()
+    \brief Sets the column the filter is matched against; -1 matches a row if any of its columns match.
+ */
+void SortFilterProxyModel::setFilterKeyColumn(int column)
+{
+    if(d->m_FilterKeyColumn == column) {
+        return;
+    }
+
+    d->m_FilterKeyColumn = column;
+    d->startJob();
+}
+
+int SortFilterProxyModel::filterRole() const
+{
+    return d->m_FilterRole;
+}
+
+void SortFilterProxyModel::setFilterRole(int role)
+{
+    if(d->m_FilterRole == role) {
+        return;
+    }
+
+    d->m_FilterRole = role;
+    d->m_FilterTextColumn = -2;
+    d->m_ExpressionColumns.fill(TypedColumn());
+    d->startJob();
+}
+
+Qt::CaseSensitivity SortFilterProxyModel::filterCaseSensitivity() const
+{
+    return d->m_FilterRegExp.caseSensitivity();
+}
+
+void SortFilterProxyModel::setFilterCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if(d->m_FilterRegExp.caseSensitivity() == cs) {
+        return;
+    }
+
+    d->m_FilterRegExp.setCaseSensitivity(cs);
+    d->startJob();
+}
+
+/*! \fn SortFilterProxyModel::filterExpression()
+    \brief The filter expression rows must match, as well as the filter regular expression.
+    \sa setFilterExpression()
+ */
+QString SortFilterProxyModel::filterExpression() const
+{
+    return d->m_FilterExpressionPattern;
+}
+
+/*! \fn SortFilterProxyModel::setFilterExpression()
+    \brief Filters rows with a Core::ViewManager::FilterExpression over the source's columns, evaluated over their
+           typed values (read with filterRole()) on worker threads; an empty \a expression removes it.
+    \returns false, leaving the filter unchanged and the reason in \a errorMessage if given, when \a expression
+             doesn't compile
+ */
+bool SortFilterProxyModel::setFilterExpression(const QString &expression, QString *errorMessage)
+{
+    if(!d->compileFilterExpression(expression, errorMessage)) {
+        return false;
+    }
+
+    d->startJob();
+    return true;
+}
+
+/*! \fn SortFilterProxyModel::dynamicSortFilter()
+    \brief Whether rows are re-sorted and re-filtered when the source data in the sort or filter column changes.
+ */
+bool SortFilterProxyModel::dynamicSortFilter() const
+{
+    return d->m_DynamicSortFilter;
+}
+
+void SortFilterProxyModel::setDynamicSortFilter(bool enable)
+{
+    d->m_DynamicSortFilter = enable;
+}
+
+/*! \fn SortFilterProxyModel::asynchronousThreshold()
+    \brief The row count above which sorting and filtering happen in the background.
+ */
+int SortFilterProxyModel::asynchronousThreshold() const
+{
+    return d->m_AsynchronousThreshold;
+}
+
+void SortFilterProxyModel::setAsynchronousThreshold(int rows)
+{
+    d->m_AsynchronousThreshold = rows;
+}
+
+/*! \fn SortFilterProxyModel::isBusy()
+    \brief Whether a background sort or filter is still running.
+ */
+bool SortFilterProxyModel::isBusy() const
+{
+    return !d->m_Job.isNull();
+}
+
+/*! \fn SortFilterProxyModel::waitForFinished()
+    \brief Blocks until any background sort or filter has finished, and applies its result.
+ */
+void SortFilterProxyModel::waitForFinished()
+{
+    if(d->m_Job.isNull()) {
+        return;
+    }
+
+    d->m_Watcher.waitForFinished();
+    d->jobFinished();
+}
+
+/*! \fn SortFilterProxyModel::invalidate()
+    \brief Throws away the cached keys, and sorts and filters again.
+ */
+void SortFilterProxyModel::invalidate()
+{
+    d->invalidateKeys();
+    d->startJob();
+}
+
+
+
+
+template <typename T>
+static inline bool keyLess(const T &left, const T &right)
+{
+    return left < right;
+}
+
+/* Empty numeric cells are NaN, which would break the ordering; they sort before every number instead */
+static inline bool keyLess(const double &left, const double &right)
+{
+    return (left == left) ? (left < right) : (right == right);
+}
+
+/* Comparators over source rows, looking their keys up in a typed array */
+template <typename T>
+struct KeyLess
+{
+    KeyLess(const T *keys) : m_Keys(keys) {}
+    bool operator()(int left, int right) const { return keyLess(m_Keys[left], m_Keys[right]); }
+    const T *m_Keys;
+};
+
+template <typename T>
+struct KeyGreater
+{
+    KeyGreater(const T *keys) : m_Keys(keys) {}
+    bool operator()(int left, int right) const { return keyLess(m_Keys[right], m_Keys[left]); }
+    const T *m_Keys;
+};
+
+static inline bool isCancelled(const QAtomicInt &flag)
+{
+#if QT_VERSION >= 0x050000
+    return flag.load() != 0;
+#else
+    return (int)flag != 0;
+#endif
+}
+
+/*!
+   \internal
+   \brief Stable sort of one chunk, done as sorted runs merged bottom-up so that a cancelled job gives up within a
+          run's worth of work rather than finishing the chunk.
+ */
+template <typename Compare>
+static void sortRange(int *begin, int *end, Compare compare, const QAtomicInt *cancelled)
+{
+    static const int RunLength = 8192;
+    int count = (int)(end - begin);
+
+    for(int first = 0; first < count; first += RunLength) {
+        if(isCancelled(*cancelled)) {
+            return;
+        }
+        std::stable_sort(begin + first, begin + qMin(first + RunLength, count), compare);
+    }
+
+    for(int width = RunLength; width < count; width *= 2) {
+        for(int first = 0; first + width < count; first += 2 * width) {
+            if(isCancelled(*cancelled)) {
+                return;
+            }
+            std::inplace_merge(begin + first, begin + first + width, begin + qMin(first + 2 * width, count), compare);
+        }
+    }
+}
+
+template <typename Compare>
+static void mergeRanges(const int *first, const int *middle, const int *last, int *out, Compare compare)
+{
+    std::merge(first, middle, middle, last, out, compare);
+}
+
+static void copyRange(const int *first, const int *last, int *out)
+{
+    std::copy(first, last, out);
+}
+
+static int chunkCount(int rows)
+{
+    static const int MinimumChunk = 16384;
+    return qMax(1, qMin(QThread::idealThreadCount(), rows / MinimumChunk));
+}
+
+/*!
+   \internal
+   \brief Stable parallel merge sort: each chunk is sorted on its own thread, then neighbouring chunks are merged in
+          rounds, each round's merges again running in parallel.
+ */
+template <typename Compare>
+static void parallelSort(QVector<int> &rows, Compare compare, const QAtomicInt &cancelled)
+{
+    int count = rows.count();
+    int chunks = chunkCount(count);
+
+    QVector<int> bounds;
+    for(int i = 0; i <= chunks; ++i) {
+        bounds.append((int)(((qint64)count * i) / chunks));
+    }
+
+    int *data = rows.data();
+    QList<QFuture<void> > futures;
+    for(int i = 0; i < chunks; ++i) {
+        futures.append(QtConcurrent::run(sortRange<Compare>, data + bounds.at(i), data + bounds.at(i + 1), compare,
+                                         &cancelled));
+    }
+    foreach(QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+
+    if(isCancelled(cancelled)) {
+        return;
+    }
+
+    QVector<int> buffer(count);
+    while(bounds.count() > 2 && !isCancelled(cancelled)) {
+        const int *source = rows.constData();
+        int *target = buffer.data();
+
+        futures.clear();
+        QVector<int> merged;
+        merged.append(0);
+        int i = 0;
+        for(; i + 2 < bounds.count(); i += 2) {
+            futures.append(QtConcurrent::run(mergeRanges<Compare>, source + bounds.at(i), source + bounds.at(i + 1),
+                                             source + bounds.at(i + 2), target + bounds.at(i), compare));
+            merged.append(bounds.at(i + 2));
+        }
+        if(i + 1 < bounds.count()) {
+            copyRange(source + bounds.at(i), source + bounds.at(i + 1), target + bounds.at(i));
+            merged.append(bounds.at(i + 1));
+        }
+        foreach(QFuture<void> future, futures) {
+            future.waitForFinished();
+        }
+
+        qSwap(rows, buffer);
+        bounds = merged;
+    }
+}
+
+/* Matches the filter regular expression and then the filter expression; scratch is only needed for both */
+static void filterRange(const SortFilterJob *job, int begin, int end, char *accepted, char *scratch)
+{
+    bool filtered = false;
+
+    if(job->filterStride > 0) {
+        QRegExp filter(job->filter);
+        const QString *texts = job->filterTexts.constData();
+        int stride = job->filterStride;
+
+        for(int row = begin; row < end; ++row) {
+            accepted[row] = 0;
+            for(int i = 0; i < stride; ++i) {
+                if(filter.indexIn(texts[row * stride + i]) >= 0) {
+                    accepted[row] = 1;
+                    break;
+                }
+            }
+        }
+
+        filtered = true;
+    }
+
+    if(!job->expression.isNull()) {
+        char *target = filtered ? scratch : accepted;
+        job->expression->evaluateRange(job->expressionValues, begin, end, target + begin);
+
+        if(filtered) {
+            for(int row = begin; row < end; ++row) {
+                accepted[row] &= scratch[row];
+            }
+        }
+    }
+}
+
+
+SortFilterProxyModelPrivate::SortFilterProxyModelPrivate() :
+    m_SortColumn(-1),
+    m_SortOrder(Qt::AscendingOrder),
+    m_SortRole(Qt::DisplayRole),
+    m_SortCaseSensitivity(Qt::CaseSensitive),
+    m_FilterKeyColumn(0),
+    m_FilterRole(Qt::DisplayRole),
+    m_DynamicSortFilter(true),
+    m_AsynchronousThreshold(10000),
+    m_SourceToProxyDirty(false),
+    m_FilterTextColumn(-2),
+    m_FilterStride(0),
+    m_Appending(false),
+    m_PendingFirst(-1)
+{
+    connect(&m_Watcher, SIGNAL(finished()), this, SLOT(jobFinished()));
+
+    m_InvalidateTimer.setSingleShot(true);
+    m_InvalidateTimer.setInterval(0);
+    connect(&m_InvalidateTimer, SIGNAL(timeout()), this, SLOT(restartJob()));
+
+    // Appended rows are gathered for a frame before they're inserted
+    m_AppendTimer.setSingleShot(true);
+    m_AppendTimer.setInterval(16);
+    connect(&m_AppendTimer, SIGNAL(timeout()), this, SLOT(flushAppendedRows()));
+}
+
+SortFilterProxyModelPrivate::~SortFilterProxyModelPrivate()
+{
+}
+
+/*!
+   \internal
+   \brief Forgets the cached sort keys, filter texts and expression columns.  The filter text column is -2 when
+          stale, as -1 is a valid key column meaning all columns.
+ */
+void SortFilterProxyModelPrivate::invalidateKeys()
+{
+    m_SortKeys.clear();
+    m_FilterTextColumn = -2;
+    m_FilterTexts.clear();
+    m_ExpressionColumns.clear();
+}
+
+/*!
+   \internal
+   \brief Reads \a column of \a model into typed values; numbers if every value in it is numeric or empty, with NaN
+          for the empty ones, strings otherwise.
+          When the same column has been read before, only rows appended since are read.  With \a ranked, string
+          columns of a columnar model are read as the sort ranks of their strings.
+ */
+void TypedColumn::read(const QAbstractItemModel *model, int column, int role, bool lowerCase, bool ranked)
+{
+    if(role == Qt::DisplayRole || role == Qt::EditRole) {
+        if(const Core::ViewManager::AbstractColumnarModel *columnar = qobject_cast<const Core::ViewManager::AbstractColumnarModel *>(model)) {
+            readColumnar(columnar, column, lowerCase, ranked);
+            return;
+        }
+    }
+
+    int rows = model->rowCount();
+
+    int first = 0;
+    if(this->column == column && this->lowerCase == lowerCase) {
+        first = count();
+        if(first >= rows) {
+            return;
+        }
+    } else {
+        clear();
+        this->column = column;
+        this->lowerCase = lowerCase;
+    }
+
+    if(numeric) {
+        numbers.resize(rows);
+        double *data = numbers.data();
+        for(int row = first; row < rows && numeric; ++row) {
+            QVariant value = model->index(row, column).data(role);
+            switch(value.userType()) {
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::LongLong:
+            case QMetaType::ULongLong:
+            case QMetaType::Double:
+            case QMetaType::Float:
+                data[row] = value.toDouble();
+                break;
+            case QVariant::Invalid:
+                data[row] = std::numeric_limits<double>::quiet_NaN();
+                break;
+            default:
+                numeric = false;
+            }
+        }
+
+        if(!numeric) {
+            first = 0;
+            numbers.clear();
+        }
+    }
+
+    if(!numeric) {
+        strings.resize(rows);
+        for(int row = first; row < rows; ++row) {
+            QString text = model->index(row, column).data(role).toString();
+            strings[row] = lowerCase ? text.toLower() : text;
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Copies \a column straight out of a columnar model's typed storage, without going through data().
+          Interning a new string changes the ranks of existing ones, so ranked columns are then read again in full.
+ */
+void TypedColumn::readColumnar(const Core::ViewManager::AbstractColumnarModel *model, int column, bool lowerCase, bool ranked)
+{
+    int rows = model->rowCount();
+    Core::ViewManager::AbstractColumnarModel::ColumnType type = model->columnType(column);
+    bool useRanks = (ranked && type == Core::ViewManager::AbstractColumnarModel::ColumnType_String);
+
+    int first = 0;
+    if(this->column == column && this->lowerCase == lowerCase &&
+            (!useRanks || ranks.count() == model->internedStringCount())) {
+        first = count();
+        if(first >= rows) {
+            return;
+        }
+    } else {
+        clear();
+        this->column = column;
+        this->lowerCase = lowerCase;
+    }
+
+    if(type == Core::ViewManager::AbstractColumnarModel::ColumnType_String && !useRanks) {
+        numeric = false;
+        strings.resize(rows);
+        const quint32 *ids = model->stringColumn(column);
+        for(int row = first; row < rows; ++row) {
+            QString text = model->internedString(ids[row]);
+            strings[row] = lowerCase ? text.toLower() : text;
+        }
+        return;
+    }
+
+    numbers.resize(rows);
+    double *data = numbers.data();
+
+    switch(type) {
+    case Core::ViewManager::AbstractColumnarModel::ColumnType_Int64:
+    {
+        const qint64 *values = model->int64Column(column);
+        for(int row = first; row < rows; ++row) {
+            data[row] = (double)values[row];
+        }
+        break;
+    }
+    case Core::ViewManager::AbstractColumnarModel::ColumnType_Double:
+        memcpy(data + first, model->doubleColumn(column) + first, (rows - first) * sizeof(double));
+        break;
+    default:
+    {
+        if(ranks.isEmpty()) {
+            ranks = model->internedStringRanks(lowerCase ? Qt::CaseInsensitive : Qt::CaseSensitive);
+        }
+        // Ids in a mapped file haven't been checked against its string table
+        const quint32 *ids = model->stringColumn(column);
+        const quint32 *rank = ranks.constData();
+        quint32 count = ranks.count();
+        for(int row = first; row < rows; ++row) {
+            data[row] = (ids[row] < count) ? rank[ids[row]] : 0;
+        }
+        break;
+    }
+    }
+}
+
+Core::ViewManager::FilterExpression::Column TypedColumn::values() const
+{
+    Core::ViewManager::FilterExpression::Column values;
+    if(numeric) {
+        values.numbers = numbers.constData();
+    } else {
+        values.strings = strings.constData();
+    }
+    return values;
+}
+
+/*!
+   \internal
+   \brief Reads the sort column into typed keys, lowercased when sorting ignores case.
+ */
+void SortFilterProxyModelPrivate::extractSortKeys()
+{
+    if(m_SortColumn < 0) {
+        return;
+    }
+
+    m_SortKeys.read(q->sourceModel(), m_SortColumn, m_SortRole, m_SortCaseSensitivity == Qt::CaseInsensitive, true);
+}
+
+/*!
+   \internal
+   \brief Reads the columns the filter expression refers to into typed values.
+ */
+void SortFilterProxyModelPrivate::extractExpressionColumns()
+{
+    if(m_FilterExpression.isNull()) {
+        return;
+    }
+
+    QList<int> columns = m_FilterExpression->columns();
+    m_ExpressionColumns.resize(columns.count());
+    for(int i = 0; i < columns.count(); ++i) {
+        m_ExpressionColumns[i].read(q->sourceModel(), columns.at(i), m_FilterRole, false);
+    }
+}
+
+/*!
+   \internal
+   \brief Compiles \a pattern against the source's current headers; an empty pattern removes the expression.
+ */
+bool SortFilterProxyModelPrivate::compileFilterExpression(const QString &pattern, QString *errorMessage)
+{
+    QSharedPointer<Core::ViewManager::FilterExpression> expression(
+                new Core::ViewManager::FilterExpression(pattern, Core::ViewManager::FilterExpression::columnNames(q->sourceModel())));
+
+    if(!expression->isValid()) {
+        if(errorMessage) {
+            *errorMessage = expression->errorString();
+        }
+        return false;
+    }
+
+    m_FilterExpressionPattern = pattern;
+    m_FilterExpression = expression->isEmpty() ? QSharedPointer<Core::ViewManager::FilterExpression>() : expression;
+    m_ExpressionColumns.clear();
+    return true;
+}
+
+/*!
+   \internal
+   \brief Reads the text the filter is matched against; one text per row, or every column's text when the filter
+          key column is -1.  When the texts are already cached, only rows appended since are read.
+ */
+void SortFilterProxyModelPrivate::extractFilterTexts()
+{
+    if(m_FilterRegExp.isEmpty()) {
+        return;
+    }
+
+    QAbstractItemModel *source = q->sourceModel();
+    int rows = source->rowCount();
+    int columns = source->columnCount();
+
+    int first = 0;
+    if(m_FilterTextColumn == m_FilterKeyColumn) {
+        if(m_FilterStride == 0) {
+            return;
+        }
+        first = m_FilterTexts.count() / m_FilterStride;
+        if(first >= rows) {
+            return;
+        }
+    } else {
+        m_FilterTexts.clear();
+        m_FilterTextColumn = m_FilterKeyColumn;
+        if(m_FilterKeyColumn >= columns) {
+            m_FilterStride = 0;
+            return;
+        }
+        m_FilterStride = (m_FilterKeyColumn < 0) ? columns : 1;
+    }
+
+    m_FilterTexts.resize(rows * m_FilterStride);
+    for(int row = first; row < rows; ++row) {
+        for(int i = 0; i < m_FilterStride; ++i) {
+            int column = (m_FilterKeyColumn < 0) ? i : m_FilterKeyColumn;
+            m_FilterTexts[row * m_FilterStride + i] = source->index(row, column).data(m_FilterRole).toString();
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Matches the filters against source rows \a first to \a last on the calling thread, setting a flag per row in
+          \a accepted; used for appended rows.
+ */
+void SortFilterProxyModelPrivate::acceptRows(int first, int last, char *accepted) const
+{
+    int count = last - first + 1;
+
+    if(m_FilterExpression.isNull()) {
+        memset(accepted, 1, count);
+    } else {
+        QVector<Core::ViewManager::FilterExpression::Column> values;
+        foreach(const TypedColumn &column, m_ExpressionColumns) {
+            values.append(column.values());
+        }
+        m_FilterExpression->evaluateRange(values, first, last + 1, accepted);
+    }
+
+    if(m_FilterRegExp.isEmpty() || m_FilterStride == 0) {
+        return;
+    }
+
+    for(int row = first; row <= last; ++row) {
+        if(!accepted[row - first]) {
+            continue;
+        }
+        accepted[row - first] = 0;
+        for(int i = 0; i < m_FilterStride; ++i) {
+            if(m_FilterRegExp.indexIn(m_FilterTexts.at(row * m_FilterStride + i)) >= 0) {
+                accepted[row - first] = 1;
+                break;
+            }
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Snapshots the keys into a job, and runs it; in the background if the model is large enough, in which case
+          the result is applied from jobFinished().  Any job already running is cancelled.
+ */
+void SortFilterProxyModelPrivate::startJob(bool synchronous)
+{
+    cancelJob();
+
+    QAbstractItemModel *source = q->sourceModel();
+    if(!source) {
+        return;
+    }
+
+    extractSortKeys();
+    extractFilterTexts();
+    extractExpressionColumns();
+
+    // The job covers every row the source has now, including any waiting to be flushed
+    m_PendingFirst = -1;
+
+    QSharedPointer<SortFilterJob> job(new SortFilterJob);
+    job->rowCount = source->rowCount();
+    if(m_SortColumn >= 0 && m_SortColumn < source->columnCount()) {
+        job->sortColumn = m_SortColumn;
+        job->order = m_SortOrder;
+        job->sortKeys = m_SortKeys;
+    }
+    if(!m_FilterRegExp.isEmpty() && m_FilterStride > 0) {
+        job->filterStride = m_FilterStride;
+        job->filterTexts = m_FilterTexts;
+        job->filter = m_FilterRegExp;
+    }
+    if(!m_FilterExpression.isNull()) {
+        job->expression = m_FilterExpression;
+        job->expressionColumns = m_ExpressionColumns;
+        foreach(const TypedColumn &column, job->expressionColumns) {
+            job->expressionValues.append(column.values());
+        }
+    }
+
+    if(synchronous || job->rowCount <= m_AsynchronousThreshold) {
+        runJob(job);
+        applyMapping(job->result);
+        return;
+    }
+
+    m_Job = job;
+    m_Watcher.setFuture(QtConcurrent::run(&SortFilterProxyModelPrivate::runJob, job));
+    emit q->busyChanged(true);
+}
+
+/*!
+   \internal
+   \brief Tells the running job, if any, to stop; its result will never be applied.
+ */
+void SortFilterProxyModelPrivate::cancelJob()
+{
+    if(m_Job.isNull()) {
+        return;
+    }
+
+    m_Job->cancelled.fetchAndStoreRelaxed(1);
+    m_Job.clear();
+    emit q->busyChanged(false);
+}
+
+/*!
+   \internal
+   \brief Worker side of a job: filters, then sorts, the source rows.  Touches nothing but the job.
+ */
+void SortFilterProxyModelPrivate::runJob(QSharedPointer<SortFilterJob> job)
+{
+    QVector<int> &rows = job->result;
+
+    if(job->filterStride > 0 || !job->expression.isNull()) {
+        QVector<char> accepted(job->rowCount);
+        QVector<char> scratch((job->filterStride > 0 && !job->expression.isNull()) ? job->rowCount : 0);
+        int chunks = chunkCount(job->rowCount);
+        QList<QFuture<void> > futures;
+        for(int i = 0; i < chunks; ++i) {
+            int begin = (int)(((qint64)job->rowCount * i) / chunks);
+            int end = (int)(((qint64)job->rowCount * (i + 1)) / chunks);
+            futures.append(QtConcurrent::run(filterRange, (const SortFilterJob *)job.data(), begin, end, accepted.data(),
+                                             scratch.data()));
+        }
+        foreach(QFuture<void> future, futures) {
+            future.waitForFinished();
+        }
+
+        if(isCancelled(job->cancelled)) {
+            return;
+        }
+
+        rows.reserve(job->rowCount);
+        for(int row = 0; row < job->rowCount; ++row) {
+            if(accepted.at(row)) {
+                rows.append(row);
+            }
+        }
+    } else {
+        rows.resize(job->rowCount);
+        for(int row = 0; row < job->rowCount; ++row) {
+            rows[row] = row;
+        }
+    }
+
+    if(job->sortColumn < 0 || isCancelled(job->cancelled)) {
+        return;
+    }
+
+    const TypedColumn &keys = job->sortKeys;
+    if(keys.numeric) {
+        if(job->order == Qt::AscendingOrder) {
+            parallelSort(rows, KeyLess<double>(keys.numbers.constData()), job->cancelled);
+        } else {
+            parallelSort(rows, KeyGreater<double>(keys.numbers.constData()), job->cancelled);
+        }
+    } else {
+        if(job->order == Qt::AscendingOrder) {
+            parallelSort(rows, KeyLess<QString>(keys.strings.constData()), job->cancelled);
+        } else {
+            parallelSort(rows, KeyGreater<QString>(keys.strings.constData()), job->cancelled);
+        }
+    }
+}
+
+void SortFilterProxyModelPrivate::restartJob()
+{
+    startJob();
+}
+
+void SortFilterProxyModelPrivate::jobFinished()
+{
+    if(m_Job.isNull() || !m_Watcher.future().isFinished()) {
+        return;
+    }
+
+    QSharedPointer<SortFilterJob> job = m_Job;
+    m_Job.clear();
+
+    applyMapping(job->result);
+    emit q->busyChanged(false);
+
+    flushAppendedRows();
+}
+
+/*!
+   \internal
+   \brief Swaps in a new proxy-to-source mapping with a single layout change, moving persistent indexes (selections,
+          the current index) along with their source rows.
+ */
+void SortFilterProxyModelPrivate::applyMapping(const QVector<int> &proxyToSource)
+{
+    emit q->layoutAboutToBeChanged();
+
+    QModelIndexList from = q->persistentIndexList();
+    QVector<int> sourceRows;
+    sourceRows.reserve(from.count());
+    foreach(QModelIndex index, from) {
+        sourceRows.append(index.row() < m_ProxyToSource.count() ? m_ProxyToSource.at(index.row()) : -1);
+    }
+
+    m_ProxyToSource = proxyToSource;
+    m_SourceToProxyDirty = true;
+
+    QModelIndexList to;
+    for(int i = 0; i < from.count(); ++i) {
+        int row = proxyRowForSource(sourceRows.at(i));
+        to.append(row < 0 ? QModelIndex() : q->createIndex(row, from.at(i).column()));
+    }
+    q->changePersistentIndexList(from, to);
+
+    emit q->layoutChanged();
+}
+
+/*!
+   \internal
+   \brief Maps every source row straight through, until a job provides the sorted and filtered mapping.
+ */
+void SortFilterProxyModelPrivate::resetMapping()
+{
+    int rows = q->sourceModel() ? q->sourceModel()->rowCount() : 0;
+    m_ProxyToSource.resize(rows);
+    m_SourceToProxy.resize(rows);
+    for(int row = 0; row < rows; ++row) {
+        m_ProxyToSource[row] = row;
+        m_SourceToProxy[row] = row;
+    }
+    m_SourceToProxyDirty = false;
+    m_PendingFirst = -1;
+}
+
+/*!
+   \internal
+   \brief Looks up the proxy row of a source row, or -1 if it is filtered out (or not yet inserted).  The reverse
+          mapping is rebuilt on first use after the proxy-to-source mapping has changed.
+ */
+int SortFilterProxyModelPrivate::proxyRowForSource(int sourceRow) const
+{
+    if(m_SourceToProxyDirty) {
+        m_SourceToProxy.fill(-1, q->sourceModel() ? q->sourceModel()->rowCount() : 0);
+        for(int row = 0; row < m_ProxyToSource.count(); ++row) {
+            m_SourceToProxy[m_ProxyToSource.at(row)] = row;
+        }
+        m_SourceToProxyDirty = false;
+    }
+
+    if(sourceRow < 0 || sourceRow >= m_SourceToProxy.count()) {
+        return -1;
+    }
+
+    return m_SourceToProxy.at(sourceRow);
+}
+
+void SortFilterProxyModelPrivate::sourceAboutToBeReset()
+{
+    cancelJob();
+    q->beginResetModel();
+}
+
+void SortFilterProxyModelPrivate::sourceReset()
+{
+    invalidateKeys();
+    resetMapping();
+    if(!compileFilterExpression(m_FilterExpressionPattern)) {
+        m_FilterExpression.clear();
+    }
+    q->endResetModel();
+    startJob();
+}
+
+/*!
+   \internal
+   \brief Rows appended to the end of the source are streamed into the current mapping by flushAppendedRows(); any
+          other insertion resets the proxy.
+ */
+void SortFilterProxyModelPrivate::sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(last)
+
+    m_Appending = (!parent.isValid() && first == q->sourceModel()->rowCount());
+    if(!m_Appending) {
+        sourceAboutToBeReset();
+    }
+}
+
+void SortFilterProxyModelPrivate::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent)
+
+    if(!m_Appending) {
+        sourceReset();
+        return;
+    }
+
+    m_Appending = false;
+
+    if(!m_SourceToProxyDirty) {
+        m_SourceToProxy.resize(last + 1);
+        for(int row = first; row <= last; ++row) {
+            m_SourceToProxy[row] = -1;
+        }
+    }
+
+    if(m_PendingFirst < 0) {
+        m_PendingFirst = first;
+    }
+
+    if(!m_AppendTimer.isActive()) {
+        m_AppendTimer.start();
+    }
+}
+
+/*!
+   \internal
+   \brief Inserts the filtered, sorted, appended rows into the mapping by binary search.  A few runs of rows are
+          inserted with one rowsInserted() each; when they land in many places, the mapping is merged and swapped in
+          with a single layout change instead.
+ */
+template <typename Compare>
+void SortFilterProxyModelPrivate::insertSorted(QVector<int> &rows, Compare compare)
+{
+    static const int MaximumInsertRuns = 16;
+
+    std::stable_sort(rows.begin(), rows.end(), compare);
+
+    QVector<int> positions(rows.count());
+    int runs = 0;
+    for(int i = 0; i < rows.count(); ++i) {
+        positions[i] = std::upper_bound(m_ProxyToSource.constBegin(), m_ProxyToSource.constEnd(), rows.at(i), compare)
+                - m_ProxyToSource.constBegin();
+        if(i == 0 || positions.at(i) != positions.at(i - 1)) {
+            ++runs;
+        }
+    }
+
+    if(runs > MaximumInsertRuns) {
+        QVector<int> merged(m_ProxyToSource.count() + rows.count());
+        std::merge(m_ProxyToSource.constBegin(), m_ProxyToSource.constEnd(), rows.constBegin(), rows.constEnd(),
+                   merged.begin(), compare);
+        applyMapping(merged);
+        return;
+    }
+
+    int inserted = 0;
+    for(int i = 0; i < rows.count(); ) {
+        int count = 1;
+        while(i + count < rows.count() && positions.at(i + count) == positions.at(i)) {
+            ++count;
+        }
+
+        int at = positions.at(i) + inserted;
+        q->beginInsertRows(QModelIndex(), at, at + count - 1);
+        m_ProxyToSource.insert(at, count, 0);
+        for(int j = 0; j < count; ++j) {
+            m_ProxyToSource[at + j] = rows.at(i + j);
+        }
+        m_SourceToProxyDirty = true;
+        q->endInsertRows();
+
+        inserted += count;
+        i += count;
+    }
+}
+
+/*!
+   \internal
+   \brief Streams rows appended to the source since the last flush into the current mapping, at most once per frame,
+          without re-sorting the rows already there.  Waits for any background job, whose mapping doesn't have them.
+ */
+void SortFilterProxyModelPrivate::flushAppendedRows()
+{
+    QAbstractItemModel *source = q->sourceModel();
+    if(m_PendingFirst < 0 || !m_Job.isNull() || !source) {
+        return;
+    }
+
+    // Keys invalidated since the last sort mean the mapping is about to be rebuilt anyway
+    int keyColumn = m_SortKeys.column;
+    bool keysNumeric = m_SortKeys.numeric;
+    bool sorted = (m_SortColumn >= 0 && m_SortColumn < source->columnCount());
+    extractSortKeys();
+    if(sorted && (keyColumn != m_SortColumn || keysNumeric != m_SortKeys.numeric)) {
+        startJob();
+        return;
+    }
+
+    extractFilterTexts();
+    extractExpressionColumns();
+
+    int first = m_PendingFirst;
+    int rowCount = source->rowCount();
+    m_PendingFirst = -1;
+
+    QVector<char> accepted(rowCount - first);
+    acceptRows(first, rowCount - 1, accepted.data());
+
+    QVector<int> rows;
+    rows.reserve(rowCount - first);
+    for(int row = first; row < rowCount; ++row) {
+        if(accepted.at(row - first)) {
+            rows.append(row);
+        }
+    }
+
+    if(rows.isEmpty()) {
+        return;
+    }
+
+    emit q->streamedRowsAboutToBeInserted();
+
+    if(!sorted) {
+        int at = m_ProxyToSource.count();
+        q->beginInsertRows(QModelIndex(), at, at + rows.count() - 1);
+        m_ProxyToSource += rows;
+        m_SourceToProxyDirty = true;
+        q->endInsertRows();
+    } else if(m_SortKeys.numeric) {
+        if(m_SortOrder == Qt::AscendingOrder) {
+            insertSorted(rows, KeyLess<double>(m_SortKeys.numbers.constData()));
+        } else {
+            insertSorted(rows, KeyGreater<double>(m_SortKeys.numbers.constData()));
+        }
+    } else {
+        if(m_SortOrder == Qt::AscendingOrder) {
+            insertSorted(rows, KeyLess<QString>(m_SortKeys.strings.constData()));
+        } else {
+            insertSorted(rows, KeyGreater<QString>(m_SortKeys.strings.constData()));
+        }
+    }
+
+    emit q->streamedRowsInserted();
+}
+
+void SortFilterProxyModelPrivate::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    int first = m_ProxyToSource.count();
+    int last = -1;
+    for(int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        int proxyRow = proxyRowForSource(row);
+        if(proxyRow >= 0) {
+            first = qMin(first, proxyRow);
+            last = qMax(last, proxyRow);
+        }
+    }
+
+    if(first <= last) {
+        emit q->dataChanged(q->index(first, topLeft.column()), q->index(last, bottomRight.column()));
+    }
+
+    bool sortChanged = (m_SortColumn >= topLeft.column() && m_SortColumn <= bottomRight.column());
+    bool filterChanged = !m_FilterRegExp.isEmpty() && (m_FilterKeyColumn < 0 ||
+            (m_FilterKeyColumn >= topLeft.column() && m_FilterKeyColumn <= bottomRight.column()));
+
+    if(sortChanged) {
+        m_SortKeys.clear();
+    }
+    if(filterChanged) {
+        m_FilterTextColumn = -2;
+    }
+
+    for(int i = 0; i < m_ExpressionColumns.count(); ++i) {
+        int column = m_ExpressionColumns.at(i).column;
+        if(column >= topLeft.column() && column <= bottomRight.column()) {
+            m_ExpressionColumns[i].clear();
+            filterChanged = true;
+        }
+    }
+
+    if(m_DynamicSortFilter && (sortChanged || filterChanged)) {
+        m_InvalidateTimer.start();
+    }
+}
+
+} // namespace TableView
+} // namespace Plugins
@@ -0,0 +1,103 @@
+/*!
+   \file SortFilterProxyModel.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_SORTFILTERPROXYMODEL_H
+#define PLUGINS_TABLEVIEW_SORTFILTERPROXYMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QRegExp>
+#include <QVector>
+
+#include "TableViewLibrary.h"
+
+namespace Plugins {
+namespace TableView {
+
+class SortFilterProxyModelPrivate;
+
+class TABLEVIEW_EXPORT SortFilterProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(SortFilterProxyModel)
+    Q_DISABLE_COPY(SortFilterProxyModel)
+
+public:
+    explicit SortFilterProxyModel(QObject *parent = 0);
+    ~SortFilterProxyModel();
+
+    virtual void setSourceModel(QAbstractItemModel *sourceModel);
+
+    virtual QModelIndex mapToSource(const QModelIndex &proxyIndex) const;
+    virtual QModelIndex mapFromSource(const QModelIndex &sourceIndex) const;
+    QVector<int> sourceRows() const;
+
+    virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    virtual QModelIndex parent(const QModelIndex &child) const;
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+    int sortColumn() const;
+    Qt::SortOrder sortOrder() const;
+
+    int sortRole() const;
+    void setSortRole(int role);
+    Qt::CaseSensitivity sortCaseSensitivity() const;
+    void setSortCaseSensitivity(Qt::CaseSensitivity cs);
+
+    QRegExp filterRegExp() const;
+    void setFilterRegExp(const QRegExp &regExp);
+    void setFilterRegExp(const QString &pattern);
+    int filterKeyColumn() const;
+    void setFilterKeyColumn(int column);
+    int filterRole() const;
+    void setFilterRole(int role);
+    Qt::CaseSensitivity filterCaseSensitivity() const;
+    void setFilterCaseSensitivity(Qt::CaseSensitivity cs);
+    QString filterExpression() const;
+    bool setFilterExpression(const QString &expression, QString *errorMessage = NULL);
+
+    bool dynamicSortFilter() const;
+    void setDynamicSortFilter(bool enable);
+
+    int asynchronousThreshold() const;
+    void setAsynchronousThreshold(int rows);
+
+    bool isBusy() const;
+    void waitForFinished();
+
+public slots:
+    void invalidate();
+
+signals:
+    void busyChanged(bool busy);
+    void streamedRowsAboutToBeInserted();
+    void streamedRowsInserted();
+
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_SORTFILTERPROXYMODEL_H
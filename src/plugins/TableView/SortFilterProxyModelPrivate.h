@@ -0,0 +1,164 @@
+/*!
+   \file SortFilterProxyModelPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_SORTFILTERPROXYMODELPRIVATE_H
+#define PLUGINS_TABLEVIEW_SORTFILTERPROXYMODELPRIVATE_H
+
+#include "SortFilterProxyModel.h"
+
+#include <QVector>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QTimer>
+
+#include <ViewManager/AbstractColumnarModel.h>
+#include <ViewManager/FilterExpression.h>
+
+namespace Plugins {
+namespace TableView {
+
+/* One source column read into typed values: numbers, NaN where empty, if every value is numeric, strings otherwise */
+struct TypedColumn
+{
+    TypedColumn() : column(-1), lowerCase(false), numeric(true) {}
+
+    void clear() { column = -1; lowerCase = false; numeric = true; numbers.clear(); strings.clear(); ranks.clear(); }
+    int count() const { return numeric ? numbers.count() : strings.count(); }
+    void read(const QAbstractItemModel *model, int column, int role, bool lowerCase, bool ranked = false);
+    void readColumnar(const Core::ViewManager::AbstractColumnarModel *model, int column, bool lowerCase, bool ranked);
+    Core::ViewManager::FilterExpression::Column values() const;
+
+    int column;
+    bool lowerCase;
+    bool numeric;
+    QVector<double> numbers;
+    QVector<QString> strings;
+
+    /* Sort ranks of a columnar model's interned strings, when a string column is read as numbers; they depend on
+       lowerCase, so reading with the other case sensitivity starts over */
+    QVector<quint32> ranks;
+};
+
+/* Everything a worker thread needs to sort and filter, copied out of the source model on the GUI thread */
+struct SortFilterJob
+{
+    SortFilterJob() : rowCount(0), sortColumn(-1), order(Qt::AscendingOrder), filterStride(0) {}
+
+    int rowCount;
+
+    int sortColumn;
+    Qt::SortOrder order;
+    TypedColumn sortKeys;
+
+    /* filterStride texts per source row; no filtering when zero */
+    int filterStride;
+    QVector<QString> filterTexts;
+    QRegExp filter;
+
+    QSharedPointer<Core::ViewManager::FilterExpression> expression;
+    QVector<TypedColumn> expressionColumns;
+    QVector<Core::ViewManager::FilterExpression::Column> expressionValues;
+
+    QAtomicInt cancelled;
+    QVector<int> result;
+};
+
+class SortFilterProxyModelPrivate : public QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(SortFilterProxyModel)
+    Q_DISABLE_COPY(SortFilterProxyModelPrivate)
+
+public:
+    SortFilterProxyModelPrivate();
+    ~SortFilterProxyModelPrivate();
+
+    void invalidateKeys();
+    void extractSortKeys();
+    void extractFilterTexts();
+    void extractExpressionColumns();
+    bool compileFilterExpression(const QString &pattern, QString *errorMessage = NULL);
+
+    void startJob(bool synchronous = false);
+    void cancelJob();
+    void applyMapping(const QVector<int> &proxyToSource);
+    void resetMapping();
+    int proxyRowForSource(int sourceRow) const;
+
+    void acceptRows(int first, int last, char *accepted) const;
+    template <typename Compare> void insertSorted(QVector<int> &rows, Compare compare);
+
+    static void runJob(QSharedPointer<SortFilterJob> job);
+
+protected slots:
+    void restartJob();
+    void jobFinished();
+    void sourceAboutToBeReset();
+    void sourceReset();
+    void sourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void flushAppendedRows();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+private:
+    int m_SortColumn;
+    Qt::SortOrder m_SortOrder;
+    int m_SortRole;
+    Qt::CaseSensitivity m_SortCaseSensitivity;
+
+    QRegExp m_FilterRegExp;
+    int m_FilterKeyColumn;
+    int m_FilterRole;
+
+    bool m_DynamicSortFilter;
+    int m_AsynchronousThreshold;
+
+    QVector<int> m_ProxyToSource;
+    mutable QVector<int> m_SourceToProxy;
+    mutable bool m_SourceToProxyDirty;
+
+    QString m_FilterExpressionPattern;
+    QSharedPointer<Core::ViewManager::FilterExpression> m_FilterExpression;
+
+    /* Typed sort keys, filter texts and expression columns, kept until the source data changes */
+    TypedColumn m_SortKeys;
+    QVector<TypedColumn> m_ExpressionColumns;
+    int m_FilterTextColumn;
+    int m_FilterStride;
+    QVector<QString> m_FilterTexts;
+
+    /* Source rows from m_PendingFirst on were appended and are waiting to be inserted; -1 when there are none */
+    bool m_Appending;
+    int m_PendingFirst;
+    QTimer m_AppendTimer;
+
+    QSharedPointer<SortFilterJob> m_Job;
+    QFutureWatcher<void> m_Watcher;
+    QTimer m_InvalidateTimer;
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_SORTFILTERPROXYMODELPRIVATE_H
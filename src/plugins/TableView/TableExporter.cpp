@@ -0,0 +1,698 @@
+/*!
+   \file TableExporter.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TableExporterPrivate.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QMimeData>
+#include <QtConcurrentRun>
+
+#include <CoreWindow/CoreWindow.h>
+
+#include "TableView.h"
+#include "SortFilterProxyModel.h"
+
+namespace Plugins {
+namespace TableView {
+
+using Core::ViewManager::AbstractColumnarModel;
+
+/*! \class Plugins::TableView::TableExporter
+    \brief Writes the rows of a TableView, or just its selection, out as comma or tab separated text, to a QIODevice
+           or the clipboard.
+
+    Rows go out in the order the view shows them, after its sorting and filtering, and only the columns the view
+    shows, in the order it shows them.  Values are the model's display data, except that the typed columns of a
+    Core::ViewManager::AbstractColumnarModel are read directly.
+
+    The export runs in slices of rows: the GUI thread copies one slice out of the model while a worker formats the
+    last and writes it to the device, so the GUI thread never waits on the disk.  Sequential devices, such as sockets,
+    belong to their own thread's event loop and are written from the GUI thread instead.  However large the table,
+    only two slices are held at a time (an export to the clipboard has to hold all of its text, of course).  Progress
+    is reported through progressChanged() as each slice is written.  The device shouldn't be used by anything else,
+    or destroyed, until finished() is emitted.
+    \code
+    QFile *file = new QFile(fileName, this);
+    file->open(QIODevice::WriteOnly);
+    TableExporter *exporter = new TableExporter(this);
+    connect(exporter, SIGNAL(finished(bool)), file, SLOT(deleteLater()));
+    exporter->start(tableView, file);
+    \endcode
+    \sa TableView::exportRows() TableView::copySelection() DelimitedImporter
+ */
+
+TableExporter::TableExporter(QObject *parent) :
+    QObject(parent),
+    d(new TableExporterPrivate)
+{
+    d->q = this;
+    connect(&d->m_Watcher, SIGNAL(finished()), d.data(), SLOT(sliceFormatted()));
+}
+
+TableExporter::~TableExporter()
+{
+    d->m_Watcher.waitForFinished();
+    d->end(false);
+}
+
+/*! \fn TableExporter::delimiter()
+    \brief The field delimiter; a comma by default.
+ */
+char TableExporter::delimiter() const
+{
+    return d->m_Delimiter;
+}
+
+void TableExporter::setDelimiter(char delimiter)
+{
+    d->m_Delimiter = delimiter;
+}
+
+/*! \fn TableExporter::headerIncluded()
+    \brief Whether the column titles are written as the first line; true by default.
+ */
+bool TableExporter::headerIncluded() const
+{
+    return d->m_HeaderIncluded;
+}
+
+void TableExporter::setHeaderIncluded(bool included)
+{
+    d->m_HeaderIncluded = included;
+}
+
+/*! \fn TableExporter::selectionOnly()
+    \brief Whether only the selected rows and columns are exported; false by default.  The rows and columns with a
+           selected cell are exported whole, so the text is always rectangular.
+ */
+bool TableExporter::selectionOnly() const
+{
+    return d->m_SelectionOnly;
+}
+
+void TableExporter::setSelectionOnly(bool selectionOnly)
+{
+    d->m_SelectionOnly = selectionOnly;
+}
+
+/*! \fn TableExporter::progressVisible()
+    \brief Whether a progress bar is shown in the main window's status bar while exporting; true by default.
+ */
+bool TableExporter::progressVisible() const
+{
+    return d->m_ProgressVisible;
+}
+
+void TableExporter::setProgressVisible(bool visible)
+{
+    d->m_ProgressVisible = visible;
+}
+
+/*! \fn TableExporter::start()
+    \brief Starts writing the rows of \a view to \a device, which must already be open for writing.  Returns false if
+           the view can't be exported; a Core::ViewManager::PagedModel, for one, doesn't hold all of its rows.
+ */
+bool TableExporter::start(TableView *view, QIODevice *device)
+{
+    if(d->m_Running) {
+        d->m_ErrorString = tr("An export is already running");
+        return false;
+    }
+    if(!device || !device->isWritable()) {
+        d->m_ErrorString = tr("The device isn't open for writing");
+        return false;
+    }
+
+    d->m_Device = device;
+    d->m_WorkerWrites = !device->isSequential();
+    d->m_Clipboard = false;
+    return d->begin(view);
+}
+
+/*! \fn TableExporter::startToClipboard()
+    \brief Starts copying the rows of \a view to the clipboard, where they are put once all of them are formatted.
+ */
+bool TableExporter::startToClipboard(TableView *view)
+{
+    if(d->m_Running) {
+        d->m_ErrorString = tr("An export is already running");
+        return false;
+    }
+
+    d->m_Device = NULL;
+    d->m_WorkerWrites = false;
+    d->m_Clipboard = true;
+    return d->begin(view);
+}
+
+bool TableExporter::isRunning() const
+{
+    return d->m_Running;
+}
+
+/*! \fn TableExporter::waitForFinished()
+    \brief Blocks until the export has finished, and returns whether it succeeded.
+ */
+bool TableExporter::waitForFinished()
+{
+    while(d->m_Running) {
+        d->m_Watcher.waitForFinished();
+        d->sliceFormatted();
+    }
+    return d->m_ErrorString.isEmpty();
+}
+
+/*! \fn TableExporter::rowCount()
+    \brief The number of rows the export writes, not counting the header.
+ */
+int TableExporter::rowCount() const
+{
+    return d->m_Rows.count();
+}
+
+qint64 TableExporter::bytesWritten() const
+{
+    return d->m_BytesWritten;
+}
+
+QString TableExporter::errorString() const
+{
+    return d->m_ErrorString;
+}
+
+/*! \fn TableExporter::cancel()
+    \brief Stops the export once the slice being formatted is done.  Whatever was written already stays written.
+ */
+void TableExporter::cancel()
+{
+    d->m_Cancelled = true;
+}
+
+
+
+
+/* Rows copied out of the model at a time */
+static const int SliceRows = 8192;
+
+static inline bool needsQuotes(const QByteArray &text, char delimiter)
+{
+    for(const char *c = text.constData(), *end = c + text.size(); c < end; ++c) {
+        if(*c == delimiter || *c == '"' || *c == '\n' || *c == '\r') {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* An empty cell, NaN, is written as an empty field */
+static inline void appendNumber(QByteArray &text, double value)
+{
+    if(value == value) {
+        text.append(QByteArray::number(value, 'g', 15));
+    }
+}
+
+static inline void appendNumber(QByteArray &text, qint64 value)
+{
+    text.append(QByteArray::number(value));
+}
+
+
+
+
+TableExporterPrivate::TableExporterPrivate() :
+    QObject(NULL),
+    m_Delimiter(','),
+    m_HeaderIncluded(true),
+    m_SelectionOnly(false),
+    m_ProgressVisible(true),
+    m_WorkerWrites(false),
+    m_Clipboard(false),
+    m_Columnar(NULL),
+    m_NextRow(0),
+    m_Formatting(NULL),
+    m_Pending(NULL),
+    m_Running(false),
+    m_Cancelled(false),
+    m_BytesWritten(0)
+{
+}
+
+TableExporterPrivate::~TableExporterPrivate()
+{
+}
+
+/*!
+   \internal
+   \brief Quotes \a text if it holds the delimiter, a quote or a line break, doubling any quotes, and encodes it.
+ */
+QByteArray TableExporterPrivate::escape(const QString &text, char delimiter)
+{
+    QByteArray bytes = text.toUtf8();
+    if(!needsQuotes(bytes, delimiter)) {
+        return bytes;
+    }
+
+    bytes.replace("\"", "\"\"");
+    bytes.prepend('"');
+    bytes.append('"');
+    return bytes;
+}
+
+/*!
+   \internal
+   \brief Snapshots everything the export needs from \a view: the rows in view order, the visible columns in visual
+          order and how each one is read.  Then gets the first slices going, the header leading the first.
+ */
+bool TableExporterPrivate::begin(TableView *view)
+{
+    m_ErrorString.clear();
+    m_BytesWritten = 0;
+    m_Cancelled = false;
+    m_ClipboardText.clear();
+    m_StringCache.clear();
+    m_Rows.clear();
+    m_Columns.clear();
+    m_NextRow = 0;
+
+    // Views that show a model without the proxy, such as a Core::ViewManager::PagedModel, don't hold every row
+    SortFilterProxyModel *proxy = view ? qobject_cast<SortFilterProxyModel *>(view->QAbstractItemView::model()) : NULL;
+    QAbstractItemModel *model = proxy ? proxy->sourceModel() : NULL;
+    if(!model) {
+        m_ErrorString = TableExporter::tr("This view can't be exported");
+        return false;
+    }
+
+    // Export what the view shows once it has finished sorting and filtering
+    proxy->waitForFinished();
+    QVector<int> sourceRows = proxy->sourceRows();
+
+    QHeaderView *header = view->horizontalHeader();
+    QVector<char> selectedColumns;
+    if(m_SelectionOnly) {
+        QVector<char> selectedRows(sourceRows.count(), 0);
+        selectedColumns.fill(0, proxy->columnCount());
+        foreach(const QItemSelectionRange &range, view->selectionModel()->selection()) {
+            for(int row = range.top(); row <= range.bottom() && row < selectedRows.count(); ++row) {
+                selectedRows[row] = 1;
+            }
+            for(int column = range.left(); column <= range.right() && column < selectedColumns.count(); ++column) {
+                selectedColumns[column] = 1;
+            }
+        }
+        for(int row = 0; row < selectedRows.count(); ++row) {
+            if(selectedRows.at(row)) {
+                m_Rows.append(sourceRows.at(row));
+            }
+        }
+    } else {
+        m_Rows = sourceRows;
+    }
+
+    m_Model = model;
+    m_Columnar = qobject_cast<AbstractColumnarModel *>(model);
+    for(int visual = 0; visual < header->count(); ++visual) {
+        int column = header->logicalIndex(visual);
+        if(column < 0 || header->isSectionHidden(column) || (m_SelectionOnly && !selectedColumns.value(column))) {
+            continue;
+        }
+
+        ExportColumn exportColumn;
+        exportColumn.column = column;
+        if(m_Columnar) {
+            switch(m_Columnar->columnType(column)) {
+            case AbstractColumnarModel::ColumnType_Int64:
+                exportColumn.kind = ExportColumn::Kind_Int64;
+                break;
+            case AbstractColumnarModel::ColumnType_Double:
+                exportColumn.kind = ExportColumn::Kind_Double;
+                break;
+            case AbstractColumnarModel::ColumnType_String:
+                exportColumn.kind = ExportColumn::Kind_String;
+                break;
+            }
+        }
+        m_Columns.append(exportColumn);
+    }
+
+    connect(model, SIGNAL(destroyed()), this, SLOT(sourceChanged()));
+    connect(model, SIGNAL(modelAboutToBeReset()), this, SLOT(sourceChanged()));
+    connect(model, SIGNAL(layoutAboutToBeChanged()), this, SLOT(sourceChanged()));
+    connect(model, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+    connect(model, SIGNAL(columnsAboutToBeRemoved(QModelIndex,int,int)), this, SLOT(sourceChanged()));
+
+    Core::CoreWindow::CoreWindow &coreWindow = Core::CoreWindow::CoreWindow::instance();
+    if(m_ProgressVisible && coreWindow.initialized()) {
+        m_ProgressBar = coreWindow.addProgressBar();
+        m_ProgressBar->setRange(0, 100);
+        m_ProgressBar->setValue(0);
+        m_ProgressBar->show();
+    }
+
+    m_Running = true;
+
+    // One slice is formatted while the next is copied
+    copySlice(&m_Slices[0]);
+    if(m_HeaderIncluded && !m_Columns.isEmpty()) {
+        QByteArray &text = m_Slices[0].text;
+        for(int i = 0; i < m_Columns.count(); ++i) {
+            if(i > 0) {
+                text.append(m_Delimiter);
+            }
+            text.append(escape(model->headerData(m_Columns.at(i).column, Qt::Horizontal).toString(), m_Delimiter));
+        }
+        text.append('\n');
+    }
+    launch(&m_Slices[0]);
+    if(m_NextRow < m_Rows.count()) {
+        copySlice(&m_Slices[1]);
+        m_Pending = &m_Slices[1];
+    }
+
+    return true;
+}
+
+/*!
+   \internal
+   \brief Finishes the export: puts the text on the clipboard if that's where it's going, takes down the progress
+          bar and lets go of the snapshot.
+ */
+void TableExporterPrivate::end(bool ok, const QString &errorString)
+{
+    if(!m_Running) {
+        return;
+    }
+
+    m_Running = false;
+    m_Formatting = NULL;
+    m_Pending = NULL;
+
+    if(m_Model) {
+        disconnect(m_Model, 0, this, 0);
+    }
+
+    if(m_ProgressBar) {
+        Core::CoreWindow::CoreWindow::instance().removeProgressBar(m_ProgressBar);
+        delete m_ProgressBar;
+    }
+
+    if(ok && m_Clipboard) {
+        QMimeData *mimeData = new QMimeData;
+        mimeData->setText(QString::fromUtf8(m_ClipboardText.constData(), m_ClipboardText.size()));
+        mimeData->setData((m_Delimiter == '\t') ? "text/tab-separated-values" : "text/csv", m_ClipboardText);
+        QApplication::clipboard()->setMimeData(mimeData);
+    }
+
+    if(!ok) {
+        m_ErrorString = errorString.isEmpty() ? TableExporter::tr("The export was cancelled") : errorString;
+    }
+
+    m_Model = NULL;
+    m_Columnar = NULL;
+    m_StringCache.clear();
+    m_ClipboardText.clear();
+    for(int i = 0; i < 2; ++i) {
+        m_Slices[i] = ExportSlice();
+    }
+
+    emit q->finished(ok);
+}
+
+/*!
+   \internal
+   \brief Copies the next slice of rows out of the model, on the GUI thread.  Interned strings are escaped once per
+          export, and handed to the worker ready to append.
+ */
+void TableExporterPrivate::copySlice(ExportSlice *slice)
+{
+    int first = m_NextRow;
+    int count = qMin(SliceRows, m_Rows.count() - first);
+    const int *rows = m_Rows.constData() + first;
+    m_NextRow += count;
+
+    slice->rows = count;
+    slice->text.clear();
+    slice->bytesWritten = 0;
+    slice->errorString.clear();
+    slice->integers.resize(m_Columns.count());
+    slice->numbers.resize(m_Columns.count());
+    slice->strings.resize(m_Columns.count());
+    slice->variants.clear();
+
+    if(m_Columnar) {
+        int rowCount = m_Columnar->rowCount();
+        for(int i = 0; i < m_Columns.count(); ++i) {
+            int column = m_Columns.at(i).column;
+            switch(m_Columns.at(i).kind) {
+            case ExportColumn::Kind_Int64:
+            {
+                const qint64 *values = m_Columnar->int64Column(column);
+                QVector<qint64> &integers = slice->integers[i];
+                integers.resize(count);
+                for(int row = 0; row < count; ++row) {
+                    integers[row] = (rows[row] < rowCount) ? values[rows[row]] : 0;
+                }
+                break;
+            }
+            case ExportColumn::Kind_Double:
+            {
+                const double *values = m_Columnar->doubleColumn(column);
+                QVector<double> &numbers = slice->numbers[i];
+                numbers.resize(count);
+                for(int row = 0; row < count; ++row) {
+                    numbers[row] = (rows[row] < rowCount) ? values[rows[row]] : 0.0;
+                }
+                break;
+            }
+            case ExportColumn::Kind_String:
+            {
+                int dictionaryCount = m_Columnar->internedStringCount();
+                for(int id = m_StringCache.count(); id < dictionaryCount; ++id) {
+                    m_StringCache.append(escape(m_Columnar->internedString(id), m_Delimiter));
+                }
+
+                const quint32 *values = m_Columnar->stringColumn(column);
+                QVector<QByteArray> &strings = slice->strings[i];
+                strings.resize(count);
+                for(int row = 0; row < count; ++row) {
+                    quint32 id = (rows[row] < rowCount) ? values[rows[row]] : 0;
+                    strings[row] = (id < (quint32)m_StringCache.count()) ? m_StringCache.at(id) : QByteArray();
+                }
+                break;
+            }
+            case ExportColumn::Kind_Variant:
+                break;
+            }
+        }
+    } else {
+        slice->variants.reserve(count * m_Columns.count());
+        for(int row = 0; row < count; ++row) {
+            for(int i = 0; i < m_Columns.count(); ++i) {
+                slice->variants.append(m_Model->data(m_Model->index(rows[row], m_Columns.at(i).column)));
+            }
+        }
+    }
+}
+
+/*!
+   \internal
+   \brief Formats \a slice on a worker thread, which writes it out too when the device allows.
+ */
+void TableExporterPrivate::launch(ExportSlice *slice)
+{
+    m_Formatting = slice;
+    QIODevice *device = m_WorkerWrites ? m_Device.data() : NULL;
+    m_Watcher.setFuture(QtConcurrent::run(&TableExporterPrivate::formatSlice, slice,
+                                          (const QVector<ExportColumn> *)&m_Columns, m_Delimiter, device));
+}
+
+/*!
+   \internal
+   \brief Runs on a worker: formats the rows of \a slice into its text, one line per row, after any text already
+          there.  With a \a device, writes the text to it and keeps only the outcome.
+ */
+void TableExporterPrivate::formatSlice(ExportSlice *slice, const QVector<ExportColumn> *columns, char delimiter,
+                                       QIODevice *device)
+{
+    const int columnCount = columns->count();
+    QByteArray &text = slice->text;
+    text.reserve(text.size() + slice->rows * columnCount * 12);
+
+    for(int row = 0; row < slice->rows; ++row) {
+        for(int i = 0; i < columnCount; ++i) {
+            if(i > 0) {
+                text.append(delimiter);
+            }
+
+            switch(columns->at(i).kind) {
+            case ExportColumn::Kind_Int64:
+                appendNumber(text, slice->integers.at(i).at(row));
+                break;
+            case ExportColumn::Kind_Double:
+                appendNumber(text, slice->numbers.at(i).at(row));
+                break;
+            case ExportColumn::Kind_String:
+                text.append(slice->strings.at(i).at(row));
+                break;
+            case ExportColumn::Kind_Variant:
+            {
+                const QVariant &value = slice->variants.at(row * columnCount + i);
+                switch((int)value.type()) {
+                case QMetaType::Double:
+                case QMetaType::Float:
+                    appendNumber(text, value.toDouble());
+                    break;
+                case QMetaType::Int:
+                case QMetaType::UInt:
+                case QMetaType::LongLong:
+                case QMetaType::ULongLong:
+                    appendNumber(text, value.toLongLong());
+                    break;
+                default:
+                    if(value.isValid()) {
+                        text.append(escape(value.toString(), delimiter));
+                    }
+                    break;
+                }
+                break;
+            }
+            }
+        }
+        text.append('\n');
+    }
+
+    // The values aren't needed once they are text
+    slice->integers.clear();
+    slice->numbers.clear();
+    slice->strings.clear();
+    slice->variants.clear();
+
+    if(device) {
+        if(device->write(text) == text.size()) {
+            slice->bytesWritten = text.size();
+        } else {
+            slice->errorString = device->errorString();
+        }
+        text.clear();
+    }
+}
+
+/*!
+   \internal
+   \brief Writes \a text to the device, or keeps it for the clipboard; ends the export if the device fails.
+ */
+bool TableExporterPrivate::write(const QByteArray &text)
+{
+    if(m_Clipboard) {
+        m_ClipboardText.append(text);
+    } else {
+        if(!m_Device) {
+            end(false, TableExporter::tr("The device was destroyed"));
+            return false;
+        }
+        if(m_Device->write(text) != text.size()) {
+            end(false, m_Device->errorString());
+            return false;
+        }
+    }
+
+    m_BytesWritten += text.size();
+    return true;
+}
+
+/*!
+   \internal
+   \brief Writes out the slice a worker has just formatted, unless the worker wrote it already, reports progress,
+          starts on the slice copied meanwhile, and copies the next.
+ */
+void TableExporterPrivate::sliceFormatted()
+{
+    // Stale notifications, from before the last slice was launched, are ignored
+    if(!m_Running || !m_Formatting || !m_Watcher.future().isFinished()) {
+        return;
+    }
+
+    ExportSlice *slice = m_Formatting;
+    m_Formatting = NULL;
+
+    if(m_WorkerWrites) {
+        if(!slice->errorString.isEmpty()) {
+            end(false, slice->errorString);
+            return;
+        }
+        m_BytesWritten += slice->bytesWritten;
+    } else if(!write(slice->text)) {
+        return;
+    }
+    slice->text.clear();
+
+    qint64 written = m_NextRow - (m_Pending ? m_Pending->rows : 0);
+    int percent = m_Rows.isEmpty() ? 100 : (int)((written * 100) / m_Rows.count());
+    if(m_ProgressBar) {
+        m_ProgressBar->setValue(percent);
+    }
+    emit q->progressChanged(percent);
+
+    if(m_Cancelled) {
+        end(false);
+        return;
+    }
+
+    if(!m_Pending) {
+        end(true);
+        return;
+    }
+
+    if(m_WorkerWrites && !m_Device) {
+        end(false, TableExporter::tr("The device was destroyed"));
+        return;
+    }
+
+    launch(m_Pending);
+    m_Pending = NULL;
+    if(m_NextRow < m_Rows.count()) {
+        copySlice(slice);
+        m_Pending = slice;
+    }
+}
+
+/*!
+   \internal
+   \brief Stops the export when the model is reset, destroyed, or loses rows or columns, as the snapshot of its rows
+          no longer holds.
+ */
+void TableExporterPrivate::sourceChanged()
+{
+    if(!m_Running) {
+        return;
+    }
+
+    m_Watcher.waitForFinished();
+    end(false, TableExporter::tr("The table changed during the export"));
+}
+
+} // namespace TableView
+} // namespace Plugins
@@ -0,0 +1,79 @@
+/*!
+   \file TableExporter.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_TABLEEXPORTER_H
+#define PLUGINS_TABLEVIEW_TABLEEXPORTER_H
+
+#include <QObject>
+
+#include "TableViewLibrary.h"
+
+class QIODevice;
+
+namespace Plugins {
+namespace TableView {
+
+class TableView;
+class TableExporterPrivate;
+
+class TABLEVIEW_EXPORT TableExporter : public QObject
+{
+    Q_OBJECT
+    DECLARE_PRIVATE(TableExporter)
+    Q_DISABLE_COPY(TableExporter)
+
+public:
+    explicit TableExporter(QObject *parent = 0);
+    ~TableExporter();
+
+    char delimiter() const;
+    void setDelimiter(char delimiter);
+    bool headerIncluded() const;
+    void setHeaderIncluded(bool included);
+    bool selectionOnly() const;
+    void setSelectionOnly(bool selectionOnly);
+    bool progressVisible() const;
+    void setProgressVisible(bool visible);
+
+    bool start(TableView *view, QIODevice *device);
+    bool startToClipboard(TableView *view);
+    bool isRunning() const;
+    bool waitForFinished();
+
+    int rowCount() const;
+    qint64 bytesWritten() const;
+    QString errorString() const;
+
+public slots:
+    void cancel();
+
+signals:
+    void progressChanged(int percent);
+    void finished(bool ok);
+
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_TABLEEXPORTER_H
@@ -0,0 +1,136 @@
+/*!
+   \file TableExporterPrivate.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef PLUGINS_TABLEVIEW_TABLEEXPORTERPRIVATE_H
+#define PLUGINS_TABLEVIEW_TABLEEXPORTERPRIVATE_H
+
+#include "TableExporter.h"
+
+#include <QAbstractItemModel>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QProgressBar>
+#include <QVariant>
+#include <QVector>
+
+#include <ViewManager/AbstractColumnarModel.h>
+
+namespace Plugins {
+namespace TableView {
+
+/* How one exported column is read on the GUI thread and written out by a worker; chosen once per export */
+struct ExportColumn
+{
+    enum Kind {
+        Kind_Int64,
+        Kind_Double,
+        Kind_String,
+        Kind_Variant
+    };
+
+    ExportColumn() : column(0), kind(Kind_Variant) {}
+
+    int column;
+    Kind kind;
+};
+
+/* A run of rows copied out of the model, and the text a worker formats them into */
+struct ExportSlice
+{
+    ExportSlice() : rows(0), bytesWritten(0) {}
+
+    int rows;
+    QVector<QVector<qint64> > integers;
+    QVector<QVector<double> > numbers;
+
+    /* Interned strings, already escaped and encoded, shared with the exporter's cache */
+    QVector<QVector<QByteArray> > strings;
+
+    /* Row by row, for models other than columnar ones */
+    QVector<QVariant> variants;
+
+    QByteArray text;
+
+    /* Set by a worker that writes the text out itself */
+    qint64 bytesWritten;
+    QString errorString;
+};
+
+class TableExporterPrivate : public QObject
+{
+    Q_OBJECT
+    DECLARE_PUBLIC(TableExporter)
+    Q_DISABLE_COPY(TableExporterPrivate)
+
+public:
+    TableExporterPrivate();
+    ~TableExporterPrivate();
+
+    bool begin(TableView *view);
+    void end(bool ok, const QString &errorString = QString());
+    void copySlice(ExportSlice *slice);
+    void launch(ExportSlice *slice);
+    bool write(const QByteArray &text);
+
+    static QByteArray escape(const QString &text, char delimiter);
+    static void formatSlice(ExportSlice *slice, const QVector<ExportColumn> *columns, char delimiter,
+                            QIODevice *device);
+
+protected slots:
+    void sliceFormatted();
+    void sourceChanged();
+
+private:
+    char m_Delimiter;
+    bool m_HeaderIncluded;
+    bool m_SelectionOnly;
+    bool m_ProgressVisible;
+
+    QPointer<QIODevice> m_Device;
+    bool m_WorkerWrites;
+    bool m_Clipboard;
+    QByteArray m_ClipboardText;
+
+    QPointer<QAbstractItemModel> m_Model;
+    const Core::ViewManager::AbstractColumnarModel *m_Columnar;
+    QVector<int> m_Rows;
+    QVector<ExportColumn> m_Columns;
+    QVector<QByteArray> m_StringCache;
+    int m_NextRow;
+
+    ExportSlice m_Slices[2];
+    ExportSlice *m_Formatting;
+    ExportSlice *m_Pending;
+
+    bool m_Running;
+    bool m_Cancelled;
+    qint64 m_BytesWritten;
+    QFutureWatcher<void> m_Watcher;
+    QPointer<QProgressBar> m_ProgressBar;
+    QString m_ErrorString;
+};
+
+} // namespace TableView
+} // namespace Plugins
+
+#endif // PLUGINS_TABLEVIEW_TABLEEXPORTERPRIVATE_H
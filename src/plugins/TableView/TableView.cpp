@@ -23,6 +23,14 @@
 
 #include "TableView.h"
 
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QScrollBar>
+
+#include <ViewManager/PagedModel.h>
+
+#include "TableExporter.h"
+
 namespace Plugins {
 namespace TableView {
 
@@ -36,13 +44,19 @@ namespace TableView {
     \brief Constructor.
  */
 TableView::TableView(QWidget *parent) :
-    QTableView(parent)
+    QTableView(parent),
+    m_LargeModelThreshold(50000),
+    m_LargeModel(false),
+    m_ScrollAnchorOffset(0)
 {
     m_ProxyModel.setFilterCaseSensitivity(Qt::CaseInsensitive);
     m_ProxyModel.setFilterRole(Qt::EditRole);
     m_ProxyModel.setSortCaseSensitivity(Qt::CaseInsensitive);
     m_ProxyModel.setSortRole(Qt::EditRole);
     QTableView::setModel(&m_ProxyModel);
+    connect(&m_ProxyModel, SIGNAL(busyChanged(bool)), this, SLOT(proxyBusyChanged(bool)));
+    connect(&m_ProxyModel, SIGNAL(streamedRowsAboutToBeInserted()), this, SLOT(saveScrollAnchor()));
+    connect(&m_ProxyModel, SIGNAL(streamedRowsInserted()), this, SLOT(restoreScrollAnchor()));
 
     setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
     setSortingEnabled(true);
@@ -52,6 +66,10 @@ TableView::TableView(QWidget *parent) :
     QAbstractItemDelegate *oldDelegate = itemDelegate();
     setItemDelegate(new Delegate(this));
     oldDelegate->deleteLater();
+
+    m_RowResizeTimer.setSingleShot(true);
+    m_RowResizeTimer.setInterval(0);
+    connect(&m_RowResizeTimer, SIGNAL(timeout()), this, SLOT(resizePendingRows()));
 }
 
 TableView::~TableView()
@@ -66,22 +84,195 @@ TableView::~TableView()
  */
 QAbstractItemModel *TableView::model() const
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
-    return proxyModel->sourceModel();
+    if(QTableView::model() != &m_ProxyModel) {
+        return QTableView::model();
+    }
+    return m_ProxyModel.sourceModel();
 }
 
 /*! \fn TableView::setModel()
     \brief Reimplemented in order to wrap the model in a proxy for easier filtering and sorting.
+
+    Models with more rows than largeModelThreshold() are sized from a sample of their rows, and get uniform row
+    heights, rather than visiting every row.
+
+    A Core::ViewManager::PagedModel is shown directly, without the proxy, as sorting or filtering it would mean
+    reading every page; it can't be sorted or filtered from the view, and is always treated as large.
     \reimp QTableView::setModel()
-    \sa QTableView::setModel TableView::model
+    \sa QTableView::setModel TableView::model resizeToSample()
  */
 void TableView::setModel(QAbstractItemModel *model)
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
-    proxyModel->setSourceModel(model);
+    m_PendingRowResizes.clear();
+
+    if(qobject_cast<Core::ViewManager::PagedModel *>(model)) {
+        m_ProxyModel.setSourceModel(NULL);
+        setSortingEnabled(false);
+        QTableView::setModel(model);
+        m_LargeModel = true;
+    } else {
+        if(QTableView::model() != &m_ProxyModel) {
+            QTableView::setModel(&m_ProxyModel);
+            setSortingEnabled(true);
+        }
+        m_ProxyModel.setSourceModel(model);
+        m_LargeModel = (m_LargeModelThreshold >= 0 && m_ProxyModel.rowCount() > m_LargeModelThreshold);
+    }
+
+    if(m_LargeModel) {
+        resizeToSample();
+    } else {
+#if QT_VERSION >= 0x050000
+        verticalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+#else
+        verticalHeader()->setResizeMode(QHeaderView::Interactive);
+#endif
+        resizeColumnsToContents();
+        resizeRowsToContents();
+    }
+}
+
+/*! \fn TableView::largeModelThreshold()
+    \brief The row count above which a model is treated as large.
+    \sa setLargeModelThreshold() isLargeModel()
+ */
+int TableView::largeModelThreshold() const
+{
+    return m_LargeModelThreshold;
+}
+
+/*! \fn TableView::setLargeModelThreshold()
+    \brief Sets the row count above which a model is treated as large; a negative value never treats it as large.
+    Takes effect the next time a model is set.
+    \sa largeModelThreshold() isLargeModel()
+ */
+void TableView::setLargeModelThreshold(int rows)
+{
+    m_LargeModelThreshold = rows;
+}
+
+/*! \fn TableView::isLargeModel()
+    \brief Whether the current model was treated as large when it was set.
+    \sa largeModelThreshold() resizeToSample()
+ */
+bool TableView::isLargeModel() const
+{
+    return m_LargeModel;
+}
+
+/*! \fn TableView::resizeToSample()
+    \brief Sizes the columns from the first, the last and a random set of \a sampleRows rows each, and gives every
+           row the same (fixed) height, through the vertical header's default section size.
+    Rows of a Core::ViewManager::PagedModel are only sampled if their page is already loaded.
+    \sa setModel() isLargeModel()
+ */
+void TableView::resizeToSample(int sampleRows)
+{
+    QAbstractItemModel *model = QTableView::model();
+    Core::ViewManager::PagedModel *pagedModel = qobject_cast<Core::ViewManager::PagedModel *>(model);
+    int rowCount = model->rowCount();
+    int columnCount = model->columnCount();
+
+    QSet<int> sampleSet;
+    for(int i = 0; i < qMin(rowCount, sampleRows); ++i) {
+        sampleSet.insert(i);
+        sampleSet.insert(rowCount - 1 - i);
+        sampleSet.insert(qrand() % rowCount);
+    }
+
+    if(pagedModel) {
+        QSet<int>::iterator iter = sampleSet.begin();
+        while(iter != sampleSet.end()) {
+            if(pagedModel->isRowLoaded(*iter)) {
+                ++iter;
+            } else {
+                iter = sampleSet.erase(iter);
+            }
+        }
+    }
+
+    QList<int> sample = sampleSet.toList();
+    qSort(sample);
+
+    QStyleOptionViewItem option = viewOptions();
+    int gridSize = showGrid() ? 1 : 0;
+    int rowHeight = 0;
+
+    for(int column = 0; column < columnCount; ++column) {
+        if(isColumnHidden(column)) {
+            continue;
+        }
+
+        int width = horizontalHeader()->isHidden() ? 0 : horizontalHeader()->sectionSizeHint(column);
+        foreach(int row, sample) {
+            QModelIndex index = model->index(row, column);
+            QSize hint = itemDelegate(index)->sizeHint(option, index);
+            width = qMax(width, hint.width() + gridSize);
+            rowHeight = qMax(rowHeight, hint.height() + gridSize);
+        }
+
+        setColumnWidth(column, width);
+    }
+
+    verticalHeader()->setDefaultSectionSize(qMax(rowHeight, verticalHeader()->minimumSectionSize()));
+#if QT_VERSION >= 0x050000
+    verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+#else
+    verticalHeader()->setResizeMode(QHeaderView::Fixed);
+#endif
+}
+
+/*! \fn TableView::exportRows()
+    \brief Starts writing the rows of the view, in the order shown, to \a device as \a delimiter separated text, in the
+           background.  The TableExporter returned can be watched or cancelled, and deletes itself once finished; NULL
+           is returned if the view can't be exported.
+    \sa TableExporter copySelection()
+ */
+TableExporter *TableView::exportRows(QIODevice *device, char delimiter, bool selectionOnly)
+{
+    TableExporter *exporter = new TableExporter(this);
+    exporter->setDelimiter(delimiter);
+    exporter->setSelectionOnly(selectionOnly);
+    connect(exporter, SIGNAL(finished(bool)), exporter, SLOT(deleteLater()));
+
+    if(!exporter->start(this, device)) {
+        delete exporter;
+        return NULL;
+    }
+
+    return exporter;
+}
+
+/*! \fn TableView::copySelection()
+    \brief Copies the selected rows to the clipboard as tab separated text, with their column titles, in the
+           background; bound to the standard copy shortcut.
+    \sa exportRows() TableExporter
+ */
+void TableView::copySelection()
+{
+    TableExporter *exporter = new TableExporter(this);
+    exporter->setDelimiter('\t');
+    exporter->setSelectionOnly(true);
+    connect(exporter, SIGNAL(finished(bool)), exporter, SLOT(deleteLater()));
 
-    resizeColumnsToContents();
-    resizeRowsToContents();
+    if(!exporter->startToClipboard(this)) {
+        delete exporter;
+    }
+}
+
+/*! \fn TableView::keyPressEvent()
+    \brief Reimplemented in order to copy the whole selection, rather than only the current item, to the clipboard.
+    \reimp QTableView::keyPressEvent()
+ */
+void TableView::keyPressEvent(QKeyEvent *event)
+{
+    if(event == QKeySequence::Copy) {
+        copySelection();
+        event->accept();
+        return;
+    }
+
+    QTableView::keyPressEvent(event);
 }
 
 /*! \fn TableView::setItemDelegate()
@@ -114,6 +305,8 @@ void TableView::setItemDelegate(QAbstractItemDelegate *delegate)
  */
 void TableView::selectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
 {
+    // In large models the rows have a fixed height and the resulting size hint changes are dropped, but the delegate
+    // is still told, as subclasses may draw selected items differently
     Delegate *delegate = qobject_cast<Delegate *>(itemDelegate());
     if(delegate) {
         foreach(QModelIndex index, selected.indexes()) {
@@ -132,16 +325,35 @@ void TableView::selectionChanged(const QItemSelection &selected, const QItemSele
     \internal
     \note I don't know why the heck this is even a problem with QTableView, but they are only updating to a new sizeHint if
           it has an editor.  Since we're likely to not need updating in this, it will never resize on selection changes,
-          so we'll just force the whole row to update.
+          so we'll just force the whole row to update.  Requests are collected per row and handled once control
+          returns to the event loop, so selecting a row of many cells only resizes it once.
  */
 void TableView::delegateSizeHintChanged(const QModelIndex &index)
 {
     Delegate *delegate = qobject_cast<Delegate *>(itemDelegate(index));
-    if(delegate) {
-        resizeRowToContents(index.row());
+    if(delegate && !m_LargeModel) {
+        m_PendingRowResizes.insert(index.row());
+        if(!m_RowResizeTimer.isActive()) {
+            m_RowResizeTimer.start();
+        }
     }
 }
 
+/*! \fn TableView::resizePendingRows()
+    \brief Resizes each row collected by delegateSizeHintChanged() once.
+    \internal
+ */
+void TableView::resizePendingRows()
+{
+    int rowCount = QTableView::model()->rowCount();
+    foreach(int row, m_PendingRowResizes) {
+        if(row < rowCount) {
+            resizeRowToContents(row);
+        }
+    }
+    m_PendingRowResizes.clear();
+}
+
 
 bool TableView::hasLegend()
 {
@@ -161,28 +373,95 @@ void TableView::setLegendVisible(bool visible)
 
 QString TableView::viewFilter() const
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
-    return proxyModel->filterRegExp().pattern();
+    return m_ProxyModel.filterRegExp().pattern();
 }
 
 void TableView::setViewFilter(const QString &regex)
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
     selectionModel()->clear();
-    proxyModel->setFilterRegExp(regex);
+    m_ProxyModel.setFilterRegExp(regex);
 }
 
 int TableView::viewFilterColumn() const
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
-    return proxyModel->filterKeyColumn();
+    return m_ProxyModel.filterKeyColumn();
 }
 
 void TableView::setViewFilterColumn(int column)
 {
-    QSortFilterProxyModel *proxyModel = qobject_cast<QSortFilterProxyModel *>(QTableView::model());
     selectionModel()->clear();
-    proxyModel->setFilterKeyColumn(column);
+    m_ProxyModel.setFilterKeyColumn(column);
+}
+
+QString TableView::viewFilterExpression() const
+{
+    return m_ProxyModel.filterExpression();
+}
+
+bool TableView::setViewFilterExpression(const QString &expression, QString *errorMessage)
+{
+    if(QTableView::model() != &m_ProxyModel) {
+        if(errorMessage) {
+            *errorMessage = tr("This view can't be filtered");
+        }
+        return false;
+    }
+
+    selectionModel()->clear();
+    return m_ProxyModel.setFilterExpression(expression, errorMessage);
+}
+
+/*! \fn TableView::proxyBusyChanged()
+    \brief Shows a busy cursor while the proxy sorts or filters in the background.
+    \internal
+ */
+void TableView::proxyBusyChanged(bool busy)
+{
+    if(busy) {
+        viewport()->setCursor(Qt::BusyCursor);
+    } else {
+        viewport()->unsetCursor();
+    }
+}
+
+/*! \fn TableView::saveScrollAnchor()
+    \brief Remembers the row at the top of the viewport before streamed rows are inserted, unless the view is scrolled
+           to the very top, where new rows are meant to show up.
+    \internal
+    \sa restoreScrollAnchor()
+ */
+void TableView::saveScrollAnchor()
+{
+    m_ScrollAnchor = QPersistentModelIndex();
+
+    if(verticalScrollBar()->value() == verticalScrollBar()->minimum()) {
+        return;
+    }
+
+    QModelIndex index = indexAt(QPoint(0, 0));
+    if(index.isValid()) {
+        m_ScrollAnchor = index;
+        m_ScrollAnchorOffset = rowViewportPosition(index.row());
+    }
+}
+
+/*! \fn TableView::restoreScrollAnchor()
+    \brief Scrolls so the row remembered by saveScrollAnchor() is back where it was in the viewport.
+    \internal
+    \sa saveScrollAnchor()
+ */
+void TableView::restoreScrollAnchor()
+{
+    if(!m_ScrollAnchor.isValid()) {
+        return;
+    }
+
+    updateGeometries();
+
+    int offset = rowViewportPosition(m_ScrollAnchor.row()) - m_ScrollAnchorOffset;
+    verticalScrollBar()->setValue(verticalScrollBar()->value() + offset);
+
+    m_ScrollAnchor = QPersistentModelIndex();
 }
 
 } // namespace TableView
@@ -25,17 +25,23 @@
 #define PLUGINS_TABLEVIEW_TABLEVIEWM_H
 
 #include <QTableView>
-#include <QSortFilterProxyModel>
+#include <QTimer>
+#include <QSet>
 
 #include <ViewManager/IView.h>
 #include <ViewManager/IViewFilterable.h>
 
 #include "TableViewLibrary.h"
+#include "SortFilterProxyModel.h"
 #include "Delegate.h"
 
+class QIODevice;
+
 namespace Plugins {
 namespace TableView {
 
+class TableExporter;
+
 class TABLEVIEW_EXPORT TableView : public QTableView, public Core::ViewManager::IViewFilterable, public Core::ViewManager::IView
 {
     Q_OBJECT
@@ -51,6 +57,14 @@ public:
 
     virtual void setItemDelegate(QAbstractItemDelegate *delegate);
 
+    int largeModelThreshold() const;
+    void setLargeModelThreshold(int rows);
+    bool isLargeModel() const;
+
+    void resizeToSample(int sampleRows = 100);
+
+    TableExporter *exportRows(QIODevice *device, char delimiter = ',', bool selectionOnly = false);
+
     virtual bool hasLegend();
     virtual bool legendVisible();
     virtual void setLegendVisible(bool visible);
@@ -59,13 +73,33 @@ public:
     virtual void setViewFilter(const QString &regex);
     virtual int viewFilterColumn() const;
     virtual void setViewFilterColumn(int column = 0);
+    virtual QString viewFilterExpression() const;
+    virtual bool setViewFilterExpression(const QString &expression, QString *errorMessage = NULL);
+
+public slots:
+    void copySelection();
 
 protected slots:
     virtual void selectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
     virtual void delegateSizeHintChanged(const QModelIndex &index);
+    void resizePendingRows();
+    void proxyBusyChanged(bool busy);
+    void saveScrollAnchor();
+    void restoreScrollAnchor();
 
 protected:
-    QSortFilterProxyModel m_ProxyModel;
+    virtual void keyPressEvent(QKeyEvent *event);
+
+    SortFilterProxyModel m_ProxyModel;
+
+    int m_LargeModelThreshold;
+    bool m_LargeModel;
+
+    QSet<int> m_PendingRowResizes;
+    QTimer m_RowResizeTimer;
+
+    QPersistentModelIndex m_ScrollAnchor;
+    int m_ScrollAnchorOffset;
 
 };
 
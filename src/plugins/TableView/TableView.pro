@@ -17,6 +17,10 @@
 
 include(../plugins.pri)
 
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += concurrent
+}
+
 CONFIG(debug, debug|release) {
     TARGET           = TableViewD
 } else {
@@ -25,11 +29,30 @@ CONFIG(debug, debug|release) {
 
 SOURCES           += TableViewPlugin.cpp \
                      TableView.cpp \
-                     Delegate.cpp
+                     Delegate.cpp \
+                     SortFilterProxyModel.cpp \
+                     DelimitedImporter.cpp \
+                     TableExporter.cpp \
+                     AggregateModel.cpp \
+                     AggregateView.cpp \
+                     AggregateViewFactory.cpp \
+                     DerivedColumnModel.cpp
 
 HEADERS           += TableViewPlugin.h \
                      TableView.h \
                      Delegate.h \
+                     SortFilterProxyModel.h \
+                     SortFilterProxyModelPrivate.h \
+                     DelimitedImporter.h \
+                     DelimitedImporterPrivate.h \
+                     TableExporter.h \
+                     TableExporterPrivate.h \
+                     AggregateModel.h \
+                     AggregateModelPrivate.h \
+                     AggregateView.h \
+                     AggregateViewFactory.h \
+                     DerivedColumnModel.h \
+                     DerivedColumnModelPrivate.h \
     TableViewLibrary.h
 
 #debug: DEFINES    += PLOTVIEW_DEBUG
@@ -37,5 +60,5 @@ HEADERS           += TableViewPlugin.h \
 DEFINES      += TABLEVIEW_LIBRARY
 
 tableViewHeaders.path = /include/plugins/TableView
-tableViewHeaders.files = TableViewLibrary.h TableView.h Delegate.h
+tableViewHeaders.files = TableViewLibrary.h TableView.h Delegate.h SortFilterProxyModel.h DelimitedImporter.h TableExporter.h AggregateModel.h AggregateView.h DerivedColumnModel.h
 INSTALLS += tableViewHeaders
@@ -27,6 +27,7 @@
 #include <ViewManager/ViewManager.h>
 
 #include "TableView.h"
+#include "AggregateViewFactory.h"
 
 namespace Plugins {
 namespace TableView {
@@ -44,7 +45,9 @@ namespace TableView {
     \todo Document this more explicitly.
  */
 
-TableViewPlugin::TableViewPlugin(QObject *parent) : QObject(parent)
+TableViewPlugin::TableViewPlugin(QObject *parent) :
+    QObject(parent),
+    m_AggregateViewFactory(NULL)
 {
     m_Name = "TableView";
     m_Version = QString("%1.%2.%3").arg(VER_MAJ).arg(VER_MIN).arg(VER_PAT);
@@ -64,6 +67,9 @@ bool TableViewPlugin::initialize(QStringList &args, QString *err)
         Core::PluginManager::PluginManager &pluginManager = Core::PluginManager::PluginManager::instance();
         pluginManager.addObject(this);                         /* Register ourselves as an IViewFactory */
 
+        m_AggregateViewFactory = new AggregateViewFactory(this);
+        pluginManager.addObject(m_AggregateViewFactory);       /* And the grouping view alongside */
+
     } catch(...) {
         return false;
     }
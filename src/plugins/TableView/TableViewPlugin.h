@@ -30,6 +30,8 @@
 namespace Plugins {
 namespace TableView {
 
+class AggregateViewFactory;
+
 class TableViewPlugin :
         public QObject,
         public Core::PluginManager::IPlugin,
@@ -65,6 +67,8 @@ protected:
     QString m_Version;
     QList<Core::PluginManager::Dependency> m_Dependencies;
 
+    AggregateViewFactory *m_AggregateViewFactory;
+
 };
 
 } // namespace TableView
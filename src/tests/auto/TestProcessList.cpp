@@ -0,0 +1,305 @@
+/*!
+   \file TestProcessList.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TestProcessList.h"
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+
+#include <ProcessList/ProcessFilterModel.h>
+#include <ProcessList/ProcessHistory.h>
+#include <ProcessList/ProcessListModel.h>
+#include <ProcessList/ProcessListModelPrivate.h>
+#include <ProcessList/ProcessTreeModel.h>
+using namespace Plugins::ProcessList;
+
+static QList<QStandardItem *> processRow(quint64 pid, quint64 parentPid, const QString &command)
+{
+    QList<QStandardItem *> items;
+    for(int column = 0; column < ProcessListModel::Column_Count; ++column) {
+        items << new QStandardItem();
+    }
+
+    items[ProcessListModel::Column_Pid]->setData(QVariant(pid), Qt::DisplayRole);
+    items[ProcessListModel::Column_ParentPid]->setData(QVariant(parentPid), Qt::DisplayRole);
+    items[ProcessListModel::Column_Command]->setData(QVariant(command), Qt::DisplayRole);
+    return items;
+}
+
+static void addProcesses(QStandardItemModel &model)
+{
+    model.setColumnCount(ProcessListModel::Column_Count);
+    model.appendRow(processRow(1, 0, "/sbin/init splash"));
+    model.appendRow(processRow(100, 1, "mpirun -np 4 ./a.out"));
+    model.appendRow(processRow(101, 100, "./a.out --rank 0"));
+    model.appendRow(processRow(200, 1, "bash"));
+    model.appendRow(processRow(201, 200, "vim Notes.txt"));
+}
+
+static QStringList filteredPids(const QAbstractItemModel &model, const QModelIndex &parent = QModelIndex())
+{
+    QStringList pids;
+    for(int row = 0; row < model.rowCount(parent); ++row) {
+        QModelIndex index = model.index(row, ProcessListModel::Column_Pid, parent);
+        pids << index.data().toString();
+        pids << filteredPids(model, index.sibling(row, 0));
+    }
+    return pids;
+}
+
+TestProcessList::TestProcessList(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void TestProcessList::initTestCase()
+{
+}
+
+void TestProcessList::cleanupTestCase()
+{
+}
+
+void TestProcessList::testParseProcessList()
+{
+    // Captured from procps ps; the long user name pushes every following column out of line
+    QByteArray output =
+            "      1       0 root     Ss    0.0 12936 Mon Oct  5 05:17:11 2026 /sbin/init splash\n"
+            "   2001       1 averylongusername_from_ldap Sl   12.5 204800 Mon Oct 19 05:20:01 2026 mpirun -np 4 ./a.out --input my file.dat\n"
+            "   2002    2001 averylongusername_from_ldap R+  99.9 1048576 Mon Oct 19 05:20:02 2026 ./a.out   --input my file.dat\n"
+            "   2003    2001 dane     S     0.0     0 Mon Oct 19 05:20:03 2026 [kworker/0:1]\n"
+            "\n";
+
+    QMap<quint64, ProcessInfo> processes = ProcessListModelPrivate::parseProcessList(output);
+    QCOMPARE(processes.count(), 4);
+
+    ProcessInfo init = processes.value(1);
+    QCOMPARE(init.parentPid, (quint64)0);
+    QCOMPARE(init.user, QString("root"));
+    QCOMPARE(init.state, QString("Ss"));
+    QCOMPARE(init.memory, (quint64)12936);
+    QCOMPARE(init.started, QDateTime(QDate(2026, 10, 5), QTime(5, 17, 11)));
+    QCOMPARE(init.command, QString("/sbin/init splash"));
+
+    ProcessInfo launcher = processes.value(2001);
+    QCOMPARE(launcher.parentPid, (quint64)1);
+    QCOMPARE(launcher.user, QString("averylongusername_from_ldap"));
+    QCOMPARE(launcher.state, QString("Sl"));
+    QCOMPARE(launcher.cpu, 12.5);
+    QCOMPARE(launcher.memory, (quint64)204800);
+    QCOMPARE(launcher.started, QDateTime(QDate(2026, 10, 19), QTime(5, 20, 1)));
+    QCOMPARE(launcher.command, QString("mpirun -np 4 ./a.out --input my file.dat"));
+
+    // Spacing inside the command is kept as is
+    ProcessInfo rank = processes.value(2002);
+    QCOMPARE(rank.parentPid, (quint64)2001);
+    QCOMPARE(rank.cpu, 99.9);
+    QCOMPARE(rank.memory, (quint64)1048576);
+    QCOMPARE(rank.command, QString("./a.out   --input my file.dat"));
+
+    QCOMPARE(processes.value(2003).command, QString("[kworker/0:1]"));
+
+    // A header line and truncated lines are skipped
+    QByteArray withHeader =
+            "    PID    PPID USER     STAT %CPU   RSS                  STARTED COMMAND\n"
+            "     42       1 root     S     0.0   100\n"
+            "     43       1 root     S     0.0   100 Mon Oct 19 05:20:03 2026 sleep 60\n";
+    processes = ProcessListModelPrivate::parseProcessList(withHeader);
+    QCOMPARE(processes.count(), 1);
+    QCOMPARE(processes.value(43).command, QString("sleep 60"));
+}
+
+void TestProcessList::testHistoryWraparound()
+{
+    ProcessHistory history(4, 16);
+    float cpu[4];
+    float memory[4];
+
+    for(int sample = 1; sample <= 2; ++sample) {
+        history.beginSample();
+        history.addSample(10, sample, sample * 100);
+        history.endSample();
+    }
+
+    QCOMPARE(history.cpuHistory(10, cpu), 2);
+    QCOMPARE(cpu[0], 1.0f);
+    QCOMPARE(cpu[1], 2.0f);
+
+    // Past the ring's length the oldest samples drop off, and the rest stay oldest first
+    for(int sample = 3; sample <= 7; ++sample) {
+        history.beginSample();
+        history.addSample(10, sample, sample * 100);
+        history.endSample();
+    }
+
+    QCOMPARE(history.cpuHistory(10, cpu), 4);
+    QCOMPARE(history.memoryHistory(10, memory), 4);
+    for(int i = 0; i < 4; ++i) {
+        QCOMPARE(cpu[i], float(4 + i));
+        QCOMPARE(memory[i], float((4 + i) * 100));
+    }
+
+    QCOMPARE(history.cpuHistory(11, cpu), 0);
+}
+
+void TestProcessList::testHistoryEviction()
+{
+    ProcessHistory history(4, 2);
+    float cpu[4];
+
+    history.beginSample();
+    history.addSample(1, 1, 1);
+    history.addSample(2, 2, 2);
+    history.addSample(3, 3, 3);
+    history.endSample();
+
+    // Never more than maximumProcesses() tracked
+    QCOMPARE(history.processCount(), 2);
+    QVERIFY(history.contains(1));
+    QVERIFY(history.contains(2));
+    QVERIFY(!history.contains(3));
+
+    // A process missing from a sample is forgotten
+    history.beginSample();
+    history.addSample(1, 10, 10);
+    history.endSample();
+
+    QCOMPARE(history.processCount(), 1);
+    QVERIFY(!history.contains(2));
+    QCOMPARE(history.cpuHistory(2, cpu), 0);
+
+    // Its slot is reused, starting from an empty history
+    history.beginSample();
+    history.addSample(1, 20, 20);
+    history.addSample(3, 30, 30);
+    history.endSample();
+
+    QCOMPARE(history.processCount(), 2);
+    QCOMPARE(history.cpuHistory(3, cpu), 1);
+    QCOMPARE(cpu[0], 30.0f);
+    QCOMPARE(history.cpuHistory(1, cpu), 3);
+    QCOMPARE(cpu[0], 1.0f);
+    QCOMPARE(cpu[2], 20.0f);
+
+    // Changing the shape clears everything
+    history.setLength(8);
+    QCOMPARE(history.processCount(), 0);
+}
+
+void TestProcessList::testFilter()
+{
+    QStandardItemModel source;
+    addProcesses(source);
+
+    ProcessFilterModel filter;
+    filter.setFilterDelay(0);
+    filter.setDynamicSortFilter(true);
+    filter.setSourceModel(&source);
+
+    QCOMPARE(filter.rowCount(), 5);
+
+    // Substring mode: case insensitive, every term of any alternative
+    filter.setFilterText("A.OUT");
+    QCOMPARE(filteredPids(filter), QStringList() << "100" << "101");
+
+    filter.setFilterText("a.out rank");
+    QCOMPARE(filteredPids(filter), QStringList() << "101");
+
+    filter.setFilterText("mpirun|vim");
+    QCOMPARE(filteredPids(filter), QStringList() << "100" << "201");
+
+    // Narrowing a filter and changed command lines are both picked up
+    filter.setFilterText("vim");
+    filter.setFilterText("vim notes");
+    QCOMPARE(filteredPids(filter), QStringList() << "201");
+
+    source.item(3, ProcessListModel::Column_Command)->setText("vim notes.md");
+    QCOMPARE(filteredPids(filter), QStringList() << "200" << "201");
+
+    // Regular expression mode is case sensitive, like QSortFilterProxyModel
+    filter.setFilterMode(ProcessFilterModel::FilterMode_RegExp);
+    filter.setFilterText("^vim .*\\.txt$");
+    QCOMPARE(filteredPids(filter), QStringList() << "201");
+
+    filter.setFilterText("^VIM");
+    QCOMPARE(filter.rowCount(), 0);
+
+    filter.setFilterCaseSensitivity(Qt::CaseInsensitive);
+    filter.setFilterText("^VIM ");
+    QCOMPARE(filteredPids(filter), QStringList() << "200" << "201");
+
+    filter.setFilterText(QString());
+    QCOMPARE(filter.rowCount(), 5);
+}
+
+void TestProcessList::testFilterTree()
+{
+    ProcessListModel source;
+    addProcesses(source);
+
+    ProcessTreeModel tree;
+    tree.setSourceModel(&source);
+
+    ProcessFilterModel filter;
+    filter.setFilterDelay(0);
+    filter.setDynamicSortFilter(true);
+    filter.setSourceModel(&tree);
+
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "100" << "101" << "200" << "201");
+
+    // Ancestors of a match are kept
+    filter.setFilterText("a.out");
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "100" << "101");
+
+    filter.setFilterText("vim");
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "200" << "201");
+
+    QSignalSpy layoutSpy(&tree, SIGNAL(layoutChanged()));
+    QSignalSpy dataSpy(&tree, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // A refresh that only changes values is forwarded cell by cell, without a layout change; a child that starts
+    // matching still brings in its parent
+    QMetaObject::invokeMethod(&source, "updateStarted");
+    source.item(4, ProcessListModel::Column_Cpu)->setData(QVariant(12.5), Qt::DisplayRole);
+    source.item(2, ProcessListModel::Column_Command)->setText("./a.out --rank 0 --vim");
+    QMetaObject::invokeMethod(&source, "updateFinished");
+
+    QCOMPARE(layoutSpy.count(), 0);
+    QCOMPARE(dataSpy.count(), 2);
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "100" << "101" << "200" << "201");
+
+    // A refresh that adds and removes processes is a single layout change
+    QMetaObject::invokeMethod(&source, "updateStarted");
+    source.removeRow(1);
+    source.appendRow(processRow(202, 200, "vim other.txt"));
+    QMetaObject::invokeMethod(&source, "updateFinished");
+
+    QCOMPARE(layoutSpy.count(), 1);
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "200" << "201" << "202" << "101");
+
+    // Reparenting outside of a refresh
+    source.item(1, ProcessListModel::Column_ParentPid)->setData(QVariant((quint64)200), Qt::DisplayRole);
+    QCOMPARE(layoutSpy.count(), 2);
+    QCOMPARE(filteredPids(filter), QStringList() << "1" << "200" << "101" << "201" << "202");
+}
@@ -0,0 +1,337 @@
+/*!
+   \file TestSettingManager.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TestSettingManager.h"
+
+#include <QTest>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+#ifndef NO_SQL_MODULE
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#endif
+
+#include <SettingManager/SettingManager.h>
+using namespace Core::SettingManager;
+#define INSTANCE SettingManager &instance = SettingManager::instance()
+
+TestSettingManager::TestSettingManager(QObject *parent) :
+    QObject(parent)
+{
+}
+
+static void removeDirectory(const QString &path)
+{
+    QDir directory(path);
+    foreach(const QFileInfo &info, directory.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)) {
+        if(info.isDir()) {
+            removeDirectory(info.filePath());
+        } else {
+            QFile::remove(info.filePath());
+        }
+    }
+    directory.rmdir(path);
+}
+
+/* Where the store of the given suffix is kept, next to the INI file */
+static QString storeFileName(const QString &suffix)
+{
+    QSettings locator(QSettings::IniFormat, QSettings::UserScope, QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    QFileInfo fileInfo(locator.fileName());
+    return QString("%1/%2.%3").arg(fileInfo.absolutePath()).arg(fileInfo.completeBaseName()).arg(suffix);
+}
+
+void TestSettingManager::initTestCase()
+{
+    // Keep the stores of the tests out of the user's own settings
+    m_OrganizationName = QCoreApplication::organizationName();
+    m_ApplicationName = QCoreApplication::applicationName();
+    QCoreApplication::setOrganizationName("PTGF");
+    QCoreApplication::setApplicationName("TestSettingManager");
+
+    m_Path = QString("%1/TestSettingManager-%2").arg(QDir::tempPath()).arg(QCoreApplication::applicationPid());
+    removeDirectory(m_Path);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_Path);
+}
+
+void TestSettingManager::cleanupTestCase()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Ini);
+    instance.shutdown();
+    removeDirectory(m_Path);
+
+    QCoreApplication::setOrganizationName(m_OrganizationName);
+    QCoreApplication::setApplicationName(m_ApplicationName);
+}
+
+
+#ifndef NO_SQL_MODULE
+/* Reads the text stored for key in the database, through a connection of its own */
+static QVariant storedValue(const QString &key)
+{
+    QVariant value;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "TestSettingManager");
+        db.setDatabaseName(storeFileName("sqlite"));
+        if(db.open()) {
+            QSqlQuery query(db);
+            query.prepare("SELECT value FROM Settings WHERE key = ?");
+            query.addBindValue(key);
+            if(query.exec() && query.next()) {
+                value = query.value(0);
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase("TestSettingManager");
+    return value;
+}
+
+/* Changes the text stored for key behind the manager's back */
+static bool storeValue(const QString &key, const QString &text)
+{
+    bool okay = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "TestSettingManager");
+        db.setDatabaseName(storeFileName("sqlite"));
+        if(db.open()) {
+            QSqlQuery query(db);
+            query.prepare("UPDATE Settings SET value = ? WHERE key = ?");
+            query.addBindValue(text);
+            query.addBindValue(key);
+            okay = query.exec() && query.numRowsAffected() == 1;
+        }
+    }
+    QSqlDatabase::removeDatabase("TestSettingManager");
+    return okay;
+}
+
+/* Lets the sync a change schedules run */
+static void flush()
+{
+    QTest::qWait(10);
+}
+
+void TestSettingManager::testSqliteMigrate()
+{
+    INSTANCE;
+    QFile::remove(storeFileName("sqlite"));
+
+    instance.setFormatType(SettingManager::FormatType_Ini);
+    instance.setValue("Migrated/name", QString("value"));
+    instance.setValue("Migrated/size", 42);
+
+    // A new store starts out with what the INI store held
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+    QCOMPARE(instance.formatType(), SettingManager::FormatType_Sqlite);
+    QVERIFY(QFile::exists(storeFileName("sqlite")));
+    QCOMPARE(instance.value("Migrated/name").toString(), QString("value"));
+    QCOMPARE(instance.value("Migrated/size").toInt(), 42);
+    QCOMPARE(storedValue("Migrated/name").toString(), QString("value"));
+
+    // An existing store isn't migrated into again
+    instance.setFormatType(SettingManager::FormatType_Ini);
+    instance.setValue("Migrated/name", QString("changed"));
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+    QCOMPARE(instance.value("Migrated/name").toString(), QString("value"));
+}
+
+void TestSettingManager::testSqliteDirtyKeys()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+
+    instance.setValue("Dirty/changed", QString("before"));
+    instance.setValue("Dirty/unchanged", QString("before"));
+    flush();
+    QCOMPARE(storedValue("Dirty/changed").toString(), QString("before"));
+    QCOMPARE(storedValue("Dirty/unchanged").toString(), QString("before"));
+
+    // Only the key set since the last sync is written
+    QVERIFY(storeValue("Dirty/unchanged", "elsewhere"));
+    instance.setValue("Dirty/changed", QString("after"));
+    flush();
+    QCOMPARE(storedValue("Dirty/changed").toString(), QString("after"));
+    QCOMPARE(storedValue("Dirty/unchanged").toString(), QString("elsewhere"));
+
+    // Setting a key to the value it has doesn't make it dirty
+    QVERIFY(storeValue("Dirty/changed", "elsewhere"));
+    instance.setValue("Dirty/changed", QString("after"));
+    flush();
+    QCOMPARE(storedValue("Dirty/changed").toString(), QString("elsewhere"));
+}
+
+void TestSettingManager::testSqliteRemoveGroup()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+
+    instance.beginGroup("Group");
+    instance.setValue("first", 1);
+    instance.setValue("sub/second", 2);
+    QCOMPARE(instance.group(), QString("Group"));
+    instance.endGroup();
+    instance.setValue("Group", 0);
+    instance.setValue("Groupie/third", 3);
+    flush();
+    QCOMPARE(storedValue("Group/sub/second").toInt(), 2);
+
+    // A group goes with everything under it, but not with keys that only start alike
+    instance.remove("Group");
+    QVERIFY(!instance.contains("Group"));
+    QVERIFY(!instance.contains("Group/first"));
+    QVERIFY(!instance.contains("Group/sub/second"));
+    QVERIFY(instance.contains("Groupie/third"));
+    flush();
+    QVERIFY(!storedValue("Group").isValid());
+    QVERIFY(!storedValue("Group/first").isValid());
+    QVERIFY(!storedValue("Group/sub/second").isValid());
+    QCOMPARE(storedValue("Groupie/third").toInt(), 3);
+
+    // Removing within a group is relative to it
+    instance.beginGroup("Groupie");
+    instance.remove("third");
+    instance.endGroup();
+    QVERIFY(!instance.contains("Groupie/third"));
+}
+
+void TestSettingManager::testSqlitePersistence()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+
+    instance.setValue("Persisted/text", QString("@at sign"));
+    instance.setValue("Persisted/number", 2.5);
+    instance.setValue("Persisted/bytes", QByteArray("\x01\x02", 2));
+    instance.setValue("Persisted/removed", true);
+    instance.remove("Persisted/removed");
+
+    // Reopening reads back what was written, even without a sync in between
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+    QCOMPARE(instance.value("Persisted/text").toString(), QString("@at sign"));
+    QCOMPARE(instance.value("Persisted/number").toDouble(), 2.5);
+    QCOMPARE(instance.value("Persisted/bytes").toByteArray(), QByteArray("\x01\x02", 2));
+    QVERIFY(!instance.contains("Persisted/removed"));
+}
+
+void TestSettingManager::testSqliteWriteAfterShutdown()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+    instance.setValue("Shutdown/value", QString("before"));
+
+    // Shutting down writes what's pending; later writes are only kept in memory
+    instance.shutdown();
+    QCOMPARE(storedValue("Shutdown/value").toString(), QString("before"));
+
+    instance.setValue("Shutdown/value", QString("after"));
+    instance.setValue("Shutdown/added", QString("after"));
+    flush();
+    QCOMPARE(instance.value("Shutdown/value").toString(), QString("after"));
+    QVERIFY(instance.contains("Shutdown/added"));
+    QCOMPARE(storedValue("Shutdown/value").toString(), QString("before"));
+    QVERIFY(!storedValue("Shutdown/added").isValid());
+
+    instance.setFormatType(SettingManager::FormatType_Sqlite);
+    QCOMPARE(instance.value("Shutdown/value").toString(), QString("before"));
+    QVERIFY(!instance.contains("Shutdown/added"));
+}
+#endif
+
+
+#ifndef NO_XML_MODULE
+void TestSettingManager::testXmlRoundTrip()
+{
+    INSTANCE;
+    QFile::remove(storeFileName("xml"));
+    instance.setFormatType(SettingManager::FormatType_Xml);
+
+    QSettings::SettingsMap values;
+    values.insert("Settings/inner", QString("a group named like the root"));
+    values.insert("Repeated/Repeated/Repeated", QString("deep"));
+    values.insert("Repeated/value", QString("a & b <c> \"d\""));
+    values.insert("Repeated-sibling", QString("sorts between"));
+    values.insert("Group", QString("a key that's also a group"));
+    values.insert("Group/key", QString("under it"));
+    values.insert("Empty", QString(""));
+    values.insert("Blank", QString("   "));
+    values.insert("Number", 42);
+
+    QSettings::SettingsMap::const_iterator iter;
+    for(iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+        instance.setValue(iter.key(), iter.value());
+    }
+
+    // Switching away writes the file, and switching back reads it
+    instance.setFormatType(SettingManager::FormatType_Ini);
+    QVERIFY(QFile::exists(storeFileName("xml")));
+    instance.setFormatType(SettingManager::FormatType_Xml);
+
+    for(iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+        QVERIFY2(instance.contains(iter.key()), qPrintable(iter.key()));
+        QCOMPARE(instance.value(iter.key()).toString(), iter.value().toString());
+    }
+}
+
+void TestSettingManager::testXmlRead()
+{
+    INSTANCE;
+    instance.setFormatType(SettingManager::FormatType_Ini);
+
+    QFile file(storeFileName("xml"));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<Settings>\n"
+               "    <Repeated><first>1</first></Repeated>\n"
+               "    <Other>2</Other>\n"
+               "    <Repeated><second>3</second></Repeated>\n"
+               "    <Split>one &amp; two &lt; three&#33;</Split>\n"
+               "    <Empty/>\n"
+               "    <Blank>  </Blank>\n"
+               "    <Settings><Settings>nested</Settings></Settings>\n"
+               "</Settings>\n");
+    file.close();
+
+    instance.setFormatType(SettingManager::FormatType_Xml);
+
+    // A group that comes around again reads into the same keys
+    QCOMPARE(instance.value("Repeated/first").toString(), QString("1"));
+    QCOMPARE(instance.value("Repeated/second").toString(), QString("3"));
+    QCOMPARE(instance.value("Other").toString(), QString("2"));
+    QVERIFY(!instance.contains("Repeated"));
+
+    // Text is whole however the reader splits it, and an element without children is a key even with no text
+    QCOMPARE(instance.value("Split").toString(), QString("one & two < three!"));
+    QVERIFY(instance.contains("Empty"));
+    QVERIFY(instance.value("Empty").toString().isEmpty());
+    QVERIFY(instance.contains("Blank"));
+    QCOMPARE(instance.value("Blank").toString(), QString("  "));
+
+    QCOMPARE(instance.value("Settings/Settings").toString(), QString("nested"));
+    QVERIFY(!instance.contains("Settings"));
+}
+#endif
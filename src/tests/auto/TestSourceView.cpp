@@ -0,0 +1,817 @@
+/*!
+   \file TestSourceView.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TestSourceView.h"
+
+#include <QTest>
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QTextCursor>
+#include <QSyntaxHighlighter>
+#include <QStringList>
+#include <QTime>
+#include <QTemporaryFile>
+#include <QSignalSpy>
+#include <QPointer>
+#include <QImage>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <SourceView/SourceView.h>
+#include <SourceView/SyntaxHighlighter.h>
+#include <SourceView/LanguageRegistry.h>
+#include <SourceView/SourceDocumentCache.h>
+#include <SourceView/SourceLocator.h>
+using namespace Plugins::SourceView;
+
+
+/* The highlighter SyntaxHighlighter replaced, running a regular expression per token kind over each line; kept to
+   benchmark against */
+class RegExpHighlighter : public QSyntaxHighlighter
+{
+public:
+    explicit RegExpHighlighter(QTextDocument *parent) :
+        QSyntaxHighlighter(parent)
+    {
+        QStringList keywords;
+        keywords << "asm" << "break" << "case" << "catch" << "class" << "const_cast" << "continue" << "default"
+                 << "delete" << "do" << "dynamic_cast" << "else" << "enum" << "explicit" << "export" << "extern"
+                 << "false" << "friend" << "for" << "goto" << "if" << "inline" << "namespace" << "new" << "operator"
+                 << "private" << "protected" << "public" << "reinterpret_cast" << "return" << "sizeof"
+                 << "static_cast" << "struct" << "switch" << "template" << "this" << "throw" << "true" << "try"
+                 << "typedef" << "typeid" << "type_info" << "typename" << "union" << "using" << "virtual" << "while"
+                 << "and" << "and_eq" << "bad_cast" << "bad_typeid" << "bitand" << "bitor" << "compl" << "not"
+                 << "not_eq" << "or" << "or_eq" << "xor" << "xor_eq";
+        m_Keywords.setPattern(QString("\\b(%1)\\b").arg(keywords.join("|")));
+
+        QStringList dataTypes;
+        dataTypes << "auto" << "bool" << "char" << "const" << "double" << "float" << "int" << "long" << "mutable"
+                  << "register" << "short" << "signed" << "static" << "unsigned" << "void" << "volatile" << "uchar"
+                  << "uint" << "int8_t" << "int16_t" << "int32_t" << "int64_t" << "uint8_t" << "uint16_t"
+                  << "uint32_t" << "uint64_t" << "wchar_t";
+        m_DataTypes.setPattern(QString("\\b(%1)\\b").arg(dataTypes.join("|")));
+
+        m_Mpi.setPattern("\\bMPI_\\w+\\b");
+        m_Preprocessor.setPattern("#\\s*\\w+\\b");
+        m_Quote.setPattern("(\".*\")|('.')|(<\\s*[\\w\\.]+\\s*>)");
+        m_OneLineComment.setPattern("(//.*$)");
+        m_CommentStart.setPattern("/\\*");
+        m_CommentEnd.setPattern("\\*/");
+    }
+
+protected:
+    void highlightBlock(const QString &text)
+    {
+        highlight(text, m_Keywords, Qt::darkYellow);
+        highlight(text, m_DataTypes, Qt::darkMagenta);
+        highlight(text, m_Mpi, Qt::red);
+        highlight(text, m_Preprocessor, Qt::darkBlue);
+        highlight(text, m_Quote, Qt::darkGreen);
+        highlight(text, m_OneLineComment, Qt::darkGreen);
+
+        setCurrentBlockState(0);
+        int startIndex = (previousBlockState() != 1) ? text.indexOf(m_CommentStart) : 0;
+        while(startIndex >= 0) {
+            int endIndex = text.indexOf(m_CommentEnd, startIndex);
+            int commentLength;
+            if(endIndex == -1) {
+                setCurrentBlockState(1);
+                commentLength = text.length() - startIndex;
+            } else {
+                commentLength = endIndex - startIndex + m_CommentEnd.matchedLength();
+            }
+            setFormat(startIndex, commentLength, Qt::darkGreen);
+            startIndex = text.indexOf(m_CommentStart, startIndex + commentLength);
+        }
+    }
+
+private:
+    void highlight(const QString &text, QRegExp &expression, const QColor &color)
+    {
+        int index = text.indexOf(expression);
+        while(index >= 0) {
+            int length = expression.matchedLength();
+            setFormat(index, length, color);
+            index = text.indexOf(expression, index + length);
+        }
+    }
+
+    QRegExp m_Keywords;
+    QRegExp m_DataTypes;
+    QRegExp m_Mpi;
+    QRegExp m_Preprocessor;
+    QRegExp m_Quote;
+    QRegExp m_OneLineComment;
+    QRegExp m_CommentStart;
+    QRegExp m_CommentEnd;
+};
+
+/* The foreground color a highlighter gave to a character of a line */
+static QColor colorAt(const QTextDocument &document, int line, int column)
+{
+    QTextBlock block = document.findBlockByNumber(line);
+    foreach(const QTextLayout::FormatRange &range, block.layout()->additionalFormats()) {
+        if(column >= range.start && column < range.start + range.length) {
+            return range.format.foreground().color();
+        }
+    }
+    return QColor();
+}
+
+/* The foreground colors a highlighter gave to every character of a line */
+static QVector<QRgb> colorsOf(const QTextBlock &block)
+{
+    QVector<QRgb> colors(block.length(), 0);
+    foreach(const QTextLayout::FormatRange &range, block.layout()->additionalFormats()) {
+        for(int i = range.start; i < range.start + range.length && i < colors.count(); ++i) {
+            colors[i] = range.format.foreground().color().rgb();
+        }
+    }
+    return colors;
+}
+
+/* Generated source of the kind that takes long to highlight: long, dense lines with comments and strings */
+static QString generatedSource(int lines)
+{
+    QStringList source;
+    source << "#include <mpi.h>" << "#include \"generated.h\"" << "";
+    for(int line = 0; line < lines; ++line) {
+        switch(line % 10) {
+        case 0:
+            source << QString("static const double table%1[] = { 1.0, 2.0, 3.0 }; /* generated block %1 */").arg(line);
+            break;
+        case 1:
+            source << QString("int kernel%1(int rank, unsigned long count, const char *name)").arg(line);
+            break;
+        case 2:
+            source << "{";
+            break;
+        case 3:
+            source << QString("    if(rank == 0 && count > %1) { MPI_Barrier(MPI_COMM_WORLD); } // sync").arg(line);
+            break;
+        case 4:
+            source << QString("    for(int i = 0; i < count; ++i) { value_%1 += table%1[i % 3] * i; }").arg(line);
+            break;
+        case 5:
+            source << "    /* a comment that spans";
+            break;
+        case 6:
+            source << "       two lines */ printf(\"%s: %d\\n\", name, rank);";
+            break;
+        case 7:
+            source << "    return MPI_Send(&count, 1, MPI_UNSIGNED_LONG, 0, 0, MPI_COMM_WORLD); }";
+            break;
+        case 8:
+            source << "#if 0";
+            break;
+        case 9:
+            source << QString("int unused%1; /* disabled */\n#endif").arg(line);
+            break;
+        }
+    }
+    return source.join("\n");
+}
+
+
+TestSourceView::TestSourceView(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void TestSourceView::initTestCase()
+{
+}
+
+void TestSourceView::cleanupTestCase()
+{
+}
+
+void TestSourceView::testSyntaxHighlighter()
+{
+    QStringList lines;
+    lines << "#include <stdio.h>"                                  // 0
+          << "int main() { return MPI_Init(0, \"//\"); } // done"  // 1
+          << "vector<int> v; /* starts"                            // 2
+          << "  ends */ unsigned_value = 'x';"                     // 3
+          << "#if 0"                                               // 4
+          << "int dead; /* #endif */"                              // 5
+          << "#ifdef NESTED"                                       // 6
+          << "#endif"                                              // 7
+          << "#else"                                               // 8
+          << "return 0;"                                           // 9
+          << "#endif";                                             // 10
+
+    QTextDocument document;
+    document.setPlainText(lines.join("\n"));
+    SyntaxHighlighter highlighter(&document);
+    highlighter.rehighlight();
+
+    QColor keyword(Qt::darkYellow);
+    QColor dataType(Qt::darkMagenta);
+    QColor mpi(Qt::red);
+    QColor preprocessor(Qt::darkBlue);
+    QColor quote(Qt::darkGreen);
+    QColor disabled(Qt::darkGray);
+
+    QCOMPARE(colorAt(document, 0, 1), preprocessor);
+    QCOMPARE(colorAt(document, 0, 10), quote);
+
+    QCOMPARE(colorAt(document, 1, 0), dataType);
+    QCOMPARE(colorAt(document, 1, 4), QColor());
+    QCOMPARE(colorAt(document, 1, 13), keyword);
+    QCOMPARE(colorAt(document, 1, 20), mpi);
+    QCOMPARE(colorAt(document, 1, 33), quote);
+    QCOMPARE(colorAt(document, 1, 39), QColor());
+    QCOMPARE(colorAt(document, 1, 42), quote);
+
+    // Template arguments aren't quotes; comments carry on to the next line
+    QCOMPARE(colorAt(document, 2, 6), QColor());
+    QCOMPARE(colorAt(document, 2, 7), dataType);
+    QCOMPARE(colorAt(document, 2, 20), quote);
+    QCOMPARE(colorAt(document, 3, 2), quote);
+    QCOMPARE(colorAt(document, 3, 10), QColor());
+    QCOMPARE(colorAt(document, 3, 28), quote);
+
+    // "#if 0" regions, nested conditionals and comments included, end at their "#else"
+    for(int line = 4; line <= 7; ++line) {
+        QCOMPARE(colorAt(document, line, 1), disabled);
+    }
+    QCOMPARE(colorAt(document, 8, 1), preprocessor);
+    QCOMPARE(colorAt(document, 9, 0), keyword);
+    QCOMPARE(colorAt(document, 10, 1), preprocessor);
+
+    // Closing the comment on an earlier line brings the rest of the document back
+    QTextCursor cursor(document.findBlockByNumber(2));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText(" */");
+    QCOMPARE(colorAt(document, 3, 2), QColor());
+}
+
+void TestSourceView::testSyntaxHighlighterBenchmark_data()
+{
+    QTest::addColumn<bool>("regExp");
+
+    QTest::newRow("regular expressions") << true;
+    QTest::newRow("single pass") << false;
+}
+
+void TestSourceView::testSyntaxHighlighterBenchmark()
+{
+    QFETCH(bool, regExp);
+
+    QTextDocument document;
+    document.setPlainText(generatedSource(20000));
+
+    QSyntaxHighlighter *highlighter;
+    if(regExp) {
+        highlighter = new RegExpHighlighter(&document);
+    } else {
+        highlighter = new SyntaxHighlighter(&document);
+    }
+
+    QBENCHMARK {
+        highlighter->rehighlight();
+    }
+
+    delete highlighter;
+}
+
+void TestSourceView::testLanguages()
+{
+    LanguageRegistry &registry = LanguageRegistry::instance();
+    QVERIFY(registry.contains("Fortran"));
+    QVERIFY(registry.contains("Python"));
+    QCOMPARE(registry.languageForFile("/build/solver.F90"), QString("Fortran"));
+    QCOMPARE(registry.languageForFile("/build/solver.f"), QString("Fortran (fixed form)"));
+    QCOMPARE(registry.languageForFile("/build/solver.C"), QString("C++"));
+    QCOMPARE(registry.languageForFile("/build/solver.PY"), QString("Python"));
+    QCOMPARE(registry.languageForFile("/build/solver"), registry.defaultLanguage());
+    QCOMPARE(registry.languageForFirstLine("#!/usr/bin/env python3"), QString("Python"));
+    QVERIFY(registry.languageForFirstLine("int main()").isEmpty());
+
+    QColor keyword(Qt::darkYellow);
+    QColor dataType(Qt::darkMagenta);
+    QColor mpi(Qt::red);
+    QColor comment(Qt::darkGreen);
+
+    // Fortran is case insensitive, and has no backslash escapes
+    QStringList fortran;
+    fortran << "PROGRAM main"                        // 0
+            << "  Integer :: ierr ! MPI_Init"        // 1
+            << "  call mpi_init(ierr)"               // 2
+            << "  print *, 'a\\', 'do'"            // 3
+            << "C not a comment in free form";       // 4
+
+    QTextDocument document;
+    document.setPlainText(fortran.join("\n"));
+    SyntaxHighlighter highlighter(&document);
+    QVERIFY(highlighter.setLanguage("Fortran"));
+    QVERIFY(!highlighter.setLanguage("Cobol"));
+    QCOMPARE(highlighter.language(), QString("Fortran"));
+    highlighter.rehighlight();
+
+    QCOMPARE(colorAt(document, 0, 0), keyword);
+    QCOMPARE(colorAt(document, 1, 2), dataType);
+    QCOMPARE(colorAt(document, 1, 20), comment);
+    QCOMPARE(colorAt(document, 2, 2), keyword);
+    QCOMPARE(colorAt(document, 2, 7), mpi);
+    QCOMPARE(colorAt(document, 3, 16), QColor());
+    QCOMPARE(colorAt(document, 3, 18), QColor(Qt::darkGreen));
+    QCOMPARE(colorAt(document, 4, 0), QColor());
+
+    // Fixed form comments start in the first column
+    QVERIFY(highlighter.setLanguage("Fortran (fixed form)"));
+    highlighter.rehighlight();
+    QCOMPARE(colorAt(document, 4, 0), comment);
+    QCOMPARE(colorAt(document, 4, 20), comment);
+    QCOMPARE(colorAt(document, 2, 7), mpi);
+
+    // Python's triple quotes span lines
+    QStringList python;
+    python << "def solve(comm): # entry"             // 0
+           << "    \"\"\"Solves, and"               // 1
+           << "    returns\"\"\" ; int"              // 2
+           << "    return MPI.COMM_WORLD";           // 3
+    document.setPlainText(python.join("\n"));
+    QVERIFY(highlighter.setLanguage("Python"));
+    highlighter.rehighlight();
+    QCOMPARE(colorAt(document, 0, 0), keyword);
+    QCOMPARE(colorAt(document, 0, 20), comment);
+    QCOMPARE(colorAt(document, 1, 10), QColor(Qt::darkGreen));
+    QCOMPARE(colorAt(document, 2, 4), QColor(Qt::darkGreen));
+    QCOMPARE(colorAt(document, 2, 16), dataType);
+    QCOMPARE(colorAt(document, 3, 4), keyword);
+    QCOMPARE(colorAt(document, 3, 11), mpi);
+
+    // Plugins add languages, which files then pick by suffix
+    LanguageDefinition definition;
+    definition.name = "TestLanguage";
+    definition.suffixes << "testlang";
+    definition.keywords << "begin" << "finish";
+    definition.lineComments << "--";
+    QVERIFY(registry.registerLanguage(definition));
+    QVERIFY(!registry.registerLanguage(definition));
+    QCOMPARE(registry.languageForFile("job.testlang"), QString("TestLanguage"));
+
+    // A line's state tells apart only so many comments and quotes that may span lines
+    LanguageDefinition blocks;
+    blocks.name = "TestBlocks";
+    blocks.suffixes << "testblocks";
+    for(int i = 0; i < 7; ++i) {
+        blocks.blockComments << qMakePair(QString("(%1").arg(i), QString("%1)").arg(i));
+    }
+    blocks.blockComments << qMakePair(QString("(x"), QString());
+    LanguageDefinition tooManyBlocks = blocks;
+    tooManyBlocks.name = "TestTooManyBlocks";
+    tooManyBlocks.blockQuotes << qMakePair(QString("<<"), QString(">>"));
+    QVERIFY(!registry.registerLanguage(tooManyBlocks));
+    QVERIFY(!registry.contains("TestTooManyBlocks"));
+    QVERIFY(registry.registerLanguage(blocks));
+
+    document.setPlainText("(6 spans\nlines 6) begin");
+    QVERIFY(highlighter.setLanguage("TestBlocks"));
+    highlighter.rehighlight();
+    QCOMPARE(colorAt(document, 1, 0), comment);
+
+    document.setPlainText("begin -- finish\nfinish");
+    QVERIFY(highlighter.setLanguage("TestLanguage"));
+    highlighter.rehighlight();
+    QCOMPARE(colorAt(document, 0, 0), keyword);
+    QCOMPARE(colorAt(document, 0, 10), comment);
+    QCOMPARE(colorAt(document, 1, 0), keyword);
+
+    QTemporaryFile file(QDir::tempPath() + "/TestSourceViewXXXXXX.f90");
+    QVERIFY(file.open());
+    file.write(fortran.join("\n").toUtf8());
+    file.close();
+
+    Plugins::SourceView::SourceView view;
+    QCOMPARE(view.language(), registry.defaultLanguage());
+    QVERIFY(view.loadFile(file.fileName()));
+    QCOMPARE(view.language(), QString("Fortran"));
+    QVERIFY(view.setLanguage("Python"));
+    QVERIFY(!view.setLanguage("Cobol"));
+    QCOMPARE(view.language(), QString("Python"));
+}
+
+void TestSourceView::testLazyHighlighting()
+{
+    QString text = generatedSource(100000);
+
+    Plugins::SourceView::SourceView view;
+    view.setLazyHighlighting(true);
+    QVERIFY(view.lazyHighlighting());
+    view.resize(640, 480);
+
+    // Only what's in view is highlighted before the view is first shown
+    view.setPlainText(text);
+    view.show();
+    QTest::qWaitForWindowShown(&view);
+
+    QTextDocument *document = view.document();
+    QCOMPARE(colorAt(*document, 0, 1), QColor(Qt::darkBlue));
+    QCOMPARE(colorAt(*document, 6, 4), QColor(Qt::darkYellow));
+    QVERIFY(document->lastBlock().userState() < 0);
+
+    // Lines out of view are highlighted in idle time, carrying comment and "#if 0" states forward
+    QTime timer;
+    timer.start();
+    while(document->lastBlock().userState() < 0 && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+    }
+
+    QTextDocument reference;
+    reference.setPlainText(text);
+    SyntaxHighlighter highlighter(&reference);
+    highlighter.rehighlight();
+
+    QCOMPARE(document->blockCount(), reference.blockCount());
+    QTextBlock block = document->firstBlock();
+    QTextBlock referenceBlock = reference.firstBlock();
+    for(; block.isValid(); block = block.next(), referenceBlock = referenceBlock.next()) {
+        if(colorsOf(block) != colorsOf(referenceBlock)) {
+            QFAIL(qPrintable(QString("Line %1 is highlighted differently").arg(block.blockNumber() + 1)));
+        }
+    }
+
+    // Edits are highlighted again, and so are the lines whose state they change
+    QTextCursor cursor(document->findBlockByNumber(5));
+    cursor.insertText("/* ");
+    timer.restart();
+    while(colorAt(*document, 6, 4) != QColor(Qt::darkGreen) && timer.elapsed() < 10000) {
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(colorAt(*document, 6, 4), QColor(Qt::darkGreen));
+}
+
+void TestSourceView::testFileLoading()
+{
+    QString text = generatedSource(400000);
+    QStringList lines = text.split('\n');
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(text.toUtf8());
+    file.close();
+
+    Plugins::SourceView::SourceView view;
+    view.setLazyHighlighting(true);
+    QVERIFY(!view.loadFile(file.fileName() + ".missing"));
+    QVERIFY(!view.errorString().isEmpty());
+
+    // The view is usable before the whole file is read
+    QVERIFY(view.loadFile(file.fileName()));
+    QVERIFY(view.isLoading());
+    QVERIFY(view.document()->blockCount() < lines.count());
+
+    // Jumping ahead waits only for the chunk holding the line
+    view.setCurrentLineNumber(200000);
+    QCOMPARE(view.textCursor().blockNumber(), 199999);
+    QCOMPARE(view.textCursor().block().text(), lines.at(199999));
+    QVERIFY(view.isLoading());
+    QVERIFY(view.document()->blockCount() < lines.count());
+
+    QSignalSpy finished(&view, SIGNAL(loadFinished()));
+    QTime timer;
+    timer.start();
+    while(view.isLoading() && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+    }
+
+    QVERIFY(!view.isLoading());
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(view.document()->blockCount(), lines.count());
+    QVERIFY(view.toPlainText() == text);
+    QVERIFY(!view.document()->isUndoAvailable());
+}
+
+void TestSourceView::testDocumentCache()
+{
+    using Plugins::SourceView::SourceDocumentCache;
+    SourceDocumentCache &cache = SourceDocumentCache::instance();
+    cache.clear();
+    QCOMPARE(cache.count(), 0);
+
+    QString text = generatedSource(50000);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(text.toUtf8());
+    file.close();
+
+    Plugins::SourceView::SourceView *first = new Plugins::SourceView::SourceView();
+    QSignalSpy firstFinished(first, SIGNAL(loadFinished()));
+    QVERIFY(first->openFile(file.fileName()));
+    QVERIFY(first->lazyHighlighting());
+    QVERIFY(first->isReadOnly());
+
+    QTime timer;
+    timer.start();
+    while(first->isLoading() && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(firstFinished.count(), 1);
+    QVERIFY(first->toPlainText() == text);
+    QCOMPARE(cache.count(), 1);
+
+    // A second view of the same file shares the loaded document, without loading it again
+    Plugins::SourceView::SourceView *second = new Plugins::SourceView::SourceView();
+    QSignalSpy secondFinished(second, SIGNAL(loadFinished()));
+    QVERIFY(second->openFile(file.fileName()));
+    QVERIFY(!second->isLoading());
+    QCOMPARE(secondFinished.count(), 1);
+    QVERIFY(second->document() == first->document());
+    QCOMPARE(cache.count(), 1);
+
+    // The document outlives the views, until the memory budget lets it go
+    QPointer<QTextDocument> document = first->document();
+    delete first;
+    delete second;
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.memoryUsage() >= (qint64)text.length() * 2);
+
+    Plugins::SourceView::SourceView third;
+    QVERIFY(third.openFile(file.fileName()));
+    QVERIFY(third.document() == document);
+    QVERIFY(!third.isLoading());
+
+    // A changed file gets a new document; the old one, no longer shown, goes once it's over budget
+    QVERIFY(file.open());
+    QVERIFY(file.seek(file.size()));
+    file.write("int changed;\n");
+    file.close();
+
+    QVERIFY(third.openFile(file.fileName()));
+    QVERIFY(third.document() != document);
+    timer.restart();
+    while(third.isLoading() && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+    }
+    QVERIFY(third.toPlainText() == text + "int changed;\n");
+    QCOMPARE(cache.count(), 2);
+
+    qint64 budget = cache.memoryBudget();
+    cache.setMemoryBudget(0);
+    QCOMPARE(cache.count(), 1);
+    QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+    QVERIFY(document.isNull());
+    cache.setMemoryBudget(budget);
+
+    // Loading a file goes back to a document of the view's own
+    QVERIFY(third.loadFile(file.fileName()));
+    QVERIFY(!third.isReadOnly());
+    QCOMPARE(cache.count(), 1);
+    cache.clear();
+    QCOMPARE(cache.count(), 0);
+
+    // A view opening a file that's still loading waits for the same load, which outlives the view that started it
+    QString largeText = generatedSource(400000);
+    QTemporaryFile largeFile;
+    QVERIFY(largeFile.open());
+    largeFile.write(largeText.toUtf8());
+    largeFile.close();
+
+    Plugins::SourceView::SourceView *loading = new Plugins::SourceView::SourceView();
+    QSignalSpy loadingFinished(loading, SIGNAL(loadFinished()));
+    QVERIFY(loading->openFile(largeFile.fileName()));
+    QVERIFY(loading->isLoading());
+
+    Plugins::SourceView::SourceView sharing;
+    QSignalSpy sharingFinished(&sharing, SIGNAL(loadFinished()));
+    QVERIFY(sharing.openFile(largeFile.fileName()));
+    QVERIFY(sharing.document() == loading->document());
+    QVERIFY(sharing.isLoading());
+    QCOMPARE(sharingFinished.count(), 0);
+    QCOMPARE(cache.count(), 1);
+
+    delete loading;
+    QVERIFY(sharing.isLoading());
+    timer.restart();
+    while(sharing.isLoading() && timer.elapsed() < 60000) {
+        QCoreApplication::processEvents();
+    }
+    QCOMPARE(loadingFinished.count(), 0);
+    QCOMPARE(sharingFinished.count(), 1);
+    QVERIFY(sharing.toPlainText() == largeText);
+
+    // Once loaded, the document is kept for the next view to open
+    Plugins::SourceView::SourceView reopened;
+    QVERIFY(reopened.openFile(largeFile.fileName()));
+    QVERIFY(reopened.document() == sharing.document());
+    QVERIFY(!reopened.isLoading());
+    cache.clear();
+}
+
+static bool writeFile(const QString &fileName, const QByteArray &data)
+{
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+static void removeDirectory(const QString &path)
+{
+    QDir directory(path);
+    foreach(const QFileInfo &info, directory.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)) {
+        if(info.isDir()) {
+            removeDirectory(info.filePath());
+        } else {
+            QFile::remove(info.filePath());
+        }
+    }
+    directory.rmdir(path);
+}
+
+void TestSourceView::testSourceLocator()
+{
+    using Plugins::SourceView::SourceLocator;
+
+    QString path = QString("%1/TestSourceLocator-%2").arg(QDir::tempPath()).arg(QCoreApplication::applicationPid());
+    removeDirectory(path);
+    QString root = path + "/sources";
+
+    QVERIFY(writeFile(root + "/app/src/solver.c", "int main()\n{\n    return solve(); /* needle */\n}\n"));
+    QVERIFY(writeFile(root + "/lib/src/solver.c", "int solve()\n{\n    return 0;\n}\n"));
+    QVERIFY(writeFile(root + "/lib/include/solver.h", "int solve(); // Needle\n"));
+    QVERIFY(writeFile(root + "/lib/solver.o", QByteArray("\x7f" "ELF\0\0needle", 12)));
+    QVERIFY(writeFile(root + "/.git/needle", "needle\n"));
+    static const int Files = 100;
+    for(int i = 0; i < Files; ++i) {
+        QVERIFY(writeFile(QString("%1/generated/d%2/file%3.c").arg(root).arg(i % 10).arg(i),
+                          generatedSource(20).toUtf8()));
+    }
+
+    SourceLocator &locator = SourceLocator::instance();
+    locator.setIndexFileName(path + "/index");
+
+    locator.setRoots(QStringList() << root);
+    QVERIFY(locator.isIndexing());
+    locator.waitForIndex();
+    QCOMPARE(locator.fileCount(), Files + 4);
+    QVERIFY(QFile::exists(path + "/index"));
+
+    // Build paths resolve to the file whose path ends the most alike
+    QCOMPARE(locator.locate("/home/builder/project/app/src/solver.c"), root + "/app/src/solver.c");
+    QCOMPARE(locator.locate("/home/builder/project/lib/src/solver.c"), root + "/lib/src/solver.c");
+    QCOMPARE(locator.locate("C:/project/include/solver.h"), root + "/lib/include/solver.h");
+    QCOMPARE(locator.locate("/home/builder/project/generated/d7/file87.c"), root + "/generated/d7/file87.c");
+    QVERIFY(locator.locate("/home/builder/project/missing.c").isEmpty());
+    QCOMPARE(locator.locate(root + "/lib/src/solver.c"), root + "/lib/src/solver.c");
+
+    // Searches skip binary and hidden files
+    QList<SourceLocator::Match> matches = locator.search("needle");
+    QCOMPARE(matches.count(), 1);
+    QCOMPARE(matches.first().fileName, root + "/app/src/solver.c");
+    QCOMPARE(matches.first().lineNumber, 3);
+    QCOMPARE(matches.first().line, QString("    return solve(); /* needle */"));
+    QCOMPARE(locator.search("NEEDLE", Qt::CaseInsensitive).count(), 2);
+    QVERIFY(locator.search("needles").isEmpty());
+    QCOMPARE(locator.search("MPI_Barrier", Qt::CaseSensitive, 100).count(), 100);
+    QCOMPARE(locator.search("generated block 17").count(), 0);
+    QCOMPARE(locator.search("table10[]").count(), Files);
+
+    // Refreshing picks up changed files, and keeps what it knew of the others without reading them again
+    QVERIFY(writeFile(root + "/lib/src/solver.c", "int solve()\n{\n    return 1; /* needle */\n}\n"));
+    QVERIFY(QFile::remove(root + "/app/src/solver.c"));
+    locator.refresh();
+    locator.waitForIndex();
+    QCOMPARE(locator.fileCount(), Files + 3);
+    matches = locator.search("needle");
+    QCOMPARE(matches.count(), 1);
+    QCOMPARE(matches.first().fileName, root + "/lib/src/solver.c");
+    QCOMPARE(matches.first().lineNumber, 3);
+    QVERIFY(locator.search("return 0;").isEmpty());
+    QCOMPARE(locator.search("table10[]").count(), Files);
+    QCOMPARE(locator.locate("/home/builder/project/app/src/solver.c"), root + "/lib/src/solver.c");
+
+    locator.setIndexFileName(QString());
+    locator.setRoots(QStringList());
+    locator.waitForIndex();
+    QCOMPARE(locator.fileCount(), 0);
+    removeDirectory(path);
+}
+
+void TestSourceView::testLineMetrics()
+{
+    Plugins::SourceView::SourceView view;
+    view.setPlainText(generatedSource(100));
+
+    QVector<int> lineNumbers;
+    QVector<double> values;
+    lineNumbers << 40 << 3 << 12 << 3 << 90;
+    values << 5.0 << 1.0 << 10.0 << 2.0 << 0.0;
+    view.setLineMetrics(lineNumbers, values, "Samples");
+
+    QCOMPARE(view.lineMetricName(), QString("Samples"));
+    QVERIFY(view.hasLineMetric(3));
+    QVERIFY(view.hasLineMetric(90));
+    QVERIFY(!view.hasLineMetric(4));
+    QCOMPARE(view.lineMetric(3), 3.0);
+    QCOMPARE(view.lineMetric(12), 10.0);
+    QCOMPARE(view.lineMetric(13), 0.0);
+    QCOMPARE(view.lineMetricTotal(1, 100), 18.0);
+    QCOMPARE(view.lineMetricTotal(4, 40), 15.0);
+    QCOMPARE(view.lineMetricTotal(13, 39), 0.0);
+    QCOMPARE(view.lineMetricTotal(50, 10), 0.0);
+
+    view.clearLineMetrics();
+    QVERIFY(!view.hasLineMetric(3));
+    QCOMPARE(view.lineMetricTotal(1, 100), 0.0);
+}
+
+void TestSourceView::testLineMetricsLarge()
+{
+    static const int Lines = 200000;
+
+    Plugins::SourceView::SourceView view;
+    view.setPlainText(generatedSource(Lines));
+    view.resize(640, 480);
+    view.show();
+    QTest::qWaitForWindowShown(&view);
+
+    QVector<int> lineNumbers(Lines);
+    QVector<double> values(Lines);
+    for(int i = 0; i < Lines; ++i) {
+        lineNumbers[i] = i + 1;
+        values[i] = (double)((i * 37) % 1000);
+    }
+
+    view.setLineMetrics(lineNumbers, values, "Time");
+    QCOMPARE(view.lineMetric(Lines), values.last());
+    QCOMPARE(view.lineMetric(Lines / 2), values.at(Lines / 2 - 1));
+    QVERIFY(!view.hasLineMetric(Lines + 1));
+
+    // Painting only looks at the visible lines, wherever they are
+    view.setCurrentLineNumber(Lines / 2);
+    QBENCHMARK {
+        view.viewport()->repaint();
+    }
+}
+
+void TestSourceView::testOverviewRuler()
+{
+    static const int Lines = 500000;
+
+    Plugins::SourceView::SourceView view;
+    view.setLazyHighlighting(true);
+    view.setPlainText(generatedSource(Lines));
+    view.resize(640, 480);
+    view.show();
+    QTest::qWaitForWindowShown(&view);
+
+    OverviewRuler *ruler = view.findChild<OverviewRuler *>();
+    QVERIFY(ruler);
+    QVERIFY(view.overviewRulerVisible());
+
+    QVector<int> lineNumbers;
+    QVector<double> values;
+    for(int lineNumber = 1; lineNumber <= Lines; lineNumber += 3) {
+        lineNumbers.append(lineNumber);
+        values.append((double)(lineNumber % 1000));
+    }
+    view.setLineMetrics(lineNumbers, values, "Time");
+    view.addAnnotation(Lines / 2, "Hot spot");
+
+    // The whole file is drawn once, after which painting just shows the picture
+    QImage image(ruler->size(), QImage::Format_RGB32);
+    ruler->render(&image);
+    int row = (int)((qint64)(Lines / 2 - 1) * ruler->height() / Lines);
+    QCOMPARE(QColor(image.pixel(ruler->width() - 1, row)), QColor("orange"));
+    QVERIFY(QColor(image.pixel(0, row)) != QColor(Qt::lightGray));
+
+    QBENCHMARK {
+        ruler->repaint();
+    }
+
+    // Clicking moves to the lines under the mouse
+    int y = ruler->height() * 3 / 4;
+    QTest::mouseClick(ruler, Qt::LeftButton, Qt::NoModifier, QPoint(1, y));
+    int expected = (int)((qint64)y * Lines / ruler->height()) + 1;
+    QCOMPARE(view.textCursor().blockNumber() + 1, expected);
+
+    view.setOverviewRulerVisible(false);
+    QVERIFY(!view.overviewRulerVisible());
+    QVERIFY(ruler->isHidden());
+}
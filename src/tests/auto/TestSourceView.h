@@ -0,0 +1,56 @@
+/*!
+   \file TestSourceView.h
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef TESTSOURCEVIEW_H
+#define TESTSOURCEVIEW_H
+
+#include <QObject>
+
+class TestSourceView : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestSourceView(QObject *parent = 0);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testSyntaxHighlighter();
+    void testSyntaxHighlighterBenchmark_data();
+    void testSyntaxHighlighterBenchmark();
+
+    void testLanguages();
+    void testLazyHighlighting();
+
+    void testFileLoading();
+    void testDocumentCache();
+    void testSourceLocator();
+
+    void testLineMetrics();
+    void testLineMetricsLarge();
+    void testOverviewRuler();
+
+};
+
+#endif // TESTSOURCEVIEW_H
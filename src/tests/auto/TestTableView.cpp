@@ -0,0 +1,1226 @@
+/*!
+   \file TestTableView.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TestTableView.h"
+
+#include <QTest>
+#include <QTableView>
+#include <QScrollBar>
+#include <QImage>
+#include <QAbstractTableModel>
+#include <QHeaderView>
+#include <QStandardItemModel>
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QSet>
+#include <QSignalSpy>
+#include <QMutex>
+#include <QThread>
+
+#include <limits>
+
+#include <ViewManager/ColumnarModel.h>
+#include <ViewManager/PagedModel.h>
+#include <TableView/AggregateModel.h>
+#include <TableView/AggregateView.h>
+#include <TableView/Delegate.h>
+#include <TableView/DerivedColumnModel.h>
+#include <TableView/DelimitedImporter.h>
+#include <TableView/TableExporter.h>
+#include <TableView/TableView.h>
+#include <TableView/SortFilterProxyModel.h>
+using namespace Plugins::TableView;
+using Core::ViewManager::ColumnarModel;
+using Core::ViewManager::PagedModel;
+
+
+/* Generates its values on the fly, so a million rows costs nothing to hold */
+class GeneratedModel : public QAbstractTableModel
+{
+public:
+    GeneratedModel(int rows, int columns) : m_Rows(rows), m_Columns(columns) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : m_Rows; }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const { return parent.isValid() ? 0 : m_Columns; }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const
+    {
+        if(!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+            return QVariant();
+        }
+        return QVariant((double)(((quint64)index.row() * 31 + index.column() * 17) % 10000) / 100.0);
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const
+    {
+        if(orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+            return (section % 5 == 0) ? QString("Time %1 (%)").arg(section) : QString("Time %1").arg(section);
+        }
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    void appendRows(int count)
+    {
+        beginInsertRows(QModelIndex(), m_Rows, m_Rows + count - 1);
+        m_Rows += count;
+        endInsertRows();
+    }
+
+private:
+    int m_Rows;
+    int m_Columns;
+};
+
+/* Records the selection changes passed on by the view */
+class SelectionDelegate : public Delegate
+{
+public:
+    explicit SelectionDelegate(QObject *parent = 0) : Delegate(parent) {}
+
+    void selected(const QModelIndex &index) { m_Selection.insert(index); Delegate::selected(index); }
+    void deselected(const QModelIndex &index) { m_Selection.remove(index); Delegate::deselected(index); }
+
+    QSet<QModelIndex> m_Selection;
+};
+
+/* Computes its pages, standing in for an experiment database far larger than memory */
+class GeneratedStore : public PagedModel::Store
+{
+public:
+    GeneratedStore(int rows, int columns) : m_Rows(rows), m_Columns(columns) {}
+
+    int rowCount() const { return m_Rows; }
+    QStringList columnNames() const
+    {
+        QStringList names;
+        for(int column = 0; column < m_Columns; ++column) {
+            names.append(QString("Time %1").arg(column));
+        }
+        return names;
+    }
+
+    bool readRows(int first, int count, QVector<QVariant> &values)
+    {
+        for(int row = first; row < first + count; ++row) {
+            for(int column = 0; column < m_Columns; ++column) {
+                values.append((double)(((quint64)row * 31 + column * 17) % 10000) / 100.0);
+            }
+        }
+        return true;
+    }
+
+private:
+    int m_Rows;
+    int m_Columns;
+};
+
+/* Whether two aggregate models hold the same groups, in the same order, with the same values */
+static bool sameAggregates(const QAbstractItemModel &a, const QAbstractItemModel &b)
+{
+    if(a.rowCount() != b.rowCount() || a.columnCount() != b.columnCount()) {
+        return false;
+    }
+    for(int row = 0; row < a.rowCount(); ++row) {
+        for(int column = 0; column < a.columnCount(); ++column) {
+            QVariant x = a.index(row, column).data();
+            QVariant y = b.index(row, column).data();
+            if(x.type() == QVariant::Double ? !qFuzzyCompare(1.0 + x.toDouble(), 1.0 + y.toDouble()) : x != y) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Collects what is written to it and which threads wrote it; optionally sequential, like a socket */
+class ThreadRecordingDevice : public QIODevice
+{
+public:
+    explicit ThreadRecordingDevice(bool sequential = false) : m_Sequential(sequential) {}
+
+    bool isSequential() const { return m_Sequential; }
+    QByteArray data() const { QMutexLocker locker(&m_Mutex); return m_Data; }
+    QSet<QThread *> writers() const { QMutexLocker locker(&m_Mutex); return m_Writers; }
+
+protected:
+    qint64 readData(char *, qint64) { return -1; }
+    qint64 writeData(const char *data, qint64 length)
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Writers.insert(QThread::currentThread());
+        m_Data.append(data, (int)length);
+        return length;
+    }
+
+private:
+    bool m_Sequential;
+    mutable QMutex m_Mutex;
+    QByteArray m_Data;
+    QSet<QThread *> m_Writers;
+};
+
+/* Fills a ColumnarModel with the same kind of data as GeneratedModel, plus a leading column of names */
+static void fillColumnarModel(ColumnarModel &model, int rows, int columns)
+{
+    model.addColumn("Function", ColumnarModel::ColumnType_String);
+    for(int column = 1; column < columns; ++column) {
+        QString name = (column % 5 == 0) ? QString("Time %1 (%)").arg(column) : QString("Time %1").arg(column);
+        model.addColumn(name, ColumnarModel::ColumnType_Double);
+    }
+
+    model.reserve(rows);
+    model.beginAppendRows(rows);
+    for(int row = 0; row < rows; ++row) {
+        model.setString(row, 0, QString("function%1").arg((row * 7) % 1000));
+        for(int column = 1; column < columns; ++column) {
+            model.setDouble(row, column, (double)(((quint64)row * 31 + column * 17) % 10000) / 100.0);
+        }
+    }
+    model.endAppendRows();
+}
+
+
+TestTableView::TestTableView(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void TestTableView::initTestCase()
+{
+}
+
+void TestTableView::cleanupTestCase()
+{
+}
+
+void TestTableView::testDelegateDisplayText_data()
+{
+    QTest::addColumn<QVariant>("value");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("double") << QVariant(1.5) << QString("%1").arg(1.5, 10, 'f', 6, QChar(0x2002));
+    QTest::newRow("negative double") << QVariant(-0.25) << QString("%1").arg(-0.25, 10, 'f', 6, QChar(0x2002));
+    QTest::newRow("int") << QVariant(42) << QString("%1").arg((qlonglong)42, 4, 10, QChar(0x2002));
+    QTest::newRow("negative int") << QVariant(-42) << QString("%1").arg((qlonglong)-42, 4, 10, QChar(0x2002));
+    QTest::newRow("unsigned") << QVariant((qulonglong)42) << QString("%1").arg((qulonglong)42, 4, 10, QChar(0x2002));
+    QTest::newRow("string") << QVariant(QString("text")) << QString("text");
+}
+
+void TestTableView::testDelegateDisplayText()
+{
+    Delegate delegate;
+
+    QFETCH(QVariant, value);
+    QFETCH(QString, text);
+
+    // Second call comes from the cache
+    QCOMPARE(delegate.displayText(value, QLocale()), text);
+    QCOMPARE(delegate.displayText(value, QLocale()), text);
+}
+
+void TestTableView::testDelegateScrolling()
+{
+    GeneratedModel model(1000000, 50);
+
+    QTableView view;
+    view.setItemDelegate(new Delegate(&view));
+    view.setModel(&model);
+    view.resize(1280, 1024);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QScrollBar *scrollBar = view.verticalScrollBar();
+    QVERIFY(scrollBar->maximum() > 0);
+
+    QBENCHMARK {
+        for(int page = 0; page < 100; ++page) {
+            scrollBar->setValue((int)(((qint64)scrollBar->maximum() * page) / 100));
+            view.viewport()->render(&image);
+        }
+    }
+}
+
+void TestTableView::testLargeModelSizing()
+{
+    GeneratedModel smallModel(100, 10);
+    GeneratedModel largeModel(1000000, 10);
+
+    TableView view;
+    view.setLargeModelThreshold(1000);
+
+    view.setModel(&smallModel);
+    QVERIFY(!view.isLargeModel());
+
+    QBENCHMARK {
+        view.setModel(&largeModel);
+    }
+    QVERIFY(view.isLargeModel());
+
+    // Every row shares the sampled height, and every column is wide enough for its header
+    QHeaderView *verticalHeader = view.verticalHeader();
+    QCOMPARE(verticalHeader->sectionSize(0), verticalHeader->defaultSectionSize());
+    QCOMPARE(verticalHeader->sectionSize(largeModel.rowCount() - 1), verticalHeader->defaultSectionSize());
+    for(int column = 0; column < largeModel.columnCount(); ++column) {
+        QVERIFY(view.columnWidth(column) >= view.horizontalHeader()->sectionSizeHint(column));
+    }
+
+    // The delegate still hears about selection changes, while the rows keep their fixed height
+    SelectionDelegate *delegate = new SelectionDelegate(&view);
+    view.setItemDelegate(delegate);
+
+    view.selectRow(5);
+    QCOMPARE(delegate->m_Selection.count(), largeModel.columnCount());
+    QVERIFY(delegate->m_Selection.contains(view.QTableView::model()->index(5, 0)));
+
+    view.selectRow(7);
+    QCOMPARE(delegate->m_Selection.count(), largeModel.columnCount());
+    QVERIFY(!delegate->m_Selection.contains(view.QTableView::model()->index(5, 0)));
+
+    QCoreApplication::processEvents();
+    QCOMPARE(verticalHeader->sectionSize(7), verticalHeader->defaultSectionSize());
+}
+
+static bool isSorted(const QAbstractItemModel &model, int column, Qt::SortOrder order)
+{
+    for(int row = 1; row < model.rowCount(); ++row) {
+        QVariant previous = model.index(row - 1, column).data();
+        QVariant current = model.index(row, column).data();
+        int compare = 0;
+        if(current.userType() == QVariant::String) {
+            compare = QString::compare(current.toString(), previous.toString());
+        } else {
+            compare = (current.toDouble() < previous.toDouble()) ? -1 : (current.toDouble() > previous.toDouble()) ? 1 : 0;
+        }
+        if((order == Qt::AscendingOrder) ? (compare < 0) : (compare > 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestTableView::testProxySort()
+{
+    GeneratedModel model(1000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+
+    proxy.sort(1, Qt::AscendingOrder);
+    QVERIFY(!proxy.isBusy());
+    QVERIFY(isSorted(proxy, 1, Qt::AscendingOrder));
+
+    proxy.sort(1, Qt::DescendingOrder);
+    QVERIFY(isSorted(proxy, 1, Qt::DescendingOrder));
+
+    // Persistent indexes follow their source row through a re-sort
+    QPersistentModelIndex persistent = proxy.index(10, 2);
+    QModelIndex source = proxy.mapToSource(persistent);
+    proxy.sort(3, Qt::AscendingOrder);
+    QCOMPARE(proxy.mapToSource(persistent), source);
+
+    proxy.sort(-1);
+    QCOMPARE(proxy.mapToSource(proxy.index(10, 0)).row(), 10);
+}
+
+void TestTableView::testProxyFilter()
+{
+    GeneratedModel model(1000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setFilterKeyColumn(0);
+    proxy.setFilterRegExp(QString("^1"));
+
+    int expected = 0;
+    for(int row = 0; row < model.rowCount(); ++row) {
+        if(model.index(row, 0).data().toString().startsWith("1")) {
+            ++expected;
+        }
+    }
+    QCOMPARE(proxy.rowCount(), expected);
+
+    proxy.setFilterRegExp(QString());
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+}
+
+void TestTableView::testProxyAsynchronousSort()
+{
+    GeneratedModel model(1000000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setAsynchronousThreshold(1000);
+    proxy.setSourceModel(&model);
+
+    // Sorting by another column mid-sort cancels the first
+    proxy.sort(1, Qt::AscendingOrder);
+    proxy.sort(2, Qt::DescendingOrder);
+    QVERIFY(proxy.isBusy());
+
+    proxy.waitForFinished();
+    QVERIFY(!proxy.isBusy());
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+    QVERIFY(isSorted(proxy, 2, Qt::DescendingOrder));
+
+    QBENCHMARK {
+        proxy.sort(3, Qt::AscendingOrder);
+        proxy.waitForFinished();
+    }
+}
+
+void TestTableView::testProxyStreamedRows()
+{
+    GeneratedModel model(1000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(1, Qt::AscendingOrder);
+
+    QPersistentModelIndex persistent = proxy.index(500, 0);
+    QModelIndex source = proxy.mapToSource(persistent);
+
+    // A few rows land in a few places, each run inserted on its own
+    model.appendRows(3);
+    QTest::qWait(100);
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+    QVERIFY(isSorted(proxy, 1, Qt::AscendingOrder));
+    QCOMPARE(proxy.mapToSource(persistent), source);
+
+    // Many rows in one frame are merged in with a single layout change
+    for(int i = 0; i < 10; ++i) {
+        model.appendRows(100);
+    }
+    QTest::qWait(100);
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+    QVERIFY(isSorted(proxy, 1, Qt::AscendingOrder));
+    QCOMPARE(proxy.mapToSource(persistent), source);
+    QVERIFY(proxy.mapFromSource(model.index(model.rowCount() - 1, 0)).isValid());
+}
+
+void TestTableView::testProxyFilterExpression()
+{
+    GeneratedModel model(1000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    QString errorMessage;
+    QVERIFY(!proxy.setFilterExpression("bogus > 1", &errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+
+    QVERIFY(proxy.setFilterExpression("\"Time 1\" > 50 && $3 < 20"));
+
+    int expected = 0;
+    for(int row = 0; row < model.rowCount(); ++row) {
+        if(model.index(row, 1).data().toDouble() > 50 && model.index(row, 2).data().toDouble() < 20) {
+            ++expected;
+        }
+    }
+    QCOMPARE(proxy.rowCount(), expected);
+
+    // Appended rows are filtered as they stream in
+    model.appendRows(100);
+    QTest::qWait(100);
+    for(int row = 1000; row < model.rowCount(); ++row) {
+        if(model.index(row, 1).data().toDouble() > 50 && model.index(row, 2).data().toDouble() < 20) {
+            ++expected;
+        }
+    }
+    QCOMPARE(proxy.rowCount(), expected);
+
+    QVERIFY(proxy.setFilterExpression(QString()));
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+}
+
+void TestTableView::testProxyEmptyCells()
+{
+    QStandardItemModel model(0, 2);
+    model.setHorizontalHeaderLabels(QStringList() << "Name" << "Value");
+    const char *names[] = { "three", "empty1", "seven", "empty2", "one" };
+    const int values[] = { 3, -1, 7, -1, 1 };
+    for(int row = 0; row < 5; ++row) {
+        QList<QStandardItem *> items;
+        items << new QStandardItem(names[row]) << new QStandardItem();
+        if(values[row] >= 0) {
+            items.last()->setData(values[row], Qt::DisplayRole);
+        }
+        model.appendRow(items);
+    }
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    // Empty cells are in no ordering, only unequal to everything
+    QVERIFY(proxy.setFilterExpression("Value < 5"));
+    QCOMPARE(proxy.rowCount(), 2);
+    QVERIFY(proxy.setFilterExpression("Value >= 0"));
+    QCOMPARE(proxy.rowCount(), 3);
+    QVERIFY(proxy.setFilterExpression("Value == 0"));
+    QCOMPARE(proxy.rowCount(), 0);
+    QVERIFY(proxy.setFilterExpression("Value != 3"));
+    QCOMPARE(proxy.rowCount(), 4);
+
+    // ...and sort before every number
+    QVERIFY(proxy.setFilterExpression(QString()));
+    proxy.sort(1, Qt::AscendingOrder);
+    QStringList order;
+    for(int row = 0; row < proxy.rowCount(); ++row) {
+        order.append(proxy.index(row, 0).data().toString());
+    }
+    QCOMPARE(order.mid(2), QStringList() << "one" << "three" << "seven");
+    QVERIFY(order.at(0).startsWith("empty") && order.at(1).startsWith("empty"));
+}
+
+void TestTableView::testColumnarModelSort()
+{
+    ColumnarModel model;
+    fillColumnarModel(model, 1000, 5);
+
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    proxy.sort(0, Qt::AscendingOrder);
+    QVERIFY(isSorted(proxy, 0, Qt::AscendingOrder));
+    proxy.sort(2, Qt::DescendingOrder);
+    QVERIFY(isSorted(proxy, 2, Qt::DescendingOrder));
+
+    // New strings change the ranks of the old ones; appended rows still land in order
+    proxy.sort(0, Qt::AscendingOrder);
+    int first = model.beginAppendRows(3);
+    model.setString(first, 0, "aaa");
+    model.setString(first + 1, 0, "function5000");
+    model.setString(first + 2, 0, "zzz");
+    model.endAppendRows();
+    QTest::qWait(100);
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+    QVERIFY(isSorted(proxy, 0, Qt::AscendingOrder));
+    QCOMPARE(proxy.index(0, 0).data().toString(), QString("aaa"));
+
+    QVERIFY(proxy.setFilterExpression("Function == \"function7\" && $3 >= 0"));
+    QVERIFY(proxy.rowCount() > 0);
+    for(int row = 0; row < proxy.rowCount(); ++row) {
+        QCOMPARE(proxy.index(row, 0).data().toString(), QString("function7"));
+    }
+
+    // The string ranks are read again when the case sensitivity changes
+    ColumnarModel names;
+    names.addColumn("Name", ColumnarModel::ColumnType_String);
+    names.beginAppendRows(3);
+    names.setString(0, 0, "cherry");
+    names.setString(1, 0, "Banana");
+    names.setString(2, 0, "apple");
+    names.endAppendRows();
+
+    SortFilterProxyModel nameProxy;
+    nameProxy.setSourceModel(&names);
+    nameProxy.sort(0, Qt::AscendingOrder);
+    QCOMPARE(nameProxy.index(0, 0).data().toString(), QString("Banana"));
+    nameProxy.setSortCaseSensitivity(Qt::CaseInsensitive);
+    QCOMPARE(nameProxy.index(0, 0).data().toString(), QString("apple"));
+    QCOMPARE(nameProxy.index(1, 0).data().toString(), QString("Banana"));
+    nameProxy.setSortCaseSensitivity(Qt::CaseSensitive);
+    QCOMPARE(nameProxy.index(0, 0).data().toString(), QString("Banana"));
+}
+
+void TestTableView::testColumnarModelScrolling()
+{
+    static const int Rows = 50000;
+    static const int Columns = 10;
+
+    ColumnarModel model;
+    fillColumnarModel(model, Rows, Columns);
+
+    // Both hold the same thousand names, so the difference is the rows alone: one typed slot per cell, with no
+    // QVariant or item behind any of them
+    ColumnarModel small;
+    fillColumnarModel(small, 1000, Columns);
+    qint64 rowBytes = (Columns - 1) * sizeof(double) + sizeof(quint32);
+    QCOMPARE(model.memoryUsage() - small.memoryUsage(), (qint64)(Rows - 1000) * rowBytes);
+
+    // ...and data() answers straight from those slots
+    for(int column = 1; column < Columns; ++column) {
+        const double *values = model.doubleColumn(column);
+        QVERIFY(values != NULL);
+        QCOMPARE(model.index(Rows - 1, column).data().toDouble(), values[Rows - 1]);
+    }
+    QVERIFY(model.stringColumn(0) != NULL);
+
+    TableView view;
+    view.setModel(&model);
+    view.resize(1280, 1024);
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QScrollBar *scrollBar = view.verticalScrollBar();
+    QVERIFY(scrollBar->maximum() > 0);
+
+    QBENCHMARK {
+        for(int page = 0; page < 100; ++page) {
+            scrollBar->setValue((int)(((qint64)scrollBar->maximum() * page) / 100));
+            view.viewport()->render(&image);
+        }
+    }
+}
+
+void TestTableView::testPagedModelScrolling()
+{
+    PagedModel model;
+    model.setMaximumPages(128);
+    model.setFetchBatchSize(1000000);
+    model.setStore(new GeneratedStore(100000000, 10));
+
+    TableView view;
+    view.setModel(&model);
+    view.resize(1280, 1024);
+    QVERIFY(view.isLargeModel());
+    QCOMPARE(view.model(), (QAbstractItemModel *)&model);
+
+    // Paged models can't be filtered from the view
+    QVERIFY(!view.setViewFilterExpression("\"Time 1\" > 50"));
+
+    QImage image(view.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QScrollBar *scrollBar = view.verticalScrollBar();
+    QVERIFY(scrollBar->maximum() > 0);
+
+    // Painting asks for pages rather than reading them; only the most recent are held, and the rows left on screen
+    // arrive without any further scrolling
+    for(int page = 0; page < 100; ++page) {
+        scrollBar->setValue((int)(((qint64)scrollBar->maximum() * page) / 100));
+        view.viewport()->render(&image);
+    }
+    QVERIFY(model.cachedPages() <= model.maximumPages());
+    int top = view.indexAt(QPoint(0, 0)).row();
+    QVERIFY(top > 0);
+    for(int i = 0; i < 100 && !model.isRowLoaded(top); ++i) {
+        QTest::qWait(50);
+    }
+    QVERIFY(model.isRowLoaded(top));
+
+    // Scrolling to the end exposes another batch
+    int rows = model.rowCount();
+    scrollBar->setValue(scrollBar->maximum());
+    QTest::qWait(100);
+    QVERIFY(model.rowCount() > rows);
+
+    QBENCHMARK {
+        for(int page = 0; page < 100; ++page) {
+            scrollBar->setValue((int)(((qint64)scrollBar->maximum() * page) / 100));
+            view.viewport()->render(&image);
+        }
+    }
+}
+
+void TestTableView::testDelimitedImport()
+{
+    DelimitedImporter importer;
+    importer.setProgressVisible(false);
+
+    // Quoted fields, escaped quotes, line breaks within quotes and empty numbers
+    QVERIFY(importer.start(QByteArray("\"Function\",Calls,Time\n"
+                                      "main,1,2.5\n"
+                                      "\"say \"\"hi\"\"\",3,\n"
+                                      "\n"
+                                      "\"two\nlines\",5,1e3\n")));
+    QVERIFY(importer.waitForFinished());
+
+    ColumnarModel *model = importer.model();
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->columnCount(), 3);
+    QCOMPARE(model->columnName(0), QString("Function"));
+    QCOMPARE(model->columnName(2), QString("Time"));
+    QCOMPARE(model->columnType(0), ColumnarModel::ColumnType_String);
+    QCOMPARE(model->columnType(1), ColumnarModel::ColumnType_Int64);
+    QCOMPARE(model->columnType(2), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model->string(1, 0), QString("say \"hi\""));
+    QCOMPARE(model->string(2, 0), QString("two\nlines"));
+    QCOMPARE(model->number(1, 1), 3.0);
+    QCOMPARE(model->number(2, 2), 1000.0);
+
+    // An empty number is no value, not zero
+    double empty = model->number(1, 2);
+    QVERIFY(empty != empty);
+    QVERIFY(!model->index(1, 2).data().isValid());
+    QCOMPARE(model->string(1, 2), QString());
+
+    // ...even in a column of integers, which then holds doubles
+    QVERIFY(importer.start(QByteArray("Calls,Time\n1,2\n,3\n4,\n")));
+    QVERIFY(importer.waitForFinished());
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->columnType(0), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model->columnType(1), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model->number(0, 0), 1.0);
+    QVERIFY(!model->index(1, 0).data().isValid());
+    QCOMPARE(model->number(2, 0), 4.0);
+    QVERIFY(!model->index(2, 1).data().isValid());
+
+    // ...and is filtered out of comparisons
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(model);
+    QVERIFY(proxy.setFilterExpression("Calls < 10"));
+    QCOMPARE(proxy.rowCount(), 2);
+
+    // Tabs are picked out by themselves; without a header the columns get generic names
+    importer.setHasHeader(false);
+    QVERIFY(importer.start(QByteArray("1\t2\r\n3\tx\r\n-4")));
+    QVERIFY(importer.waitForFinished());
+    QCOMPARE(model->rowCount(), 3);
+    QCOMPARE(model->columnName(0), QString("Column 1"));
+    QCOMPARE(model->columnType(0), ColumnarModel::ColumnType_Int64);
+    QCOMPARE(model->columnType(1), ColumnarModel::ColumnType_String);
+    QCOMPARE(model->number(2, 0), -4.0);
+    QCOMPARE(model->string(0, 1), QString("2"));
+    QCOMPARE(model->string(1, 1), QString("x"));
+    QCOMPARE(model->string(2, 1), QString());
+
+    // Nothing at all is an empty, successful import
+    QVERIFY(importer.start(QByteArray()));
+    QVERIFY(importer.waitForFinished());
+    QCOMPARE(model->rowCount(), 0);
+}
+
+void TestTableView::testDelimitedImportWidening()
+{
+    static const int Rows = 400000;
+
+    // Several chunks of integers, then a single value that makes the whole column text
+    QByteArray text("Function,Count,Time\n");
+    for(int row = 0; row < Rows; ++row) {
+        text.append("function").append(QByteArray::number(row % 1000)).append(',')
+            .append(QByteArray::number(row)).append(',').append(QByteArray::number(row % 100)).append('\n');
+    }
+    text.append("last,n/a,0.5\n");
+
+    DelimitedImporter importer;
+    importer.setProgressVisible(false);
+    QVERIFY(importer.start(text));
+    QVERIFY(importer.waitForFinished());
+
+    ColumnarModel *model = importer.model();
+    QCOMPARE(model->rowCount(), Rows + 1);
+    QCOMPARE(model->columnType(1), ColumnarModel::ColumnType_String);
+    QCOMPARE(model->columnType(2), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model->string(0, 1), QString("0"));
+    QCOMPARE(model->string(Rows - 1, 1), QString::number(Rows - 1));
+    QCOMPARE(model->string(Rows, 1), QString("n/a"));
+    QCOMPARE(model->number(Rows - 1, 2), (double)((Rows - 1) % 100));
+    QCOMPARE(model->number(Rows, 2), 0.5);
+}
+
+void TestTableView::testDelimitedImportThroughput()
+{
+    static const int Size = 50 * 1024 * 1024;
+
+    // An export of a profile: a name, a count and a few times per line
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QByteArray text("Function,Calls,Exclusive Time,Inclusive Time,% of Total,Average\n");
+    int rows = 0;
+    qint64 written = 0;
+    while(written < Size) {
+        for(int row = 0; row < 10000; ++row, ++rows) {
+            text.append("function").append(QByteArray::number((rows * 7) % 1000)).append(',')
+                .append(QByteArray::number(rows % 5000)).append(',')
+                .append(QByteArray::number((double)((rows * 31) % 100000) / 1000.0, 'f', 3)).append(',')
+                .append(QByteArray::number((double)((rows * 17) % 100000) / 100.0, 'f', 2)).append(',')
+                .append(QByteArray::number((double)(rows % 10000) / 100.0, 'f', 2)).append(',')
+                .append(QByteArray::number((double)((rows * 13) % 1000000) / 10000.0, 'g', 10)).append('\n');
+        }
+        written += file.write(text);
+        text.clear();
+    }
+    file.close();
+
+    DelimitedImporter importer;
+    importer.setProgressVisible(false);
+
+    QVERIFY(importer.start(file.fileName()));
+    QVERIFY(importer.waitForFinished());
+
+    ColumnarModel *model = importer.model();
+    QCOMPARE(model->rowCount(), rows);
+    QCOMPARE(model->columnType(0), ColumnarModel::ColumnType_String);
+    QCOMPARE(model->columnType(1), ColumnarModel::ColumnType_Int64);
+    QCOMPARE(model->columnType(2), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model->number(rows - 1, 1), (double)((rows - 1) % 5000));
+
+    // Cancelling stops the import with an error, keeping whatever rows it had
+    QVERIFY(importer.start(file.fileName()));
+    importer.cancel();
+    QVERIFY(!importer.waitForFinished());
+    QVERIFY(!importer.errorString().isEmpty());
+    QVERIFY(model->rowCount() < rows);
+
+    QBENCHMARK {
+        importer.start(file.fileName());
+        importer.waitForFinished();
+    }
+}
+
+void TestTableView::testExport()
+{
+    QStandardItemModel model(3, 3);
+    model.setHorizontalHeaderLabels(QStringList() << "Name" << "Count" << "Hidden");
+    model.setItem(0, 0, new QStandardItem("b,x"));
+    model.setItem(1, 0, new QStandardItem("a \"q\""));
+    model.setItem(2, 0, new QStandardItem("c"));
+    for(int row = 0; row < 3; ++row) {
+        QStandardItem *item = new QStandardItem;
+        item->setData(row + 1, Qt::DisplayRole);
+        model.setItem(row, 1, item);
+        model.setItem(row, 2, new QStandardItem("hidden"));
+    }
+
+    TableView view;
+    view.setModel(&model);
+    view.sortByColumn(0, Qt::AscendingOrder);
+    view.setColumnHidden(2, true);
+
+    // Rows in view order, hidden columns left out, and awkward text quoted
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TableExporter exporter;
+    exporter.setProgressVisible(false);
+    QVERIFY(exporter.start(&view, &buffer));
+    QVERIFY(exporter.waitForFinished());
+    QCOMPARE(buffer.data(), QByteArray("Name,Count\n\"a \"\"q\"\"\",2\n\"b,x\",1\nc,3\n"));
+    QCOMPARE(exporter.bytesWritten(), (qint64)buffer.size());
+
+    // Just the selection, tab separated
+    QAbstractItemModel *proxy = view.QAbstractItemView::model();
+    view.selectionModel()->select(proxy->index(2, 0), QItemSelectionModel::Select | QItemSelectionModel::Rows);
+    buffer.close();
+    buffer.setData(QByteArray());
+    buffer.open(QIODevice::WriteOnly);
+    exporter.setDelimiter('\t');
+    exporter.setSelectionOnly(true);
+    QVERIFY(exporter.start(&view, &buffer));
+    QVERIFY(exporter.waitForFinished());
+    QCOMPARE(exporter.rowCount(), 1);
+    QCOMPARE(buffer.data(), QByteArray("Name\tCount\nc\t3\n"));
+
+    // A closed device is turned away
+    buffer.close();
+    QVERIFY(!exporter.start(&view, &buffer));
+    QVERIFY(!exporter.errorString().isEmpty());
+
+    // The worker writes to the device itself; sequential devices are left to the GUI thread.  The event loop is
+    // spun rather than calling waitForFinished(), which may run a slice's work on the waiting thread.
+    exporter.setDelimiter(',');
+    exporter.setSelectionOnly(false);
+    ThreadRecordingDevice randomAccess;
+    randomAccess.open(QIODevice::WriteOnly);
+    QVERIFY(exporter.start(&view, &randomAccess));
+    for(int i = 0; i < 100 && exporter.isRunning(); ++i) {
+        QTest::qWait(50);
+    }
+    QVERIFY(!exporter.isRunning());
+    QCOMPARE(randomAccess.data(), QByteArray("Name,Count\n\"a \"\"q\"\"\",2\n\"b,x\",1\nc,3\n"));
+    QCOMPARE(randomAccess.writers().count(), 1);
+    QVERIFY(!randomAccess.writers().contains(QThread::currentThread()));
+
+    ThreadRecordingDevice sequential(true);
+    sequential.open(QIODevice::WriteOnly);
+    QVERIFY(exporter.start(&view, &sequential));
+    for(int i = 0; i < 100 && exporter.isRunning(); ++i) {
+        QTest::qWait(50);
+    }
+    QVERIFY(!exporter.isRunning());
+    QCOMPARE(sequential.data(), randomAccess.data());
+    QCOMPARE(sequential.writers(), QSet<QThread *>() << QThread::currentThread());
+}
+
+void TestTableView::testExportLarge()
+{
+    static const int Rows = 1000000;
+    static const int Columns = 5;
+
+    ColumnarModel model;
+    fillColumnarModel(model, Rows, Columns);
+
+    TableView view;
+    view.setModel(&model);
+    view.sortByColumn(1, Qt::DescendingOrder);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    // The text goes out a slice at a time, with progress reported as each one is written
+    TableExporter exporter;
+    exporter.setProgressVisible(false);
+    QSignalSpy progress(&exporter, SIGNAL(progressChanged(int)));
+    QVERIFY(exporter.start(&view, &file));
+    QVERIFY(exporter.waitForFinished());
+    file.flush();
+
+    QCOMPARE(exporter.rowCount(), Rows);
+    QCOMPARE(file.size(), exporter.bytesWritten());
+    QVERIFY(progress.count() > 100);
+    int percent = 0;
+    for(int i = 0; i < progress.count(); ++i) {
+        QVERIFY(progress.at(i).at(0).toInt() >= percent);
+        percent = progress.at(i).at(0).toInt();
+    }
+    QCOMPARE(percent, 100);
+
+    // The text reads back in the same order
+    DelimitedImporter importer;
+    importer.setProgressVisible(false);
+    QVERIFY(importer.start(file.fileName()));
+    QVERIFY(importer.waitForFinished());
+    ColumnarModel *imported = importer.model();
+    QCOMPARE(imported->rowCount(), Rows);
+    QCOMPARE(imported->columnName(1), model.columnName(1));
+    QAbstractItemModel *proxy = view.QAbstractItemView::model();
+    for(int row = 0; row < Rows; row += Rows / 100) {
+        QCOMPARE(imported->string(row, 0), proxy->index(row, 0).data().toString());
+        QCOMPARE(imported->number(row, 1), proxy->index(row, 1).data().toDouble());
+    }
+
+    // Cancelling ends the export with an error, short of the whole text
+    qint64 size = exporter.bytesWritten();
+    file.resize(0);
+    file.seek(0);
+    QVERIFY(exporter.start(&view, &file));
+    exporter.cancel();
+    QVERIFY(!exporter.waitForFinished());
+    QVERIFY(!exporter.errorString().isEmpty());
+    QVERIFY(exporter.bytesWritten() < size);
+}
+
+void TestTableView::testExportWithoutEventLoop()
+{
+    static const int Rows = 100000;
+
+    ColumnarModel model;
+    fillColumnarModel(model, Rows, 3);
+
+    TableView view;
+    view.setModel(&model);
+
+    // Waiting goes through every slice without the watcher's notifications being delivered
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    TableExporter exporter;
+    exporter.setProgressVisible(false);
+    QSignalSpy progress(&exporter, SIGNAL(progressChanged(int)));
+    QVERIFY(exporter.start(&view, &buffer));
+    QVERIFY(exporter.waitForFinished());
+    QVERIFY(!exporter.isRunning());
+    QCOMPARE(buffer.data().count('\n'), Rows + 1);
+    QCOMPARE(exporter.bytesWritten(), (qint64)buffer.size());
+    QCOMPARE(progress.last().at(0).toInt(), 100);
+
+    // Nor do the notifications still queued from that export disturb the next one
+    QByteArray first = buffer.data();
+    buffer.close();
+    buffer.setData(QByteArray());
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(exporter.start(&view, &buffer));
+    QVERIFY(exporter.waitForFinished());
+    QCoreApplication::processEvents();
+    QVERIFY(!exporter.isRunning());
+    QCOMPARE(buffer.data(), first);
+}
+
+void TestTableView::testAggregateModel()
+{
+    QStandardItemModel source(0, 4);
+    source.setHorizontalHeaderLabels(QStringList() << "Module" << "Function" << "Time" << "Calls");
+    const char *rows[][2] = { { "libc", "malloc" }, { "app", "main" }, { "libc", "free" }, { "app", "solve" } };
+    const double times[] = { 1.0, 4.0, 3.0, 2.0 };
+    const int calls[] = { 10, 1, 5, 2 };
+    for(int row = 0; row < 4; ++row) {
+        QList<QStandardItem *> items;
+        items << new QStandardItem(rows[row][0]) << new QStandardItem(rows[row][1]) << new QStandardItem
+              << new QStandardItem;
+        items.at(2)->setData(times[row], Qt::DisplayRole);
+        items.at(3)->setData(calls[row], Qt::DisplayRole);
+        source.appendRow(items);
+    }
+
+    AggregateModel model;
+    model.setSourceModel(&source);
+    model.setGroupColumns(QList<int>() << 0);
+
+    // Groups in order of their first row, and every aggregate of both numeric columns
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.columnCount(), 12);
+    QCOMPARE(model.headerData(1, Qt::Horizontal).toString(), QString("Count"));
+    QCOMPARE(model.headerData(2, Qt::Horizontal).toString(), QString("Sum of Time"));
+    QVERIFY(model.headerData(3, Qt::Horizontal).toString().contains("%"));
+    QCOMPARE(model.index(0, 0).data().toString(), QString("libc"));
+    QCOMPARE(model.index(0, 1).data().toLongLong(), (qlonglong)2);
+    QCOMPARE(model.index(0, 2).data().toDouble(), 4.0);
+    QCOMPARE(model.index(0, 3).data().toDouble(), 40.0);
+    QCOMPARE(model.index(0, 4).data().toDouble(), 1.0);
+    QCOMPARE(model.index(0, 5).data().toDouble(), 3.0);
+    QCOMPARE(model.index(0, 6).data().toDouble(), 2.0);
+    QCOMPARE(model.index(1, 7).data().toDouble(), 3.0);
+
+    // Appended, changed and removed rows are folded into their groups
+    QList<QStandardItem *> items;
+    items << new QStandardItem("kernel") << new QStandardItem("idle") << new QStandardItem << new QStandardItem;
+    items.at(2)->setData(10.0, Qt::DisplayRole);
+    items.at(3)->setData(1, Qt::DisplayRole);
+    source.appendRow(items);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.index(0, 3).data().toDouble(), 20.0);
+
+    source.item(1, 2)->setData(5.0, Qt::DisplayRole);
+    QCOMPARE(model.index(1, 2).data().toDouble(), 7.0);
+
+    source.removeRow(0);
+    QCOMPARE(model.index(0, 1).data().toLongLong(), (qlonglong)1);
+    QCOMPARE(model.index(0, 4).data().toDouble(), 3.0);
+
+    source.removeRow(1);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.index(0, 0).data().toString(), QString("app"));
+
+    // Rows inserted in the middle move those after them; a group that loses its maximum finds it again
+    const char *inserted[][2] = { { "libc", "calloc" }, { "app", "init" } };
+    const double insertedTimes[] = { 8.0, 9.0 };
+    const int insertedRows[] = { 1, 0 };
+    for(int i = 0; i < 2; ++i) {
+        QList<QStandardItem *> items;
+        items << new QStandardItem(inserted[i][0]) << new QStandardItem(inserted[i][1]) << new QStandardItem
+              << new QStandardItem;
+        items.at(2)->setData(insertedTimes[i], Qt::DisplayRole);
+        items.at(3)->setData(1, Qt::DisplayRole);
+        source.insertRow(insertedRows[i], items);
+    }
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.index(0, 5).data().toDouble(), 9.0);
+    QCOMPARE(model.index(2, 5).data().toDouble(), 8.0);
+
+    source.removeRow(0);
+    QCOMPARE(model.index(0, 1).data().toLongLong(), (qlonglong)2);
+    QCOMPARE(model.index(0, 5).data().toDouble(), 5.0);
+    QCOMPARE(model.index(2, 5).data().toDouble(), 8.0);
+
+    source.removeRow(1);
+    QCOMPARE(model.rowCount(), 2);
+
+    AggregateModel fresh;
+    fresh.setSourceModel(&source);
+    fresh.setGroupColumns(QList<int>() << 0);
+    QVERIFY(sameAggregates(model, fresh));
+
+    // No group columns give a single row of grand totals
+    fresh.setGroupColumns(QList<int>());
+    fresh.setFunctions(AggregateModel::Function_Sum);
+    QCOMPARE(fresh.rowCount(), 1);
+    QCOMPARE(fresh.columnCount(), 3);
+    QCOMPARE(fresh.index(0, 1).data().toDouble(), 17.0);
+
+    // The view aggregates the model it is given
+    AggregateView view;
+    view.setModel(&source);
+    QCOMPARE(view.model(), (QAbstractItemModel *)&source);
+    QCOMPARE(view.aggregateModel()->rowCount(), 2);
+}
+
+void TestTableView::testAggregateModelLarge()
+{
+    static const int Rows = 1000000;
+
+    ColumnarModel source;
+    fillColumnarModel(source, Rows, 5);
+
+    AggregateModel model;
+    model.setSourceModel(&source);
+    model.setGroupColumns(QList<int>() << 0);
+    QVERIFY(model.isBusy());
+    model.waitForFinished();
+
+    QCOMPARE(model.rowCount(), 1000);
+    QHash<QString, double> sums;
+    for(int row = 0; row < Rows; ++row) {
+        sums[source.string(row, 0)] += source.number(row, 1);
+    }
+    for(int group = 0; group < model.rowCount(); ++group) {
+        double expected = sums.value(model.index(group, 0).data().toString());
+        QVERIFY(qAbs(model.index(group, 2).data().toDouble() - expected) < 1e-6 * qMax(1.0, expected));
+    }
+
+    // A small append is folded in without aggregating everything again
+    int first = source.beginAppendRows(1000);
+    for(int row = first; row < first + 1000; ++row) {
+        source.setString(row, 0, "appended");
+        for(int column = 1; column < 5; ++column) {
+            source.setDouble(row, column, 1.0);
+        }
+    }
+    source.endAppendRows();
+    QVERIFY(!model.isBusy());
+    QCOMPARE(model.rowCount(), 1001);
+    QCOMPARE(model.index(1000, 1).data().toLongLong(), (qlonglong)1000);
+    QCOMPARE(model.index(1000, 2).data().toDouble(), 1000.0);
+
+    QBENCHMARK {
+        model.setGroupColumns(QList<int>() << 0);
+        model.waitForFinished();
+    }
+}
+
+void TestTableView::testDerivedColumns()
+{
+    ColumnarModel source;
+    source.addColumn("Function", ColumnarModel::ColumnType_String);
+    source.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+    source.addColumn("Time", ColumnarModel::ColumnType_Double);
+    source.addColumn("Baseline", ColumnarModel::ColumnType_Double);
+    source.beginAppendRows(4);
+    for(int row = 0; row < 4; ++row) {
+        source.setString(row, 0, QString("function%1").arg(row));
+        source.setInt64(row, 1, row);
+        source.setDouble(row, 2, (row + 1) * 10.0);
+        source.setDouble(row, 3, (row % 2) ? 20.0 : 0.0);
+    }
+    source.endAppendRows();
+
+    DerivedColumnModel model;
+    model.setSourceModel(&source);
+    QCOMPARE(model.columnCount(), 4);
+    QCOMPARE(model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, 0), -1);
+    QCOMPARE(model.addDerivedColumn(DerivedColumnModel::Operation_Ratio, 2, 0), -1);
+
+    int percent = model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, 2);
+    int ratio = model.addDerivedColumn(DerivedColumnModel::Operation_Ratio, 2, 1);
+    int difference = model.addDerivedColumn(DerivedColumnModel::Operation_Difference, 2, 3);
+    int change = model.addDerivedColumn(DerivedColumnModel::Operation_PercentChange, 2, 3);
+    int derived = model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, difference);
+    QCOMPARE(percent, 4);
+    QCOMPARE(derived, 8);
+    QCOMPARE(model.columnCount(), 9);
+    QCOMPARE(model.derivedColumnCount(), 5);
+    QVERIFY(model.headerData(percent, Qt::Horizontal).toString().contains('%'));
+    QCOMPARE(model.columnType(ratio), ColumnarModel::ColumnType_Double);
+    QCOMPARE(model.index(1, 0).data().toString(), QString("function1"));
+
+    // Totals: time 100; difference 60
+    QCOMPARE(model.index(0, percent).data().toDouble(), 10.0);
+    QCOMPARE(model.index(3, percent).data().toDouble(), 40.0);
+    QCOMPARE(model.index(0, ratio).data().toDouble(), 0.0);
+    QCOMPARE(model.index(2, ratio).data().toDouble(), 15.0);
+    QCOMPARE(model.index(1, difference).data().toDouble(), 0.0);
+    QCOMPARE(model.index(2, difference).data().toDouble(), 30.0);
+    QCOMPARE(model.index(0, change).data().toDouble(), 0.0);
+    QCOMPARE(model.index(3, change).data().toDouble(), 100.0);
+    QCOMPARE(model.index(2, derived).data().toDouble(), 50.0);
+
+    // Derived columns sort through the columnar fast path
+    SortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.sort(ratio, Qt::DescendingOrder);
+    QVERIFY(isSorted(proxy, ratio, Qt::DescendingOrder));
+
+    // Appended rows and changed values are picked up by the columns that read them
+    int first = source.beginAppendRows(1);
+    source.setString(first, 0, "appended");
+    source.setInt64(first, 1, 1);
+    source.setDouble(first, 2, 100.0);
+    source.setDouble(first, 3, 0.0);
+    source.endAppendRows();
+    QCOMPARE(model.rowCount(), 5);
+    QCOMPARE(model.index(4, percent).data().toDouble(), 50.0);
+    QCOMPARE(model.index(0, percent).data().toDouble(), 5.0);
+    QCOMPARE(model.index(4, ratio).data().toDouble(), 100.0);
+
+    // A removed input takes the columns that read it along
+    model.removeDerivedColumn(difference);
+    QCOMPARE(model.derivedColumnCount(), 3);
+    QCOMPARE(model.columnCount(), 7);
+    QCOMPARE(model.index(2, 6).data().toDouble(), 0.0);
+    QVERIFY(model.columnName(6).contains("change"));
+
+    // New source columns push the derived ones along
+    source.addColumn("Extra", ColumnarModel::ColumnType_Double);
+    QCOMPARE(model.columnCount(), 8);
+    QCOMPARE(model.index(2, ratio + 1).data().toDouble(), 15.0);
+
+    model.clearDerivedColumns();
+    QCOMPARE(model.columnCount(), 5);
+}
+
+void TestTableView::testDerivedColumnsEmptyCells()
+{
+    ColumnarModel source;
+    source.addColumn("Time", ColumnarModel::ColumnType_Double);
+    source.beginAppendRows(5);
+    for(int row = 0; row < 5; ++row) {
+        source.setDouble(row, 0, (row == 2) ? std::numeric_limits<double>::quiet_NaN() : (row + 1) * 10.0);
+    }
+    source.endAppendRows();
+
+    DerivedColumnModel model;
+    model.setSourceModel(&source);
+    int percent = model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, 0);
+
+    // An empty cell is left out of the total, 120, and stays empty itself
+    const double *values = model.doubleColumn(percent);
+    QVERIFY(values);
+    QVERIFY(values[2] != values[2]);
+    QCOMPARE(values[0], 1000.0 / 120.0);
+    QCOMPARE(values[4], 5000.0 / 120.0);
+    QCOMPARE(values[0] + values[1] + values[3] + values[4], 100.0);
+}
+
+void TestTableView::testDerivedColumnsLarge()
+{
+    static const int Rows = 10000000;
+
+    ColumnarModel source;
+    source.addColumn("Time", ColumnarModel::ColumnType_Double);
+    source.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+    source.reserve(Rows);
+    source.beginAppendRows(Rows);
+    for(int row = 0; row < Rows; ++row) {
+        source.setDouble(row, 0, (double)(row % 1000) / 10.0);
+        source.setInt64(row, 1, row % 7);
+    }
+    source.endAppendRows();
+
+    DerivedColumnModel model;
+    model.setSourceModel(&source);
+
+    int percent = model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, 0);
+    int ratio = model.addDerivedColumn(DerivedColumnModel::Operation_Ratio, 0, 1);
+    const double *percents = model.doubleColumn(percent);
+    const double *ratios = model.doubleColumn(ratio);
+
+    QVERIFY(percents && ratios);
+    QCOMPARE(ratios[15], 1.5);
+    QCOMPARE(ratios[14], 0.0);
+    // Every thousand rows sum to 49950, so the total is 4.995e8
+    QVERIFY(qAbs(percents[999] / 2e-5 - 1.0) < 1e-9);
+
+    // Cached until the source changes
+    QCOMPARE(model.doubleColumn(percent), percents);
+
+    QBENCHMARK {
+        model.clearDerivedColumns();
+        model.addDerivedColumn(DerivedColumnModel::Operation_PercentOfTotal, 0);
+        model.doubleColumn(percent);
+    }
+}
@@ -0,0 +1,680 @@
+/*!
+   \file TestViewManager.cpp
+   \author Dane Gardner <dane.gardner@gmail.com>
+
+   \section LICENSE
+   This file is part of the Parallel Tools GUI Framework (PTGF)
+   Copyright (C) 2010-2015 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TestViewManager.h"
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryFile>
+#include <QMutex>
+#include <QSemaphore>
+#include <limits>
+
+#include <ViewManager/ColumnarModel.h>
+#include <ViewManager/FilterExpression.h>
+#include <ViewManager/MappedColumnarModel.h>
+#include <ViewManager/PagedModel.h>
+using namespace Core::ViewManager;
+
+
+static QStringList columnNames()
+{
+    return QStringList() << "Exclusive Time (ms)" << "Inclusive Time (ms)" << "Function" << "Calls";
+}
+
+/* Rows of doubles in a binary file, read with a seek per page */
+class BinaryFileStore : public PagedModel::Store
+{
+public:
+    BinaryFileStore(const QString &fileName, int columns) : m_File(fileName), m_Columns(columns) { m_File.open(QIODevice::ReadOnly); }
+
+    int rowCount() const { return (int)(m_File.size() / (m_Columns * sizeof(double))); }
+    QStringList columnNames() const
+    {
+        QStringList names;
+        for(int column = 0; column < m_Columns; ++column) {
+            names.append(QString("Column %1").arg(column));
+        }
+        return names;
+    }
+
+    bool readRows(int first, int count, QVector<QVariant> &values)
+    {
+        QVector<double> buffer(count * m_Columns);
+        qint64 bytes = buffer.count() * sizeof(double);
+        if(!m_File.seek((qint64)first * m_Columns * sizeof(double)) || m_File.read((char *)buffer.data(), bytes) != bytes) {
+            return false;
+        }
+        foreach(double value, buffer) {
+            values.append(value);
+        }
+        return true;
+    }
+
+private:
+    QFile m_File;
+    int m_Columns;
+};
+
+/* Computes its rows, standing in for a store far larger than memory */
+class GeneratedStore : public PagedModel::Store
+{
+public:
+    explicit GeneratedStore(int rows) : m_Rows(rows) {}
+
+    int rowCount() const { return m_Rows; }
+    QStringList columnNames() const { return QStringList() << "Row" << "Time"; }
+
+    bool readRows(int first, int count, QVector<QVariant> &values)
+    {
+        for(int row = first; row < first + count; ++row) {
+            values.append(row);
+            values.append((double)(((qint64)row * 7919) % 1000) / 10.0);
+        }
+        return true;
+    }
+
+private:
+    int m_Rows;
+};
+
+/* Records which pages it is asked for, holding the loader thread in the first read until open() */
+class GatedStore : public PagedModel::Store
+{
+public:
+    GatedStore(int rows, int pageSize) : m_Rows(rows), m_PageSize(pageSize) {}
+
+    int rowCount() const { return m_Rows; }
+    QStringList columnNames() const { return QStringList() << "Row"; }
+
+    bool readRows(int first, int count, QVector<QVariant> &values)
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Pages.append(first / m_PageSize);
+        locker.unlock();
+
+        // The first page is read by setStore() on the GUI thread, and mustn't wait
+        if(first > 0) {
+            m_Gate.acquire();
+            m_Gate.release();
+        }
+
+        for(int row = first; row < first + count; ++row) {
+            values.append(row);
+        }
+        return true;
+    }
+
+    void open() { m_Gate.release(); }
+    QList<int> pages() const { QMutexLocker locker(&m_Mutex); return m_Pages; }
+
+private:
+    int m_Rows;
+    int m_PageSize;
+    mutable QMutex m_Mutex;
+    QList<int> m_Pages;
+    QSemaphore m_Gate;
+};
+
+/* Spins the event loop until the page holding \a row has been delivered, or five seconds have passed */
+static bool waitForRow(const PagedModel &model, int row)
+{
+    for(int i = 0; i < 100 && !model.isRowLoaded(row); ++i) {
+        QTest::qWait(50);
+    }
+    return model.isRowLoaded(row);
+}
+
+
+TestViewManager::TestViewManager(QObject *parent) :
+    QObject(parent)
+{
+}
+
+void TestViewManager::initTestCase()
+{
+}
+
+void TestViewManager::cleanupTestCase()
+{
+}
+
+void TestViewManager::testFilterExpressionCompile_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<QString>("columns");
+
+    QTest::newRow("empty") << QString("  ") << true << QString();
+    QTest::newRow("abbreviated") << QString("excl_time > 0.5") << true << QString("0");
+    QTest::newRow("quoted") << QString("\"Inclusive Time (ms)\" >= 1e-3") << true << QString("1");
+    QTest::newRow("index") << QString("$4 != 0") << true << QString("3");
+    QTest::newRow("logic") << QString("excl > 0.5 && function ~ \"MPI_\" || not (calls < 10)") << true << QString("0,2,3");
+    QTest::newRow("keywords") << QString("function = main and calls > -1") << true << QString("2,3");
+    QTest::newRow("not a prefix") << QString("time > 0") << false << QString();
+    QTest::newRow("unknown") << QString("bogus > 0") << false << QString();
+    QTest::newRow("no operator") << QString("calls 5") << false << QString();
+    QTest::newRow("no value") << QString("calls >") << false << QString();
+    QTest::newRow("unbalanced") << QString("(calls > 5") << false << QString();
+    QTest::newRow("trailing") << QString("calls > 5)") << false << QString();
+    QTest::newRow("unterminated") << QString("function == \"main") << false << QString();
+    QTest::newRow("bad regexp") << QString("function ~ \"(\"") << false << QString();
+}
+
+void TestViewManager::testFilterExpressionCompile()
+{
+    QFETCH(QString, pattern);
+    QFETCH(bool, valid);
+    QFETCH(QString, columns);
+
+    FilterExpression expression(pattern, columnNames());
+    QCOMPARE(expression.isValid(), valid);
+    QCOMPARE(expression.errorString().isEmpty(), valid);
+
+    QStringList referenced;
+    foreach(int column, expression.columns()) {
+        referenced.append(QString::number(column));
+    }
+    QCOMPARE(referenced.join(","), columns);
+}
+
+void TestViewManager::testFilterExpressionEvaluate_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("accepted");
+
+    // Rows: (0.25, 1, MPI_Send, 3) (0.75, empty, main, 1) (1.5, 3, MPI_Recv, 40) (0.5, 4, mpi_wait, 12)
+    QTest::newRow("empty") << QString() << QString("1111");
+    QTest::newRow("greater") << QString("excl > 0.5") << QString("0110");
+    QTest::newRow("greater equal") << QString("excl >= 0.5") << QString("0111");
+    QTest::newRow("equal") << QString("excl == 0.5") << QString("0001");
+    QTest::newRow("match") << QString("function ~ \"^MPI_\"") << QString("1011");
+    QTest::newRow("not match") << QString("function !~ \"^MPI_\"") << QString("0100");
+    QTest::newRow("string equal") << QString("function == MAIN") << QString("0100");
+    QTest::newRow("string less") << QString("function < \"MPI_S\"") << QString("0110");
+    QTest::newRow("number as text") << QString("calls ~ \"^[14]\"") << QString("0111");
+    QTest::newRow("and") << QString("excl > 0.3 && calls > 5") << QString("0011");
+    QTest::newRow("or") << QString("excl < 0.3 || calls == 1") << QString("1100");
+    QTest::newRow("not") << QString("!(excl > 0.3 && calls > 5)") << QString("1100");
+    QTest::newRow("precedence") << QString("calls == 3 || calls == 1 && excl > 1") << QString("1000");
+    QTest::newRow("empty less") << QString("incl < 10") << QString("1011");
+    QTest::newRow("empty greater equal") << QString("incl >= 0") << QString("1011");
+    QTest::newRow("empty not equal") << QString("incl != 3") << QString("1101");
+    QTest::newRow("empty as text") << QString("incl ~ \"^$\"") << QString("0100");
+}
+
+void TestViewManager::testFilterExpressionEvaluate()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, accepted);
+
+    QVector<double> exclusive;
+    exclusive << 0.25 << 0.75 << 1.5 << 0.5;
+    QVector<double> inclusive;
+    inclusive << 1.0 << std::numeric_limits<double>::quiet_NaN() << 3.0 << 4.0;
+    QVector<QString> function;
+    function << "MPI_Send" << "main" << "MPI_Recv" << "mpi_wait";
+    QVector<double> calls;
+    calls << 3 << 1 << 40 << 12;
+
+    FilterExpression expression(pattern, columnNames());
+    QVERIFY2(expression.isValid(), qPrintable(expression.errorString()));
+
+    QVector<FilterExpression::Column> columns;
+    foreach(int column, expression.columns()) {
+        FilterExpression::Column values;
+        switch(column) {
+        case 0: values.numbers = exclusive.constData(); break;
+        case 1: values.numbers = inclusive.constData(); break;
+        case 2: values.strings = function.constData(); break;
+        case 3: values.numbers = calls.constData(); break;
+        }
+        columns.append(values);
+    }
+
+    QVector<char> result = expression.evaluate(columns, 4);
+    QString flags;
+    foreach(char flag, result) {
+        flags.append(flag ? '1' : '0');
+    }
+    QCOMPARE(flags, accepted);
+}
+
+void TestViewManager::testFilterExpressionScale()
+{
+    static const int Rows = 10000000;
+
+    QVector<double> exclusive(Rows);
+    QVector<double> calls(Rows);
+    for(int row = 0; row < Rows; ++row) {
+        exclusive[row] = (double)(((qint64)row * 7919) % 1000) / 1000.0;
+        calls[row] = row % 100;
+    }
+
+    FilterExpression expression("excl_time > 0.5 && (calls < 10 || !(calls >= 90))", columnNames());
+    QVERIFY(expression.isValid());
+
+    QVector<FilterExpression::Column> columns(2);
+    columns[0].numbers = exclusive.constData();
+    columns[1].numbers = calls.constData();
+
+    QVector<char> accepted = expression.evaluate(columns, Rows);
+
+    int count = 0;
+    int mismatches = 0;
+    for(int row = 0; row < Rows; ++row) {
+        bool expected = exclusive.at(row) > 0.5 && (calls.at(row) < 10 || !(calls.at(row) >= 90));
+        mismatches += ((accepted.at(row) != 0) != expected) ? 1 : 0;
+        count += accepted.at(row);
+    }
+    QCOMPARE(mismatches, 0);
+    QVERIFY(count > 0);
+
+    QBENCHMARK {
+        expression.evaluate(columns, Rows);
+    }
+}
+
+void TestViewManager::testColumnarModel()
+{
+    ColumnarModel model;
+    QCOMPARE(model.addColumn("Function", ColumnarModel::ColumnType_String), 0);
+    QCOMPARE(model.addColumn("Calls", ColumnarModel::ColumnType_Int64), 1);
+    QCOMPARE(model.addColumn("Time", ColumnarModel::ColumnType_Double), 2);
+    QCOMPARE(model.headerData(2, Qt::Horizontal).toString(), QString("Time"));
+
+    QSignalSpy inserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy changed(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // Rows being appended stay hidden, and quiet, until endAppendRows()
+    model.reserve(1000);
+    int first = model.beginAppendRows(1000);
+    QCOMPARE(first, 0);
+    for(int row = 0; row < 1000; ++row) {
+        model.setString(row, 0, QString("function%1").arg(row % 10));
+        model.setInt64(row, 1, row);
+        model.setDouble(row, 2, row / 4.0);
+    }
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(changed.count(), 0);
+
+    model.endAppendRows();
+    QCOMPARE(model.rowCount(), 1000);
+    QCOMPARE(inserted.count(), 1);
+
+    QCOMPARE(model.index(7, 0).data().toString(), QString("function7"));
+    QCOMPARE(model.index(7, 1).data().toLongLong(), (qlonglong)7);
+    QCOMPARE(model.index(7, 2).data().toDouble(), 1.75);
+    QCOMPARE(model.number(7, 1), 7.0);
+    QCOMPARE(model.string(7, 1), QString("7"));
+    QCOMPARE(model.doubleColumn(2)[9], 2.25);
+    QVERIFY(!model.doubleColumn(1));
+
+    // Each distinct string is held once, plus the empty string
+    QCOMPARE(model.internedStringCount(), 11);
+    QCOMPARE(model.internedString(model.stringColumn(0)[13]), QString("function3"));
+
+    model.setDouble(7, 2, 3.0);
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(model.number(7, 2), 3.0);
+
+    QVERIFY(model.memoryUsage() >= 1000 * (qint64)(sizeof(quint32) + sizeof(qint64) + sizeof(double)));
+
+    model.clear();
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.columnCount(), 0);
+    QCOMPARE(model.internedStringCount(), 1);
+}
+
+void TestViewManager::testColumnarModelRanks()
+{
+    ColumnarModel model;
+    model.addColumn("Name", ColumnarModel::ColumnType_String);
+
+    QStringList names;
+    names << "pear" << "Apple" << "apple" << "banana";
+    model.beginAppendRows(names.count());
+    for(int row = 0; row < names.count(); ++row) {
+        model.setString(row, 0, names.at(row));
+    }
+    model.endAppendRows();
+
+    const quint32 *ids = model.stringColumn(0);
+
+    QVector<quint32> ranks = model.internedStringRanks(Qt::CaseSensitive);
+    QVERIFY(ranks.at(ids[1]) < ranks.at(ids[2]));
+    QVERIFY(ranks.at(ids[2]) < ranks.at(ids[3]));
+    QVERIFY(ranks.at(ids[3]) < ranks.at(ids[0]));
+
+    ranks = model.internedStringRanks(Qt::CaseInsensitive);
+    QCOMPARE(ranks.at(ids[1]), ranks.at(ids[2]));
+    QVERIFY(ranks.at(ids[2]) < ranks.at(ids[3]));
+}
+
+void TestViewManager::testColumnarModelAppend()
+{
+    static const int Rows = 200000;
+
+    // Appending row by row, past a small reserve(), grows the columns geometrically rather than to each new size
+    QBENCHMARK {
+        ColumnarModel model;
+        model.addColumn("Function", ColumnarModel::ColumnType_String);
+        model.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+        model.addColumn("Time", ColumnarModel::ColumnType_Double);
+        model.reserve(100);
+        for(int row = 0; row < Rows; ++row) {
+            QCOMPARE(model.beginAppendRows(1), row);
+            model.setString(row, 0, QString("function%1").arg(row % 10));
+            model.setInt64(row, 1, row);
+            model.setDouble(row, 2, row / 4.0);
+            model.endAppendRows();
+        }
+
+        QCOMPARE(model.rowCount(), Rows);
+        QCOMPARE(model.index(99, 1).data().toLongLong(), (qlonglong)99);
+        QCOMPARE(model.index(Rows - 1, 0).data().toString(), QString("function9"));
+        QCOMPARE(model.number(Rows - 1, 1), (double)(Rows - 1));
+        QCOMPARE(model.doubleColumn(2)[Rows / 2], Rows / 8.0);
+        QVERIFY(model.memoryUsage() >= Rows * (qint64)(sizeof(quint32) + sizeof(qint64) + sizeof(double)));
+    }
+}
+
+void TestViewManager::testMappedColumnarModel()
+{
+    ColumnarModel model;
+    model.addColumn("Function", ColumnarModel::ColumnType_String);
+    model.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+    model.addColumn("Time (ms)", ColumnarModel::ColumnType_Double);
+    model.beginAppendRows(1000);
+    for(int row = 0; row < 1000; ++row) {
+        model.setString(row, 0, QString::fromUtf8("funci\xc3\xb3n%1").arg(row % 10));
+        model.setInt64(row, 1, (qint64)row << 33);
+        model.setDouble(row, 2, row / 8.0);
+    }
+    model.endAppendRows();
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+    QString errorMessage;
+    QVERIFY2(model.save(file.fileName(), &errorMessage), qPrintable(errorMessage));
+
+    MappedColumnarModel mapped;
+    QVERIFY2(mapped.open(file.fileName()), qPrintable(mapped.errorString()));
+    QVERIFY(mapped.isOpen());
+    QCOMPARE(mapped.fileVersion(), (quint32)1);
+    QCOMPARE(mapped.rowCount(), 1000);
+    QCOMPARE(mapped.columnCount(), 3);
+    QCOMPARE(mapped.headerData(2, Qt::Horizontal).toString(), QString("Time (ms)"));
+    QCOMPARE(mapped.columnType(1), AbstractColumnarModel::ColumnType_Int64);
+
+    for(int row = 0; row < 1000; row += 37) {
+        for(int column = 0; column < 3; ++column) {
+            QCOMPARE(mapped.index(row, column).data(), model.index(row, column).data());
+        }
+    }
+    QCOMPARE(mapped.internedStringCount(), model.internedStringCount());
+    QCOMPARE(mapped.internedStringRanks(), model.internedStringRanks());
+
+    mapped.close();
+    QVERIFY(!mapped.isOpen());
+    QCOMPARE(mapped.rowCount(), 0);
+}
+
+void TestViewManager::testMappedColumnarModelErrors()
+{
+    ColumnarModel model;
+    model.addColumn("Time", ColumnarModel::ColumnType_Double);
+    model.beginAppendRows(100);
+    model.endAppendRows();
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+    QVERIFY(model.save(file.fileName()));
+
+    QFile raw(file.fileName());
+    QVERIFY(raw.open(QIODevice::ReadOnly));
+    QByteArray contents = raw.readAll();
+    raw.close();
+
+    MappedColumnarModel mapped;
+
+    // A newer version than this code knows about
+    QByteArray future = contents;
+    future[12] = 2;
+    QVERIFY(raw.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    raw.write(future);
+    raw.close();
+    QVERIFY(!mapped.open(file.fileName()));
+    QVERIFY(!mapped.errorString().isEmpty());
+    QCOMPARE(mapped.rowCount(), 0);
+
+    // A file cut short
+    QVERIFY(raw.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    raw.write(contents.left(contents.size() - 500));
+    raw.close();
+    QVERIFY(!mapped.open(file.fileName()));
+
+    // Not a table at all
+    QVERIFY(raw.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    raw.write(QByteArray(1024, 'x'));
+    raw.close();
+    QVERIFY(!mapped.open(file.fileName()));
+    QVERIFY(!mapped.isOpen());
+}
+
+void TestViewManager::testMappedColumnarModelOpenTime()
+{
+    static const int Rows = 4000000;
+
+    ColumnarModel model;
+    model.addColumn("Function", ColumnarModel::ColumnType_String);
+    model.addColumn("Time", ColumnarModel::ColumnType_Double);
+    model.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+    model.reserve(Rows);
+    model.beginAppendRows(Rows);
+    for(int row = 0; row < Rows; ++row) {
+        model.setString(row, 0, QString("function%1").arg(row % 5000));
+        model.setDouble(row, 1, row * 0.5);
+        model.setInt64(row, 2, row);
+    }
+    model.endAppendRows();
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+    QVERIFY(model.save(file.fileName()));
+    model.clear();
+
+    // Opening maps the file without reading it, however large it is
+    MappedColumnarModel mapped;
+    QBENCHMARK {
+        QVERIFY(mapped.open(file.fileName()));
+    }
+    QCOMPARE(mapped.rowCount(), Rows);
+    QCOMPARE(mapped.index(Rows - 1, 0).data().toString(), QString("function%1").arg((Rows - 1) % 5000));
+    QCOMPARE(mapped.index(Rows - 1, 2).data().toLongLong(), (qlonglong)Rows - 1);
+
+    // The columns are never copied out of the mapping: a value changed on disk after open() shows through
+    static const qint64 Marker = Q_INT64_C(0x0123456789abcdef);
+    ColumnarModel small;
+    small.addColumn("Calls", ColumnarModel::ColumnType_Int64);
+    small.beginAppendRows(3);
+    small.setInt64(0, 0, 1);
+    small.setInt64(1, 0, Marker);
+    small.setInt64(2, 0, 3);
+    small.endAppendRows();
+
+    QTemporaryFile smallFile;
+    QVERIFY(smallFile.open());
+    smallFile.close();
+    QVERIFY(small.save(smallFile.fileName()));
+
+    QFile raw(smallFile.fileName());
+    QVERIFY(raw.open(QIODevice::ReadWrite));
+    int offset = raw.readAll().indexOf(QByteArray((const char *)&Marker, sizeof(Marker)));
+    QVERIFY(offset >= 0);
+
+    QVERIFY(mapped.open(smallFile.fileName()));
+    QCOMPARE(mapped.index(1, 0).data().toLongLong(), (qlonglong)Marker);
+
+    qint64 changed = 42;
+    QVERIFY(raw.seek(offset));
+    QCOMPARE(raw.write((const char *)&changed, sizeof(changed)), (qint64)sizeof(changed));
+    raw.close();
+    QCOMPARE(mapped.index(1, 0).data().toLongLong(), (qlonglong)42);
+}
+
+void TestViewManager::testPagedModel()
+{
+    static const int Rows = 200000;
+    static const int Columns = 4;
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVector<double> row(Columns);
+    for(int i = 0; i < Rows; ++i) {
+        for(int column = 0; column < Columns; ++column) {
+            row[column] = i + column / 10.0;
+        }
+        file.write((const char *)row.constData(), Columns * sizeof(double));
+    }
+    file.close();
+
+    PagedModel model;
+    model.setPageSize(1000);
+    model.setFetchBatchSize(50000);
+    model.setStore(new BinaryFileStore(file.fileName(), Columns));
+
+    // Rows are exposed a batch at a time
+    QCOMPARE(model.columnCount(), Columns);
+    QCOMPARE(model.rowCount(), 50000);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 100000);
+
+    // The first page is read up front; the rest show the placeholder until they arrive
+    QVERIFY(model.isRowLoaded(999));
+    QCOMPARE(model.index(10, 2).data().toDouble(), 10.2);
+    QVERIFY(!model.isRowLoaded(75000));
+
+    QSignalSpy changed(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    QCOMPARE(model.index(75000, 1).data(), model.placeholder());
+    QVERIFY(waitForRow(model, 75000));
+    QCOMPARE(changed.count(), 1);
+    QCOMPARE(model.index(75000, 1).data().toDouble(), 75000.1);
+
+    while(model.canFetchMore(QModelIndex())) {
+        model.fetchMore(QModelIndex());
+    }
+    QCOMPARE(model.rowCount(), Rows);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+}
+
+void TestViewManager::testPagedModelRandomAccess()
+{
+    static const int Rows = 100000000;
+
+    PagedModel model;
+    model.setMaximumPages(64);
+    model.setFetchBatchSize(0);
+    model.setStore(new GeneratedStore(Rows));
+    QCOMPARE(model.rowCount(), Rows);
+
+    // Jumping all over the store never holds more than the maximum number of pages
+    QBENCHMARK {
+        for(int i = 0; i < 1000; ++i) {
+            int row = (int)(((qint64)i * 104729 * 1009) % Rows);
+            model.index(row, 1).data();
+        }
+    }
+    QVERIFY(model.cachedPages() <= model.maximumPages());
+
+    int row = Rows - 1;
+    model.index(row, 0).data();
+    QVERIFY(waitForRow(model, row));
+    QCOMPARE(model.index(row, 0).data().toInt(), row);
+    QVERIFY(model.cachedPages() <= model.maximumPages());
+}
+
+void TestViewManager::testPagedModelRequestOrder()
+{
+    static const int PageSize = 100;
+
+    GatedStore *store = new GatedStore(100000, PageSize);
+    PagedModel model;
+    model.setPageSize(PageSize);
+    model.setMaximumPages(4);
+    model.setFetchBatchSize(0);
+    model.setStore(store);
+
+    // Asking for a page answers with the placeholder, and the loader picks it up
+    QCOMPARE(model.index(10 * PageSize, 0).data(), model.placeholder());
+    for(int i = 0; i < 100 && store->pages().count() < 2; ++i) {
+        QTest::qWait(10);
+    }
+    QCOMPARE(store->pages(), QList<int>() << 0 << 10);
+
+    // While it is held there, five more are asked for; only the four most recent stay queued...
+    for(int page = 20; page <= 60; page += 10) {
+        model.index(page * PageSize, 0).data();
+    }
+    store->open();
+
+    // ...and are read most recently asked for first
+    QVERIFY(waitForRow(model, 30 * PageSize));
+    QCOMPARE(store->pages(), QList<int>() << 0 << 10 << 60 << 50 << 40 << 30);
+    QVERIFY(!model.isRowLoaded(20 * PageSize));
+    QCOMPARE(model.index(30 * PageSize, 0).data().toInt(), 30 * PageSize);
+}
+
+void TestViewManager::testPagedModelEviction()
+{
+    PagedModel model;
+    model.setPageSize(100);
+    model.setMaximumPages(4);
+    model.setFetchBatchSize(0);
+    model.setStore(new GeneratedStore(100000));
+
+    for(int page = 1; page <= 3; ++page) {
+        model.index(page * 100, 0).data();
+        QVERIFY(waitForRow(model, page * 100));
+    }
+    QCOMPARE(model.cachedPages(), 4);
+
+    // Reading page 0 leaves page 1 least recently used, so it is the one dropped to make room for page 5
+    QCOMPARE(model.index(0, 0).data().toInt(), 0);
+    model.index(500, 0).data();
+    QVERIFY(waitForRow(model, 500));
+    QCOMPARE(model.cachedPages(), 4);
+    QVERIFY(model.isRowLoaded(0));
+    QVERIFY(!model.isRowLoaded(100));
+    QVERIFY(model.isRowLoaded(200));
+    QVERIFY(model.isRowLoaded(300));
+
+    // A dropped page is read again when it is next shown
+    QCOMPARE(model.index(100, 0).data(), model.placeholder());
+    QVERIFY(waitForRow(model, 100));
+    QCOMPARE(model.index(150, 0).data().toInt(), 150);
+}
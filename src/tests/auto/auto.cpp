@@ -27,11 +27,14 @@
 #include "TestPluginManager.h"
 #include "TestActionManager.h"
 //#include "TestNotificationManager.h"
-//#include "TestSettingManager.h"
-//#include "TestViewManager.h"
+#include "TestSettingManager.h"
+#include "TestViewManager.h"
 //#include "TestWindowManager.h"
 
 #include "TestNodeListView.h"
+#include "TestTableView.h"
+#include "TestSourceView.h"
+#include "TestProcessList.h"
 
 
 #define RUNTEST(t) t t##instance; QTest::qExec(&t##instance)
@@ -44,11 +47,14 @@ int main(int argc, char **argv)
 //    RUNTEST(TestPluginManager);
     RUNTEST(TestActionManager);
 //    RUNTEST(TestNotificationManager);
-//    RUNTEST(TestSettingManager);
-//    RUNTEST(TestViewManager);
+    RUNTEST(TestSettingManager);
+    RUNTEST(TestViewManager);
 //    RUNTEST(TestWindowManager);
 
     RUNTEST(TestNodeListView);
+    RUNTEST(TestTableView);
+    RUNTEST(TestSourceView);
+    RUNTEST(TestProcessList);
 
     return 0;
 }
@@ -20,6 +20,26 @@ include(../../PTGF.pri)
 QT       += testlib
 TEMPLATE  = app
 
+greaterThan(QT_MAJOR_VERSION, 4) {
+    qtHaveModule(xml) {
+        QT += xml
+    } else {
+        DEFINES += NO_XML_MODULE
+    }
+} else {
+    QT += xml
+}
+
+greaterThan(QT_MAJOR_VERSION, 4) {
+    qtHaveModule(sql) {
+        QT += sql
+    } else {
+        DEFINES += NO_SQL_MODULE
+    }
+} else {
+    QT += sql
+}
+
 CONFIG(debug, debug|release) {
   TARGET = $${APPLICATION_TARGET}AutoTestsD
 } else {
@@ -30,15 +50,28 @@ CONFIG(debug, debug|release) {
 SOURCES  += auto.cpp \
             TestActionManager.cpp \
             TestPluginManager.cpp \
-            TestNodeListView.cpp
+            TestSettingManager.cpp \
+            TestViewManager.cpp \
+            TestNodeListView.cpp \
+            TestTableView.cpp \
+            TestSourceView.cpp \
+            TestProcessList.cpp
 
 HEADERS  += TestActionManager.h \
             TestPluginManager.h \
-            TestNodeListView.h
+            TestSettingManager.h \
+            TestViewManager.h \
+            TestNodeListView.h \
+            TestTableView.h \
+            TestSourceView.h \
+            TestProcessList.h
 
 
 LIBS    += -L$$quote($${BUILD_PATH}/core/lib/$${DIR_POSTFIX}) -lCore$${LIB_POSTFIX}
 LIBS    += -L$$quote($${BUILD_PATH}/plugins/NodeListView/$${DIR_POSTFIX}) -lNodeListView$${LIB_POSTFIX}
+LIBS    += -L$$quote($${BUILD_PATH}/plugins/TableView/$${DIR_POSTFIX}) -lTableView$${LIB_POSTFIX}
+LIBS    += -L$$quote($${BUILD_PATH}/plugins/SourceView/$${DIR_POSTFIX}) -lSourceView$${LIB_POSTFIX}
+LIBS    += -L$$quote($${BUILD_PATH}/plugins/ProcessList/$${DIR_POSTFIX}) -lProcessList$${LIB_POSTFIX}
 
 win32:target.path = /
 else:target.path  = /bin